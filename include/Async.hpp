@@ -39,6 +39,8 @@ private:
     std::mutex mutex_;
     uv_async_t* handle_;
     std::queue<DefaultCallback> callbacks_;
+    //队列由空变为非空的时刻，用于统计跨线程调用的排队时延。
+    uint64_t queuedTime_;
     OnCloseCompletedCallback onCloseCompletCallback_;
     void process();
     static void Callback(uv_async_t* handle);
@@ -0,0 +1,132 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_DM_TIMER_ADAPTER_HPP
+#define UV_DM_TIMER_ADAPTER_HPP
+
+#include <dmtimermodule.h>
+
+#include "EventLoop.hpp"
+
+namespace uv
+{
+
+//在EventLoop中驱动dmtimer：每interval毫秒调用一次CDMTimerModule::Run()，
+//timer sink均在loop线程中回调，无需跨线程同步。
+//未指定module时创建并持有一个本loop专用的模块，通过attach()将节点绑定到该模块。
+//uvcpp库本身不依赖dmtimer，因此仅提供头文件实现，使用时需链接dmtimer。
+//构造、析构及节点的SetTimer/KillTimer都需在loop线程(或loop运行前)中调用。
+//loop退出前需close()，关闭回调执行后才可析构；loop退出后uv_close的回调不会再执行。
+class DMTimerAdapter
+{
+public:
+    DMTimerAdapter(EventLoop* loop, uint64_t interval = 1, CDMTimerModule* module = nullptr)
+        :handle_(new uv_timer_t),
+        interval_(interval > 0 ? interval : 1),
+        module_(module),
+        owned_(nullptr == module),
+        onClosed_(nullptr)
+    {
+        if (owned_)
+        {
+            module_ = new CDMTimerModule();
+        }
+        handle_->data = static_cast<void*>(this);
+        ::uv_timer_init(loop->handle(), handle_);
+    }
+
+    ~DMTimerAdapter()
+    {
+        if (nullptr != handle_)
+        {
+            ::uv_timer_stop(handle_);
+            ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
+            {
+                delete (uv_timer_t*)handle;
+            });
+        }
+        if (owned_)
+        {
+            //模块析构时从节点中移除未触发的timer。
+            delete module_;
+        }
+    }
+
+    DMTimerAdapter(const DMTimerAdapter&) = delete;
+    DMTimerAdapter& operator=(const DMTimerAdapter&) = delete;
+
+    void start()
+    {
+        if (nullptr != handle_)
+        {
+            ::uv_timer_start(handle_, DMTimerAdapter::OnTick, interval_, interval_);
+        }
+    }
+
+    void stop()
+    {
+        if (nullptr != handle_)
+        {
+            ::uv_timer_stop(handle_);
+        }
+    }
+
+    //停止并关闭定时器句柄，句柄关闭后在loop线程回调callback。
+    void close(DefaultCallback callback)
+    {
+        if (nullptr == handle_)
+        {
+            return;
+        }
+        onClosed_ = callback;
+        ::uv_timer_stop(handle_);
+        ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
+        {
+            auto ptr = static_cast<DMTimerAdapter*>(handle->data);
+            delete (uv_timer_t*)handle;
+            if (ptr->onClosed_)
+            {
+                ptr->onClosed_();
+            }
+        });
+        handle_ = nullptr;
+    }
+
+    bool isClosed()
+    {
+        return nullptr == handle_;
+    }
+
+    void attach(CDMTimerNode* node)
+    {
+        node->SetTimerModule(module_);
+    }
+
+    CDMTimerModule* getModule()
+    {
+        return module_;
+    }
+
+private:
+    uv_timer_t* handle_;
+    uint64_t interval_;
+    CDMTimerModule* module_;
+    bool owned_;
+    DefaultCallback onClosed_;
+
+    static void OnTick(uv_timer_t* handle)
+    {
+        auto ptr = static_cast<DMTimerAdapter*>(handle->data);
+        ptr->module_->Run();
+    }
+};
+
+}
+#endif
@@ -1,67 +1,85 @@
-﻿/*
-   Copyright © 2017-2019, orcaer@yeah.net  All rights reserved.
-
-   Author: orcaer@yeah.net
-
-   Last modified: 2019-6-17
-
-   Description: https://github.com/wlgq2/uv-cpp
-*/
-
-#ifndef   UV_EVENT_LOOP_HPP
-#define   UV_EVENT_LOOP_HPP
-
-#include <uv.h>
-#include <thread>
-#include <atomic>
-#include <functional>
-#include <memory>
-
-namespace uv
-{
-using DefaultCallback = std::function<void()>;
-
-class Async;
-class EventLoop
-{
-public:
-    enum Mode
-    {
-        Default,
-        New
-    };
-    enum Status
-    {
-        NotRun,
-        Runed,
-        Stop
-    };
-    EventLoop();
-    ~EventLoop();
-
-    static EventLoop* DefaultLoop();
-
-    int run();
-    int runNoWait();
-    int stop();
-    bool isStoped();
-    Status getStatus();
-    bool isRunInLoopThread();
-    void runInThisLoop(const DefaultCallback func);
-    uv_loop_t* handle();
-
-    static const char* GetErrorMessage(int status);
-
-private:
-    EventLoop(Mode mode);
-
-    std::thread::id loopThreadId_;
-    uv_loop_t* loop_;
-    Async* async_;
-    std::atomic<Status> status_;
-};
-
-using EventLoopPtr = std::shared_ptr<uv::EventLoop>;
-}
-#endif
-
+﻿/*
+   Copyright © 2017-2019, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2019-6-17
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef   UV_EVENT_LOOP_HPP
+#define   UV_EVENT_LOOP_HPP
+
+#include <uv.h>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "LoopStats.hpp"
+
+namespace uv
+{
+using DefaultCallback = std::function<void()>;
+
+class Async;
+class TimerService;
+class EventLoop
+{
+public:
+    enum Mode
+    {
+        Default,
+        New
+    };
+    enum Status
+    {
+        NotRun,
+        Runed,
+        Stop
+    };
+    EventLoop();
+    ~EventLoop();
+
+    static EventLoop* DefaultLoop();
+
+    int run();
+    int runNoWait();
+    int stop();
+    bool isStoped();
+    Status getStatus();
+    bool isRunInLoopThread();
+    void runInThisLoop(const DefaultCallback func);
+    uv_loop_t* handle();
+    //loop内共用的定时器服务(首次调用时创建)，只能在loop线程中使用。
+    TimerService* getTimerService();
+    //loop运行统计(见LoopStats)，需在loop线程中或run之前开启/关闭，开销为每轮数次uv_hrtime。
+    void setStatsEnabled(bool enable);
+    //从未开启时为nullptr，供I/O及定时器回调入口记录。
+    LoopStats* getLoopStats();
+    //累计统计快照，可在任意线程调用，未开启时各项为0。
+    LoopStats::Snapshot stats();
+
+    static const char* GetErrorMessage(int status);
+
+private:
+    EventLoop(Mode mode);
+    //关闭loop内部的句柄(定时器服务等)，全部关闭回调执行后回调callback。没有需要关闭的句柄时返回false。
+    bool closeHandles(DefaultCallback callback);
+    void onHandleClosed();
+
+    std::thread::id loopThreadId_;
+    uv_loop_t* loop_;
+    Async* async_;
+    TimerService* timerService_;
+    std::atomic<LoopStats*> stats_;
+    int closingHandles_;
+    DefaultCallback onHandlesClosed_;
+    std::atomic<Status> status_;
+};
+
+using EventLoopPtr = std::shared_ptr<uv::EventLoop>;
+}
+#endif
+
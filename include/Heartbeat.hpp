@@ -0,0 +1,105 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+
+#ifndef UV_HEARTBEAT_HPP
+#define UV_HEARTBEAT_HPP
+
+#include <functional>
+#include <string>
+#include <uv.h>
+
+namespace uv
+{
+
+struct HeartbeatStats
+{
+    uint64_t pingsSent;
+    uint64_t pongsReceived;
+    //以下RTT单位均为微秒，未收到pong前为0。
+    uint64_t lastRtt;
+    uint64_t minRtt;
+    uint64_t smoothedRtt;
+    uint64_t rttJitter;
+    //距上次收到数据的毫秒数。
+    uint64_t idle;
+    //最近一次TCP_INFO采样(仅Linux)，rtt单位为微秒，retransmits为累计重传次数。
+    bool tcpInfoValid;
+    uint32_t tcpRtt;
+    uint32_t tcpRttVar;
+    uint32_t tcpRetransmits;
+    uint32_t tcpCwnd;
+};
+
+//Packet协议之上的心跳控制帧，以Packet::ControlHeadByte代替包头，不会与应用数据包混淆：
+//---------------------------------------------------------
+//  head  |  size   |  kind  |  stamp  |  end   |
+// 1 byte | 2 bytes | 1 byte | 8 bytes | 1 byte |
+//---------------------------------------------------------
+//ping携带发送方的uv_hrtime，对端原样以pong返回，发送方据此计算RTT(平滑方式同RFC 6298)。
+//本类只负责从接收字节流中剥离控制帧及统计，定时发送及失效检测由TcpConnection完成。
+class Heartbeat
+{
+public:
+    enum Kind
+    {
+        Ping = 1,
+        Pong = 2
+    };
+    static const uint16_t ControlSize = 9;
+    static const uint32_t FrameSize = ControlSize + 4;
+
+    //非控制帧的字节(含包头包尾)按原顺序交给forward，可能分多次。
+    using ForwardCallback = std::function<void(const char*, size_t)>;
+    using ControlCallback = std::function<void(Kind, uint64_t)>;
+
+    Heartbeat(ForwardCallback forward, ControlCallback control);
+
+    void input(const char* buf, size_t size);
+    static void Pack(char* out, Kind kind, uint64_t stamp);
+
+    //interval毫秒一次ping，interval*maxMisses毫秒内未收到数据视为失效。
+    void setInterval(uint64_t interval, unsigned int maxMisses, uint64_t now);
+    uint64_t getInterval();
+    void onReceive(uint64_t now);
+    void onPingSent();
+    void onPong(uint64_t stamp);
+    bool isExpired(uint64_t now);
+    void sampleTcpInfo(uv_os_fd_t fd);
+    void getStats(HeartbeatStats& stats, uint64_t now);
+
+private:
+    enum State
+    {
+        Search,
+        DataHeader,
+        Passthrough,
+        Control
+    };
+    void onFrame();
+
+    ForwardCallback forward_;
+    ControlCallback control_;
+    State state_;
+    //数据包的长度字段(可能跨两次读取)。
+    uint8_t header_[2];
+    size_t headerSize_;
+    //当前控制帧已收到的字节，收齐后校验。
+    std::string hold_;
+    uint64_t remaining_;
+
+    uint64_t interval_;
+    unsigned int maxMisses_;
+    uint64_t lastReceive_;
+    HeartbeatStats stats_;
+};
+
+}
+#endif
@@ -0,0 +1,105 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HIGH_RES_TIMER_HPP
+#define UV_HIGH_RES_TIMER_HPP
+
+#ifdef __linux__
+
+#include <functional>
+#include <vector>
+#include <deque>
+
+#include "EventLoop.hpp"
+
+namespace uv
+{
+
+//微秒级定时器(仅Linux)：libuv定时器精度为1ms，用于50~200us的发送节奏控制等场景。
+//一个timerfd(CLOCK_MONOTONIC，绝对时间)由uv_poll_t监听，到期时间按纳秒存放于最小堆，
+//timerfd始终设为堆顶时间。取消为延迟删除(槽位代数变化)，堆中失效项过多时重建。
+//只能在loop线程中使用。
+class HighResTimer
+{
+public:
+    using TimerCallback = std::function<void()>;
+
+    //轻量句柄：定时器结束或取消后(代数变化)自动失效，可安全重复cancel。
+    struct Handle
+    {
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+    };
+
+    HighResTimer(EventLoop* loop);
+    ~HighResTimer();
+    HighResTimer(const HighResTimer&) = delete;
+    HighResTimer& operator=(const HighResTimer&) = delete;
+
+    //timerfd创建失败时返回false，此后schedule返回无效句柄。
+    bool isValid();
+    //timeoutUs微秒后回调，repeatUs非0时此后每repeatUs微秒重复，直至cancel。
+    //重复定时器按计划时间推进，loop阻塞超过一个周期时不补发错过的周期。
+    Handle schedule(uint64_t timeoutUs, TimerCallback callback, uint64_t repeatUs = 0);
+    //返回定时器是否仍在等待。可在回调中取消自身。
+    bool cancel(Handle& handle);
+    bool isPending(const Handle& handle);
+    size_t size();
+
+    //CLOCK_MONOTONIC纳秒时间。
+    static uint64_t Now();
+
+private:
+    struct Slot
+    {
+        enum State
+        {
+            Free,
+            Pending,
+            Running,
+            Cancelled
+        };
+        uint64_t deadline;
+        uint64_t period;
+        uint32_t generation;
+        State state;
+        TimerCallback callback;
+    };
+    struct Entry
+    {
+        uint64_t deadline;
+        uint32_t slot;
+        uint32_t generation;
+    };
+
+    EventLoop* loop_;
+    int fd_;
+    uv_poll_t* poll_;
+    //当前timerfd的到期时间，0为未设置。
+    uint64_t armed_;
+    size_t size_;
+    //deque扩容不移动已有元素，回调中schedule不影响正在执行的槽。
+    std::deque<Slot> slots_;
+    std::vector<uint32_t> free_;
+    std::vector<Entry> heap_;
+
+    uint32_t fetch();
+    void push(uint32_t slot);
+    void release(uint32_t slot);
+    void compact();
+    void run();
+    void rearm();
+    static bool Later(const Entry& left, const Entry& right);
+    static void OnReadable(uv_poll_t* handle, int status, int events);
+};
+
+}
+#endif
+#endif
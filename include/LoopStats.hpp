@@ -0,0 +1,120 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+
+#ifndef UV_LOOP_STATS_HPP
+#define UV_LOOP_STATS_HPP
+
+#include <atomic>
+#include <functional>
+#include <uv.h>
+
+namespace uv
+{
+
+class EventLoop;
+//loop运行统计：prepare/check钩子把每轮迭代分为poll等待及回调执行两段(微秒)，并记录每轮执行的
+//Async任务数及定时器触发延迟。libuv在poll阶段内直接执行I/O回调，uvcpp的tcp读写、accept及Async
+//回调入口调用Wake标记poll返回的时刻，此后至下一轮prepare均计为回调时间。
+//只在loop线程写入(单写者relaxed原子量，无锁前缀)，snapshot可在任意线程调用。
+class LoopStats
+{
+public:
+    //log2分桶：0单独一桶，第i桶为[2^(i-1), 2^i)，超出的计入最后一桶。
+    class Histogram
+    {
+    public:
+        static const int Buckets = 32;
+        struct Snapshot
+        {
+            uint64_t count;
+            uint64_t sum;
+            uint64_t max;
+            uint64_t buckets[Buckets];
+
+            double mean() const;
+            //按所在桶上限估算，不超过max。
+            uint64_t percentile(double q) const;
+        };
+
+        Histogram();
+        void record(uint64_t value);
+        void snapshot(Snapshot& out) const;
+
+    private:
+        std::atomic<uint64_t> count_;
+        std::atomic<uint64_t> sum_;
+        std::atomic<uint64_t> max_;
+        std::atomic<uint64_t> buckets_[Buckets];
+    };
+
+    struct Snapshot
+    {
+        uint64_t iterations;
+        //单位：微秒。
+        Histogram::Snapshot poll;
+        Histogram::Snapshot callback;
+        Histogram::Snapshot timerLateness;
+        //每轮执行的Async任务数。
+        Histogram::Snapshot asyncTasks;
+
+        //回调时间占比(0~1)。
+        double utilization() const;
+    };
+
+    LoopStats(EventLoop* loop);
+    ~LoopStats();
+    LoopStats(const LoopStats&) = delete;
+    LoopStats& operator=(const LoopStats&) = delete;
+
+    void start();
+    void stop();
+    bool isRunning();
+    //关闭prepare/check句柄，两者的关闭回调都执行后回调callback。由EventLoop停止时调用。
+    void close(std::function<void()> callback);
+    bool isClosed();
+
+    //I/O回调入口调用，本轮第一次调用的时刻为poll返回时刻。
+    void onWake();
+    void onAsyncTasks(uint64_t count);
+    //deadline为定时器的到期loop时间，延迟按loop时间计算(精度1ms)。
+    void onTimer(uint64_t deadline);
+
+    void snapshot(Snapshot& out) const;
+
+    //供回调入口调用，loop未开启统计时只有一次判断。
+    static void Wake(EventLoop* loop);
+    static void TimerFired(EventLoop* loop, uint64_t deadline);
+
+private:
+    void onHandleClosed();
+    static void OnPrepare(uv_prepare_t* handle);
+    static void OnCheck(uv_check_t* handle);
+
+    EventLoop* loop_;
+    uv_prepare_t* prepare_;
+    uv_check_t* check_;
+    bool running_;
+    int closing_;
+    std::function<void()> onClosed_;
+    //以下为uv_hrtime/1000，0为本轮尚未发生。
+    uint64_t prepareTime_;
+    uint64_t wakeTime_;
+    uint64_t asyncTasks_;
+
+    std::atomic<uint64_t> iterations_;
+    Histogram poll_;
+    Histogram callback_;
+    Histogram timerLateness_;
+    Histogram asyncTaskCounts_;
+};
+
+}
+#endif
@@ -0,0 +1,122 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_METRICS_HPP
+#define UV_METRICS_HPP
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace uv
+{
+
+//指标注册表：各指标按线程分片累加(relaxed原子操作，线程各写各自的cache line)，
+//仅在抓取时汇总，无人抓取时开销只有一次原子加。
+//name可带固定label，如 uvcpp_http_requests_total{code="2xx"}，同名family合并输出。
+class Metrics
+{
+public:
+    static const unsigned int Shards = 16;
+
+    class Metric
+    {
+    public:
+        virtual ~Metric();
+        virtual const char* type() = 0;
+        virtual void serialize(const std::string& family, const std::string& labels, std::string& out) = 0;
+    };
+
+    class Counter : public Metric
+    {
+    public:
+        void inc(uint64_t value = 1);
+        uint64_t value();
+
+        const char* type() override;
+        void serialize(const std::string& family, const std::string& labels, std::string& out) override;
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<uint64_t> value{ 0 };
+        };
+        Slot slots_[Shards];
+    };
+
+    class Gauge : public Metric
+    {
+    public:
+        void add(int64_t value = 1);
+        void sub(int64_t value = 1);
+        int64_t value();
+
+        const char* type() override;
+        void serialize(const std::string& family, const std::string& labels, std::string& out) override;
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<int64_t> value{ 0 };
+        };
+        Slot slots_[Shards];
+    };
+
+    //bounds为升序的桶上限(含)，输出时乘以scale(如以us记录、以秒输出时为1e-6)。
+    class Histogram : public Metric
+    {
+    public:
+        Histogram(const std::vector<uint64_t>& bounds, double scale);
+        void observe(uint64_t value);
+
+        const char* type() override;
+        void serialize(const std::string& family, const std::string& labels, std::string& out) override;
+    private:
+        std::vector<uint64_t> bounds_;
+        double scale_;
+        //每个分片依次为各桶计数、+Inf桶计数、sum，按cache line对齐步长存放。
+        size_t stride_;
+        std::vector<std::atomic<uint64_t>> slots_;
+    };
+
+public:
+    static Metrics* Instance();
+    //同名指标只创建一次，重复注册返回已有对象(类型不符时返回nullptr)。
+    Counter* counter(const std::string& name, const std::string& help);
+    Gauge* gauge(const std::string& name, const std::string& help);
+    Histogram* histogram(const std::string& name, const std::string& help, const std::vector<uint64_t>& bounds, double scale = 1.0);
+
+    //Prometheus文本格式(text/plain; version=0.0.4)。
+    void serialize(std::string& out);
+
+    //当前线程的分片序号。
+    static unsigned int Shard();
+
+    static const char* ContentType;
+
+private:
+    Metrics();
+    Metric* find(const std::string& name);
+    void add(const std::string& name, const std::string& help, Metric* metric);
+
+    struct Family
+    {
+        std::string name;
+        std::string help;
+        std::vector<std::pair<std::string, std::unique_ptr<Metric>>> metrics;
+    };
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+    std::map<std::string, Metric*> metrics_;
+};
+
+}
+#endif
@@ -18,6 +18,8 @@ Description: https://github.com/wlgq2/uv-cpp
 //  head  |  size   | data   |  end   |
 // 1 byte | 2 bytes | N bytes| 1 byte |
 //------------------------------------------------
+//以ControlHeadByte开头的帧保留给连接的控制帧(心跳，见Heartbeat)，
+//应用数据包总以HeadByte开头，不会被当作控制帧。两者须不同。
 
 namespace uv
 {
@@ -54,6 +56,7 @@ public:
     };
 
     static uint8_t HeadByte;
+    static uint8_t ControlHeadByte;
     static uint8_t EndByte;
     static DataMode Mode;
 
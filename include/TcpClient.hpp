@@ -38,6 +38,7 @@ public:
     bool isTcpNoDelay();
     void setTcpNoDelay(bool isNoDelay);
     void connect(SocketAddr& addr);
+    //连接中调用时关闭socket，connect请求取消，不再回调连接状态。
     void close(std::function<void(uv::TcpClient*)> callback);
 
     int write(const char* buf, unsigned int size, AfterWriteCallback callback = nullptr);
@@ -45,6 +46,9 @@ public:
 
     void setConnectStatusCallback(ConnectStatusCallback callback);
     void setMessageCallback(NewMessageCallback callback);
+    //连接建立后开启内置心跳(见TcpConnection::setHeartbeat)，服务端需同样开启。
+    void setHeartbeat(uint64_t intervalMs, unsigned int maxMisses = 3);
+    bool getHeartbeatStats(HeartbeatStats& stats);
 
     EventLoop* Loop();
     PacketBufferPtr getCurrentBuf();
@@ -60,9 +64,13 @@ private:
     uv_connect_t* connect_;
     SocketAddr::IPV ipv;
     bool tcpNoDelay_;
+    bool connecting_;
 
     ConnectStatusCallback connectCallback_;
+    std::function<void(uv::TcpClient*)> closeCallback_;
     NewMessageCallback onMessageCallback_;
+    uint64_t heartbeatInterval_;
+    unsigned int heartbeatMisses_;
 
     TcpConnectionPtr connection_;
     void update();
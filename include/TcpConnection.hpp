@@ -1,116 +1,152 @@
-﻿/*
-   Copyright © 2017-2019, orcaer@yeah.net  All rights reserved.
-
-   Author: orcaer@yeah.net
-
-   Last modified: 2019-12-31
-
-   Description: https://github.com/wlgq2/uv-cpp
-*/
-
-#ifndef UV_TCP_CONNECTION_HPP
-#define UV_TCP_CONNECTION_HPP
-
-#include <memory>
-
-
-#include <chrono>
-#include <functional>
-#include <atomic>
-#include <string>
-
-#include "EventLoop.hpp"
-#include "ListBuffer.hpp"
-#include "CycleBuffer.hpp"
-#include "SocketAddr.hpp"
-
-namespace uv
-{
-
-struct WriteInfo
-{
-	static const int Disconnected = -1;
-	int status;
-	char* buf;
-	unsigned long size;
-};
-
-
-class TcpConnection ;
-class TcpServer;
-class ConnectionWrapper;
-
-using TcpConnectionPtr = std::shared_ptr<TcpConnection>;
-using AfterWriteCallback =  std::function<void (WriteInfo& )> ;
-using OnMessageCallback =  std::function<void (TcpConnectionPtr,const char*,ssize_t)>  ;
-using OnCloseCallback =  std::function<void (std::string& )>  ;
-using CloseCompleteCallback =  std::function<void (std::string&)>  ;
-
-
-class TcpConnection : public std::enable_shared_from_this<TcpConnection>
-{
-public :
-    TcpConnection(EventLoop* loop,std::string& name,UVTcpPtr client,bool isConnected = true);
-    virtual ~TcpConnection();
-    
-    void onSocketClose();
-    void close(std::function<void(std::string&)> callback);
-
-    int write(const char* buf,ssize_t size,AfterWriteCallback callback);
-    void writeInLoop(const char* buf,ssize_t size,AfterWriteCallback callback);
-
-    void setWrapper(std::shared_ptr<ConnectionWrapper> wrapper);
-    std::shared_ptr<ConnectionWrapper> getWrapper();
-
-    void setMessageCallback(OnMessageCallback callback);
-    void setConnectCloseCallback(OnCloseCallback callback);
-    
-    void setConnectStatus(bool status);
-    bool isConnected();
-    
-    const std::string& Name();
-
-    PacketBufferPtr getPacketBuffer();
-private:
-    void onMessage(const char* buf, ssize_t size);
-    void CloseComplete();
-    char* resizeData(size_t size);
-    static void  onMesageReceive(uv_stream_t* client, ssize_t nread, const uv_buf_t* buf);
-    
-private :
-    std::string name_;
-    bool connected_;
-    EventLoop* loop_;
-    UVTcpPtr handle_;
-    std::string data_;
-    PacketBufferPtr buffer_;
-    std::weak_ptr<ConnectionWrapper> wrapper_;
-
-    OnMessageCallback onMessageCallback_;
-    OnCloseCallback onConnectCloseCallback_;
-    CloseCompleteCallback closeCompleteCallback_;
-};
-
-class  ConnectionWrapper : public std::enable_shared_from_this<ConnectionWrapper>
-{
-public:
-    ConnectionWrapper(TcpConnectionPtr connection)
-        :connection_(connection)
-    {
-    }
-
-    ~ConnectionWrapper()
-    {
-        TcpConnectionPtr connection = connection_.lock();
-        if (connection)
-        {
-            connection->onSocketClose();
-        }
-    }
-
-private:
-    std::weak_ptr<TcpConnection> connection_;
-};
-using ConnectionWrapperPtr = std::shared_ptr<ConnectionWrapper>;
-}
-#endif
+﻿/*
+   Copyright © 2017-2019, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2019-12-31
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_TCP_CONNECTION_HPP
+#define UV_TCP_CONNECTION_HPP
+
+#include <memory>
+
+
+#include <chrono>
+#include <functional>
+#include <atomic>
+#include <string>
+#include <deque>
+
+#include "EventLoop.hpp"
+#include "ListBuffer.hpp"
+#include "CycleBuffer.hpp"
+#include "SocketAddr.hpp"
+#include "TimerWheel.hpp"
+#include "TimerService.hpp"
+#include "Heartbeat.hpp"
+
+namespace uv
+{
+
+struct WriteInfo
+{
+	static const int Disconnected = -1;
+	int status;
+	char* buf;
+	unsigned long size;
+};
+
+
+class TcpConnection ;
+class TcpServer;
+
+using TcpConnectionPtr = std::shared_ptr<TcpConnection>;
+using AfterWriteCallback =  std::function<void (WriteInfo& )> ;
+using OnMessageCallback =  std::function<void (TcpConnectionPtr,const char*,ssize_t)>  ;
+using OnCloseCallback =  std::function<void (std::string& )>  ;
+using CloseCompleteCallback =  std::function<void (std::string&)>  ;
+//输出积压回调：最早未完成写请求的排队时长(ms)及排队字节数。
+using OnSlowConsumerCallback =  std::function<void (TcpConnectionPtr, uint64_t, size_t)>  ;
+
+
+//继承TimerWheelNode以便挂入TcpServer的空闲超时时间轮。
+class TcpConnection : public std::enable_shared_from_this<TcpConnection>, public TimerWheelNode
+{
+public :
+    TcpConnection(EventLoop* loop,std::string& name,UVTcpPtr client,bool isConnected = true);
+    virtual ~TcpConnection();
+    
+    void onSocketClose();
+    void close(std::function<void(std::string&)> callback);
+
+    int write(const char* buf,ssize_t size,AfterWriteCallback callback);
+    //聚合写，bufs指向的内存需保持有效直至回调完成。
+    //回调WriteInfo的size为总长度，nbufs大于1时buf为nullptr，由调用者自行记录各buf。
+    int write(const uv_buf_t* bufs,unsigned int nbufs,AfterWriteCallback callback);
+    void writeInLoop(const char* buf,ssize_t size,AfterWriteCallback callback);
+
+    //连接上下文，生命周期与连接相同。
+    void setContext(std::shared_ptr<void> context);
+    std::shared_ptr<void> getContext();
+
+    void setMessageCallback(OnMessageCallback callback);
+    void setConnectCloseCallback(OnCloseCallback callback);
+
+    //输出截止：最早的未完成写请求排队超过deadlineMs毫秒，或排队字节数超过maxBytes时回调，
+    //每次积压只回调一次(队列清空后重新计算)；evict为true时随后关闭连接。0为不限制。
+    //排队时长由loop的TimerService检查，每个连接至多一个定时器，与写请求数无关。
+    void setWriteLimits(uint64_t deadlineMs, size_t maxBytes, bool evict);
+    void setSlowConsumerCallback(OnSlowConsumerCallback callback);
+    size_t getWriteQueueBytes();
+    //最早的未完成写请求已排队的毫秒数，无排队时为0。
+    uint64_t getOldestWriteAge();
+
+    //内置心跳(Packet协议，见Heartbeat)：每intervalMs发送一次ping，对端自动回pong；
+    //连续maxMisses个周期未收到任何数据时关闭连接，即对端失效最迟(maxMisses+1)*intervalMs内检出。
+    //两端均需开启，且每次write须为完整的包。开启后intervalMs为0只停止发送ping，仍剥离控制帧并回复。
+    void setHeartbeat(uint64_t intervalMs, unsigned int maxMisses = 3);
+    //未开启心跳时返回false。
+    bool getHeartbeatStats(HeartbeatStats& stats);
+    
+    void setConnectStatus(bool status);
+    bool isConnected();
+    
+    const std::string& Name();
+    //底层socket句柄，供sendfile等绕过写队列的场景使用。
+    int fileno(uv_os_fd_t& fd);
+    //暂停/恢复读取，暂停期间数据留在内核接收缓冲区(接收端背压)。
+    void pauseRead();
+    void resumeRead();
+
+    PacketBufferPtr getPacketBuffer();
+private:
+    void onMessage(const char* buf, ssize_t size);
+    void onWriteQueued(size_t size);
+    void onWriteComplete(size_t size);
+    void scheduleWriteDeadline(uint64_t delay);
+    void cancelWriteDeadline();
+    void onWriteDeadline();
+    void onSlowConsumer();
+    void forwardMessage(const char* buf, size_t size);
+    void onHeartbeatControl(Heartbeat::Kind kind, uint64_t stamp);
+    void onHeartbeatTick();
+    void sendHeartbeat(Heartbeat::Kind kind, uint64_t stamp);
+    void cancelHeartbeat();
+    int startRead();
+    void CloseComplete();
+    char* resizeData(size_t size);
+    static void  onMesageReceive(uv_stream_t* client, ssize_t nread, const uv_buf_t* buf);
+    
+private :
+    std::string name_;
+    bool connected_;
+    EventLoop* loop_;
+    UVTcpPtr handle_;
+    std::string data_;
+    PacketBufferPtr buffer_;
+    std::shared_ptr<void> context_;
+
+    OnMessageCallback onMessageCallback_;
+    OnCloseCallback onConnectCloseCallback_;
+    CloseCompleteCallback closeCompleteCallback_;
+
+    uint64_t writeDeadline_;
+    size_t writeQueueLimit_;
+    bool evictSlowConsumer_;
+    //本次积压已回调。
+    bool slowConsumer_;
+    OnSlowConsumerCallback onSlowConsumerCallback_;
+    //libuv按顺序完成同一stream的写请求，队首即最早的未完成请求。
+    std::deque<uint64_t> writeQueuedTimes_;
+    size_t writeQueueBytes_;
+    TimerService::Handle writeDeadlineTimer_;
+
+    std::unique_ptr<Heartbeat> heartbeat_;
+    TimerService::Handle heartbeatTimer_;
+};
+
+}
+#endif
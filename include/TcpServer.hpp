@@ -49,10 +49,28 @@ public:
     void writeInLoop(TcpConnectionPtr connection,const char* buf,unsigned int size,AfterWriteCallback callback);
     void writeInLoop(std::string& name,const char* buf,unsigned int size,AfterWriteCallback callback);
 
+    //空闲超时(秒)，超时无消息的连接被关闭。
     void setTimeout(unsigned int);
+    //毫秒级空闲超时，resolution为时间轮精度(ms)，0时取timeout的1/10。需在bindAndListen前设置。
+    void setTimeout(uint64_t ms, uint64_t resolution);
+    unsigned int getTimeout();
+    uint64_t getTimeoutMs();
+    uint64_t getTimeoutResolution();
+
+    //新连接的输出截止及积压字节上限(见TcpConnection::setWriteLimits)，空闲超时只看输入，
+    //不读数据的对端由此检出。需在bindAndListen前设置。
+    void setWriteLimits(uint64_t deadlineMs, size_t maxBytes, bool evict = true);
+    void setSlowConsumerCallback(OnSlowConsumerCallback callback);
+
+    //新连接开启内置心跳(见TcpConnection::setHeartbeat)，客户端需同样开启。需在bindAndListen前设置。
+    void setHeartbeat(uint64_t intervalMs, unsigned int maxMisses = 3);
+protected:
+    virtual void onAccept(EventLoop* loop, UVTcpPtr client);
+    //不监听端口，仅接管其他loop转交来的连接时代替bindAndListen调用。
+    void prepareAccept(SocketAddr::IPV ipv);
+    //关闭全部连接及超时时间轮，句柄关闭回调都执行后回调callback。需在loop线程调用。
+    void closeConnections(DefaultCallback callback);
 private:
-    void onAccept(EventLoop* loop, UVTcpPtr client);
-
     void addConnection(std::string& name, TcpConnectionPtr connection);
     void removeConnection(std::string& name);
     void onMessage(TcpConnectionPtr connection, const char* buf, ssize_t size);
@@ -68,7 +86,14 @@ private:
     OnMessageCallback onMessageCallback_;
     OnConnectionStatusCallback onNewConnectCallback_;
     OnConnectionStatusCallback onConnectCloseCallback_;
-    TimerWheel<ConnectionWrapper> timerWheel_;
+    TimerWheel<TcpConnection> timerWheel_;
+protected:
+    uint64_t writeDeadline_;
+    size_t writeQueueLimit_;
+    bool evictSlowConsumer_;
+    OnSlowConsumerCallback onSlowConsumerCallback_;
+    uint64_t heartbeatInterval_;
+    unsigned int heartbeatMisses_;
 };
 
 
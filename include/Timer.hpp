@@ -1,50 +1,64 @@
-﻿/*
-   Copyright © 2017-2019, orcaer@yeah.net  All rights reserved.
-
-   Author: orcaer@yeah.net
-    
-   Last modified: 2019-9-11
-    
-   Description: https://github.com/wlgq2/uv-cpp
-*/
-#ifndef UV_TIMER_HPP
-#define UV_TIMER_HPP
-
-#include <functional>
-#include <mutex>
-#include "EventLoop.hpp"
-namespace uv
-{
-
-class Timer
-{
-public:
-    using TimerCallback = std::function<void(Timer*)>;
-    using TimerCloseComplete = std::function<void(Timer*)>;
-
-    Timer(EventLoop* loop, uint64_t timeout, uint64_t repeat, TimerCallback callback);
-    virtual ~Timer();
-
-    void start();
-    void close(TimerCloseComplete callback);
-    void setTimerRepeat(uint64_t ms);
-
-private:
-    bool started_;
-    uv_timer_t* handle_;
-    uint64_t timeout_;
-    uint64_t repeat_;
-    TimerCallback callback_;
-
-    TimerCloseComplete closeComplete_;
-
-private:
-    void onTimeOut();
-    void closeComplete();
-
-    static void process(uv_timer_t* handle);
-
-};
-
-}
-#endif
+﻿/*
+   Copyright © 2017-2019, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+    
+   Last modified: 2019-9-11
+    
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+#ifndef UV_TIMER_HPP
+#define UV_TIMER_HPP
+
+#include <functional>
+#include <mutex>
+#include "EventLoop.hpp"
+namespace uv
+{
+
+class Timer
+{
+public:
+    using TimerCallback = std::function<void(Timer*)>;
+    using TimerCloseComplete = std::function<void(Timer*)>;
+
+    Timer(EventLoop* loop, uint64_t timeout, uint64_t repeat, TimerCallback callback);
+    virtual ~Timer();
+
+    void start();
+    //停止计时，之后可再次start。
+    void stop();
+    void close(TimerCloseComplete callback);
+    void setTimerRepeat(uint64_t ms);
+    //到期时间向上对齐到loop时间slack毫秒的整数倍，相近的定时器合并到同一次唤醒中触发。
+    //需在start前设置，0(默认)不对齐。
+    void setSlack(uint64_t ms);
+    uint64_t getSlack();
+
+    //deadline向上对齐到slack的整数倍。
+    static uint64_t AlignDeadline(uint64_t deadline, uint64_t slack);
+
+private:
+    bool started_;
+    EventLoop* loop_;
+    uv_timer_t* handle_;
+    uint64_t timeout_;
+    uint64_t repeat_;
+    uint64_t slack_;
+    //对齐前的到期时间(未设置slack时同libuv的到期时间)。
+    uint64_t due_;
+    TimerCallback callback_;
+
+    TimerCloseComplete closeComplete_;
+
+private:
+    void onTimeOut();
+    void closeComplete();
+    void startAligned(uint64_t now);
+
+    static void process(uv_timer_t* handle);
+
+};
+
+}
+#endif
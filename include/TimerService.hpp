@@ -0,0 +1,117 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_TIMER_SERVICE_HPP
+#define UV_TIMER_SERVICE_HPP
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "EventLoop.hpp"
+
+namespace uv
+{
+
+//loop内共用的定时器服务：Linux内核风格5级时间轮(精度1ms，根层256格，其余4层各64格)，
+//所有定时器共用一个uv_timer_t，只在有到期定时器的tick唤醒loop。
+//定时器元素从对象池分配，schedule/cancel均为O(1)且不经过loop往返。只能在loop线程中使用。
+class TimerService
+{
+public:
+    using TimerCallback = std::function<void()>;
+
+    struct Element;
+    //轻量句柄：元素回收复用后(代数变化)旧句柄自动失效，可安全重复cancel。
+    struct Handle
+    {
+        Element* element = nullptr;
+        uint64_t generation = 0;
+    };
+
+    TimerService(EventLoop* loop);
+    ~TimerService();
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    //timeout毫秒后回调，repeat非0时此后每repeat毫秒重复，直至cancel。
+    Handle schedule(uint64_t timeout, TimerCallback callback, uint64_t repeat = 0);
+    //返回定时器是否仍在等待(已到期或已取消返回false)。可在回调中取消自身。
+    bool cancel(Handle& handle);
+    bool isPending(const Handle& handle);
+    //等待中的定时器数。
+    size_t size();
+    //到期时间向上对齐到slack毫秒的整数倍(同uv::Timer::setSlack)，只影响此后schedule及重复的定时器。
+    void setSlack(uint64_t ms);
+    uint64_t getSlack();
+    //关闭底层uv_timer_t，关闭回调执行后回调callback，此后定时器不再触发。由EventLoop停止时调用。
+    void close(DefaultCallback callback);
+    bool isClosed();
+
+    struct ListHead
+    {
+        ListHead* prev;
+        ListHead* next;
+    };
+    struct Element : public ListHead
+    {
+        enum State
+        {
+            Free,
+            Pending,
+            Running,
+            Cancelled
+        };
+        uint64_t expires;
+        //对齐前的到期时间。
+        uint64_t due;
+        uint64_t repeat;
+        uint64_t generation;
+        State state;
+        TimerCallback callback;
+    };
+
+private:
+    static const int RootBits = 8;
+    static const int LevelBits = 6;
+    static const int RootSize = 1 << RootBits;
+    static const int LevelSize = 1 << LevelBits;
+    static const int Levels = 4;
+    //对象池每次扩容的元素数。
+    static const int PoolChunk = 1024;
+
+    EventLoop* loop_;
+    uv_timer_t* handle_;
+    //下一个待处理的tick。
+    uint64_t current_;
+    uint64_t armed_;
+    uint64_t slack_;
+    size_t size_;
+    ListHead root_[RootSize];
+    ListHead levels_[Levels][LevelSize];
+
+    //当前处理的格中已触发定时器的原到期时间，用于统计省去的唤醒。
+    std::vector<uint64_t> dues_;
+    std::vector<std::unique_ptr<Element[]>> chunks_;
+    std::vector<Element*> free_;
+    DefaultCallback onClosed_;
+
+    Element* fetch();
+    void release(Element* element);
+    void add(Element* element);
+    void cascade(int level);
+    void run();
+    void rearm();
+    uint64_t nextExpiry();
+    static void OnTimeout(uv_timer_t* handle);
+};
+
+}
+#endif
@@ -11,37 +11,126 @@
 #ifndef   UV_TIMER_WHEEL_HPP
 #define   UV_TIMER_WHEEL_HPP
 
-#include <vector>
-#include <set>
+#include <functional>
 #include <memory>
 #include "Timer.hpp"
-#include "TcpConnection.hpp"
 
 namespace uv
 {
 
-//algorithm complexity  o(1).
+//嵌入被管理对象的双向链表节点(侵入式)，刷新超时只需重新链接，不分配内存也不增减引用计数。
+//对象析构时自动从时间轮摘除。
+class TimerWheelNode
+{
+public:
+    TimerWheelNode();
+    ~TimerWheelNode();
+    TimerWheelNode(const TimerWheelNode&) = delete;
+    TimerWheelNode& operator=(const TimerWheelNode&) = delete;
+
+    bool isLinked();
+    void unlink();
+
+private:
+    template<typename Type> friend class TimerWheel;
+    TimerWheelNode* prev_;
+    TimerWheelNode* next_;
+    unsigned int slot_;
+
+    void linkBefore(TimerWheelNode* head);
+    void takeFrom(TimerWheelNode* head);
+};
+
+inline TimerWheelNode::TimerWheelNode()
+    :prev_(this),
+    next_(this),
+    slot_(0)
+{
+}
+
+inline TimerWheelNode::~TimerWheelNode()
+{
+    unlink();
+}
+
+inline bool TimerWheelNode::isLinked()
+{
+    return next_ != this;
+}
+
+inline void TimerWheelNode::unlink()
+{
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_ = this;
+    next_ = this;
+}
+
+inline void TimerWheelNode::linkBefore(TimerWheelNode* head)
+{
+    prev_ = head->prev_;
+    next_ = head;
+    head->prev_->next_ = this;
+    head->prev_ = this;
+}
 
+//把head链表整体转移到本(哨兵)节点，head置空。
+inline void TimerWheelNode::takeFrom(TimerWheelNode* head)
+{
+    if (!head->isLinked())
+    {
+        return;
+    }
+    prev_ = head->prev_;
+    next_ = head->next_;
+    prev_->next_ = this;
+    next_->prev_ = this;
+    head->prev_ = head;
+    head->next_ = head;
+}
+
+//哈希时间轮，algorithm complexity o(1)：每个槽是一条侵入式链表，insert把节点移到
+//(当前槽+超时格数)槽，每格(resolution ms)到期时整槽批量回调。实际超时在[timeout, timeout+resolution)。
+//Type需公有继承TimerWheelNode，只能在loop线程中使用。
 template<typename Type>
 class TimerWheel
 {
 public:
+    using OnTimeoutCallback = std::function<void(Type*)>;
+
     TimerWheel(EventLoop* loop);
     TimerWheel(EventLoop* loop,unsigned int timeout);
+    ~TimerWheel();
     void setTimeout(unsigned int seconds);
+    //毫秒超时及时间轮精度，resolution为0时取timeout的1/10(1ms~1s)。需在start前设置。
+    void setTimeout(uint64_t ms, uint64_t resolution);
+    //时间轮的tick对齐到slack毫秒网格(见Timer::setSlack)，同一loop中的多个时间轮在同一次唤醒中推进。需在start前设置。
+    void setSlack(uint64_t ms);
     int getTimeout();
+    uint64_t getTimeoutMs();
+    uint64_t getResolution();
+    void setTimeoutCallback(OnTimeoutCallback callback);
     void start();
-    void insert(std::shared_ptr<Type> value);
-    
+    //关闭内部定时器，关闭回调执行后回调callback，之后析构无需loop运行。
+    void close(DefaultCallback callback);
+    //插入或刷新超时。
+    void insert(Type* value);
+    void remove(Type* value);
+
 private:
+    EventLoop* loop_;
+    uint64_t timeoutMs_;
+    uint64_t resolution_;
+    uint64_t slack_;
     unsigned int index_;
-    unsigned int timeoutSec_;
-    Timer timer_;
-
-    std::vector<std::set<std::shared_ptr<Type>>> wheel_;
+    unsigned int size_;
+    uint64_t nextTick_;
+    Timer* timer_;
+    std::unique_ptr<TimerWheelNode[]> wheel_;
+    OnTimeoutCallback callback_;
 
     void wheelCallback();
-
+    void expire(unsigned int slot);
 };
 
 template<typename Type>
@@ -53,54 +142,195 @@ inline TimerWheel<Type>::TimerWheel(EventLoop* loop)
 
 template<typename Type>
 inline TimerWheel<Type>::TimerWheel(EventLoop* loop, unsigned int timeout)
-    :index_(0),
-    timeoutSec_(timeout),
-    timer_(loop, 1000, 1000, std::bind(&TimerWheel::wheelCallback, this))
+    :loop_(loop),
+    timeoutMs_(0),
+    resolution_(0),
+    slack_(0),
+    index_(0),
+    size_(0),
+    nextTick_(0),
+    timer_(nullptr),
+    callback_(nullptr)
 {
+    setTimeout(timeout);
+}
 
+template<typename Type>
+inline TimerWheel<Type>::~TimerWheel()
+{
+    //摘除剩余节点，避免对象析构时访问已释放的槽。
+    for (unsigned int i = 0; i < size_; i++)
+    {
+        while (wheel_[i].isLinked())
+        {
+            wheel_[i].next_->unlink();
+        }
+    }
+    if (nullptr != timer_)
+    {
+        timer_->close([](Timer* timer)
+        {
+            delete timer;
+        });
+    }
 }
 
 template<typename Type>
 inline void TimerWheel<Type>::setTimeout(unsigned int seconds)
 {
-    timeoutSec_ = seconds;
+    setTimeout((uint64_t)seconds * 1000, 1000);
+}
+
+template<typename Type>
+inline void TimerWheel<Type>::setTimeout(uint64_t ms, uint64_t resolution)
+{
+    if (0 == resolution)
+    {
+        resolution = ms / 10;
+        if (resolution < 1)
+        {
+            resolution = 1;
+        }
+        else if (resolution > 1000)
+        {
+            resolution = 1000;
+        }
+    }
+    timeoutMs_ = ms;
+    resolution_ = resolution;
+}
+
+template<typename Type>
+inline void TimerWheel<Type>::setSlack(uint64_t ms)
+{
+    slack_ = ms;
 }
 
 template<typename Type>
 inline void TimerWheel<Type>::start()
 {
-    if (timeoutSec_)
+    if (timeoutMs_ && nullptr == timer_)
+    {
+        //节点插入到当前槽之后第ticks个槽，槽数多一个以免与当前槽重合。
+        size_ = (unsigned int)((timeoutMs_ + resolution_ - 1) / resolution_) + 2;
+        wheel_.reset(new TimerWheelNode[size_]);
+        index_ = 0;
+        nextTick_ = ::uv_now(loop_->handle()) + resolution_;
+        timer_ = new Timer(loop_, resolution_, resolution_, std::bind(&TimerWheel::wheelCallback, this));
+        timer_->setSlack(slack_);
+        timer_->start();
+    }
+}
+
+template<typename Type>
+inline void TimerWheel<Type>::close(DefaultCallback callback)
+{
+    if (nullptr == timer_)
+    {
+        callback();
+        return;
+    }
+    timer_->close([callback](Timer* timer)
+    {
+        delete timer;
+        callback();
+    });
+    timer_ = nullptr;
+}
+
+template<typename Type>
+inline void TimerWheel<Type>::insert(Type* value)
+{
+    if (nullptr == timer_ || nullptr == value)
+    {
+        return;
+    }
+    TimerWheelNode* node = value;
+    unsigned int slot = index_ + size_ - 1;
+    if (slot >= size_)
+    {
+        slot -= size_;
+    }
+    //同一格内多次刷新无需移动。
+    if (node->isLinked() && node->slot_ == slot)
     {
-        wheel_.resize(timeoutSec_);
-        timer_.start();
+        return;
     }
+    node->unlink();
+    node->slot_ = slot;
+    node->linkBefore(&wheel_[slot]);
 }
 
 template<typename Type>
-inline void TimerWheel<Type>::insert(std::shared_ptr<Type> value)
+inline void TimerWheel<Type>::remove(Type* value)
 {
-    if (timeoutSec_ > 0 && nullptr != value)
+    if (nullptr != value)
     {
-        wheel_[index_].insert(value);
+        static_cast<TimerWheelNode*>(value)->unlink();
     }
 }
 
 template<typename Type>
 inline int TimerWheel<Type>::getTimeout()
 {
-    return timeoutSec_;
+    return (int)(timeoutMs_ / 1000);
+}
+
+template<typename Type>
+inline uint64_t TimerWheel<Type>::getTimeoutMs()
+{
+    return timeoutMs_;
+}
+
+template<typename Type>
+inline uint64_t TimerWheel<Type>::getResolution()
+{
+    return resolution_;
+}
+
+template<typename Type>
+inline void TimerWheel<Type>::setTimeoutCallback(OnTimeoutCallback callback)
+{
+    callback_ = callback;
 }
 
 template<typename Type>
 inline void TimerWheel<Type>::wheelCallback()
 {
-    if (!timeoutSec_)
-        return;
-    if (++index_ == timeoutSec_)
+    //loop阻塞导致定时器迟到时补齐错过的格。
+    uint64_t now = ::uv_now(loop_->handle());
+    unsigned int ticks = 0;
+    while (nextTick_ <= now && ticks < size_)
     {
-        index_ = 0;
+        if (++index_ == size_)
+        {
+            index_ = 0;
+        }
+        expire(index_);
+        nextTick_ += resolution_;
+        ticks++;
+    }
+    if (nextTick_ <= now)
+    {
+        nextTick_ = now + resolution_;
+    }
+}
+
+template<typename Type>
+inline void TimerWheel<Type>::expire(unsigned int slot)
+{
+    //先整体摘出到局部链表，回调中增删节点不影响遍历。
+    TimerWheelNode expired;
+    expired.takeFrom(&wheel_[slot]);
+    while (expired.isLinked())
+    {
+        TimerWheelNode* node = expired.next_;
+        node->unlink();
+        if (callback_)
+        {
+            callback_(static_cast<Type*>(node));
+        }
     }
-    wheel_[index_].clear();
 }
 }
 #endif
@@ -0,0 +1,66 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_COMPRESSION_HPP
+#define UV_HTTP_COMPRESSION_HPP
+
+#include <memory>
+#include "Request.hpp"
+#include "Response.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//gzip/deflate压缩(依赖zlib，编译时未定义UV_HAVE_ZLIB则不支持，协商结果恒为Identity)。
+//实例为流式压缩器，非线程安全；静态接口线程安全。
+class Compression
+{
+public:
+    enum Encoding
+    {
+        Identity = 0,
+        Gzip,
+        Deflate,
+    };
+
+    Compression(Encoding encoding, int level = DefaultLevel);
+    ~Compression();
+
+    //压缩data追加到out，每次调用后已输出的数据可被完整解压(Z_SYNC_FLUSH)；
+    //finish为true时结束压缩流。返回0成功。
+    int update(const char* data, uint64_t size, std::string& out, bool finish = false);
+    Encoding getEncoding();
+
+    static bool IsSupported();
+    //按Accept-Encoding的q值选择编码，同等权重优先gzip。
+    static Encoding Negotiate(Request& req);
+    //客户端是否接受该编码(不要求本地支持压缩，如预压缩文件)。
+    static bool IsAccepted(Request& req, Encoding encoding);
+    static const char* EncodingName(Encoding encoding);
+    //未指定Content-Type视为可压缩。
+    static bool IsCompressibleType(const std::string& contentType);
+    //响应可压缩：状态码带body、未指定Content-Encoding且类型可压缩。
+    static bool IsCompressible(Response& resp);
+    //一次性压缩，返回0成功。
+    static int Compress(Encoding encoding, const char* data, uint64_t size, std::string& out, int level = DefaultLevel);
+
+    static int DefaultLevel;
+
+private:
+    struct Stream;
+    Encoding encoding_;
+    std::unique_ptr<Stream> stream_;
+};
+
+}
+}
+#endif
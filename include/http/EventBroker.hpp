@@ -0,0 +1,47 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_EVENT_BROKER_HPP
+#define UV_HTTP_EVENT_BROKER_HPP
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include "EventStream.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//按频道分发Server-Sent Events，线程安全。
+//事件只编码一次，所有订阅端共享同一份数据；已关闭的订阅端在发布时移除。
+class EventBroker
+{
+public:
+    EventBroker();
+
+    void subscribe(const std::string& channel, EventStreamPtr stream);
+    void unsubscribe(const std::string& channel, EventStreamPtr stream);
+    size_t Subscribers(const std::string& channel);
+
+    //返回投递的订阅端数。
+    size_t publish(const std::string& channel, std::shared_ptr<std::string> event);
+    size_t publish(const std::string& channel, const std::string& event, const std::string& data,
+        const std::string& id = "");
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, std::vector<EventStreamPtr>> channels_;
+};
+
+}
+}
+#endif
@@ -0,0 +1,80 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_EVENT_STREAM_HPP
+#define UV_HTTP_EVENT_STREAM_HPP
+
+#include <atomic>
+#include "Request.hpp"
+#include "ResponseStream.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+class EventStream;
+using EventStreamPtr = std::shared_ptr<EventStream>;
+
+//Server-Sent Events订阅端(text/event-stream)，发送接口线程安全。
+//事件以编码后的共享数据写出，多个订阅端可共用同一份数据。
+//待写数据超过高水位时按策略处理，不无限缓存：
+//Drop丢弃新事件；Coalesce只保留最新一条，可写时再发送。
+class EventStream : public std::enable_shared_from_this<EventStream>
+{
+public:
+    enum Policy
+    {
+        Drop,
+        Coalesce
+    };
+
+    EventStream(ResponseStreamPtr stream);
+    virtual ~EventStream();
+
+    //写出text/event-stream响应头，由HttpServer在loop线程中调用。
+    void open();
+
+    void send(std::shared_ptr<std::string> event);
+    void send(const std::string& event, const std::string& data, const std::string& id = "");
+    void close();
+
+    bool isClosed();
+    EventLoop* getLoop();
+    //因积压被丢弃或合并的事件数。
+    uint64_t DroppedEvents();
+
+    void setPolicy(Policy policy);
+    void setHighWaterMark(uint64_t size);
+
+    //event、id为空时省略对应字段，data按行拆分为多个data字段；retry为0时省略。
+    static std::shared_ptr<std::string> Encode(const std::string& event, const std::string& data,
+        const std::string& id = "", uint64_t retry = 0);
+    //注释行，可用作保活。
+    static std::shared_ptr<std::string> EncodeComment(const std::string& comment);
+
+    static uint64_t DefaultHighWaterMark;
+
+private:
+    friend class EventBroker;
+
+    ResponseStreamPtr stream_;
+    std::atomic<Policy> policy_;
+    std::atomic<uint64_t> dropped_;
+    //Coalesce策略下等待可写的最新事件，仅在loop线程中访问。
+    std::shared_ptr<std::string> coalesced_;
+
+    void sendInLoop(std::shared_ptr<std::string> event);
+    void onDrain();
+};
+
+}
+}
+#endif
@@ -0,0 +1,75 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_FILE_SENDER_HPP
+#define UV_HTTP_FILE_SENDER_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "../TcpConnection.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//将文件区间写入连接：优先在线程池中uv_fs_sendfile(内核零拷贝)，
+//socket发送缓冲满(EAGAIN)时读出一段经连接写队列发出，之后继续sendfile。
+//windows下仅使用读写方式。start调用时连接写队列须为空，发送期间不可有其他写入。
+class FileSender : public std::enable_shared_from_this<FileSender>
+{
+public:
+    //status为0表示全部写出。
+    using OnCompleteCallback = std::function<void(int status)>;
+    //读出的一段数据交由调用方写出，写完后以status调用done；data在done之前有效。
+    using OnPieceCallback = std::function<void(const char* data, uint64_t size, OnCompleteCallback done)>;
+
+    //接管file，完成或析构时关闭。
+    FileSender(EventLoop* loop, uv_file file, int64_t offset, uint64_t length);
+    virtual ~FileSender();
+
+    void start(TcpConnectionPtr connection, OnCompleteCallback callback);
+    //仅读写方式，用于需自行封装数据的协议(如Http2 DATA帧)。
+    void start(OnPieceCallback writer, OnCompleteCallback callback);
+
+    static uint64_t PieceSize;
+
+private:
+    void sendfile();
+    void read();
+    void onSendfile(ssize_t result);
+    void onRead(ssize_t result);
+    void onWrite(uint64_t size, int status);
+    void finish(int status);
+    void closeSocket();
+
+    static void OnFsCallback(uv_fs_t* req);
+
+private:
+    EventLoop* loop_;
+    std::weak_ptr<TcpConnection> connection_;
+    uv_file file_;
+    int socket_;
+    bool sendfileMode_;
+    int64_t offset_;
+    uint64_t remain_;
+    uv_fs_t req_;
+    std::string buffer_;
+    std::shared_ptr<FileSender> self_;
+    OnCompleteCallback callback_;
+    OnPieceCallback writer_;
+};
+
+using FileSenderPtr = std::shared_ptr<FileSender>;
+
+}
+}
+#endif
@@ -0,0 +1,104 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_HPACK_HPP
+#define UV_HTTP_HPACK_HPP
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace uv
+{
+namespace http
+{
+
+//HPACK头部压缩(RFC 7541)：静态表、动态表与Huffman编码。
+//编解码器各自维护连接级动态表，非线程安全。
+using HpackHeaders = std::vector<std::pair<std::string, std::string>>;
+
+class HpackTable
+{
+public:
+    HpackTable(uint64_t maxSize = DefaultTableSize);
+
+    //index从1开始，1-61为静态表，之后为动态表(最新的在前)。
+    bool get(uint64_t index, std::string& name, std::string& value);
+    void add(const std::string& name, const std::string& value);
+    void setMaxSize(uint64_t size);
+    uint64_t getMaxSize();
+    uint64_t size();
+    //返回完全匹配的index，nameIndex为仅名称匹配的index，未找到均为0。
+    uint64_t find(const std::string& name, const std::string& value, uint64_t& nameIndex);
+
+    static const uint64_t DefaultTableSize = 4096;
+    static const uint64_t StaticTableSize = 61;
+    //每条目额外开销(RFC 7541 4.1)。
+    static const uint64_t EntryOverhead = 32;
+
+private:
+    std::deque<std::pair<std::string, std::string>> entries_;
+    uint64_t size_;
+    uint64_t maxSize_;
+
+    void evict(uint64_t size);
+};
+
+class HpackDecoder
+{
+public:
+    HpackDecoder();
+
+    //解码完整的header block，返回0成功，-1为压缩错误(需以COMPRESSION_ERROR关闭连接)。
+    int decode(const char* data, uint64_t size, HpackHeaders& headers);
+    //本端SETTINGS_HEADER_TABLE_SIZE，对端的动态表大小更新不可超过该值。
+    void setMaxTableSize(uint64_t size);
+
+private:
+    HpackTable table_;
+    uint64_t maxTableSize_;
+
+    int decodeString(const uint8_t*& pos, const uint8_t* end, std::string& out);
+};
+
+class HpackEncoder
+{
+public:
+    HpackEncoder();
+
+    void encode(const HpackHeaders& headers, std::string& out);
+    //对端SETTINGS_HEADER_TABLE_SIZE，下一个header block开头发出动态表大小更新。
+    void setMaxTableSize(uint64_t size);
+
+private:
+    HpackTable table_;
+    bool sizeUpdate_;
+
+    void encodeString(const std::string& str, std::string& out);
+};
+
+class Hpack
+{
+public:
+    static void EncodeInteger(uint64_t value, int prefix, uint8_t flags, std::string& out);
+    //返回0成功，-1为数据不完整或溢出。
+    static int DecodeInteger(const uint8_t*& pos, const uint8_t* end, int prefix, uint64_t& value);
+
+    static uint64_t HuffmanEncodedSize(const std::string& str);
+    static void HuffmanEncode(const std::string& str, std::string& out);
+    //返回0成功，-1为非法编码(含EOS或填充错误)。
+    static int HuffmanDecode(const uint8_t* data, uint64_t size, std::string& out);
+};
+
+}
+}
+#endif
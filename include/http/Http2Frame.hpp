@@ -0,0 +1,104 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_HTTP2_FRAME_HPP
+#define UV_HTTP_HTTP2_FRAME_HPP
+
+#include <string>
+#include <cstdint>
+
+namespace uv
+{
+namespace http
+{
+
+//Http2帧(RFC 7540 4.1)：9字节帧头 + payload。
+struct Http2Frame
+{
+    enum Type
+    {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        RstStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    enum Flag
+    {
+        EndStream = 0x1,
+        Ack = 0x1,
+        EndHeaders = 0x4,
+        Padded = 0x8,
+        PriorityFlag = 0x20,
+    };
+
+    enum ErrorCode
+    {
+        NoError = 0x0,
+        ProtocolError = 0x1,
+        InternalError = 0x2,
+        FlowControlError = 0x3,
+        SettingsTimeout = 0x4,
+        StreamClosed = 0x5,
+        FrameSizeError = 0x6,
+        RefusedStream = 0x7,
+        Cancel = 0x8,
+        CompressionError = 0x9,
+        ConnectError = 0xa,
+        EnhanceYourCalm = 0xb,
+        InadequateSecurity = 0xc,
+        Http11Required = 0xd,
+    };
+
+    enum SettingId
+    {
+        HeaderTableSize = 0x1,
+        EnablePush = 0x2,
+        MaxConcurrentStreams = 0x3,
+        InitialWindowSize = 0x4,
+        MaxFrameSize = 0x5,
+        MaxHeaderListSize = 0x6,
+    };
+
+    static const uint32_t HeadSize = 9;
+    static const uint32_t DefaultMaxFrameSize = 16384;
+    static const uint32_t MaxFrameSizeLimit = 16777215;
+    static const uint32_t DefaultWindowSize = 65535;
+    static const uint32_t MaxWindowSize = 0x7fffffff;
+
+    uint32_t length;
+    uint8_t type;
+    uint8_t flags;
+    uint32_t streamId;
+    const char* payload;
+
+    //data至少HeadSize字节，payload指向帧头之后。
+    static void DecodeHead(const char* data, Http2Frame& frame);
+    static void EncodeHead(std::string& out, uint32_t length, uint8_t type, uint8_t flags, uint32_t streamId);
+
+    static void EncodeSetting(std::string& out, uint16_t id, uint32_t value);
+    static void EncodeRstStream(std::string& out, uint32_t streamId, uint32_t error);
+    static void EncodeWindowUpdate(std::string& out, uint32_t streamId, uint32_t increment);
+    static void EncodeGoAway(std::string& out, uint32_t lastStreamId, uint32_t error);
+    static void EncodePing(std::string& out, const char data[8], bool ack);
+
+    static void AppendUint32(std::string& out, uint32_t value);
+    static uint32_t ReadUint32(const char* data);
+};
+
+}
+}
+#endif
@@ -0,0 +1,174 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_HTTP2_SESSION_HPP
+#define UV_HTTP_HTTP2_SESSION_HPP
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <functional>
+#include "../TcpConnection.hpp"
+#include "Request.hpp"
+#include "Response.hpp"
+#include "ResponseStream.hpp"
+#include "Http2Frame.hpp"
+#include "Hpack.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+class Http2Stream;
+class Http2Session;
+using Http2SessionPtr = std::shared_ptr<Http2Session>;
+
+//明文Http2(h2c)连接：支持prior knowledge与Upgrade: h2c两种方式建立。
+//请求完整接收(END_STREAM)后以Http2Stream回调，响应接口与ResponseStream相同，各stream并发处理。
+//DATA帧受连接级及stream级流量控制，多个stream轮流发送；同一轮处理中产生的帧合并为一次聚合写。
+//not thread safe，仅在连接所属loop中使用(Http2Stream的写接口线程安全)。
+class Http2Session : public std::enable_shared_from_this<Http2Session>
+{
+public:
+    using OnRequestCallback = std::function<void(Request&, ResponseStreamPtr)>;
+    using OnDataCallback = std::function<void(int status)>;
+
+    Http2Session(EventLoop* loop, TcpConnectionPtr connection);
+    virtual ~Http2Session();
+
+    void setRequestCallback(OnRequestCallback callback);
+    void setCloseConnectionCallback(DefaultCallback callback);
+    void setMaxConcurrentStreams(uint32_t num);
+    //单个请求body上限，超过时以413应答并重置stream。
+    void setMaxRequestSize(uint64_t size);
+
+    //prior knowledge：发送本端SETTINGS，之后的数据以客户端preface开头。
+    void start();
+    //Upgrade：已应答101，settings为HTTP2-Settings头，req作为stream 1处理。返回0成功。
+    int startUpgrade(const std::string& settings, Request& req);
+    void onData(const char* data, size_t size);
+    void onDisconnected();
+    //发送GOAWAY，不再接受新stream。
+    void shutdown(uint32_t error = Http2Frame::NoError);
+
+    uint64_t streamSize();
+    EventLoop* getLoop();
+
+    //以下接口由Http2Stream在loop线程中调用。
+    void submitHeaders(uint32_t id, Response& resp, bool endStream);
+    //data为空且endStream时发送空的结束帧；callback在数据写出或stream关闭时调用。
+    void submitData(uint32_t id, std::shared_ptr<std::string> data, bool endStream, OnDataCallback callback);
+    void resetStream(uint32_t id, uint32_t error);
+
+    //返回1为完整preface，0为数据不足以判断，-1不是Http2 preface。
+    static int MatchPreface(const char* data, size_t size);
+    static bool IsUpgradeRequest(Request& req);
+
+    static const char Preface[];
+    static const size_t PrefaceSize = 24;
+    static uint32_t DefaultMaxConcurrentStreams;
+    static uint64_t DefaultMaxRequestSize;
+    //本端接收窗口。
+    static uint32_t LocalWindowSize;
+
+private:
+    struct DataChunk
+    {
+        std::shared_ptr<std::string> data;
+        uint64_t offset;
+        bool endStream;
+        OnDataCallback callback;
+    };
+
+    struct StreamState
+    {
+        uint32_t id;
+        //对端已发送END_STREAM。
+        bool remoteClosed;
+        bool scheduled;
+        int64_t sendWindow;
+        int64_t recvWindow;
+        HpackHeaders headers;
+        std::string body;
+        std::deque<DataChunk> queue;
+        std::shared_ptr<Http2Stream> response;
+    };
+
+    //待写出的一段：control为帧头等小块数据，可继续追加。
+    struct Segment
+    {
+        std::shared_ptr<std::string> data;
+        uint64_t offset;
+        uint64_t size;
+        bool control;
+    };
+
+    EventLoop* loop_;
+    std::weak_ptr<TcpConnection> connection_;
+    OnRequestCallback onRequest_;
+    DefaultCallback onClose_;
+
+    std::string input_;
+    bool prefaceReceived_;
+    bool settingsReceived_;
+    bool closed_;
+    bool goingAway_;
+    bool inInput_;
+    uint32_t lastStreamId_;
+    uint32_t maxConcurrentStreams_;
+    uint64_t maxRequestSize_;
+
+    //正在接收的header block(HEADERS + CONTINUATION)。
+    uint32_t headerStream_;
+    uint8_t headerFlags_;
+    std::string headerBlock_;
+
+    HpackDecoder decoder_;
+    HpackEncoder encoder_;
+    uint32_t peerMaxFrameSize_;
+    uint32_t peerInitialWindow_;
+    int64_t sendWindow_;
+    int64_t recvWindow_;
+
+    std::map<uint32_t, StreamState> streams_;
+    std::deque<uint32_t> ready_;
+    std::vector<Segment> output_;
+    std::vector<OnDataCallback> callbacks_;
+
+    void processInput();
+    int onFrame(Http2Frame& frame);
+    int onHeaders(Http2Frame& frame);
+    int onContinuation(Http2Frame& frame);
+    int onHeaderBlock();
+    int onDataFrame(Http2Frame& frame);
+    int onRstStream(Http2Frame& frame);
+    int onSettings(Http2Frame& frame);
+    int onPing(Http2Frame& frame);
+    int onWindowUpdate(Http2Frame& frame);
+    int applySetting(uint16_t id, uint32_t value);
+
+    StreamState& createStream(uint32_t id);
+    void dispatch(StreamState& stream);
+    void respond(StreamState& stream, Request& req);
+    int buildRequest(StreamState& stream, Request& req);
+    void closeStream(uint32_t id, int status);
+    void connectionError(uint32_t error);
+
+    std::string& control();
+    void sendSettings();
+    void sendData();
+    void schedule(StreamState& stream);
+    void flush();
+};
+
+}
+}
+#endif
@@ -0,0 +1,52 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_HTTP2_STREAM_HPP
+#define UV_HTTP_HTTP2_STREAM_HPP
+
+#include "ResponseStream.hpp"
+#include "Http2Session.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//Http2 stream的响应句柄：消息头编码为HEADERS帧，body经Http2Session按流量控制分为DATA帧。
+//无需Content-Length/chunked，end()以END_STREAM结束；sendFile以读写方式发送。
+class Http2Stream : public ResponseStream
+{
+public:
+    Http2Stream(EventLoop* loop, TcpConnectionPtr connection, Http2SessionPtr session, uint32_t id);
+    virtual ~Http2Stream();
+
+    uint32_t getStreamId();
+    //以RST_STREAM(CANCEL)重置本stream，不影响连接上的其他stream。
+    void cancel() override;
+
+protected:
+    void sendInLoop(std::shared_ptr<Response> resp) override;
+    void writeHeadInLoop(std::shared_ptr<Response> head) override;
+    void writeBufferInLoop(std::shared_ptr<std::string> data, uint64_t size) override;
+    void sendFileInLoop(std::shared_ptr<Response> head, std::shared_ptr<FileSender> sender) override;
+    void sendSerializedInLoop(std::shared_ptr<std::string> head, std::shared_ptr<std::string> body) override;
+    void endInLoop() override;
+
+private:
+    std::weak_ptr<Http2Session> session_;
+    uint32_t id_;
+
+    std::shared_ptr<Http2Stream> self();
+    void submitEnd(Http2SessionPtr session, std::shared_ptr<std::string> data, uint64_t size);
+};
+
+}
+}
+#endif
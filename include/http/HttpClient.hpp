@@ -14,6 +14,7 @@
 #include "../TcpClient.hpp"
 #include "Request.hpp"
 #include "Response.hpp"
+#include "ResponseParser.hpp"
 
 namespace uv
 {
@@ -31,6 +32,9 @@ public:
         Unknow = 3,
     };
     using OnRespCallback = std::function<void(ReqResult, Response*)>;
+    using OnHeadersCallback = std::function<void(Response*)>;
+    using OnBodyChunkCallback = std::function<void(const char*, size_t)>;
+    using OnCompleteCallback = std::function<void(ReqResult)>;
 public:
     HttpClient(EventLoop* loop);
     virtual ~HttpClient();
@@ -39,11 +43,22 @@ public:
 
     void setOnResp(OnRespCallback callback);
 
+    //流式接收：消息头解析完成回调onHeaders，body按到达分段回调onBodyChunk(chunked已解码，
+    //数据仅在回调内有效)，结束回调onComplete。设置onBodyChunk后body不再缓存，
+    //内存占用与响应大小无关；OnResp回调中的Response不含body。
+    void setOnHeaders(OnHeadersCallback callback);
+    void setOnBodyChunk(OnBodyChunkCallback callback);
+    void setOnComplete(OnCompleteCallback callback);
+
 private:
     TcpClient* client_;
     OnRespCallback callback_;
+    OnHeadersCallback onHeaders_;
+    OnBodyChunkCallback onBodyChunk_;
+    OnCompleteCallback onComplete_;
     Request req_;
-    std::string buffer_;
+    ResponseParser parser_;
+    bool completed_;
 
 private:
     void onResp(ReqResult rst, Response* resp);
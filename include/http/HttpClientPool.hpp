@@ -0,0 +1,109 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_CLIENT_POOL_HPP
+#define UV_HTTP_CLIENT_POOL_HPP
+
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+
+#include "../TcpClient.hpp"
+#include "../Timer.hpp"
+#include "HttpClient.hpp"
+#include "ResponseParser.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//按host:port复用连接的http客户端连接池，每个loop一个，not thread safe。
+//空闲连接keep-alive复用，每个upstream连接数有上限，超出时请求排队等待空闲连接；
+//可选pipeline(单连接未完成请求数上限)；空闲超时后关闭连接；按upstream统计时延。
+class HttpClientPool
+{
+public:
+    using OnRespCallback = HttpClient::OnRespCallback;
+
+    struct UpstreamStats
+    {
+        static const int LatencyBuckets = 32;
+
+        uint64_t requests;
+        uint64_t failures;
+        uint64_t connects;
+        //复用已有连接发送的请求数。
+        uint64_t reuses;
+        uint64_t queued;
+        uint64_t connections;
+        //时延(us)，从Req调用至响应完成，含排队时间。
+        uint64_t latencyTotal;
+        uint64_t latencyMax;
+        //第i个桶统计时延小于2^i us的请求。
+        uint64_t latency[LatencyBuckets];
+
+        uint64_t latencyAverage() const;
+        //时延分位数上界(us)，p取值0~1。
+        uint64_t latencyPercentile(double p) const;
+    };
+
+public:
+    HttpClientPool(EventLoop* loop);
+    virtual ~HttpClientPool();
+
+    void Req(SocketAddr& addr, Request& req, OnRespCallback callback);
+
+    //每个upstream的最大连接数，默认8。
+    void setMaxConnections(unsigned int size);
+    //单连接未完成请求数上限，默认1(不使用pipeline)。
+    //连接断开时已发出的幂等请求重发一次，POST等其余请求以ConnectFail结束，不会重复执行。
+    void setPipelining(unsigned int depth);
+    //空闲连接超时(ms)，默认60s。
+    void setIdleTimeout(uint64_t ms);
+
+    bool getStats(const std::string& upstream, UpstreamStats& stats);
+    void getStats(std::map<std::string, UpstreamStats>& stats);
+
+private:
+    struct Pending;
+    struct Connection;
+    struct Upstream;
+    using PendingPtr = std::shared_ptr<Pending>;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+    using UpstreamPtr = std::shared_ptr<Upstream>;
+
+    void dispatch(Upstream* upstream);
+    void connect(Upstream* upstream);
+    void send(Connection* conn, PendingPtr pending);
+    void closeConnection(Connection* conn);
+    //未完成的请求中可重发的放回队列，其余放入failed。
+    void requeue(Connection* conn, std::deque<PendingPtr>& failed);
+    void fail(Upstream* upstream, std::deque<PendingPtr>& failed);
+    void complete(Upstream* upstream, PendingPtr pending, HttpClient::ReqResult rst, Response* resp);
+
+    void onConnectStatus(Connection* conn, TcpClient::ConnectStatus status);
+    void onMessage(Connection* conn, const char* data, ssize_t size);
+    void onClosed(Connection* conn);
+    void onTimer();
+
+private:
+    EventLoop* loop_;
+    unsigned int maxConnections_;
+    unsigned int pipelining_;
+    uint64_t idleTimeout_;
+    Timer* timer_;
+    std::map<std::string, UpstreamPtr> upstreams_;
+};
+
+}
+}
+#endif
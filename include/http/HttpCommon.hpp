@@ -55,6 +55,9 @@ extern int SplitHttpOfCRLF(std::string& str, std::vector<std::string>& out, int
 extern int SplitStrOfSpace(std::string& str, std::vector<std::string>& out, int defaultSize = 4);
 extern uint64_t GetCommomStringLength(const std::string& str1, const std::string& str2);
 extern int AppendHead(std::string& str,std::map<std::string,std::string>& heads);
+//SHA-1摘要(20字节)，用于WebSocket握手。
+extern void Sha1(const char* data, uint64_t size, unsigned char digest[20]);
+extern std::string Base64Encode(const unsigned char* data, uint64_t size);
 }
 }
 #endif
@@ -11,10 +11,25 @@
 #ifndef UV_HTTP_SERVER_HPP
 #define UV_HTTP_SERVER_HPP
 
+#include <list>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
 #include "../TcpServer.hpp"
-#include "RadixTree.hpp"
+#include "../Timer.hpp"
+#include "RouteTable.hpp"
 #include "Request.hpp"
 #include "Response.hpp"
+#include "ResponseStream.hpp"
+#include "HttpSession.hpp"
+#include "StaticFileHandler.hpp"
+#include "WebSocketGroup.hpp"
+#include "EventBroker.hpp"
+#include "ResponseCache.hpp"
+#include "ResponseCompressor.hpp"
+#include "TempFileSink.hpp"
 
 namespace uv
 {
@@ -24,10 +39,20 @@ namespace http
 class HttpServer : public uv::TcpServer
 {
 public:
-    using OnHttpReqCallback = std::function<void(Request&,Response*)>;
+    using OnHttpReqCallback = RouteTable::OnHttpReqCallback;
+    using OnHttpStreamCallback = RouteTable::OnHttpStreamCallback;
+    using OnWebSocketCallback = RouteTable::OnWebSocketCallback;
+    using OnHttpBodyCallback = RouteTable::OnHttpBodyCallback;
+    //status为0时path为上传的临时文件，由回调方移走或删除。
+    using OnUploadFileCallback = std::function<void(Request&, int status, const std::string& path, ResponseStreamPtr)>;
+    using OnEventStreamCallback = std::function<void(Request&,EventStreamPtr)>;
+    using Route = RouteTable::Route;
 
 public:
     HttpServer(EventLoop* loop);
+    virtual ~HttpServer();
+    int bindAndListen(SocketAddr& addr);
+
     void Get(std::string path, OnHttpReqCallback callback);
     void Post(std::string path, OnHttpReqCallback callback);
     void Head(std::string path, OnHttpReqCallback callback);
@@ -37,12 +62,116 @@ public:
     void Options(std::string path, OnHttpReqCallback callback);
     void Trace(std::string path, OnHttpReqCallback callback);
     void Patch(std::string path, OnHttpReqCallback callback);
+    //流式响应路由，回调返回后可继续(跨线程)写入ResponseStream。
+    void Stream(Methon methon, std::string path, OnHttpStreamCallback callback);
+    //流式请求body路由：消息头解析后即回调，body经RequestBody分块交付(不受请求超时限制)。
+    void Upload(Methon methon, std::string path, OnHttpBodyCallback callback);
+    //body以TempFileSink写入dir下的临时文件(dir为空时为系统临时目录)，写完后回调。
+    void UploadFile(Methon methon, std::string path, OnUploadFileCallback callback, std::string dir = "");
+    //静态文件路由(GET/HEAD)：path为url前缀(如"/static/")，root为本地目录。
+    StaticFileHandlerPtr Static(std::string path, std::string root);
+    //带响应缓存的GET路由，cache为空时以默认配置新建；多个路由可共用同一cache(共享字节预算)。
+    ResponseCachePtr GetCached(std::string path, OnHttpReqCallback callback, ResponseCachePtr cache = nullptr);
+    //按Accept-Encoding压缩响应(gzip/deflate)，可共享compressor。
+    ResponseCompressorPtr GetCompressed(std::string path, OnHttpReqCallback callback, ResponseCompressorPtr compressor = nullptr);
+    //WebSocket路由(GET)：握手成功后以升级后的session回调，连接此后不再按http解析。
+    void WebSocket(std::string path, OnWebSocketCallback callback);
+    //Server-Sent Events路由(GET)：写出text/event-stream响应头后以订阅端回调，连接保持至任一端关闭。
+    void EventSource(std::string path, OnEventStreamCallback callback);
+    //Prometheus指标路由(GET)，输出uv::Metrics中注册的全部指标。
+    void Metrics(std::string path = "/metrics");
+
+    //超时(ms)仍未开始响应的请求以code应答，0为不限制。
+    void setRequestTimeout(uint64_t ms, Response::StatusCode code = Response::StatusCode::GatewayTimeout);
+    //未完成请求超过size时直接以503应答，0为不限制。
+    void setMaxPendingRequests(uint64_t size);
+    uint64_t PendingRequests();
+    //请求body上限，Content-Length超过时不读取body直接以413应答并关闭连接，0为不限制。
+    void setMaxBodySize(uint64_t size);
+    //明文Http2(h2c)：接受prior knowledge及Upgrade: h2c，stream按同一路由表处理。默认开启。
+    void setHttp2(bool enable);
+
+    //路由注册写入未发布的副本，各loop下一次请求时发布，连续注册只复制一次，可在运行中(任意线程)调用。
+    RouteTablePtr getRoutes();
+    void setRoutes(RouteTablePtr routes);
+
+    //多loop模式：本loop只负责accept，连接按轮询分配给num个工作线程的loop，
+    //请求在连接所属loop中处理，所有loop共享同一路由表。需在bindAndListen前设置。
+    void setThreadNum(unsigned int num);
+
+    static uint64_t DefaultMaxBodySize;
+
+protected:
+    void onAccept(EventLoop* loop, UVTcpPtr client) override;
 
 private:
-    RadixTree<OnHttpReqCallback> route_[Methon::Invalid];
+    struct Worker
+    {
+        EventLoop* loop;
+        HttpServer* server;
+        std::thread thread;
+    };
 
-    void onMesage(TcpConnectionPtr conn, const char* data, ssize_t size);
+    struct Deadline
+    {
+        uint64_t time;
+        std::weak_ptr<ResponseStream> stream;
+        bool expired;
+    };
+    using DeadlineIterator = std::list<Deadline>::iterator;
+
+    //工作loop中的实例指向accept所在的HttpServer，路由表及配置由其统一管理。
+    HttpServer(EventLoop* loop, HttpServer* parent);
+
+    HttpServer* parent_;
+    std::mutex routeMutex_;
+    RouteTablePtr routes_;
+    //自上次发布后注册的路由，原位修改。
+    std::shared_ptr<RouteTable> pendingRoutes_;
+    std::atomic<uint64_t> routeVersion_;
+    //本loop缓存的路由表，版本变化时重新加载。
+    RouteTablePtr cachedRoutes_;
+    uint64_t cachedVersion_;
+
+    unsigned int threadNum_;
+    size_t nextWorker_;
+    std::vector<Worker*> workers_;
 
+    std::atomic<uint64_t> pending_;
+    uint64_t maxPending_;
+    uint64_t maxBodySize_;
+    bool http2_;
+    uint64_t requestTimeout_;
+    Response::StatusCode timeoutCode_;
+    //按到期时间排序，已超时但未完成的移入expired_。
+    std::list<Deadline> deadlines_;
+    std::list<Deadline> expired_;
+    Timer timer_;
+
+    void addRoute(Methon methon, std::string& path, const Route& route);
+    const RouteTablePtr& currentRoutes();
+    void startWorkers(SocketAddr::IPV ipv);
+    void adopt(uv_os_sock_t sock);
+    //工作loop退出前关闭连接及定时器。
+    void closeInLoop(DefaultCallback callback);
+
+    void onMesage(TcpConnectionPtr conn, const char* data, ssize_t size);
+    void onRequest(TcpConnectionPtr conn, HttpSessionPtr session, Request& req, RequestBodyPtr body = nullptr);
+    void beginBody(TcpConnectionPtr conn, HttpSessionPtr session, Request& req, uint64_t length, std::string& partial);
+    //返回body使用的字节数。
+    uint64_t feedBody(HttpSessionPtr session, RequestBodyPtr body, const char* data, uint64_t size);
+    void dispatch(Request& req, ResponseStreamPtr stream, bool found, Route& route, RequestBodyPtr body = nullptr);
+    //计入未完成请求，timed时加入超时检查，返回是否加入。
+    bool track(ResponseStreamPtr stream, DeadlineIterator& deadline, bool timed = true);
+    void untrack(bool tracked, DeadlineIterator deadline);
+    void onResponseComplete(std::weak_ptr<HttpSession> session, std::string& name,
+        ResponseStream* stream, bool tracked, DeadlineIterator deadline);
+    Http2SessionPtr createHttp2(TcpConnectionPtr conn, HttpSessionPtr session);
+    void upgradeHttp2(TcpConnectionPtr conn, HttpSessionPtr session, Request& req);
+    void onHttp2Request(Request& req, ResponseStreamPtr stream);
+    void onBadRequest(TcpConnectionPtr conn, HttpSessionPtr session, Response::StatusCode code = Response::StatusCode::BadRequest);
+    bool upgrade(TcpConnectionPtr conn, HttpSessionPtr session, Request& req, OnWebSocketCallback& callback);
+    void onTimer();
 
 };
 
@@ -0,0 +1,67 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_SESSION_HPP
+#define UV_HTTP_SESSION_HPP
+
+#include <deque>
+#include <memory>
+#include "ResponseStream.hpp"
+#include "WebSocketSession.hpp"
+#include "Http2Session.hpp"
+#include "RequestBody.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//单个连接上的http会话，保存pipeline中尚未完成的响应。
+//not thread safe，仅在连接所属loop中使用。
+class HttpSession
+{
+public:
+    HttpSession();
+    virtual ~HttpSession();
+
+    //返回是否位于队首(可立即写出)。
+    bool push(ResponseStreamPtr stream);
+    //移除已完成的响应，返回新的队首(可能为空)。
+    ResponseStreamPtr complete(ResponseStream* stream);
+    uint64_t size();
+
+    void setClosing();
+    bool isClosing();
+
+    //升级为WebSocket后，后续数据交由session处理。
+    void setWebSocket(WebSocketSessionPtr session);
+    WebSocketSessionPtr getWebSocket();
+
+    //切换为Http2后，后续数据交由session处理。
+    void setHttp2(Http2SessionPtr session);
+    Http2SessionPtr getHttp2();
+
+    //正在接收body的请求，接收完之前后续数据均属于该body。
+    void setIncoming(RequestBodyPtr body);
+    RequestBodyPtr getIncoming();
+
+private:
+    std::deque<ResponseStreamPtr> pipeline_;
+    bool closing_;
+    WebSocketSessionPtr webSocket_;
+    Http2SessionPtr http2_;
+    RequestBodyPtr incoming_;
+};
+
+using HttpSessionPtr = std::shared_ptr<HttpSession>;
+
+}
+}
+#endif
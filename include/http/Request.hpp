@@ -46,11 +46,18 @@ public:
     void setPath(std::string&& path);
     void setPath(std::string& path);
     const std::string& getPath();
+    //解析"/path?k=v"形式的url，设置path及url参数。
+    int parseUrl(std::string& url);
     const std::string& getValue();
  
     int pack(std::string& data);
     ParseResult unpack(std::string& data);
     ParseResult unpackAndCompleted(std::string& data);
+    //size返回该请求占用的字节数，data中其后的数据属于下一个(pipeline)请求。
+    ParseResult unpackAndCompleted(std::string& data, uint64_t& size);
+    bool isKeepAlive();
+    //Content-Length头，不存在时为0；格式错误返回-1。
+    int getContentLength(uint64_t& length);
 
     static std::string MethonToStr(Methon methon);
     static Methon StrToMethon(std::string& str);
@@ -0,0 +1,74 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_REQUEST_BODY_HPP
+#define UV_HTTP_REQUEST_BODY_HPP
+
+#include <memory>
+#include <string>
+#include <functional>
+#include "../TcpConnection.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//流式请求body：路由回调时只解析了消息头，body随读取分块回调，不经连接的packet buffer缓存。
+//回调设置之前到达的数据暂存，设置时补发。
+//not thread safe，仅在连接所属loop中使用。
+class RequestBody : public std::enable_shared_from_this<RequestBody>
+{
+public:
+    using OnBodyChunkCallback = std::function<void(const char* data, size_t size)>;
+    //status为0表示body完整接收，连接断开时为WriteInfo::Disconnected。
+    using OnBodyEndCallback = std::function<void(int status)>;
+
+    //connection为空时(如Http2已缓存的body)pause/resume无效。
+    RequestBody(TcpConnectionPtr connection, uint64_t length);
+    virtual ~RequestBody();
+
+    void onBodyChunk(OnBodyChunkCallback callback);
+    void onEnd(OnBodyEndCallback callback);
+
+    //处理跟不上时暂停读取连接，之后resume。
+    void pause();
+    void resume();
+    bool isPaused();
+
+    uint64_t getContentLength();
+    uint64_t getReceived();
+    bool isCompleted();
+
+    //以下接口由HttpServer调用。
+    void append(const char* data, size_t size);
+    void complete(int status);
+
+private:
+    std::weak_ptr<TcpConnection> connection_;
+    uint64_t length_;
+    uint64_t received_;
+    bool paused_;
+    bool completed_;
+    int status_;
+    //设置回调之前收到的数据。
+    std::string pending_;
+
+    OnBodyChunkCallback onChunk_;
+    OnBodyEndCallback onEnd_;
+
+    void notifyEnd();
+};
+
+using RequestBodyPtr = std::shared_ptr<RequestBody>;
+
+}
+}
+#endif
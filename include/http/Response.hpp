@@ -19,18 +19,39 @@ namespace uv
 namespace http
 {
 
+class ResponseWriter;
+class ResponseParser;
 class Response 
 {
 public:
+    friend class ResponseWriter;
+    friend class ResponseParser;
     enum StatusCode
     {
+        Continue = 100, //客户端应继续发送请求
+        SwitchingProtocols = 101, //服务器根据客户端请求切换协议
         OK =200,    //客户端请求成功
+        Created = 201, //请求成功并创建了新资源
+        Accepted = 202, //请求已接受，但尚未处理完成
+        NoContent = 204, //请求成功，但无返回内容
+        PartialContent = 206, //成功处理了部分GET请求(Range)
+        MovedPermanently = 301, //资源已永久移动到新位置
+        Found = 302, //资源临时移动到新位置
+        NotModified = 304, //资源未修改，可使用客户端缓存
         BadRequest = 400,  //客户端请求有语法错误，不能被服务器所理解
         Unauthorized  = 401,//请求未经授权，这个状态代码必须和WWW-Authenticate报头域一起使用 
         Forbidden = 403 , //服务器收到请求，但是拒绝提供服务
         NotFound = 404 , //请求资源不存在，eg：输入了错误的URL
+        MethodNotAllowed = 405, //请求方法不被允许
+        RequestTimeout = 408, //服务器等待请求超时
+        PayloadTooLarge = 413, //请求实体过大
+        RangeNotSatisfiable = 416, //请求的Range无法满足
+        RequestHeaderFieldsTooLarge = 431, //请求消息头过大
         InternalServerError = 500 , //服务器发生不可预期的错误
+        NotImplemented = 501, //服务器不支持请求的功能
+        BadGateway = 502, //网关从上游服务器收到无效响应
         ServerUnavailable = 503,  //服务器当前不能处理客户端的请求，一段时间后可能恢复正常
+        GatewayTimeout = 504, //网关未能及时从上游服务器收到响应
     };
 
 public:
@@ -47,6 +68,8 @@ public:
     void appendHead(std::string&& key, std::string&& value);
     
     std::string getHead(std::string& key);
+    void removeHead(const std::string& key);
+    const std::map<std::string, std::string>& getHeads();
     void swapContent(std::string& body);
     void swapContent(std::string&& body);
     const std::string& getContent();
@@ -0,0 +1,111 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_RESPONSE_CACHE_HPP
+#define UV_HTTP_RESPONSE_CACHE_HPP
+
+#include <list>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include "Request.hpp"
+#include "Response.hpp"
+#include "ResponseStream.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//响应缓存(线程安全，可被多个路由及loop共享)。
+//key为method+path+指定的url参数及请求头；缓存完整序列化后的响应，命中时直接写出不拷贝。
+//按字节预算LRU淘汰；有效期取响应Cache-Control的s-maxage/max-age，缺省为默认TTL，
+//no-store/no-cache/private的响应不缓存。
+//同一key并发未命中时只调用一次handler，其余请求等待并共享其结果(singleflight)。
+class ResponseCache : public std::enable_shared_from_this<ResponseCache>
+{
+public:
+    using OnHttpReqCallback = std::function<void(Request&, Response*)>;
+    using OnHttpStreamCallback = std::function<void(Request&, ResponseStreamPtr)>;
+    //延迟生成响应：done可在任意线程调用一次。
+    using ResponseDone = std::function<void(Response&)>;
+    using OnDeferredCallback = std::function<void(Request&, ResponseDone)>;
+
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        //等待同一key进行中请求的次数。
+        uint64_t coalesced;
+        uint64_t evictions;
+        uint64_t expired;
+        uint64_t entries;
+        uint64_t bytes;
+    };
+
+    ResponseCache(uint64_t maxBytes = DefaultMaxBytes, uint64_t ttlMs = DefaultTtl);
+
+    void setMaxBytes(uint64_t size);
+    //单个响应超过size时不缓存。
+    void setMaxEntrySize(uint64_t size);
+    void setDefaultTtl(uint64_t ms);
+    //参与key的url参数及请求头，默认均不参与。
+    void setKeyParams(const std::vector<std::string>& params);
+    void setKeyHeads(const std::vector<std::string>& heads);
+
+    OnHttpStreamCallback wrap(OnHttpReqCallback handler);
+    OnHttpStreamCallback wrapDeferred(OnDeferredCallback handler);
+    void handle(Request& req, ResponseStreamPtr stream, OnDeferredCallback& handler);
+
+    void clear();
+    void getStats(Stats& stats);
+
+    static uint64_t DefaultMaxBytes;
+    static uint64_t DefaultTtl;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<std::string> head;
+        std::shared_ptr<std::string> body;
+        uint64_t expire;
+        uint64_t size;
+    };
+    using EntryIterator = std::list<Entry>::iterator;
+
+    std::mutex mutex_;
+    uint64_t maxBytes_;
+    uint64_t maxEntrySize_;
+    uint64_t ttl_;
+    std::vector<std::string> keyParams_;
+    std::vector<std::string> keyHeads_;
+    //表头为最近使用。
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, EntryIterator> index_;
+    std::unordered_map<std::string, std::vector<ResponseStreamPtr>> flights_;
+    uint64_t bytes_;
+    Stats stats_;
+
+    std::string makeKey(Request& req);
+    void complete(const std::string& key, Response& resp);
+    void insert(const std::string& key, std::shared_ptr<std::string> head,
+        std::shared_ptr<std::string> body, uint64_t ttl);
+    void erase(EntryIterator it);
+    uint64_t getTtl(Response& resp);
+
+    static uint64_t Now();
+};
+
+using ResponseCachePtr = std::shared_ptr<ResponseCache>;
+
+}
+}
+#endif
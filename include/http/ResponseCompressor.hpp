@@ -0,0 +1,57 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_RESPONSE_COMPRESSOR_HPP
+#define UV_HTTP_RESPONSE_COMPRESSOR_HPP
+
+#include <memory>
+#include <functional>
+#include "Compression.hpp"
+#include "ResponseStream.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//路由级响应压缩：包装路由回调，按请求协商编码。
+//小于minSize的响应不压缩；大于asyncSize的响应投递到libuv线程池压缩，不阻塞loop。
+class ResponseCompressor : public std::enable_shared_from_this<ResponseCompressor>
+{
+public:
+    using OnHttpReqCallback = std::function<void(Request&, Response*)>;
+    using OnHttpStreamCallback = std::function<void(Request&, ResponseStreamPtr)>;
+
+    ResponseCompressor(int level = Compression::DefaultLevel);
+
+    void setLevel(int level);
+    void setMinSize(uint64_t size);
+    void setAsyncSize(uint64_t size);
+
+    OnHttpStreamCallback wrap(OnHttpReqCallback handler);
+    //流式响应逐块压缩(chunked)。
+    OnHttpStreamCallback wrapStream(OnHttpStreamCallback handler);
+
+    static uint64_t DefaultMinSize;
+    static uint64_t DefaultAsyncSize;
+
+private:
+    int level_;
+    uint64_t minSize_;
+    uint64_t asyncSize_;
+
+    void compressInPool(ResponseStreamPtr stream, std::shared_ptr<Response> resp, Compression::Encoding encoding);
+};
+
+using ResponseCompressorPtr = std::shared_ptr<ResponseCompressor>;
+
+}
+}
+#endif
@@ -0,0 +1,91 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_RESPONSE_PARSER_HPP
+#define UV_HTTP_RESPONSE_PARSER_HPP
+
+#include <functional>
+#include <string>
+#include "Response.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//增量式Response解析：随数据到达逐段解析，已解析的数据不再重复扫描。
+//body支持Content-Length、chunked及以关闭连接结束三种形式。
+class ResponseParser
+{
+public:
+    using OnHeadersCallback = std::function<void(Response&)>;
+    using OnBodyCallback = std::function<void(const char*, size_t)>;
+
+    ResponseParser();
+
+    //消息头解析完成时回调(不含1xx中间响应)。
+    void setHeadersCallback(OnHeadersCallback callback);
+    //设置后body按到达分段回调(chunked已解码)，不再缓存到Response中。
+    void setBodyCallback(OnBodyCallback callback);
+
+    //每个响应开始前调用，HEAD请求的响应不含body。
+    void reset(bool headRequest = false);
+    //used返回消耗的字节数；返回Success表示响应完整，data中其后的数据属于下一个响应。
+    ParseResult parse(const char* data, size_t size, size_t& used);
+    //连接关闭时调用，以关闭连接结束的响应返回Success。
+    ParseResult finish();
+
+    Response& getResponse();
+    //响应结束后连接是否可复用。
+    bool isKeepAlive();
+    //是否已收到当前响应的数据。
+    bool isStarted();
+
+    static uint64_t MaxHeadSize;
+
+private:
+    enum State
+    {
+        Head,
+        Body,
+        ChunkSize,
+        ChunkData,
+        ChunkCrlf,
+        Trailer,
+        UntilClose,
+        Completed
+    };
+
+    ParseResult parseHead(const char* data, size_t size, size_t& used);
+    ParseResult onHeadCompleted();
+    ParseResult parseLine(const char* data, size_t size, size_t& used, bool& completed);
+    ParseResult parseChunkSize();
+    void onBody(const char* data, size_t size);
+    ParseResult onCompleted();
+    bool findHead(const char* key, std::string& value);
+
+private:
+    State state_;
+    bool headRequest_;
+    bool keepAlive_;
+    bool started_;
+    uint64_t remain_;
+    std::string head_;
+    std::string line_;
+    std::string body_;
+    Response response_;
+
+    OnHeadersCallback onHeaders_;
+    OnBodyCallback onBody_;
+};
+
+}
+}
+#endif
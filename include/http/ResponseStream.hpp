@@ -0,0 +1,127 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_RESPONSE_STREAM_HPP
+#define UV_HTTP_RESPONSE_STREAM_HPP
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include "../TcpConnection.hpp"
+#include "Response.hpp"
+#include "FileSender.hpp"
+#include "Compression.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//响应句柄：可一次性send完整响应，也可流式响应writeHead -> writeChunk ... -> end。
+//所有接口线程安全，非loop线程调用时转投到连接所属loop执行，可在回调返回后延迟完成。
+//Http1.1流式响应未指定Content-Length时使用chunked编码。
+//同一连接上pipeline的多个请求按请求顺序写出，未轮到的响应先缓存。
+class ResponseStream : public std::enable_shared_from_this<ResponseStream>
+{
+public:
+    ResponseStream(EventLoop* loop, TcpConnectionPtr connection, HttpVersion version);
+    virtual ~ResponseStream();
+
+    void send(Response& resp);
+
+    void writeHead(Response& head);
+    //返回false表示待写数据超过高水位，应等待drain回调后继续写入。
+    bool writeChunk(const char* data, size_t size);
+    bool writeChunk(std::string&& data);
+    //共享数据(如文件缓存)直接写出不拷贝，写出期间data不可修改。
+    bool writeChunk(std::shared_ptr<std::string> data);
+    void end();
+    //head需包含Content-Length，之后写出file的[offset, offset+length)区间并结束响应。
+    //接管file，完成后关闭。
+    void sendFile(Response& head, uv_file file, int64_t offset, uint64_t length);
+    //写出已序列化的完整响应(如缓存)：head为状态行及消息头，不含Connection头及结束空行；
+    //head与body共享不拷贝，写出期间不可修改。
+    void sendSerialized(std::shared_ptr<std::string> head, std::shared_ptr<std::string> body);
+
+    //压缩之后写出的body(send/writeHead之前调用)，响应不可压缩时忽略；sendFile/sendSerialized不压缩。
+    void setCompression(Compression::Encoding encoding, int level = Compression::DefaultLevel);
+
+    bool isWritable();
+    bool isClosed();
+    bool isEnded();
+    bool isKeepAlive();
+    uint64_t pendingSize();
+    EventLoop* getLoop();
+
+    //待写数据降至低水位(高水位一半)时在loop线程回调；连接断开时同样回调，需检查isClosed()。
+    //与写操作一样转投到loop执行。
+    void setDrainCallback(DefaultCallback callback);
+    void setHighWaterMark(uint64_t size);
+
+    //以下接口由HttpServer在loop线程中调用。
+    void setKeepAlive(bool keepAlive);
+    void setCompleteCallback(DefaultCallback callback);
+    void activate();
+    //尚未开始响应时以code应答并返回true。
+    bool sendStatus(Response::StatusCode code);
+    //连接关闭时放弃未写出的响应。
+    void abort();
+    //已开始的响应无法按时结束时放弃：Http1.x关闭连接，Http2重置stream。
+    virtual void cancel();
+
+    static uint64_t DefaultHighWaterMark;
+
+protected:
+    //以下在loop线程中执行，子类(如Http2Stream)改写输出方式。
+    virtual void sendInLoop(std::shared_ptr<Response> resp);
+    virtual void writeHeadInLoop(std::shared_ptr<Response> head);
+    //size为计入pending_的大小，压缩时与data实际大小不同。
+    virtual void writeBufferInLoop(std::shared_ptr<std::string> data, uint64_t size);
+    virtual void sendFileInLoop(std::shared_ptr<Response> head, std::shared_ptr<FileSender> sender);
+    virtual void sendSerializedInLoop(std::shared_ptr<std::string> head, std::shared_ptr<std::string> body);
+    virtual void endInLoop();
+
+    void post(DefaultCallback op);
+    void writeChunkInLoop(std::shared_ptr<std::string> data);
+    void prepareCompression(Response& resp);
+    //一次性压缩resp的body。
+    void compressContent(Response& resp);
+    void appendConnectionHead(Response& resp);
+    void afterWrite(uint64_t size, int status);
+    void onClosed();
+    void onComplete();
+
+protected:
+    EventLoop* loop_;
+    std::weak_ptr<TcpConnection> connection_;
+    HttpVersion version_;
+    bool chunked_;
+    bool headSent_;
+    bool keepAlive_;
+    bool active_;
+    bool completed_;
+    std::deque<DefaultCallback> ops_;
+    std::atomic<bool> needDrain_;
+    std::atomic<bool> started_;
+    std::atomic<bool> ended_;
+    std::atomic<bool> closed_;
+    std::atomic<uint64_t> pending_;
+    std::atomic<uint64_t> highWaterMark_;
+    std::unique_ptr<Compression> compression_;
+
+    DefaultCallback onDrain_;
+    DefaultCallback onComplete_;
+};
+
+using ResponseStreamPtr = std::shared_ptr<ResponseStream>;
+
+}
+}
+#endif
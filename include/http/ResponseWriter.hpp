@@ -0,0 +1,50 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_RESPONSE_WRITER_HPP
+#define UV_HTTP_RESPONSE_WRITER_HPP
+
+#include <ctime>
+#include <memory>
+#include "../TcpConnection.hpp"
+#include "Response.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//Response快速序列化:
+//状态行按StatusCode预先生成，Date消息头每秒生成一次(线程内缓存)，
+//消息头写入线程内复用的缓存，body不拷贝，与消息头聚合写出。
+class ResponseWriter
+{
+public:
+    static const std::string& GetStatusLine(HttpVersion version, Response::StatusCode code);
+    static const char* GetStatusInfo(Response::StatusCode code);
+    static const std::string& GetDateHead();
+    //RFC 7231 HTTP-date，如 "Sun, 06 Nov 1994 08:49:37 GMT"。
+    static std::string FormatHttpDate(time_t time);
+
+    //生成状态行及消息头(含空行)，缺省时补充Date与Content-Length。
+    static void PackHead(Response& resp, std::string& out, bool withLength = true);
+    //写出后resp的body被移走。
+    static int Write(TcpConnectionPtr conn, Response& resp, AfterWriteCallback callback);
+
+    static std::string* FetchBuffer();
+    static void ReleaseBuffer(std::string* buffer);
+
+    static const unsigned int BufferPoolSize = 256;
+    static const unsigned int BufferReserveSize = 512;
+};
+
+}
+}
+#endif
@@ -0,0 +1,76 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_ROUTE_TABLE_HPP
+#define UV_HTTP_ROUTE_TABLE_HPP
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+#include "RadixTree.hpp"
+#include "Request.hpp"
+#include "Response.hpp"
+#include "ResponseStream.hpp"
+#include "RequestBody.hpp"
+#include "WebSocketSession.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//路由表：发布(以RouteTablePtr共享)后只读，可被多个loop线程同时查询。
+class RouteTable
+{
+public:
+    using OnHttpReqCallback = std::function<void(Request&,Response*)>;
+    using OnHttpStreamCallback = std::function<void(Request&,ResponseStreamPtr)>;
+    using OnWebSocketCallback = std::function<void(Request&,WebSocketSessionPtr)>;
+    using OnHttpBodyCallback = std::function<void(Request&,RequestBodyPtr,ResponseStreamPtr)>;
+
+    struct Route
+    {
+        OnHttpReqCallback callback = nullptr;
+        OnHttpStreamCallback streamCallback = nullptr;
+        OnWebSocketCallback webSocketCallback = nullptr;
+        OnHttpBodyCallback bodyCallback = nullptr;
+    };
+
+public:
+    RouteTable();
+    //前缀树节点为共享指针，拷贝时按注册顺序重建，新表修改不影响原表。
+    RouteTable(const RouteTable& other);
+    RouteTable& operator=(const RouteTable& other) = delete;
+
+    //同一方法及路径重复注册时原位替换。
+    void set(Methon methon, const std::string& path, const Route& route);
+    bool get(Methon methon, const std::string& path, Route& route) const;
+    size_t size() const;
+
+private:
+    struct Entry
+    {
+        Methon methon;
+        std::string path;
+        Route route;
+    };
+    std::vector<Entry> entries_;
+    //路径到entries_下标。
+    std::unordered_map<std::string, size_t> index_[Methon::Invalid];
+    RadixTree<Route> route_[Methon::Invalid];
+};
+
+using RouteTablePtr = std::shared_ptr<const RouteTable>;
+
+}
+}
+#endif
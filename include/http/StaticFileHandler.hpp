@@ -0,0 +1,105 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_STATIC_FILE_HANDLER_HPP
+#define UV_HTTP_STATIC_FILE_HANDLER_HPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Request.hpp"
+#include "ResponseStream.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//静态文件服务:
+//文件元数据与小文件内容缓存于LRU，大文件经sendfile发送，
+//支持ETag/Last-Modified条件请求(304)与单区间Range请求(206/416)。
+//stat、open、read均在libuv线程池中执行，不阻塞loop。
+//开启setGzipSiblings后，客户端接受gzip且存在同名.gz文件时直接发送预压缩文件。
+class StaticFileHandler : public std::enable_shared_from_this<StaticFileHandler>
+{
+public:
+    struct FileInfo
+    {
+        bool exists;
+        uint64_t size;
+        int64_t mtime;
+        std::string etag;
+        std::string lastModified;
+        //stat时间(loop时间，ms)。
+        uint64_t checkTime;
+        //小文件内容，未缓存时为空。
+        std::shared_ptr<std::string> data;
+    };
+    using FileInfoPtr = std::shared_ptr<const FileInfo>;
+
+    //prefix为url前缀，root为本地目录。
+    StaticFileHandler(std::string prefix, std::string root);
+    virtual ~StaticFileHandler();
+
+    void handle(Request& req, ResponseStreamPtr stream);
+
+    void setIndex(std::string index);
+    //LRU条目数及内容缓存总字节数上限。
+    void setCacheSize(uint64_t entries, uint64_t bytes);
+    //不超过size的文件缓存内容，超过的使用sendfile。
+    void setMaxCacheFileSize(uint64_t size);
+    //缓存的元数据超过ms后重新stat。
+    void setStatInterval(uint64_t ms);
+    void setGzipSiblings(bool enable);
+
+    uint64_t CacheEntries();
+    uint64_t CacheBytes();
+
+    static std::string GetContentType(const std::string& path);
+
+private:
+    struct FileRequest;
+    using FileRequestPtr = std::shared_ptr<FileRequest>;
+
+    void lookup(FileRequestPtr request);
+    void stat(FileRequestPtr request);
+    void load(FileRequestPtr request, FileInfoPtr info);
+    void respond(FileRequestPtr request, FileInfoPtr info);
+    void sendFile(FileRequestPtr request, Response& head, uint64_t offset, uint64_t length);
+
+    FileInfoPtr getCache(const std::string& path);
+    void setCache(const std::string& path, FileInfoPtr info);
+
+    int toLocalPath(const std::string& url, std::string& path);
+
+private:
+    std::string prefix_;
+    std::string root_;
+    std::string index_;
+    uint64_t maxEntries_;
+    uint64_t maxBytes_;
+    uint64_t maxFileSize_;
+    uint64_t statInterval_;
+    bool gzipSiblings_;
+
+    std::mutex mutex_;
+    uint64_t bytes_;
+    std::list<std::pair<std::string, FileInfoPtr>> lru_;
+    std::unordered_map<std::string, std::list<std::pair<std::string, FileInfoPtr>>::iterator> cache_;
+};
+
+using StaticFileHandlerPtr = std::shared_ptr<StaticFileHandler>;
+
+}
+}
+#endif
@@ -0,0 +1,78 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_TEMP_FILE_SINK_HPP
+#define UV_HTTP_TEMP_FILE_SINK_HPP
+
+#include <memory>
+#include <string>
+#include <functional>
+#include "RequestBody.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//将RequestBody写入临时文件：打开、写入、关闭均为libuv fs异步请求(线程池)，不阻塞loop。
+//写入期间到达的分块合并为下一次写入；待写数据超过HighWaterMark时暂停读取连接。
+class TempFileSink : public std::enable_shared_from_this<TempFileSink>
+{
+public:
+    //status为0时path为已写完并关闭的文件，由调用方移走或删除；失败时文件已删除，path为空。
+    using OnCompleteCallback = std::function<void(int status, const std::string& path)>;
+
+    //dir为空时使用系统临时目录。
+    TempFileSink(EventLoop* loop, const std::string& dir = "");
+    virtual ~TempFileSink();
+
+    void start(RequestBodyPtr body, OnCompleteCallback callback);
+    const std::string& getPath();
+    uint64_t getWritten();
+
+    static uint64_t HighWaterMark;
+
+private:
+    void open();
+    void write();
+    void close();
+    void onOpen(ssize_t result);
+    void onWrite(ssize_t result);
+    void onClose();
+    void onChunk(const char* data, size_t size);
+    void onEnd(int status);
+    void fail(int status);
+    void finish();
+
+    static void OnFsCallback(uv_fs_t* req);
+    static std::string MakePath(const std::string& dir);
+
+private:
+    EventLoop* loop_;
+    std::string path_;
+    uv_file file_;
+    uv_fs_t req_;
+    //有fs请求在执行。
+    bool busy_;
+    bool ended_;
+    int status_;
+    uint64_t offset_;
+    std::string writing_;
+    std::string queued_;
+    RequestBodyPtr body_;
+    std::shared_ptr<TempFileSink> self_;
+    OnCompleteCallback callback_;
+};
+
+using TempFileSinkPtr = std::shared_ptr<TempFileSink>;
+
+}
+}
+#endif
@@ -0,0 +1,46 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_WEBSOCKET_GROUP_HPP
+#define UV_HTTP_WEBSOCKET_GROUP_HPP
+
+#include <map>
+#include <mutex>
+#include "WebSocketSession.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+//WebSocket广播组，线程安全。
+//每条消息只编码一次，所有订阅连接共享同一帧数据(可分属不同loop)。
+//组内只保存弱引用，连接关闭后自动移出。
+class WebSocketGroup
+{
+public:
+    WebSocketGroup();
+
+    void add(WebSocketSessionPtr session);
+    void remove(WebSocketSessionPtr session);
+    size_t size();
+
+    //返回投递的连接数。
+    size_t broadcast(WebSocketFrame::Opcode opcode, const char* data, uint64_t size);
+    size_t broadcast(const std::string& text);
+
+private:
+    std::mutex mutex_;
+    std::map<WebSocketSession*, std::weak_ptr<WebSocketSession>> sessions_;
+};
+
+}
+}
+#endif
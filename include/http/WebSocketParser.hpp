@@ -0,0 +1,88 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_WEBSOCKET_PARSER_HPP
+#define UV_HTTP_WEBSOCKET_PARSER_HPP
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "HttpCommon.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+struct WebSocketFrame
+{
+    enum Opcode
+    {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xA,
+    };
+
+    enum CloseCode
+    {
+        Normal = 1000,
+        GoingAway = 1001,
+        ProtocolError = 1002,
+        UnsupportedData = 1003,
+        NoStatus = 1005,
+        Abnormal = 1006,
+        InvalidPayload = 1007,
+        PolicyViolation = 1008,
+        MessageTooBig = 1009,
+        InternalError = 1011,
+    };
+
+    bool fin;
+    uint8_t opcode;
+    char* payload;
+    uint64_t size;
+};
+
+//RFC 6455帧增量解析：数据追加到内部缓存，帧完整后原地去掩码，payload不再拷贝。
+class WebSocketParser
+{
+public:
+    WebSocketParser();
+
+    //客户端发送的帧必须带掩码(服务端解析时开启)。
+    void setRequireMask(bool require);
+    //单帧payload上限，超过时以MessageTooBig出错，不再缓存后续数据。
+    void setMaxFrameSize(uint64_t size);
+
+    void append(const char* data, size_t size);
+    //Success：frame为一个完整帧，payload在下一次append前有效；Fail：数据不足；
+    //Error：协议错误，error为应答的关闭码。
+    ParseResult next(WebSocketFrame& frame, uint16_t& error);
+
+    //原地异或掩码，SSE2/NEON按16字节处理，其余平台按8字节处理。
+    static void Unmask(char* data, uint64_t size, const unsigned char key[4]);
+    //服务端帧头(无掩码)。
+    static void EncodeHead(std::string& out, uint8_t opcode, uint64_t size, bool fin = true);
+    static std::shared_ptr<std::string> Encode(uint8_t opcode, const char* data, uint64_t size);
+    static bool IsValidUtf8(const char* data, uint64_t size);
+
+private:
+    std::string buffer_;
+    size_t offset_;
+    uint64_t maxFrameSize_;
+    bool requireMask_;
+};
+
+}
+}
+#endif
@@ -0,0 +1,119 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef UV_HTTP_WEBSOCKET_SESSION_HPP
+#define UV_HTTP_WEBSOCKET_SESSION_HPP
+
+#include <atomic>
+#include <functional>
+#include "../TcpConnection.hpp"
+#include "../TimerService.hpp"
+#include "Request.hpp"
+#include "WebSocketParser.hpp"
+
+namespace uv
+{
+namespace http
+{
+
+class WebSocketSession;
+using WebSocketSessionPtr = std::shared_ptr<WebSocketSession>;
+
+//HttpServer升级后的WebSocket连接。
+//回调均在连接所属loop中执行；发送接口线程安全，非loop线程调用时转投到loop执行。
+//分片消息合并后回调，ping自动以pong应答。
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession>
+{
+public:
+    using OnMessageCallback = std::function<void(WebSocketSessionPtr, WebSocketFrame::Opcode, std::string&)>;
+    using OnCloseCallback = std::function<void(WebSocketSessionPtr, uint16_t, const std::string&)>;
+    using OnPongCallback = std::function<void(WebSocketSessionPtr, std::string&)>;
+
+    WebSocketSession(EventLoop* loop, TcpConnectionPtr connection);
+    virtual ~WebSocketSession();
+
+    void setMessageCallback(OnMessageCallback callback);
+    //连接关闭时回调一次，code为对端关闭码，异常断开为Abnormal(1006)。
+    void setCloseCallback(OnCloseCallback callback);
+    void setPongCallback(OnPongCallback callback);
+    //单条消息(含分片合并后)上限，超过时以MessageTooBig(1009)关闭。
+    void setMaxMessageSize(uint64_t size);
+    //本端发起关闭后等待对端关闭帧的毫秒数，超时直接断开连接，0为不限。
+    void setCloseTimeout(uint64_t ms);
+
+    void sendText(const std::string& data);
+    void sendBinary(const std::string& data);
+    void send(WebSocketFrame::Opcode opcode, const char* data, uint64_t size);
+    //写出已编码的帧，广播时多个连接共享同一帧数据。
+    void sendFrame(std::shared_ptr<std::string> frame);
+    void ping(const std::string& data = "");
+    //发送关闭帧，收到对端关闭帧后断开连接。
+    void close(uint16_t code = WebSocketFrame::Normal, const std::string& reason = "");
+
+    bool isOpen();
+    uint64_t pendingSize();
+    const std::string& Name();
+    EventLoop* getLoop();
+
+    //以下接口由HttpServer在loop线程中调用。
+    void setCloseConnectionCallback(DefaultCallback callback);
+    void onData(const char* data, size_t size);
+    void onDisconnected();
+
+    static bool IsUpgradeRequest(Request& req);
+    static std::string AcceptKey(const std::string& key);
+    static uint64_t DefaultMaxMessageSize;
+    static uint64_t DefaultCloseTimeout;
+
+private:
+    enum State
+    {
+        Open,
+        //已发送关闭帧，等待对端关闭帧。
+        Closing,
+        Closed
+    };
+
+    EventLoop* loop_;
+    std::weak_ptr<TcpConnection> connection_;
+    std::string name_;
+    std::atomic<int> state_;
+    std::atomic<uint64_t> pending_;
+    WebSocketParser parser_;
+    //分片消息
+    uint8_t messageOpcode_;
+    std::string message_;
+    uint64_t maxMessageSize_;
+    bool closeNotified_;
+    uint64_t closeTimeout_;
+    TimerService::Handle closeTimer_;
+
+    OnMessageCallback onMessageCallback_;
+    OnCloseCallback onCloseCallback_;
+    OnPongCallback onPongCallback_;
+    DefaultCallback closeConnectionCallback_;
+
+    void post(DefaultCallback op);
+    void writeFrame(std::shared_ptr<std::string> frame, DefaultCallback callback = nullptr);
+    void closeInLoop(uint16_t code, const std::string& reason);
+    void onCloseTimeout();
+    void cancelCloseTimer();
+    void onFrame(WebSocketFrame& frame);
+    void onCloseFrame(WebSocketFrame& frame);
+    void deliver(uint8_t opcode, std::string& message);
+    void fail(uint16_t code);
+    void shutdown();
+    void notifyClose(uint16_t code, const std::string& reason);
+    static std::shared_ptr<std::string> EncodeClose(uint16_t code, const std::string& reason);
+};
+
+}
+}
+#endif
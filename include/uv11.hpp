@@ -23,7 +23,12 @@
 #include   "Idle.hpp"
 #include   "GlobalConfig.hpp"
 #include   "DnsGet.hpp"
+#include   "Metrics.hpp"
+#include   "TimerService.hpp"
+#include   "HighResTimer.hpp"
 #include   "http/HttpClient.hpp"
+#include   "http/HttpClientPool.hpp"
 #include   "http/HttpServer.hpp"
+#include   "http/ResponseWriter.hpp"
 
 #endif
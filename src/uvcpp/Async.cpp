@@ -1,94 +1,133 @@
-﻿/*
-Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
-
-Author: orcaer@yeah.net
-
-Last modified: 2020-10-6
-
-Description: https://github.com/wlgq2/uv-cpp
-*/
-#include "include/Async.hpp"
-
-using namespace uv;
-
-Async::Async(EventLoop * loop)
-    :loop_(loop),
-    handle_(nullptr),
-    onCloseCompletCallback_(nullptr)
-{
-
-}
-
-void Async::init()
-{
-    if (nullptr == handle_)
-    {
-        handle_ = new uv_async_t;
-        ::uv_async_init(loop_->handle(), handle_, Async::Callback);
-        handle_->data = static_cast<void*>(this);
-        ::uv_async_send(handle_);
-    }
-}
-
-Async::~Async()
-{
-
-}
-
-void Async::runInThisLoop(DefaultCallback callback)
-{
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        callbacks_.push(callback);
-    }
-    if(handle_ != nullptr)
-        ::uv_async_send(handle_);
-}
-
-void uv::Async::process()
-{
-    std::queue<DefaultCallback> callbacks;
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        callbacks_.swap(callbacks);
-    }
-    while (!callbacks.empty())
-    {
-        auto func = callbacks.front();
-        func();
-        callbacks.pop();
-    }
-}
-
-void Async::close(uv::Async::OnCloseCompletedCallback callback)
-{
-    onCloseCompletCallback_ = callback;
-    if (::uv_is_closing((uv_handle_t*)handle_) == 0)
-    {
-        ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
-        {
-            auto ptr = static_cast<Async*>(handle->data);
-            ptr->onCloseCompleted();
-            delete (uv_async_t*)handle;
-        });
-    }
-}
-
-EventLoop* uv::Async::Loop()
-{
-    return loop_;
-}
-
-void Async::Callback(uv_async_t* handle)
-{
-    auto async = static_cast<Async*>(handle->data);
-    async->process();
-}
-
-void uv::Async::onCloseCompleted()
-{
-    if (nullptr != onCloseCompletCallback_)
-    {
-        onCloseCompletCallback_(this);
-    }
-}
+﻿/*
+Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+Author: orcaer@yeah.net
+
+Last modified: 2020-10-6
+
+Description: https://github.com/wlgq2/uv-cpp
+*/
+#include "include/Async.hpp"
+#include "include/Metrics.hpp"
+
+using namespace uv;
+
+struct AsyncMetrics
+{
+    AsyncMetrics()
+    {
+        auto metrics = Metrics::Instance();
+        calls = metrics->counter("uvcpp_async_calls_total", "Functions queued to run in a loop from other threads.");
+        //排队时延反映loop的繁忙程度(loop lag)。
+        delay = metrics->histogram("uvcpp_async_queue_delay_seconds", "Delay between queueing a function and the loop running it.",
+            { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000 }, 1e-6);
+    }
+    Metrics::Counter* calls;
+    Metrics::Histogram* delay;
+};
+
+static AsyncMetrics& GetAsyncMetrics()
+{
+    static AsyncMetrics metrics;
+    return metrics;
+}
+
+Async::Async(EventLoop * loop)
+    :loop_(loop),
+    handle_(nullptr),
+    queuedTime_(0),
+    onCloseCompletCallback_(nullptr)
+{
+
+}
+
+void Async::init()
+{
+    if (nullptr == handle_)
+    {
+        handle_ = new uv_async_t;
+        ::uv_async_init(loop_->handle(), handle_, Async::Callback);
+        handle_->data = static_cast<void*>(this);
+        ::uv_async_send(handle_);
+    }
+}
+
+Async::~Async()
+{
+
+}
+
+void Async::runInThisLoop(DefaultCallback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (callbacks_.empty())
+        {
+            queuedTime_ = uv_hrtime();
+        }
+        callbacks_.push(callback);
+    }
+    GetAsyncMetrics().calls->inc();
+    if(handle_ != nullptr)
+        ::uv_async_send(handle_);
+}
+
+void uv::Async::process()
+{
+    std::queue<DefaultCallback> callbacks;
+    uint64_t queuedTime;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_.swap(callbacks);
+        queuedTime = queuedTime_;
+    }
+    if (!callbacks.empty())
+    {
+        GetAsyncMetrics().delay->observe((uv_hrtime() - queuedTime) / 1000);
+        auto stats = loop_->getLoopStats();
+        if (nullptr != stats)
+        {
+            stats->onAsyncTasks(callbacks.size());
+        }
+    }
+    while (!callbacks.empty())
+    {
+        auto func = callbacks.front();
+        func();
+        callbacks.pop();
+    }
+}
+
+void Async::close(uv::Async::OnCloseCompletedCallback callback)
+{
+    onCloseCompletCallback_ = callback;
+    if (::uv_is_closing((uv_handle_t*)handle_) == 0)
+    {
+        ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
+        {
+            auto ptr = static_cast<Async*>(handle->data);
+            ptr->onCloseCompleted();
+            delete (uv_async_t*)handle;
+        });
+    }
+}
+
+EventLoop* uv::Async::Loop()
+{
+    return loop_;
+}
+
+void Async::Callback(uv_async_t* handle)
+{
+    auto async = static_cast<Async*>(handle->data);
+    LoopStats::Wake(async->loop_);
+    async->process();
+}
+
+void uv::Async::onCloseCompleted()
+{
+    if (nullptr != onCloseCompletCallback_)
+    {
+        onCloseCompletCallback_(this);
+    }
+}
@@ -1,143 +1,237 @@
-﻿/*
-   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
-
-   Author: orcaer@yeah.net
-    
-   Last modified: 2019-6-17
-    
-   Description: https://github.com/wlgq2/uv-cpp
-*/
-
-#include "include/EventLoop.hpp"
-#include "include/TcpConnection.hpp"
-#include "include/Async.hpp"
-
-using namespace uv;
-
-EventLoop::EventLoop()
-    :EventLoop(EventLoop::Mode::New)
-{
-}
-
-EventLoop::EventLoop(EventLoop::Mode mode)
-    :loop_(nullptr),
-    async_(nullptr),
-    status_(NotRun)
-{
-    if (mode == EventLoop::Mode::New)
-    {
-        loop_ = new uv_loop_t();
-        ::uv_loop_init(loop_);
-    }
-    else
-    {
-        loop_ = uv_default_loop();
-    }
-    async_ = new Async(this);
-}
-
-EventLoop::~EventLoop()
-{
-    if (loop_ != uv_default_loop())
-    {   
-        uv_loop_close(loop_);
-        delete async_;
-        delete loop_;
-    }
-}
-
-EventLoop* uv::EventLoop::DefaultLoop()
-{
-    static EventLoop defaultLoop(EventLoop::Mode::Default);
-    return &defaultLoop;
-}
-
-uv_loop_t* EventLoop::handle()
-{
-    return loop_;
-}
-
-int EventLoop::run()
-{
-    if (status_ == Status::NotRun)
-    {
-        async_->init();
-        loopThreadId_ = std::this_thread::get_id();
-        status_ = Status::Runed;
-        auto rst = ::uv_run(loop_, UV_RUN_DEFAULT);
-        status_ = Status::Stop;
-        return rst;
-    }
-    return -1;
-}
-
-int uv::EventLoop::runNoWait()
-{
-    if (status_ == Status::NotRun)
-    {
-        async_->init();
-        loopThreadId_ = std::this_thread::get_id();
-        status_ = Status::Runed;
-        auto rst = ::uv_run(loop_, UV_RUN_NOWAIT);
-        status_ = Status::NotRun;
-        return rst;
-    }
-    return -1;
-}
-
-int uv::EventLoop::stop()
-{
-    if (status_ == Status::Runed)
-    {
-        async_->close([](Async* ptr)
-        {
-            ::uv_stop(ptr->Loop()->handle());
-        });
-        return 0;
-    }
-    return -1;
-}
-
-bool EventLoop::isStoped()
-{
-    return status_ == Status::Stop;
-}
-
-EventLoop::Status EventLoop::getStatus()
-{
-    return status_;
-}
-
-
-bool EventLoop::isRunInLoopThread()
-{
-    if (status_ == Status::Runed)
-    {
-        return std::this_thread::get_id() == loopThreadId_;
-    }
-    //EventLoop未运行.
-    return false;
-}
-
-void uv::EventLoop::runInThisLoop(const DefaultCallback func)
-{
-    if (nullptr == func)
-        return;
-
-    if (isRunInLoopThread() || isStoped())
-    {
-        func();
-        return;
-    }
-    async_->runInThisLoop(func);
-}
-
-const char* EventLoop::GetErrorMessage(int status)
-{
-    if (WriteInfo::Disconnected == status)
-    {
-        static char info[] = "the connection is disconnected";
-        return info;
-    }
-    return uv_strerror(status);
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+    
+   Last modified: 2019-6-17
+    
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "include/EventLoop.hpp"
+#include "include/TcpConnection.hpp"
+#include "include/Async.hpp"
+#include "include/Metrics.hpp"
+#include "include/TimerService.hpp"
+
+using namespace uv;
+
+EventLoop::EventLoop()
+    :EventLoop(EventLoop::Mode::New)
+{
+}
+
+EventLoop::EventLoop(EventLoop::Mode mode)
+    :loop_(nullptr),
+    async_(nullptr),
+    timerService_(nullptr),
+    stats_(nullptr),
+    closingHandles_(0),
+    onHandlesClosed_(nullptr),
+    status_(NotRun)
+{
+    if (mode == EventLoop::Mode::New)
+    {
+        loop_ = new uv_loop_t();
+        ::uv_loop_init(loop_);
+    }
+    else
+    {
+        loop_ = uv_default_loop();
+    }
+    async_ = new Async(this);
+}
+
+EventLoop::~EventLoop()
+{
+    if (loop_ != uv_default_loop())
+    {
+        //未经stop()退出的loop内部句柄仍打开，关闭后运行一次loop执行关闭回调，uv_loop_close才能成功。
+        if (closeHandles(nullptr))
+        {
+            ::uv_run(loop_, UV_RUN_NOWAIT);
+        }
+        uv_loop_close(loop_);
+        delete async_;
+        delete loop_;
+    }
+    delete timerService_;
+    delete stats_.load();
+}
+
+EventLoop* uv::EventLoop::DefaultLoop()
+{
+    static EventLoop defaultLoop(EventLoop::Mode::Default);
+    return &defaultLoop;
+}
+
+uv_loop_t* EventLoop::handle()
+{
+    return loop_;
+}
+
+TimerService* EventLoop::getTimerService()
+{
+    if (nullptr == timerService_)
+    {
+        timerService_ = new TimerService(this);
+    }
+    return timerService_;
+}
+
+void EventLoop::setStatsEnabled(bool enable)
+{
+    auto stats = stats_.load(std::memory_order_relaxed);
+    if (enable)
+    {
+        if (nullptr == stats)
+        {
+            stats = new LoopStats(this);
+            stats_.store(stats, std::memory_order_release);
+        }
+        stats->start();
+    }
+    else if (nullptr != stats)
+    {
+        //保留对象，此前的统计仍可读取。
+        stats->stop();
+    }
+}
+
+LoopStats* EventLoop::getLoopStats()
+{
+    return stats_.load(std::memory_order_relaxed);
+}
+
+LoopStats::Snapshot EventLoop::stats()
+{
+    LoopStats::Snapshot snapshot{};
+    auto stats = stats_.load(std::memory_order_acquire);
+    if (nullptr != stats)
+    {
+        stats->snapshot(snapshot);
+    }
+    return snapshot;
+}
+
+int EventLoop::run()
+{
+    if (status_ == Status::NotRun)
+    {
+        async_->init();
+        loopThreadId_ = std::this_thread::get_id();
+        status_ = Status::Runed;
+        static auto running = Metrics::Instance()->gauge("uvcpp_event_loops_running", "Event loops currently running.");
+        running->add();
+        auto rst = ::uv_run(loop_, UV_RUN_DEFAULT);
+        running->sub();
+        status_ = Status::Stop;
+        return rst;
+    }
+    return -1;
+}
+
+int uv::EventLoop::runNoWait()
+{
+    if (status_ == Status::NotRun)
+    {
+        async_->init();
+        loopThreadId_ = std::this_thread::get_id();
+        status_ = Status::Runed;
+        auto rst = ::uv_run(loop_, UV_RUN_NOWAIT);
+        status_ = Status::NotRun;
+        return rst;
+    }
+    return -1;
+}
+
+int uv::EventLoop::stop()
+{
+    if (status_ == Status::Runed)
+    {
+        async_->close([](Async* ptr)
+        {
+            auto loop = ptr->Loop();
+            //内部句柄的关闭回调在下一轮执行，之后再退出uv_run。
+            if (!loop->closeHandles([loop]()
+            {
+                ::uv_stop(loop->handle());
+            }))
+            {
+                ::uv_stop(loop->handle());
+            }
+        });
+        return 0;
+    }
+    return -1;
+}
+
+bool EventLoop::closeHandles(DefaultCallback callback)
+{
+    closingHandles_ = 0;
+    onHandlesClosed_ = callback;
+    if (nullptr != timerService_ && !timerService_->isClosed())
+    {
+        closingHandles_++;
+        timerService_->close(std::bind(&EventLoop::onHandleClosed, this));
+    }
+    auto stats = stats_.load(std::memory_order_relaxed);
+    if (nullptr != stats && !stats->isClosed())
+    {
+        closingHandles_++;
+        stats->close(std::bind(&EventLoop::onHandleClosed, this));
+    }
+    return closingHandles_ > 0;
+}
+
+void EventLoop::onHandleClosed()
+{
+    if (0 == --closingHandles_ && onHandlesClosed_)
+    {
+        onHandlesClosed_();
+    }
+}
+
+bool EventLoop::isStoped()
+{
+    return status_ == Status::Stop;
+}
+
+EventLoop::Status EventLoop::getStatus()
+{
+    return status_;
+}
+
+
+bool EventLoop::isRunInLoopThread()
+{
+    if (status_ == Status::Runed)
+    {
+        return std::this_thread::get_id() == loopThreadId_;
+    }
+    //EventLoop未运行.
+    return false;
+}
+
+void uv::EventLoop::runInThisLoop(const DefaultCallback func)
+{
+    if (nullptr == func)
+        return;
+
+    if (isRunInLoopThread() || isStoped())
+    {
+        func();
+        return;
+    }
+    async_->runInThisLoop(func);
+}
+
+const char* EventLoop::GetErrorMessage(int status)
+{
+    if (WriteInfo::Disconnected == status)
+    {
+        static char info[] = "the connection is disconnected";
+        return info;
+    }
+    return uv_strerror(status);
 }
\ No newline at end of file
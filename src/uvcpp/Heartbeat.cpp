@@ -0,0 +1,219 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+
+#include "include/Heartbeat.hpp"
+#include "include/Packet.hpp"
+#include "include/Metrics.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+using namespace uv;
+
+static Metrics::Histogram* GetRttHistogram()
+{
+    static auto histogram = Metrics::Instance()->histogram("uvcpp_tcp_heartbeat_rtt_seconds", "Round trip time measured by tcp heartbeat ping/pong.",
+        { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000 }, 1e-6);
+    return histogram;
+}
+
+Heartbeat::Heartbeat(ForwardCallback forward, ControlCallback control)
+    :forward_(forward),
+    control_(control),
+    state_(Search),
+    headerSize_(0),
+    remaining_(0),
+    interval_(0),
+    maxMisses_(0),
+    lastReceive_(0)
+{
+    std::memset(&stats_, 0, sizeof(stats_));
+}
+
+void Heartbeat::input(const char* buf, size_t size)
+{
+    //run为待转发的连续字节起点，遇到控制帧时先转发。数据包不暂存，只跟踪其边界。
+    const char* run = buf;
+    const char* pos = buf;
+    const char* end = buf + size;
+    while (pos < end)
+    {
+        if (Passthrough == state_)
+        {
+            auto n = std::min<uint64_t>(remaining_, end - pos);
+            pos += n;
+            remaining_ -= n;
+            if (0 == remaining_)
+            {
+                state_ = Search;
+            }
+        }
+        else if (DataHeader == state_)
+        {
+            header_[headerSize_++] = static_cast<uint8_t>(*pos++);
+            if (sizeof(header_) == headerSize_)
+            {
+                uint16_t dataSize;
+                Packet::UnpackNum(header_, dataSize);
+                remaining_ = dataSize + 1;
+                state_ = Passthrough;
+            }
+        }
+        else if (Control == state_)
+        {
+            size_t n = std::min<size_t>(FrameSize - hold_.size(), end - pos);
+            hold_.append(pos, n);
+            pos += n;
+            run = pos;
+            if (FrameSize == hold_.size())
+            {
+                state_ = Search;
+                onFrame();
+            }
+        }
+        else
+        {
+            //包外字节原样转发，由应用层的解析跳过。
+            auto byte = static_cast<uint8_t>(*pos);
+            if (Packet::ControlHeadByte == byte)
+            {
+                if (pos > run)
+                {
+                    forward_(run, pos - run);
+                }
+                hold_.clear();
+                state_ = Control;
+                continue;
+            }
+            if (Packet::HeadByte == byte)
+            {
+                headerSize_ = 0;
+                state_ = DataHeader;
+            }
+            pos++;
+        }
+    }
+    if (pos > run)
+    {
+        forward_(run, pos - run);
+    }
+}
+
+void Heartbeat::onFrame()
+{
+    auto data = (const uint8_t*)hold_.c_str();
+    uint16_t dataSize;
+    Packet::UnpackNum(data + 1, dataSize);
+    auto kind = data[3];
+    if (ControlSize == dataSize && Packet::EndByte == data[FrameSize - 1] && (Ping == kind || Pong == kind))
+    {
+        uint64_t stamp;
+        Packet::UnpackNum(data + 4, stamp);
+        control_(static_cast<Kind>(kind), stamp);
+        return;
+    }
+    //不是完整的控制帧，首字节按包外字节转发，其余重新解析。
+    std::string rest = hold_.substr(1);
+    forward_(hold_.c_str(), 1);
+    input(rest.c_str(), rest.size());
+}
+
+void Heartbeat::Pack(char* out, Kind kind, uint64_t stamp)
+{
+    out[0] = Packet::ControlHeadByte;
+    Packet::PackNum(out + 1, ControlSize);
+    out[3] = static_cast<char>(kind);
+    Packet::PackNum(out + 4, stamp);
+    out[FrameSize - 1] = Packet::EndByte;
+}
+
+void Heartbeat::setInterval(uint64_t interval, unsigned int maxMisses, uint64_t now)
+{
+    interval_ = interval;
+    maxMisses_ = maxMisses;
+    lastReceive_ = now;
+}
+
+uint64_t Heartbeat::getInterval()
+{
+    return interval_;
+}
+
+void Heartbeat::onReceive(uint64_t now)
+{
+    lastReceive_ = now;
+}
+
+void Heartbeat::onPingSent()
+{
+    stats_.pingsSent++;
+}
+
+void Heartbeat::onPong(uint64_t stamp)
+{
+    auto now = ::uv_hrtime();
+    if (stamp > now)
+    {
+        return;
+    }
+    auto rtt = (now - stamp) / 1000;
+    stats_.pongsReceived++;
+    stats_.lastRtt = rtt;
+    if (1 == stats_.pongsReceived)
+    {
+        stats_.minRtt = rtt;
+        stats_.smoothedRtt = rtt;
+        stats_.rttJitter = rtt / 2;
+    }
+    else
+    {
+        stats_.minRtt = std::min(stats_.minRtt, rtt);
+        auto diff = stats_.smoothedRtt > rtt ? stats_.smoothedRtt - rtt : rtt - stats_.smoothedRtt;
+        stats_.rttJitter = (stats_.rttJitter * 3 + diff) / 4;
+        stats_.smoothedRtt = (stats_.smoothedRtt * 7 + rtt) / 8;
+    }
+    GetRttHistogram()->observe(rtt);
+}
+
+bool Heartbeat::isExpired(uint64_t now)
+{
+    return interval_ > 0 && maxMisses_ > 0 && now - lastReceive_ >= interval_ * maxMisses_;
+}
+
+void Heartbeat::sampleTcpInfo(uv_os_fd_t fd)
+{
+#if defined(__linux__)
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+    if (0 == ::getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len))
+    {
+        stats_.tcpInfoValid = true;
+        stats_.tcpRtt = info.tcpi_rtt;
+        stats_.tcpRttVar = info.tcpi_rttvar;
+        stats_.tcpRetransmits = info.tcpi_total_retrans;
+        stats_.tcpCwnd = info.tcpi_snd_cwnd;
+    }
+#else
+    (void)fd;
+#endif
+}
+
+void Heartbeat::getStats(HeartbeatStats& stats, uint64_t now)
+{
+    stats = stats_;
+    stats.idle = now > lastReceive_ ? now - lastReceive_ : 0;
+}
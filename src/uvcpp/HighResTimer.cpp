@@ -0,0 +1,284 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "include/HighResTimer.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+#include "include/LogWriter.hpp"
+
+using namespace uv;
+
+HighResTimer::HighResTimer(EventLoop* loop)
+    :loop_(loop),
+    fd_(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+    poll_(nullptr),
+    armed_(0),
+    size_(0)
+{
+    if (fd_ < 0)
+    {
+        uv::LogWriter::Instance()->error("timerfd_create fail.");
+        return;
+    }
+    poll_ = new uv_poll_t;
+    ::uv_poll_init(loop->handle(), poll_, fd_);
+    poll_->data = static_cast<void*>(this);
+    ::uv_poll_start(poll_, UV_READABLE, HighResTimer::OnReadable);
+}
+
+HighResTimer::~HighResTimer()
+{
+    if (nullptr == poll_)
+    {
+        return;
+    }
+    ::uv_poll_stop(poll_);
+    //fd需在poll句柄关闭完成后再关闭。
+    poll_->data = reinterpret_cast<void*>((intptr_t)fd_);
+    ::uv_close((uv_handle_t*)poll_, [](uv_handle_t* handle)
+    {
+        ::close((int)(intptr_t)handle->data);
+        delete (uv_poll_t*)handle;
+    });
+}
+
+bool HighResTimer::isValid()
+{
+    return nullptr != poll_;
+}
+
+HighResTimer::Handle HighResTimer::schedule(uint64_t timeoutUs, TimerCallback callback, uint64_t repeatUs)
+{
+    Handle handle;
+    if (!isValid())
+    {
+        return handle;
+    }
+    auto index = fetch();
+    auto& slot = slots_[index];
+    slot.deadline = Now() + timeoutUs * 1000;
+    slot.period = repeatUs * 1000;
+    slot.state = Slot::Pending;
+    slot.callback = std::move(callback);
+    push(index);
+    size_++;
+    if (0 == armed_ || slot.deadline < armed_)
+    {
+        rearm();
+    }
+    handle.slot = index;
+    handle.generation = slot.generation;
+    return handle;
+}
+
+bool HighResTimer::cancel(Handle& handle)
+{
+    auto index = handle.slot;
+    auto generation = handle.generation;
+    handle.generation = 0;
+    if (index >= slots_.size() || 0 == generation || slots_[index].generation != generation)
+    {
+        return false;
+    }
+    auto& slot = slots_[index];
+    if (slot.state == Slot::Pending)
+    {
+        //堆中的项在弹出或重建时丢弃。
+        size_--;
+        release(index);
+        return true;
+    }
+    if (slot.state == Slot::Running)
+    {
+        //回调中取消自身，回调返回后回收。
+        slot.state = Slot::Cancelled;
+        return slot.period != 0;
+    }
+    return false;
+}
+
+bool HighResTimer::isPending(const Handle& handle)
+{
+    if (handle.slot >= slots_.size() || 0 == handle.generation || slots_[handle.slot].generation != handle.generation)
+    {
+        return false;
+    }
+    auto& slot = slots_[handle.slot];
+    return slot.state == Slot::Pending || (slot.state == Slot::Running && slot.period != 0);
+}
+
+size_t HighResTimer::size()
+{
+    return size_;
+}
+
+uint64_t HighResTimer::Now()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t HighResTimer::fetch()
+{
+    if (free_.empty())
+    {
+        Slot slot;
+        //代数从1开始，默认构造的句柄无效。
+        slot.generation = 1;
+        slot.state = Slot::Free;
+        slots_.push_back(std::move(slot));
+        return (uint32_t)slots_.size() - 1;
+    }
+    auto index = free_.back();
+    free_.pop_back();
+    return index;
+}
+
+void HighResTimer::push(uint32_t index)
+{
+    auto& slot = slots_[index];
+    heap_.push_back(Entry{ slot.deadline, index, slot.generation });
+    std::push_heap(heap_.begin(), heap_.end(), HighResTimer::Later);
+}
+
+void HighResTimer::release(uint32_t index)
+{
+    auto& slot = slots_[index];
+    slot.state = Slot::Free;
+    slot.callback = nullptr;
+    if (++slot.generation == 0)
+    {
+        slot.generation = 1;
+    }
+    free_.push_back(index);
+}
+
+void HighResTimer::compact()
+{
+    //丢弃已取消定时器留下的失效项。
+    auto end = std::remove_if(heap_.begin(), heap_.end(), [this](const Entry& entry)
+    {
+        auto& slot = slots_[entry.slot];
+        return slot.generation != entry.generation || slot.state != Slot::Pending;
+    });
+    heap_.erase(end, heap_.end());
+    std::make_heap(heap_.begin(), heap_.end(), HighResTimer::Later);
+}
+
+void HighResTimer::run()
+{
+    uint64_t expirations;
+    while (::read(fd_, &expirations, sizeof(expirations)) > 0)
+    {
+    }
+    armed_ = 0;
+    auto now = Now();
+    while (!heap_.empty() && heap_.front().deadline <= now)
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), HighResTimer::Later);
+        auto entry = heap_.back();
+        heap_.pop_back();
+        auto& slot = slots_[entry.slot];
+        if (slot.generation != entry.generation || slot.state != Slot::Pending)
+        {
+            continue;
+        }
+        size_--;
+        slot.state = Slot::Running;
+        slot.callback();
+        if (slot.state == Slot::Running && slot.period > 0)
+        {
+            slot.deadline += slot.period;
+            if (slot.deadline <= now)
+            {
+                //loop阻塞时不补发错过的周期。
+                slot.deadline = now + slot.period;
+            }
+            slot.state = Slot::Pending;
+            push(entry.slot);
+            size_++;
+        }
+        else
+        {
+            release(entry.slot);
+        }
+    }
+    rearm();
+}
+
+void HighResTimer::rearm()
+{
+    if (heap_.size() > size_ * 2 + 64)
+    {
+        compact();
+    }
+    while (!heap_.empty())
+    {
+        auto& entry = heap_.front();
+        auto& slot = slots_[entry.slot];
+        if (slot.generation == entry.generation && slot.state == Slot::Pending)
+        {
+            break;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), HighResTimer::Later);
+        heap_.pop_back();
+    }
+    struct itimerspec spec = {};
+    if (heap_.empty())
+    {
+        if (0 == armed_)
+        {
+            return;
+        }
+        armed_ = 0;
+    }
+    else
+    {
+        auto deadline = heap_.front().deadline;
+        if (deadline == armed_)
+        {
+            return;
+        }
+        armed_ = deadline;
+        spec.it_value.tv_sec = deadline / 1000000000ull;
+        spec.it_value.tv_nsec = deadline % 1000000000ull;
+    }
+    ::timerfd_settime(fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+bool HighResTimer::Later(const Entry& left, const Entry& right)
+{
+    return left.deadline > right.deadline;
+}
+
+void HighResTimer::OnReadable(uv_poll_t* handle, int status, int events)
+{
+    if (status < 0)
+    {
+        //timerfd出错后无法再唤醒，停止poll避免反复回调。
+        uv::LogWriter::Instance()->error(std::string("high resolution timer poll error:") + EventLoop::GetErrorMessage(status));
+        ::uv_poll_stop(handle);
+        return;
+    }
+    if (events & UV_READABLE)
+    {
+        auto ptr = static_cast<HighResTimer*>(handle->data);
+        ptr->run();
+    }
+}
+
+#endif
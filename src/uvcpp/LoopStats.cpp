@@ -0,0 +1,333 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+
+#include "include/LoopStats.hpp"
+#include "include/EventLoop.hpp"
+#include "include/Metrics.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace uv;
+
+struct LoopMetrics
+{
+    LoopMetrics()
+    {
+        auto metrics = Metrics::Instance();
+        std::vector<uint64_t> bounds = { 10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000 };
+        poll = metrics->histogram("uvcpp_loop_poll_seconds", "Time each loop iteration spent waiting in poll.", bounds, 1e-6);
+        busy = metrics->histogram("uvcpp_loop_busy_seconds", "Time each loop iteration spent running callbacks.", bounds, 1e-6);
+        timerLateness = metrics->histogram("uvcpp_loop_timer_lateness_seconds", "Delay between a timer's deadline and its callback.", bounds, 1e-6);
+    }
+    Metrics::Histogram* poll;
+    Metrics::Histogram* busy;
+    Metrics::Histogram* timerLateness;
+};
+
+static LoopMetrics& GetLoopMetrics()
+{
+    static LoopMetrics metrics;
+    return metrics;
+}
+
+//只有loop线程写入，load+store即可，不需要带锁前缀的原子加。
+static inline void Add(std::atomic<uint64_t>& value, uint64_t n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+static inline int BucketOf(uint64_t value)
+{
+    if (0 == value)
+    {
+        return 0;
+    }
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    int bits = (int)index + 1;
+#else
+    int bits = 64 - __builtin_clzll(value);
+#endif
+    return bits < LoopStats::Histogram::Buckets ? bits : LoopStats::Histogram::Buckets - 1;
+}
+
+static inline uint64_t NowUs()
+{
+    return ::uv_hrtime() / 1000;
+}
+
+LoopStats::Histogram::Histogram()
+{
+    count_.store(0);
+    sum_.store(0);
+    max_.store(0);
+    for (auto& bucket : buckets_)
+    {
+        bucket.store(0);
+    }
+}
+
+void LoopStats::Histogram::record(uint64_t value)
+{
+    Add(count_, 1);
+    Add(sum_, value);
+    Add(buckets_[BucketOf(value)], 1);
+    if (value > max_.load(std::memory_order_relaxed))
+    {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LoopStats::Histogram::snapshot(Snapshot& out) const
+{
+    out.count = count_.load(std::memory_order_relaxed);
+    out.sum = sum_.load(std::memory_order_relaxed);
+    out.max = max_.load(std::memory_order_relaxed);
+    for (int i = 0; i < Buckets; i++)
+    {
+        out.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+}
+
+double LoopStats::Histogram::Snapshot::mean() const
+{
+    return count > 0 ? (double)sum / count : 0.0;
+}
+
+uint64_t LoopStats::Histogram::Snapshot::percentile(double q) const
+{
+    //各项分别读取，计数可能略有出入，以各桶之和为准。
+    uint64_t total = 0;
+    for (int i = 0; i < Buckets; i++)
+    {
+        total += buckets[i];
+    }
+    if (0 == total)
+    {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(q * total);
+    if (rank >= total)
+    {
+        rank = total - 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < Buckets - 1; i++)
+    {
+        seen += buckets[i];
+        if (seen > rank)
+        {
+            uint64_t upper = 0 == i ? 0 : (1ull << i) - 1;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+double LoopStats::Snapshot::utilization() const
+{
+    auto total = poll.sum + callback.sum;
+    return total > 0 ? (double)callback.sum / total : 0.0;
+}
+
+LoopStats::LoopStats(EventLoop* loop)
+    :loop_(loop),
+    prepare_(new uv_prepare_t),
+    check_(new uv_check_t),
+    running_(false),
+    closing_(0),
+    onClosed_(nullptr),
+    prepareTime_(0),
+    wakeTime_(0),
+    asyncTasks_(0),
+    iterations_(0)
+{
+    ::uv_prepare_init(loop->handle(), prepare_);
+    ::uv_check_init(loop->handle(), check_);
+    prepare_->data = static_cast<void*>(this);
+    check_->data = static_cast<void*>(this);
+    //统计句柄不使loop保持运行。
+    ::uv_unref((uv_handle_t*)prepare_);
+    ::uv_unref((uv_handle_t*)check_);
+}
+
+LoopStats::~LoopStats()
+{
+    if (isClosed())
+    {
+        return;
+    }
+    stop();
+    ::uv_close((uv_handle_t*)prepare_, [](uv_handle_t* handle)
+    {
+        delete (uv_prepare_t*)handle;
+    });
+    ::uv_close((uv_handle_t*)check_, [](uv_handle_t* handle)
+    {
+        delete (uv_check_t*)handle;
+    });
+}
+
+void LoopStats::close(std::function<void()> callback)
+{
+    if (isClosed())
+    {
+        return;
+    }
+    stop();
+    closing_ = 2;
+    onClosed_ = callback;
+    ::uv_close((uv_handle_t*)prepare_, [](uv_handle_t* handle)
+    {
+        auto stats = static_cast<LoopStats*>(handle->data);
+        delete (uv_prepare_t*)handle;
+        stats->onHandleClosed();
+    });
+    ::uv_close((uv_handle_t*)check_, [](uv_handle_t* handle)
+    {
+        auto stats = static_cast<LoopStats*>(handle->data);
+        delete (uv_check_t*)handle;
+        stats->onHandleClosed();
+    });
+    prepare_ = nullptr;
+    check_ = nullptr;
+}
+
+void LoopStats::onHandleClosed()
+{
+    if (0 == --closing_ && onClosed_)
+    {
+        onClosed_();
+    }
+}
+
+bool LoopStats::isClosed()
+{
+    return nullptr == prepare_;
+}
+
+void LoopStats::start()
+{
+    if (!running_ && !isClosed())
+    {
+        running_ = true;
+        prepareTime_ = 0;
+        wakeTime_ = 0;
+        ::uv_prepare_start(prepare_, &LoopStats::OnPrepare);
+        ::uv_check_start(check_, &LoopStats::OnCheck);
+    }
+}
+
+void LoopStats::stop()
+{
+    if (running_)
+    {
+        running_ = false;
+        prepareTime_ = 0;
+        ::uv_prepare_stop(prepare_);
+        ::uv_check_stop(check_);
+    }
+}
+
+bool LoopStats::isRunning()
+{
+    return running_;
+}
+
+void LoopStats::onWake()
+{
+    //只有prepare之后、check之前的第一次调用生效。
+    if (0 == wakeTime_ && 0 != prepareTime_)
+    {
+        wakeTime_ = NowUs();
+    }
+}
+
+void LoopStats::onAsyncTasks(uint64_t count)
+{
+    asyncTasks_ += count;
+}
+
+void LoopStats::onTimer(uint64_t deadline)
+{
+    if (!running_)
+    {
+        return;
+    }
+    auto now = ::uv_now(loop_->handle());
+    uint64_t lateness = now > deadline ? (now - deadline) * 1000 : 0;
+    timerLateness_.record(lateness);
+    GetLoopMetrics().timerLateness->observe(lateness);
+}
+
+void LoopStats::snapshot(Snapshot& out) const
+{
+    out.iterations = iterations_.load(std::memory_order_relaxed);
+    poll_.snapshot(out.poll);
+    callback_.snapshot(out.callback);
+    timerLateness_.snapshot(out.timerLateness);
+    asyncTaskCounts_.snapshot(out.asyncTasks);
+}
+
+void LoopStats::Wake(EventLoop* loop)
+{
+    auto stats = loop->getLoopStats();
+    if (nullptr != stats)
+    {
+        stats->onWake();
+    }
+}
+
+void LoopStats::TimerFired(EventLoop* loop, uint64_t deadline)
+{
+    auto stats = loop->getLoopStats();
+    if (nullptr != stats)
+    {
+        stats->onTimer(deadline);
+    }
+}
+
+void LoopStats::OnPrepare(uv_prepare_t* handle)
+{
+    auto stats = static_cast<LoopStats*>(handle->data);
+    auto now = NowUs();
+    if (0 != stats->prepareTime_)
+    {
+        //上一轮poll返回(或check)至本次prepare均为回调时间。
+        auto busy = now - stats->wakeTime_;
+        stats->callback_.record(busy);
+        stats->asyncTaskCounts_.record(stats->asyncTasks_);
+        Add(stats->iterations_, 1);
+        GetLoopMetrics().busy->observe(busy);
+    }
+    stats->asyncTasks_ = 0;
+    stats->prepareTime_ = now;
+    stats->wakeTime_ = 0;
+}
+
+void LoopStats::OnCheck(uv_check_t* handle)
+{
+    auto stats = static_cast<LoopStats*>(handle->data);
+    if (0 == stats->prepareTime_)
+    {
+        return;
+    }
+    if (0 == stats->wakeTime_)
+    {
+        stats->wakeTime_ = NowUs();
+    }
+    auto poll = stats->wakeTime_ - stats->prepareTime_;
+    stats->poll_.record(poll);
+    GetLoopMetrics().poll->observe(poll);
+}
@@ -0,0 +1,252 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <algorithm>
+#include <cstdio>
+
+#include "include/Metrics.hpp"
+
+using namespace uv;
+
+const char* Metrics::ContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+static std::string FormatValue(double value)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", value);
+    return buf;
+}
+
+//name{labels} value，extra为追加的label(如le="0.1")。
+static void WriteSample(std::string& out, const std::string& name, const std::string& labels, const std::string& extra, const std::string& value)
+{
+    out += name;
+    if (!labels.empty() || !extra.empty())
+    {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty())
+        {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+Metrics::Metric::~Metric()
+{
+}
+
+void Metrics::Counter::inc(uint64_t value)
+{
+    slots_[Shard()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Metrics::Counter::value()
+{
+    uint64_t sum = 0;
+    for (auto& slot : slots_)
+    {
+        sum += slot.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+const char* Metrics::Counter::type()
+{
+    return "counter";
+}
+
+void Metrics::Counter::serialize(const std::string& family, const std::string& labels, std::string& out)
+{
+    WriteSample(out, family, labels, "", std::to_string(value()));
+}
+
+void Metrics::Gauge::add(int64_t value)
+{
+    slots_[Shard()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+void Metrics::Gauge::sub(int64_t value)
+{
+    slots_[Shard()].value.fetch_sub(value, std::memory_order_relaxed);
+}
+
+int64_t Metrics::Gauge::value()
+{
+    int64_t sum = 0;
+    for (auto& slot : slots_)
+    {
+        sum += slot.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+const char* Metrics::Gauge::type()
+{
+    return "gauge";
+}
+
+void Metrics::Gauge::serialize(const std::string& family, const std::string& labels, std::string& out)
+{
+    WriteSample(out, family, labels, "", std::to_string(value()));
+}
+
+Metrics::Histogram::Histogram(const std::vector<uint64_t>& bounds, double scale)
+    :bounds_(bounds),
+    scale_(scale),
+    stride_((bounds.size() + 2 + 7) / 8 * 8),
+    slots_(Shards * stride_)
+{
+    std::sort(bounds_.begin(), bounds_.end());
+}
+
+void Metrics::Histogram::observe(uint64_t value)
+{
+    auto index = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    auto base = Shard() * stride_;
+    slots_[base + index].fetch_add(1, std::memory_order_relaxed);
+    slots_[base + bounds_.size() + 1].fetch_add(value, std::memory_order_relaxed);
+}
+
+const char* Metrics::Histogram::type()
+{
+    return "histogram";
+}
+
+void Metrics::Histogram::serialize(const std::string& family, const std::string& labels, std::string& out)
+{
+    std::vector<uint64_t> counts(bounds_.size() + 2, 0);
+    for (unsigned int shard = 0; shard < Shards; shard++)
+    {
+        for (size_t i = 0; i < counts.size(); i++)
+        {
+            counts[i] += slots_[shard * stride_ + i].load(std::memory_order_relaxed);
+        }
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < bounds_.size(); i++)
+    {
+        total += counts[i];
+        WriteSample(out, family + "_bucket", labels, "le=\"" + FormatValue(bounds_[i] * scale_) + "\"", std::to_string(total));
+    }
+    total += counts[bounds_.size()];
+    WriteSample(out, family + "_bucket", labels, "le=\"+Inf\"", std::to_string(total));
+    WriteSample(out, family + "_sum", labels, "", FormatValue(counts[bounds_.size() + 1] * scale_));
+    WriteSample(out, family + "_count", labels, "", std::to_string(total));
+}
+
+Metrics::Metrics()
+{
+}
+
+Metrics* Metrics::Instance()
+{
+    static Metrics single;
+    return &single;
+}
+
+unsigned int Metrics::Shard()
+{
+    static std::atomic<unsigned int> next(0);
+    thread_local unsigned int shard = next.fetch_add(1, std::memory_order_relaxed) % Shards;
+    return shard;
+}
+
+Metrics::Counter* Metrics::counter(const std::string& name, const std::string& help)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto metric = find(name);
+    if (nullptr == metric)
+    {
+        metric = new Counter();
+        add(name, help, metric);
+    }
+    return dynamic_cast<Counter*>(metric);
+}
+
+Metrics::Gauge* Metrics::gauge(const std::string& name, const std::string& help)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto metric = find(name);
+    if (nullptr == metric)
+    {
+        metric = new Gauge();
+        add(name, help, metric);
+    }
+    return dynamic_cast<Gauge*>(metric);
+}
+
+Metrics::Histogram* Metrics::histogram(const std::string& name, const std::string& help, const std::vector<uint64_t>& bounds, double scale)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto metric = find(name);
+    if (nullptr == metric)
+    {
+        metric = new Histogram(bounds, scale);
+        add(name, help, metric);
+    }
+    return dynamic_cast<Histogram*>(metric);
+}
+
+void Metrics::serialize(std::string& out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& family : families_)
+    {
+        out += "# HELP " + family->name + " " + family->help + "\n";
+        out += "# TYPE " + family->name + " " + family->metrics.front().second->type() + "\n";
+        for (auto& metric : family->metrics)
+        {
+            metric.second->serialize(family->name, metric.first, out);
+        }
+    }
+}
+
+Metrics::Metric* Metrics::find(const std::string& name)
+{
+    auto it = metrics_.find(name);
+    return it == metrics_.end() ? nullptr : it->second;
+}
+
+void Metrics::add(const std::string& name, const std::string& help, Metric* metric)
+{
+    //拆分family与label：name{a="b"} -> name, a="b"
+    std::string familyName = name;
+    std::string labels;
+    auto pos = name.find('{');
+    if (pos != std::string::npos && name.back() == '}')
+    {
+        familyName = name.substr(0, pos);
+        labels = name.substr(pos + 1, name.size() - pos - 2);
+    }
+    Family* family = nullptr;
+    for (auto& item : families_)
+    {
+        if (item->name == familyName)
+        {
+            family = item.get();
+            break;
+        }
+    }
+    if (nullptr == family)
+    {
+        family = new Family();
+        family->name = familyName;
+        family->help = help;
+        families_.push_back(std::unique_ptr<Family>(family));
+    }
+    family->metrics.push_back(std::make_pair(labels, std::unique_ptr<Metric>(metric)));
+    metrics_[name] = metric;
+}
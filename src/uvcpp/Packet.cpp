@@ -14,6 +14,7 @@ using namespace uv;
 
 
 uint8_t Packet::HeadByte = 0x7e;
+uint8_t Packet::ControlHeadByte = 0x7d;
 uint8_t Packet::EndByte = 0xe7;
 Packet::DataMode Packet::Mode = Packet::DataMode::LittleEndian;
 
@@ -13,6 +13,7 @@ Description: https://github.com/wlgq2/uv-cpp
 #include "include/Async.hpp"
 #include "include/LogWriter.hpp"
 #include "include/GlobalConfig.hpp"
+#include "include/Metrics.hpp"
 
 using namespace std;
 using namespace std::chrono;
@@ -23,6 +24,8 @@ struct WriteReq
     uv_write_t req;
     uv_buf_t buf;
     AfterWriteCallback callback;
+    //写请求总在句柄关闭回调之前完成，此时连接仍有效。
+    TcpConnection* connection;
 };
 
 struct WriteArgs
@@ -41,8 +44,44 @@ struct WriteArgs
     AfterWriteCallback callback;
 };
 
+struct TcpMetrics
+{
+    TcpMetrics()
+    {
+        auto metrics = Metrics::Instance();
+        connections = metrics->gauge("uvcpp_tcp_connections", "Open tcp connections.");
+        receivedBytes = metrics->counter("uvcpp_tcp_received_bytes_total", "Bytes read from tcp connections.");
+        sentBytes = metrics->counter("uvcpp_tcp_sent_bytes_total", "Bytes written to tcp connections.");
+        writeErrors = metrics->counter("uvcpp_tcp_write_errors_total", "Failed tcp writes.");
+        writeQueueBytes = metrics->gauge("uvcpp_tcp_write_queue_bytes", "Bytes queued in tcp write requests not yet completed.");
+        writeQueueRequests = metrics->gauge("uvcpp_tcp_write_queue_requests", "Tcp write requests not yet completed.");
+        slowConsumers = metrics->counter("uvcpp_tcp_slow_consumers_total", "Connections whose queued output exceeded the write deadline or size limit.");
+        heartbeatTimeouts = metrics->counter("uvcpp_tcp_heartbeat_timeouts_total", "Connections closed because the peer missed heartbeats.");
+    }
+    Metrics::Gauge* connections;
+    Metrics::Counter* receivedBytes;
+    Metrics::Counter* sentBytes;
+    Metrics::Counter* writeErrors;
+    Metrics::Gauge* writeQueueBytes;
+    Metrics::Gauge* writeQueueRequests;
+    Metrics::Counter* slowConsumers;
+    Metrics::Counter* heartbeatTimeouts;
+};
+
+static TcpMetrics& GetTcpMetrics()
+{
+    static TcpMetrics metrics;
+    return metrics;
+}
+
 TcpConnection:: ~TcpConnection()
 {
+    if (loop_->isRunInLoopThread())
+    {
+        cancelWriteDeadline();
+        cancelHeartbeat();
+    }
+    GetTcpMetrics().connections->sub();
 }
 
 TcpConnection::TcpConnection(EventLoop* loop, std::string& name, UVTcpPtr client, bool isConnected)
@@ -53,10 +92,30 @@ TcpConnection::TcpConnection(EventLoop* loop, std::string& name, UVTcpPtr client
     buffer_(nullptr),
     onMessageCallback_(nullptr),
     onConnectCloseCallback_(nullptr),
-    closeCompleteCallback_(nullptr)
+    closeCompleteCallback_(nullptr),
+    writeDeadline_(0),
+    writeQueueLimit_(0),
+    evictSlowConsumer_(false),
+    slowConsumer_(false),
+    onSlowConsumerCallback_(nullptr),
+    writeQueueBytes_(0)
 {
     handle_->data = static_cast<void*>(this);
-    ::uv_read_start((uv_stream_t*)handle_.get(),
+    GetTcpMetrics().connections->add();
+    startRead();
+    if (GlobalConfig::BufferModeStatus == GlobalConfig::ListBuffer)
+    {
+        buffer_ = std::make_shared<ListBuffer>();
+    }
+    else if(GlobalConfig::BufferModeStatus == GlobalConfig::CycleBuffer)
+    {
+        buffer_ = std::make_shared<CycleBuffer>();
+    }
+}
+
+int TcpConnection::startRead()
+{
+    return ::uv_read_start((uv_stream_t*)handle_.get(),
         [](uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
     {
         auto conn = static_cast<TcpConnection*>(handle->data);
@@ -68,18 +127,36 @@ TcpConnection::TcpConnection(EventLoop* loop, std::string& name, UVTcpPtr client
 #endif
     },
         &TcpConnection::onMesageReceive);
-    if (GlobalConfig::BufferModeStatus == GlobalConfig::ListBuffer)
+}
+
+void TcpConnection::pauseRead()
+{
+    uv_tcp_t* ptr = handle_.get();
+    if (connected_ && ::uv_is_closing((uv_handle_t*)ptr) == 0)
     {
-        buffer_ = std::make_shared<ListBuffer>();
+        ::uv_read_stop((uv_stream_t*)ptr);
     }
-    else if(GlobalConfig::BufferModeStatus == GlobalConfig::CycleBuffer)
+}
+
+void TcpConnection::resumeRead()
+{
+    uv_tcp_t* ptr = handle_.get();
+    if (connected_ && ::uv_is_closing((uv_handle_t*)ptr) == 0)
     {
-        buffer_ = std::make_shared<CycleBuffer>();
+        startRead();
     }
 }
 
 void TcpConnection::onMessage(const char* buf, ssize_t size)
 {
+    if (heartbeat_)
+    {
+        //回调中可能关闭连接。
+        auto self = shared_from_this();
+        heartbeat_->onReceive(::uv_now(loop_->handle()));
+        heartbeat_->input(buf, size);
+        return;
+    }
     if (onMessageCallback_)
         onMessageCallback_(shared_from_this(), buf, size);
 }
@@ -97,6 +174,8 @@ void TcpConnection::close(std::function<void(std::string&)> callback)
     closeCompleteCallback_ = nullptr;
 
     closeCompleteCallback_ = callback;
+    cancelWriteDeadline();
+    cancelHeartbeat();
     uv_tcp_t* ptr = handle_.get();
     if (::uv_is_active((uv_handle_t*)ptr))
     {
@@ -120,17 +199,44 @@ void TcpConnection::close(std::function<void(std::string&)> callback)
 
 int TcpConnection::write(const char* buf, ssize_t size, AfterWriteCallback callback)
 {
+    uv_buf_t buffer = uv_buf_init(const_cast<char*>(buf), static_cast<unsigned int>(size));
+    return write(&buffer, 1, callback);
+}
+
+int TcpConnection::write(const uv_buf_t* bufs, unsigned int nbufs, AfterWriteCallback callback)
+{
+    unsigned long size = 0;
+    for (unsigned int i = 0; i < nbufs; i++)
+    {
+        size += static_cast<unsigned long>(bufs[i].len);
+    }
+    //多个buf时没有与总长度对应的单一地址，回调中buf为nullptr。
+    char* buf = 1 == nbufs ? bufs[0].base : nullptr;
     int rst;
     if (connected_)
     {
         WriteReq* req = new WriteReq;
-        req->buf = uv_buf_init(const_cast<char*>(buf), static_cast<unsigned int>(size));
+        req->buf = uv_buf_init(buf, static_cast<unsigned int>(size));
         req->callback = callback;
+        req->connection = this;
         auto ptr = handle_.get();
-        rst = ::uv_write((uv_write_t*)req, (uv_stream_t*)ptr, &req->buf, 1,
+        rst = ::uv_write((uv_write_t*)req, (uv_stream_t*)ptr, bufs, nbufs,
             [](uv_write_t *req, int status)
         {
             WriteReq* wr = (WriteReq*)req;
+            LoopStats::Wake(wr->connection->loop_);
+            auto& metrics = GetTcpMetrics();
+            metrics.writeQueueBytes->sub(wr->buf.len);
+            metrics.writeQueueRequests->sub();
+            if (0 == status)
+            {
+                metrics.sentBytes->inc(wr->buf.len);
+            }
+            else
+            {
+                metrics.writeErrors->inc();
+            }
+            wr->connection->onWriteComplete(wr->buf.len);
             if (nullptr != wr->callback)
             {
                 struct WriteInfo info;
@@ -143,27 +249,249 @@ int TcpConnection::write(const char* buf, ssize_t size, AfterWriteCallback callb
         });
         if (0 != rst)
         {
+            GetTcpMetrics().writeErrors->inc();
             uv::LogWriter::Instance()->error(std::string("write data error:"+std::to_string(rst)));
             if (nullptr != callback)
             {
-                struct WriteInfo info = { rst,const_cast<char*>(buf),static_cast<unsigned long>(size) };
+                struct WriteInfo info = { rst,buf,size };
                 callback(info);
             }
             delete req;
         }
+        else
+        {
+            GetTcpMetrics().writeQueueBytes->add(size);
+            GetTcpMetrics().writeQueueRequests->add();
+            onWriteQueued(size);
+        }
     }
     else
     {
         rst = -1;
         if (nullptr != callback)
         {
-            struct WriteInfo info = { WriteInfo::Disconnected,const_cast<char*>(buf),static_cast<unsigned long>(size) };
+            struct WriteInfo info = { WriteInfo::Disconnected,buf,size };
             callback(info);
         }
     }
     return rst;
 }
 
+void TcpConnection::setWriteLimits(uint64_t deadlineMs, size_t maxBytes, bool evict)
+{
+    writeDeadline_ = deadlineMs;
+    writeQueueLimit_ = maxBytes;
+    evictSlowConsumer_ = evict;
+    if (0 == writeDeadline_)
+    {
+        cancelWriteDeadline();
+    }
+    else if (!writeQueuedTimes_.empty() && !slowConsumer_)
+    {
+        onWriteDeadline();
+    }
+}
+
+void TcpConnection::setSlowConsumerCallback(OnSlowConsumerCallback callback)
+{
+    onSlowConsumerCallback_ = callback;
+}
+
+size_t TcpConnection::getWriteQueueBytes()
+{
+    return writeQueueBytes_;
+}
+
+uint64_t TcpConnection::getOldestWriteAge()
+{
+    if (writeQueuedTimes_.empty())
+    {
+        return 0;
+    }
+    return ::uv_now(loop_->handle()) - writeQueuedTimes_.front();
+}
+
+void TcpConnection::onWriteQueued(size_t size)
+{
+    writeQueuedTimes_.push_back(::uv_now(loop_->handle()));
+    writeQueueBytes_ += size;
+    if (slowConsumer_)
+    {
+        return;
+    }
+    if (writeQueueLimit_ > 0 && writeQueueBytes_ > writeQueueLimit_)
+    {
+        onSlowConsumer();
+        return;
+    }
+    //队列由空变为非空时按该请求的截止时间启动检查。
+    if (writeDeadline_ > 0 && 1 == writeQueuedTimes_.size())
+    {
+        scheduleWriteDeadline(writeDeadline_);
+    }
+}
+
+void TcpConnection::onWriteComplete(size_t size)
+{
+    if (!writeQueuedTimes_.empty())
+    {
+        writeQueuedTimes_.pop_front();
+    }
+    writeQueueBytes_ -= size < writeQueueBytes_ ? size : writeQueueBytes_;
+    if (writeQueuedTimes_.empty())
+    {
+        slowConsumer_ = false;
+        cancelWriteDeadline();
+    }
+}
+
+void TcpConnection::cancelWriteDeadline()
+{
+    //未设置过截止检查的连接不创建TimerService。
+    if (nullptr != writeDeadlineTimer_.element)
+    {
+        loop_->getTimerService()->cancel(writeDeadlineTimer_);
+    }
+}
+
+void TcpConnection::scheduleWriteDeadline(uint64_t delay)
+{
+    auto service = loop_->getTimerService();
+    service->cancel(writeDeadlineTimer_);
+    std::weak_ptr<TcpConnection> connection = shared_from_this();
+    writeDeadlineTimer_ = service->schedule(delay, [connection]()
+    {
+        auto ptr = connection.lock();
+        if (ptr)
+        {
+            ptr->onWriteDeadline();
+        }
+    });
+}
+
+void TcpConnection::onWriteDeadline()
+{
+    if (writeQueuedTimes_.empty() || slowConsumer_ || 0 == writeDeadline_)
+    {
+        return;
+    }
+    auto age = getOldestWriteAge();
+    if (age >= writeDeadline_)
+    {
+        onSlowConsumer();
+    }
+    else
+    {
+        //期间较早的请求已完成，按新的队首重新计时。
+        scheduleWriteDeadline(writeDeadline_ - age);
+    }
+}
+
+void TcpConnection::onSlowConsumer()
+{
+    slowConsumer_ = true;
+    cancelWriteDeadline();
+    GetTcpMetrics().slowConsumers->inc();
+    auto self = shared_from_this();
+    if (onSlowConsumerCallback_)
+    {
+        onSlowConsumerCallback_(self, getOldestWriteAge(), writeQueueBytes_);
+    }
+    if (evictSlowConsumer_ && connected_)
+    {
+        uv::LogWriter::Instance()->warn("evict slow consumer " + name_);
+        onSocketClose();
+    }
+}
+
+void TcpConnection::setHeartbeat(uint64_t intervalMs, unsigned int maxMisses)
+{
+    if (!heartbeat_)
+    {
+        heartbeat_.reset(new Heartbeat(std::bind(&TcpConnection::forwardMessage, this, placeholders::_1, placeholders::_2),
+            std::bind(&TcpConnection::onHeartbeatControl, this, placeholders::_1, placeholders::_2)));
+    }
+    heartbeat_->setInterval(intervalMs, maxMisses, ::uv_now(loop_->handle()));
+    cancelHeartbeat();
+    if (intervalMs > 0)
+    {
+        std::weak_ptr<TcpConnection> connection = shared_from_this();
+        heartbeatTimer_ = loop_->getTimerService()->schedule(intervalMs, [connection]()
+        {
+            auto ptr = connection.lock();
+            if (ptr)
+            {
+                ptr->onHeartbeatTick();
+            }
+        }, intervalMs);
+    }
+}
+
+bool TcpConnection::getHeartbeatStats(HeartbeatStats& stats)
+{
+    if (!heartbeat_)
+    {
+        return false;
+    }
+    heartbeat_->getStats(stats, ::uv_now(loop_->handle()));
+    return true;
+}
+
+void TcpConnection::forwardMessage(const char* buf, size_t size)
+{
+    if (onMessageCallback_)
+        onMessageCallback_(shared_from_this(), buf, size);
+}
+
+void TcpConnection::onHeartbeatControl(Heartbeat::Kind kind, uint64_t stamp)
+{
+    if (Heartbeat::Ping == kind)
+    {
+        sendHeartbeat(Heartbeat::Pong, stamp);
+    }
+    else
+    {
+        heartbeat_->onPong(stamp);
+    }
+}
+
+void TcpConnection::onHeartbeatTick()
+{
+    if (heartbeat_->isExpired(::uv_now(loop_->handle())))
+    {
+        cancelHeartbeat();
+        GetTcpMetrics().heartbeatTimeouts->inc();
+        uv::LogWriter::Instance()->warn("heartbeat timeout " + name_);
+        onSocketClose();
+        return;
+    }
+    uv_os_fd_t fd;
+    if (0 == fileno(fd))
+    {
+        heartbeat_->sampleTcpInfo(fd);
+    }
+    heartbeat_->onPingSent();
+    sendHeartbeat(Heartbeat::Ping, ::uv_hrtime());
+}
+
+void TcpConnection::sendHeartbeat(Heartbeat::Kind kind, uint64_t stamp)
+{
+    char* frame = new char[Heartbeat::FrameSize];
+    Heartbeat::Pack(frame, kind, stamp);
+    write(frame, Heartbeat::FrameSize, [](WriteInfo& info)
+    {
+        delete[] info.buf;
+    });
+}
+
+void TcpConnection::cancelHeartbeat()
+{
+    if (nullptr != heartbeatTimer_.element)
+    {
+        loop_->getTimerService()->cancel(heartbeatTimer_);
+    }
+}
+
 void TcpConnection::writeInLoop(const char* buf, ssize_t size, AfterWriteCallback callback)
 {
     std::weak_ptr<uv::TcpConnection> conn = shared_from_this();
@@ -184,21 +512,23 @@ void TcpConnection::writeInLoop(const char* buf, ssize_t size, AfterWriteCallbac
 }
 
 
-void TcpConnection::setWrapper(ConnectionWrapperPtr wrapper)
+void TcpConnection::setContext(std::shared_ptr<void> context)
 {
-    wrapper_ = wrapper;
+    context_ = context;
 }
 
-std::shared_ptr<ConnectionWrapper> TcpConnection::getWrapper()
+std::shared_ptr<void> TcpConnection::getContext()
 {
-    return wrapper_.lock();
+    return context_;
 }
 
 void  TcpConnection::onMesageReceive(uv_stream_t* client, ssize_t nread, const uv_buf_t* buf)
 {
     auto connection = static_cast<TcpConnection*>(client->data);
+    LoopStats::Wake(connection->loop_);
     if (nread > 0)
     {
+        GetTcpMetrics().receivedBytes->inc(nread);
         connection->onMessage(buf->base, nread);
     }
     else if (nread < 0)
@@ -262,6 +592,11 @@ const std::string& uv::TcpConnection::Name()
     return name_;
 }
 
+int uv::TcpConnection::fileno(uv_os_fd_t& fd)
+{
+    return ::uv_fileno((uv_handle_t*)handle_.get(), &fd);
+}
+
 char* uv::TcpConnection::resizeData(size_t size)
 {
     data_.resize(size);
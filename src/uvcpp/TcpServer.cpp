@@ -15,6 +15,7 @@
 
 #include "include/TcpServer.hpp"
 #include "include/LogWriter.hpp"
+#include "include/Metrics.hpp"
 
 using namespace std;
 using namespace uv;
@@ -32,9 +33,18 @@ TcpServer::TcpServer(EventLoop* loop, bool tcpNoDelay)
     onMessageCallback_(nullptr),
     onNewConnectCallback_(nullptr),
     onConnectCloseCallback_(nullptr),
-    timerWheel_(loop)
+    timerWheel_(loop),
+    writeDeadline_(0),
+    writeQueueLimit_(0),
+    evictSlowConsumer_(false),
+    onSlowConsumerCallback_(nullptr),
+    heartbeatInterval_(0),
+    heartbeatMisses_(0)
 {
-
+    timerWheel_.setTimeoutCallback([](TcpConnection* connection)
+    {
+        connection->onSocketClose();
+    });
 }
 
 TcpServer:: ~TcpServer()
@@ -47,24 +57,74 @@ void TcpServer::setTimeout(unsigned int seconds)
     timerWheel_.setTimeout(seconds);
 }
 
+void TcpServer::setTimeout(uint64_t ms, uint64_t resolution)
+{
+    timerWheel_.setTimeout(ms, resolution);
+}
+
+unsigned int uv::TcpServer::getTimeout()
+{
+    return timerWheel_.getTimeout();
+}
+
+uint64_t uv::TcpServer::getTimeoutMs()
+{
+    return timerWheel_.getTimeoutMs();
+}
+
+uint64_t uv::TcpServer::getTimeoutResolution()
+{
+    return timerWheel_.getResolution();
+}
+
+void uv::TcpServer::setWriteLimits(uint64_t deadlineMs, size_t maxBytes, bool evict)
+{
+    writeDeadline_ = deadlineMs;
+    writeQueueLimit_ = maxBytes;
+    evictSlowConsumer_ = evict;
+}
+
+void uv::TcpServer::setSlowConsumerCallback(OnSlowConsumerCallback callback)
+{
+    onSlowConsumerCallback_ = callback;
+}
+
+void uv::TcpServer::setHeartbeat(uint64_t intervalMs, unsigned int maxMisses)
+{
+    heartbeatInterval_ = intervalMs;
+    heartbeatMisses_ = maxMisses;
+}
+
+void uv::TcpServer::prepareAccept(SocketAddr::IPV ipv)
+{
+    ipv_ = ipv;
+    timerWheel_.start();
+}
+
 void uv::TcpServer::onAccept(EventLoop * loop, UVTcpPtr client)
 {
     string key;
     SocketAddr::AddrToStr(client.get(), key, ipv_);
 
     uv::LogWriter::Instance()->debug("new connect  " + key);
+    static auto accepted = Metrics::Instance()->counter("uvcpp_tcp_accepted_total", "Tcp connections accepted by servers.");
+    accepted->inc();
     shared_ptr<TcpConnection> connection(new TcpConnection(loop, key, client));
     if (connection)
     {
         connection->setMessageCallback(std::bind(&TcpServer::onMessage, this, placeholders::_1, placeholders::_2, placeholders::_3));
         connection->setConnectCloseCallback(std::bind(&TcpServer::closeConnection, this, placeholders::_1));
-	    addConnection(key, connection);
-        if (timerWheel_.getTimeout() > 0)
+        if (writeDeadline_ > 0 || writeQueueLimit_ > 0)
+        {
+            connection->setWriteLimits(writeDeadline_, writeQueueLimit_, evictSlowConsumer_);
+            connection->setSlowConsumerCallback(onSlowConsumerCallback_);
+        }
+        if (heartbeatInterval_ > 0)
         {
-            auto wrapper = std::make_shared<ConnectionWrapper>(connection);
-            connection->setWrapper(wrapper);
-            timerWheel_.insert(wrapper);
+            connection->setHeartbeat(heartbeatInterval_, heartbeatMisses_);
         }
+	    addConnection(key, connection);
+        timerWheel_.insert(connection.get());
         if (onNewConnectCallback_)
             onNewConnectCallback_(connection);
     }
@@ -101,6 +161,39 @@ void TcpServer::close(DefaultCallback callback)
     });
 }
 
+void TcpServer::closeConnections(DefaultCallback callback)
+{
+    auto pending = std::make_shared<size_t>(connnections_.size() + 1);
+    auto onClosed = [pending, callback]()
+    {
+        if (0 == --(*pending) && callback)
+        {
+            callback();
+        }
+    };
+    //已在关闭中的连接会同步回调并从表中移除，遍历副本。
+    auto connections = connnections_;
+    for (auto& it : connections)
+    {
+        timerWheel_.remove(it.second.get());
+        it.second->close([this, onClosed](std::string& name)
+        {
+            //已在关闭中的连接在原关闭回调中还会再回调一次，只计一次。
+            auto connection = getConnection(name);
+            if (nullptr != connection)
+            {
+                if (onConnectCloseCallback_)
+                {
+                    onConnectCloseCallback_(connection);
+                }
+                removeConnection(name);
+                onClosed();
+            }
+        });
+    }
+    timerWheel_.close(onClosed);
+}
+
 void TcpServer::addConnection(std::string& name, TcpConnectionPtr connection)
 {
     connnections_.insert(pair<string,shared_ptr<TcpConnection>>(std::move(name),connection));
@@ -126,6 +219,7 @@ void TcpServer::closeConnection(const string& name)
     auto connection = getConnection(name);
     if (nullptr != connection)
     {
+        timerWheel_.remove(connection.get());
         connection->close([this](std::string& name)
         {
             auto connection = getConnection(name);
@@ -147,10 +241,7 @@ void TcpServer::onMessage(TcpConnectionPtr connection,const char* buf,ssize_t si
 {
     if(onMessageCallback_)
         onMessageCallback_(connection,buf,size);
-    if (timerWheel_.getTimeout() > 0)
-    {
-        timerWheel_.insert(connection->getWrapper());
-    }
+    timerWheel_.insert(connection.get());
 }
 
 
@@ -1,91 +1,214 @@
-﻿/*
-   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
-
-   Author: orcaer@yeah.net
-    
-   Last modified: 2019-9-10
-    
-   Description: uv-cpp
-*/
-
-#include "include/Timer.hpp"
-
-using namespace uv;
-
-Timer::Timer(EventLoop * loop, uint64_t timeout, uint64_t repeat, TimerCallback callback)
-    :started_(false),
-    handle_(new uv_timer_t),
-    timeout_(timeout),
-    repeat_(repeat),
-    callback_(callback),
-    closeComplete_(nullptr)
-{
-    handle_->data = static_cast<void*>(this);
-    ::uv_timer_init(loop->handle(), handle_);
-}
-
-Timer::~Timer()
-{
-}
-
-void Timer::start()
-{
-    if (!started_)
-    {
-        started_ = true;
-        ::uv_timer_start(handle_, Timer::process, timeout_, repeat_);
-    }
-}
-
-void Timer::close(TimerCloseComplete callback)
-{
-    closeComplete_ = callback;
-    if (uv_is_active((uv_handle_t*)handle_))
-    {
-        uv_timer_stop(handle_);
-    }
-    if (uv_is_closing((uv_handle_t*)handle_) == 0)
-    {
-        ::uv_close((uv_handle_t*)handle_,
-            [](uv_handle_t* handle)
-        {
-            auto ptr = static_cast<Timer*>(handle->data);
-            ptr->closeComplete();
-            delete handle;
-        });
-    }
-    else
-    {
-        closeComplete();
-    }
-}
-
-
-void Timer::setTimerRepeat(uint64_t ms)
-{
-    repeat_ = ms;
-    ::uv_timer_set_repeat(handle_, ms);
-}
-
-
-void Timer::onTimeOut()
-{
-    if (callback_)
-    {
-        callback_(this);
-    }
-}
-
-void Timer::closeComplete()
-{
-    if (closeComplete_)
-        closeComplete_(this);
-}
-
-void Timer::process(uv_timer_t * handle)
-{
-    auto ptr = static_cast<Timer*>(handle->data);
-    ptr->onTimeOut();
-}
-
-
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+    
+   Last modified: 2019-9-10
+    
+   Description: uv-cpp
+*/
+
+#include "include/Timer.hpp"
+#include "include/Metrics.hpp"
+
+#include <vector>
+#include <algorithm>
+
+using namespace uv;
+
+struct TimerMetrics
+{
+    TimerMetrics()
+    {
+        auto metrics = Metrics::Instance();
+        timers = metrics->gauge("uvcpp_timers", "Timers created and not yet closed.");
+        callbacks = metrics->counter("uvcpp_timer_callbacks_total", "Timer callbacks run.");
+        wakeupsSaved = metrics->counter("uvcpp_timer_wakeups_saved_total", "Timer deadlines merged into an earlier loop wakeup by slack alignment.");
+    }
+    Metrics::Gauge* timers;
+    Metrics::Counter* callbacks;
+    Metrics::Counter* wakeupsSaved;
+};
+
+//本线程当前这次唤醒(loop及loop时间)中已触发的对齐定时器的原到期时间。
+//同一次唤醒中每多一个不同的原到期时间，就省去了一次唤醒。
+struct CoalesceState
+{
+    uv_loop_t* loop = nullptr;
+    uint64_t now = 0;
+    std::vector<uint64_t> dues;
+};
+
+static thread_local CoalesceState Coalesced;
+
+static TimerMetrics& GetTimerMetrics()
+{
+    static TimerMetrics metrics;
+    return metrics;
+}
+
+Timer::Timer(EventLoop * loop, uint64_t timeout, uint64_t repeat, TimerCallback callback)
+    :started_(false),
+    loop_(loop),
+    handle_(new uv_timer_t),
+    timeout_(timeout),
+    repeat_(repeat),
+    slack_(0),
+    due_(0),
+    callback_(callback),
+    closeComplete_(nullptr)
+{
+    handle_->data = static_cast<void*>(this);
+    ::uv_timer_init(loop->handle(), handle_);
+    GetTimerMetrics().timers->add();
+}
+
+Timer::~Timer()
+{
+}
+
+void Timer::start()
+{
+    if (!started_)
+    {
+        started_ = true;
+        auto now = ::uv_now(handle_->loop);
+        due_ = now + timeout_;
+        if (slack_ > 1)
+        {
+            //重复周期由onTimeOut按对齐后的时间重新启动，libuv的repeat会偏离网格。
+            startAligned(now);
+        }
+        else
+        {
+            ::uv_timer_start(handle_, Timer::process, timeout_, repeat_);
+        }
+    }
+}
+
+void Timer::stop()
+{
+    if (started_)
+    {
+        started_ = false;
+        ::uv_timer_stop(handle_);
+    }
+}
+
+void Timer::startAligned(uint64_t now)
+{
+    auto deadline = AlignDeadline(due_, slack_);
+    ::uv_timer_start(handle_, Timer::process, deadline > now ? deadline - now : 0, 0);
+}
+
+void Timer::close(TimerCloseComplete callback)
+{
+    closeComplete_ = callback;
+    if (uv_is_active((uv_handle_t*)handle_))
+    {
+        uv_timer_stop(handle_);
+    }
+    if (uv_is_closing((uv_handle_t*)handle_) == 0)
+    {
+        ::uv_close((uv_handle_t*)handle_,
+            [](uv_handle_t* handle)
+        {
+            auto ptr = static_cast<Timer*>(handle->data);
+            GetTimerMetrics().timers->sub();
+            ptr->closeComplete();
+            delete (uv_timer_t*)handle;
+        });
+    }
+    else
+    {
+        closeComplete();
+    }
+}
+
+
+void Timer::setTimerRepeat(uint64_t ms)
+{
+    repeat_ = ms;
+    if (slack_ <= 1)
+    {
+        ::uv_timer_set_repeat(handle_, ms);
+    }
+}
+
+void Timer::setSlack(uint64_t ms)
+{
+    slack_ = ms;
+}
+
+uint64_t Timer::getSlack()
+{
+    return slack_;
+}
+
+uint64_t Timer::AlignDeadline(uint64_t deadline, uint64_t slack)
+{
+    if (slack <= 1)
+    {
+        return deadline;
+    }
+    return (deadline + slack - 1) / slack * slack;
+}
+
+
+void Timer::onTimeOut()
+{
+    GetTimerMetrics().callbacks->inc();
+    LoopStats::TimerFired(loop_, AlignDeadline(due_, slack_));
+    if (slack_ > 1 && started_)
+    {
+        auto now = ::uv_now(handle_->loop);
+        auto& state = Coalesced;
+        if (state.loop != handle_->loop || state.now != now)
+        {
+            state.loop = handle_->loop;
+            state.now = now;
+            state.dues.clear();
+        }
+        if (std::find(state.dues.begin(), state.dues.end(), due_) == state.dues.end())
+        {
+            if (!state.dues.empty())
+            {
+                GetTimerMetrics().wakeupsSaved->inc();
+            }
+            state.dues.push_back(due_);
+        }
+        //先启动下一周期，回调中close时一并停止。
+        if (repeat_ > 0)
+        {
+            due_ += repeat_;
+            if (due_ <= now)
+            {
+                due_ = now + repeat_;
+            }
+            startAligned(now);
+        }
+    }
+    else if (repeat_ > 0)
+    {
+        //libuv按本次触发时的loop时间加repeat重新计时。
+        due_ = ::uv_now(handle_->loop) + repeat_;
+    }
+    if (callback_)
+    {
+        callback_(this);
+    }
+}
+
+void Timer::closeComplete()
+{
+    if (closeComplete_)
+        closeComplete_(this);
+}
+
+void Timer::process(uv_timer_t * handle)
+{
+    auto ptr = static_cast<Timer*>(handle->data);
+    ptr->onTimeOut();
+}
+
+
@@ -0,0 +1,376 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "include/TimerService.hpp"
+#include "include/Timer.hpp"
+#include "include/Metrics.hpp"
+
+#include <algorithm>
+
+using namespace uv;
+
+static Metrics::Counter* GetWakeupsSaved()
+{
+    static auto counter = Metrics::Instance()->counter("uvcpp_timer_wakeups_saved_total",
+        "Timer deadlines merged into an earlier loop wakeup by slack alignment.");
+    return counter;
+}
+
+static inline void ListInit(TimerService::ListHead* head)
+{
+    head->prev = head;
+    head->next = head;
+}
+
+static inline bool ListEmpty(TimerService::ListHead* head)
+{
+    return head->next == head;
+}
+
+static inline void ListAddTail(TimerService::ListHead* node, TimerService::ListHead* head)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static inline void ListDel(TimerService::ListHead* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+}
+
+//把from整条链表移到to(to原为空)，from置空。
+static inline void ListReplace(TimerService::ListHead* from, TimerService::ListHead* to)
+{
+    if (ListEmpty(from))
+    {
+        ListInit(to);
+        return;
+    }
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    ListInit(from);
+}
+
+TimerService::TimerService(EventLoop* loop)
+    :loop_(loop),
+    handle_(new uv_timer_t),
+    current_(::uv_now(loop->handle())),
+    armed_(0),
+    slack_(0),
+    size_(0)
+{
+    for (auto& head : root_)
+    {
+        ListInit(&head);
+    }
+    for (auto& level : levels_)
+    {
+        for (auto& head : level)
+        {
+            ListInit(&head);
+        }
+    }
+    ::uv_timer_init(loop->handle(), handle_);
+    handle_->data = static_cast<void*>(this);
+}
+
+TimerService::~TimerService()
+{
+    if (nullptr != handle_)
+    {
+        ::uv_timer_stop(handle_);
+        ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
+        {
+            delete (uv_timer_t*)handle;
+        });
+    }
+}
+
+void TimerService::close(DefaultCallback callback)
+{
+    if (nullptr == handle_)
+    {
+        return;
+    }
+    onClosed_ = callback;
+    ::uv_timer_stop(handle_);
+    ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
+    {
+        auto service = static_cast<TimerService*>(handle->data);
+        delete (uv_timer_t*)handle;
+        if (service->onClosed_)
+        {
+            service->onClosed_();
+        }
+    });
+    handle_ = nullptr;
+}
+
+bool TimerService::isClosed()
+{
+    return nullptr == handle_;
+}
+
+TimerService::Handle TimerService::schedule(uint64_t timeout, TimerCallback callback, uint64_t repeat)
+{
+    auto now = ::uv_now(loop_->handle());
+    if (0 == size_)
+    {
+        //空闲期间不推进tick，有定时器时从当前时间继续。
+        current_ = now;
+    }
+    auto element = fetch();
+    element->due = now + timeout;
+    element->expires = Timer::AlignDeadline(element->due, slack_);
+    element->repeat = repeat;
+    element->state = Element::Pending;
+    element->callback = std::move(callback);
+    add(element);
+    size_++;
+    if (nullptr != handle_ && (!::uv_is_active((uv_handle_t*)handle_) || element->expires < armed_))
+    {
+        rearm();
+    }
+    Handle handle;
+    handle.element = element;
+    handle.generation = element->generation;
+    return handle;
+}
+
+bool TimerService::cancel(Handle& handle)
+{
+    auto element = handle.element;
+    handle.element = nullptr;
+    if (nullptr == element || element->generation != handle.generation)
+    {
+        return false;
+    }
+    if (element->state == Element::Pending)
+    {
+        ListDel(element);
+        size_--;
+        release(element);
+        return true;
+    }
+    if (element->state == Element::Running)
+    {
+        //回调中取消自身，回调返回后回收。
+        element->state = Element::Cancelled;
+        return element->repeat != 0;
+    }
+    return false;
+}
+
+bool TimerService::isPending(const Handle& handle)
+{
+    auto element = handle.element;
+    if (nullptr == element || element->generation != handle.generation)
+    {
+        return false;
+    }
+    return element->state == Element::Pending || (element->state == Element::Running && element->repeat != 0);
+}
+
+size_t TimerService::size()
+{
+    return size_;
+}
+
+void TimerService::setSlack(uint64_t ms)
+{
+    slack_ = ms;
+}
+
+uint64_t TimerService::getSlack()
+{
+    return slack_;
+}
+
+TimerService::Element* TimerService::fetch()
+{
+    if (free_.empty())
+    {
+        std::unique_ptr<Element[]> chunk(new Element[PoolChunk]);
+        for (int i = PoolChunk - 1; i >= 0; i--)
+        {
+            chunk[i].generation = 0;
+            chunk[i].state = Element::Free;
+            free_.push_back(&chunk[i]);
+        }
+        chunks_.push_back(std::move(chunk));
+    }
+    auto element = free_.back();
+    free_.pop_back();
+    return element;
+}
+
+void TimerService::release(Element* element)
+{
+    element->state = Element::Free;
+    element->callback = nullptr;
+    element->generation++;
+    free_.push_back(element);
+}
+
+void TimerService::add(Element* element)
+{
+    auto expires = element->expires;
+    auto ticks = expires - current_;
+    ListHead* head;
+    if ((int64_t)ticks < 0)
+    {
+        //已过期的放入下一个处理的格。
+        head = &root_[current_ & (RootSize - 1)];
+    }
+    else if (ticks < RootSize)
+    {
+        head = &root_[expires & (RootSize - 1)];
+    }
+    else
+    {
+        if (ticks > 0xffffffffull)
+        {
+            //超过约49天的按上限处理，到期后重新计算。
+            expires = current_ + 0xffffffffull;
+        }
+        int level = 0;
+        while (level < Levels - 1 && ticks >= (1ull << (RootBits + (level + 1) * LevelBits)))
+        {
+            level++;
+        }
+        head = &levels_[level][(expires >> (RootBits + level * LevelBits)) & (LevelSize - 1)];
+    }
+    ListAddTail(element, head);
+}
+
+void TimerService::cascade(int level)
+{
+    int index = (current_ >> (RootBits + level * LevelBits)) & (LevelSize - 1);
+    ListHead list;
+    ListReplace(&levels_[level][index], &list);
+    while (!ListEmpty(&list))
+    {
+        auto element = static_cast<Element*>(list.next);
+        ListDel(element);
+        add(element);
+    }
+    //本层也回到0格时继续从上一层下移。
+    if (0 == index && level + 1 < Levels)
+    {
+        cascade(level + 1);
+    }
+}
+
+void TimerService::run()
+{
+    auto now = ::uv_now(loop_->handle());
+    uint64_t saved = 0;
+    while (current_ <= now && size_ > 0)
+    {
+        int index = current_ & (RootSize - 1);
+        if (0 == index)
+        {
+            cascade(0);
+        }
+        ListHead list;
+        ListReplace(&root_[index], &list);
+        //先推进tick，回调中新加入的已到期定时器落在下一格。
+        current_++;
+        dues_.clear();
+        while (!ListEmpty(&list))
+        {
+            auto element = static_cast<Element*>(list.next);
+            ListDel(element);
+            size_--;
+            //同一格中每多一个不同的原到期时间，就省去了一次唤醒。
+            if (slack_ > 1 && std::find(dues_.begin(), dues_.end(), element->due) == dues_.end())
+            {
+                if (!dues_.empty())
+                {
+                    saved++;
+                }
+                dues_.push_back(element->due);
+            }
+            element->state = Element::Running;
+            element->callback();
+            if (element->state == Element::Running && element->repeat > 0)
+            {
+                element->due += element->repeat;
+                if (element->due <= now)
+                {
+                    //loop阻塞时不补发错过的周期。
+                    element->due = now + element->repeat;
+                }
+                element->expires = Timer::AlignDeadline(element->due, slack_);
+                element->state = Element::Pending;
+                add(element);
+                size_++;
+            }
+            else
+            {
+                release(element);
+            }
+        }
+    }
+    if (0 == size_)
+    {
+        current_ = now + 1;
+    }
+    if (saved > 0)
+    {
+        GetWakeupsSaved()->inc(saved);
+    }
+}
+
+uint64_t TimerService::nextExpiry()
+{
+    //根层只覆盖到下一个256格边界，之后的定时器需在边界处从上层下移，届时再计算。
+    //current_恰在边界上时需先在此处下移。
+    uint64_t boundary = (current_ + RootSize - 1) & ~(uint64_t)(RootSize - 1);
+    for (auto tick = current_; tick < boundary; tick++)
+    {
+        if (!ListEmpty(&root_[tick & (RootSize - 1)]))
+        {
+            return tick;
+        }
+    }
+    return boundary;
+}
+
+void TimerService::rearm()
+{
+    if (nullptr == handle_)
+    {
+        return;
+    }
+    if (0 == size_)
+    {
+        ::uv_timer_stop(handle_);
+        return;
+    }
+    auto now = ::uv_now(loop_->handle());
+    armed_ = nextExpiry();
+    ::uv_timer_start(handle_, &TimerService::OnTimeout, armed_ > now ? armed_ - now : 0, 0);
+}
+
+void TimerService::OnTimeout(uv_timer_t* handle)
+{
+    auto service = static_cast<TimerService*>(handle->data);
+    LoopStats::TimerFired(service->loop_, service->armed_);
+    service->run();
+    service->rearm();
+}
@@ -1,127 +1,158 @@
-﻿/*
-Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
-
-Author: orcaer@yeah.net
-
-Last modified: 2019-10-20
-
-Description: https://github.com/wlgq2/uv-cpp
-*/
-#include "include/Udp.hpp"
-#include "include/LogWriter.hpp"
-
-using namespace uv;
-
-Udp::Udp(EventLoop* loop)
-    :handle_(new uv_udp_t()),
-    onMessageCallback_(nullptr)
-{
-    ::uv_udp_init(loop->handle(),handle_);
-    handle_->data = this;
-}
-
-Udp::~Udp()
-{
-    delete handle_;
-}
-
-int Udp::bindAndRead(SocketAddr& addr)
-{
-    ipv_ = addr.Ipv();
-    auto rst = uv_udp_bind(handle_, addr.Addr(), 0);
-    if (0 != rst)
-    {
-        return rst;
-    }
-    return ::uv_udp_recv_start(handle_,
-        [](uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
-    {
-        buf->base = new char[suggested_size];
-#if _MSC_VER
-        buf->len = (ULONG)suggested_size;
-#else
-        buf->len = suggested_size;
-#endif
-    },
-        &Udp::onMesageReceive);
-}
-
-int Udp::send(SocketAddr& to, const char* buf, unsigned size)
-{
-    uv_udp_send_t* sendHandle = new uv_udp_send_t();
-    const uv_buf_t uvbuf = uv_buf_init(const_cast<char*>(buf), size);
-    return ::uv_udp_send(sendHandle, handle_, &uvbuf, 1, to.Addr(),
-        [](uv_udp_send_t* handle, int status)
-    {
-        if (status) 
-        {
-            std::string info("udp send error :");
-            info += EventLoop::GetErrorMessage(status);
-            uv::LogWriter::Instance()->error(info);
-        }
-        delete handle;
-    });
-}
-
-void Udp::close(DefaultCallback callback)
-{
-    onClose_ = callback;
-    if (uv_is_active((uv_handle_t*)handle_))
-    {
-        uv_udp_recv_stop(handle_);
-    }
-    if (uv_is_closing((uv_handle_t*)handle_) == 0)
-    {
-        ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
-        {
-            Udp* ptr = static_cast<Udp*>(handle->data);
-            ptr->onCloseCompleted();
-        });
-    }
-    else
-    {
-        onCloseCompleted();
-    }
-
-}
-
-void Udp::onCloseCompleted()
-{
-    if (onClose_)
-    {
-        onClose_();
-    }
-}
-
-void Udp::onMessage(const sockaddr* from, const char* data, unsigned size)
-{
-    if (nullptr != onMessageCallback_)
-    {
-        SocketAddr addr(from, ipv_);
-        onMessageCallback_(addr, data, size);
-    }
-}
-
-void Udp::setMessageCallback(OnUdpMessageCallback callback)
-{
-    onMessageCallback_ = callback;
-}
-
-void Udp::onMesageReceive(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const sockaddr* addr, unsigned flags)
-{
-    if (nread < 0) 
-    {
-        std::string info("udp read error :");
-        info += EventLoop::GetErrorMessage((int)nread);
-        uv::LogWriter::Instance()->error(info);
-    }
-    else if(nread >0)
-    {
-        Udp* obj = static_cast<Udp*>(handle->data);
-        obj->onMessage(addr, buf->base, (unsigned)nread);
-    }
-    else;
-
-    delete[](buf->base);
-}
-
+﻿/*
+Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+Author: orcaer@yeah.net
+
+Last modified: 2019-10-20
+
+Description: https://github.com/wlgq2/uv-cpp
+*/
+#include "include/Udp.hpp"
+#include "include/LogWriter.hpp"
+#include "include/Metrics.hpp"
+
+using namespace uv;
+
+struct UdpMetrics
+{
+    UdpMetrics()
+    {
+        auto metrics = Metrics::Instance();
+        receivedDatagrams = metrics->counter("uvcpp_udp_received_datagrams_total", "Udp datagrams received.");
+        receivedBytes = metrics->counter("uvcpp_udp_received_bytes_total", "Udp bytes received.");
+        sentDatagrams = metrics->counter("uvcpp_udp_sent_datagrams_total", "Udp datagrams sent.");
+        sentBytes = metrics->counter("uvcpp_udp_sent_bytes_total", "Udp bytes sent.");
+        errors = metrics->counter("uvcpp_udp_errors_total", "Udp send and receive errors.");
+    }
+    Metrics::Counter* receivedDatagrams;
+    Metrics::Counter* receivedBytes;
+    Metrics::Counter* sentDatagrams;
+    Metrics::Counter* sentBytes;
+    Metrics::Counter* errors;
+};
+
+static UdpMetrics& GetUdpMetrics()
+{
+    static UdpMetrics metrics;
+    return metrics;
+}
+
+Udp::Udp(EventLoop* loop)
+    :handle_(new uv_udp_t()),
+    onMessageCallback_(nullptr)
+{
+    ::uv_udp_init(loop->handle(),handle_);
+    handle_->data = this;
+}
+
+Udp::~Udp()
+{
+    delete handle_;
+}
+
+int Udp::bindAndRead(SocketAddr& addr)
+{
+    ipv_ = addr.Ipv();
+    auto rst = uv_udp_bind(handle_, addr.Addr(), 0);
+    if (0 != rst)
+    {
+        return rst;
+    }
+    return ::uv_udp_recv_start(handle_,
+        [](uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
+    {
+        buf->base = new char[suggested_size];
+#if _MSC_VER
+        buf->len = (ULONG)suggested_size;
+#else
+        buf->len = suggested_size;
+#endif
+    },
+        &Udp::onMesageReceive);
+}
+
+int Udp::send(SocketAddr& to, const char* buf, unsigned size)
+{
+    uv_udp_send_t* sendHandle = new uv_udp_send_t();
+    const uv_buf_t uvbuf = uv_buf_init(const_cast<char*>(buf), size);
+    GetUdpMetrics().sentDatagrams->inc();
+    GetUdpMetrics().sentBytes->inc(size);
+    return ::uv_udp_send(sendHandle, handle_, &uvbuf, 1, to.Addr(),
+        [](uv_udp_send_t* handle, int status)
+    {
+        if (status) 
+        {
+            GetUdpMetrics().errors->inc();
+            std::string info("udp send error :");
+            info += EventLoop::GetErrorMessage(status);
+            uv::LogWriter::Instance()->error(info);
+        }
+        delete handle;
+    });
+}
+
+void Udp::close(DefaultCallback callback)
+{
+    onClose_ = callback;
+    if (uv_is_active((uv_handle_t*)handle_))
+    {
+        uv_udp_recv_stop(handle_);
+    }
+    if (uv_is_closing((uv_handle_t*)handle_) == 0)
+    {
+        ::uv_close((uv_handle_t*)handle_, [](uv_handle_t* handle)
+        {
+            Udp* ptr = static_cast<Udp*>(handle->data);
+            ptr->onCloseCompleted();
+        });
+    }
+    else
+    {
+        onCloseCompleted();
+    }
+
+}
+
+void Udp::onCloseCompleted()
+{
+    if (onClose_)
+    {
+        onClose_();
+    }
+}
+
+void Udp::onMessage(const sockaddr* from, const char* data, unsigned size)
+{
+    if (nullptr != onMessageCallback_)
+    {
+        SocketAddr addr(from, ipv_);
+        onMessageCallback_(addr, data, size);
+    }
+}
+
+void Udp::setMessageCallback(OnUdpMessageCallback callback)
+{
+    onMessageCallback_ = callback;
+}
+
+void Udp::onMesageReceive(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const sockaddr* addr, unsigned flags)
+{
+    if (nread < 0) 
+    {
+        GetUdpMetrics().errors->inc();
+        std::string info("udp read error :");
+        info += EventLoop::GetErrorMessage((int)nread);
+        uv::LogWriter::Instance()->error(info);
+    }
+    else if(nread >0)
+    {
+        GetUdpMetrics().receivedDatagrams->inc();
+        GetUdpMetrics().receivedBytes->inc(nread);
+        Udp* obj = static_cast<Udp*>(handle->data);
+        obj->onMessage(addr, buf->base, (unsigned)nread);
+    }
+    else;
+
+    delete[](buf->base);
+}
+
@@ -0,0 +1,332 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <algorithm>
+#ifdef UV_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "../include/http/Compression.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+int Compression::DefaultLevel = 6;
+
+namespace
+{
+
+std::string ToLower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(),
+        [](unsigned char ch) { return (char)::tolower(ch); });
+    return str;
+}
+
+std::string Trim(const std::string& str, size_t begin, size_t end)
+{
+    while (begin < end && (str[begin] == ' ' || str[begin] == '\t'))
+    {
+        begin++;
+    }
+    while (end > begin && (str[end - 1] == ' ' || str[end - 1] == '\t'))
+    {
+        end--;
+    }
+    return str.substr(begin, end - begin);
+}
+
+std::string GetResponseHead(Response& resp, const char* key, const char* lowerKey)
+{
+    std::string name(key);
+    auto value = resp.getHead(name);
+    if (value.empty())
+    {
+        name = lowerKey;
+        value = resp.getHead(name);
+    }
+    return value;
+}
+
+//解析"gzip;q=0.8"形式的q值，缺省为1。
+double ParseQuality(const std::string& params)
+{
+    auto pos = ToLower(params).find("q=");
+    if (pos == params.npos)
+    {
+        return 1.0;
+    }
+    try
+    {
+        return std::stod(params.substr(pos + 2));
+    }
+    catch (...)
+    {
+        return 0.0;
+    }
+}
+
+//取gzip及deflate的q值，未列出的编码取"*"的权重，均未列出为0。
+void ParseAcceptEncoding(Request& req, double& gzip, double& deflate)
+{
+    auto value = req.getHead("Accept-Encoding");
+    if (value.empty())
+    {
+        value = req.getHead("accept-encoding");
+    }
+    gzip = -1.0;
+    deflate = -1.0;
+    double any = 0.0;
+    size_t begin = 0;
+    while (begin < value.size())
+    {
+        auto end = value.find(',', begin);
+        if (end == value.npos)
+        {
+            end = value.size();
+        }
+        auto item = Trim(value, begin, end);
+        begin = end + 1;
+        auto semicolon = item.find(';');
+        auto name = ToLower(Trim(item, 0, semicolon == item.npos ? item.size() : semicolon));
+        double q = semicolon == item.npos ? 1.0 : ParseQuality(item.substr(semicolon + 1));
+        if (name == "gzip" || name == "x-gzip")
+        {
+            gzip = q;
+        }
+        else if (name == "deflate")
+        {
+            deflate = q;
+        }
+        else if (name == "*")
+        {
+            any = q;
+        }
+    }
+    if (gzip < 0)
+    {
+        gzip = any;
+    }
+    if (deflate < 0)
+    {
+        deflate = any;
+    }
+}
+
+}
+
+#ifdef UV_HAVE_ZLIB
+struct Compression::Stream
+{
+    ~Stream()
+    {
+        ::deflateEnd(&zs);
+    }
+    z_stream zs;
+};
+#else
+struct Compression::Stream
+{
+};
+#endif
+
+Compression::Compression(Encoding encoding, int level)
+    :encoding_(encoding),
+    stream_(nullptr)
+{
+#ifdef UV_HAVE_ZLIB
+    if (Identity == encoding_)
+    {
+        return;
+    }
+    stream_.reset(new Stream());
+    //windowBits 15+16为gzip格式，15为zlib格式(Http的deflate)。
+    int bits = Gzip == encoding_ ? 15 + 16 : 15;
+    if (Z_OK != ::deflateInit2(&stream_->zs, level, Z_DEFLATED, bits, 8, Z_DEFAULT_STRATEGY))
+    {
+        stream_.reset();
+        encoding_ = Identity;
+    }
+#else
+    encoding_ = Identity;
+#endif
+}
+
+Compression::~Compression()
+{
+}
+
+int Compression::update(const char* data, uint64_t size, std::string& out, bool finish)
+{
+    if (Identity == encoding_)
+    {
+        out.append(data, size);
+        return 0;
+    }
+#ifdef UV_HAVE_ZLIB
+    if (nullptr == stream_)
+    {
+        return -1;
+    }
+    auto& zs = stream_->zs;
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = (uInt)size;
+    int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+    auto begin = out.size();
+    auto written = begin;
+    out.resize(begin + ::deflateBound(&zs, (uLong)size) + 16);
+    while (true)
+    {
+        zs.next_out = reinterpret_cast<Bytef*>(&out[written]);
+        zs.avail_out = (uInt)(out.size() - written);
+        int rst = ::deflate(&zs, flush);
+        if (Z_STREAM_ERROR == rst)
+        {
+            out.resize(begin);
+            return -1;
+        }
+        written = out.size() - zs.avail_out;
+        if (0 != zs.avail_out || Z_STREAM_END == rst)
+        {
+            break;
+        }
+        //输出空间不足，扩容后继续。
+        out.resize(out.size() * 2);
+    }
+    out.resize(written);
+    if (finish)
+    {
+        stream_.reset();
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+Compression::Encoding Compression::getEncoding()
+{
+    return encoding_;
+}
+
+bool Compression::IsSupported()
+{
+#ifdef UV_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+Compression::Encoding Compression::Negotiate(Request& req)
+{
+    if (!IsSupported())
+    {
+        return Identity;
+    }
+    double gzip = 0.0;
+    double deflate = 0.0;
+    ParseAcceptEncoding(req, gzip, deflate);
+    if (gzip > 0 && gzip >= deflate)
+    {
+        return Gzip;
+    }
+    if (deflate > 0)
+    {
+        return Deflate;
+    }
+    return Identity;
+}
+
+bool Compression::IsAccepted(Request& req, Encoding encoding)
+{
+    if (Identity == encoding)
+    {
+        return true;
+    }
+    double gzip = 0.0;
+    double deflate = 0.0;
+    ParseAcceptEncoding(req, gzip, deflate);
+    return (Gzip == encoding ? gzip : deflate) > 0;
+}
+
+const char* Compression::EncodingName(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Gzip:
+        return "gzip";
+    case Deflate:
+        return "deflate";
+    default:
+        return "identity";
+    }
+}
+
+bool Compression::IsCompressibleType(const std::string& contentType)
+{
+    if (contentType.empty())
+    {
+        return true;
+    }
+    auto type = ToLower(contentType);
+    auto semicolon = type.find(';');
+    if (semicolon != type.npos)
+    {
+        type = Trim(type, 0, semicolon);
+    }
+    if (type.compare(0, 5, "text/") == 0)
+    {
+        return true;
+    }
+    static const char* types[] =
+    {
+        "application/json",
+        "application/javascript",
+        "application/xml",
+        "application/wasm",
+        "image/svg+xml",
+        "image/x-icon",
+    };
+    for (auto name : types)
+    {
+        if (type == name)
+        {
+            return true;
+        }
+    }
+    auto plus = type.rfind('+');
+    return plus != type.npos && (type.compare(plus, 5, "+json") == 0 || type.compare(plus, 4, "+xml") == 0);
+}
+
+bool Compression::IsCompressible(Response& resp)
+{
+    auto code = resp.getStatusCode();
+    if (code < 200 || code == Response::StatusCode::NoContent || code == Response::StatusCode::NotModified
+        || code == Response::StatusCode::PartialContent)
+    {
+        return false;
+    }
+    if (!GetResponseHead(resp, "Content-Encoding", "content-encoding").empty())
+    {
+        return false;
+    }
+    return IsCompressibleType(GetResponseHead(resp, "Content-Type", "content-type"));
+}
+
+int Compression::Compress(Encoding encoding, const char* data, uint64_t size, std::string& out, int level)
+{
+    Compression compression(encoding, level);
+    if (compression.getEncoding() != encoding)
+    {
+        return -1;
+    }
+    return compression.update(data, size, out, true);
+}
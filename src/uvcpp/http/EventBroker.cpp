@@ -0,0 +1,95 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <algorithm>
+
+#include "../include/http/EventBroker.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+EventBroker::EventBroker()
+{
+}
+
+void EventBroker::subscribe(const std::string& channel, EventStreamPtr stream)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    channels_[channel].push_back(stream);
+}
+
+void EventBroker::unsubscribe(const std::string& channel, EventStreamPtr stream)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = channels_.find(channel);
+    if (it == channels_.end())
+    {
+        return;
+    }
+    auto& streams = it->second;
+    streams.erase(std::remove(streams.begin(), streams.end(), stream), streams.end());
+    if (streams.empty())
+    {
+        channels_.erase(it);
+    }
+}
+
+size_t EventBroker::Subscribers(const std::string& channel)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = channels_.find(channel);
+    return it == channels_.end() ? 0 : it->second.size();
+}
+
+size_t EventBroker::publish(const std::string& channel, std::shared_ptr<std::string> event)
+{
+    //按loop分组，每个loop只投递一次。
+    std::map<EventLoop*, std::vector<EventStreamPtr>> loops;
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = channels_.find(channel);
+        if (it == channels_.end())
+        {
+            return 0;
+        }
+        auto& subscribers = it->second;
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+            [](EventStreamPtr& stream) { return stream->isClosed(); }), subscribers.end());
+        if (subscribers.empty())
+        {
+            channels_.erase(it);
+            return 0;
+        }
+        for (auto& stream : subscribers)
+        {
+            loops[stream->getLoop()].push_back(stream);
+        }
+        size = subscribers.size();
+    }
+    for (auto& it : loops)
+    {
+        auto streams = std::make_shared<std::vector<EventStreamPtr>>(std::move(it.second));
+        it.first->runInThisLoop([streams, event]()
+        {
+            for (auto& stream : *streams)
+            {
+                stream->sendInLoop(event);
+            }
+        });
+    }
+    return size;
+}
+
+size_t EventBroker::publish(const std::string& channel, const std::string& event, const std::string& data,
+    const std::string& id)
+{
+    return publish(channel, EventStream::Encode(event, data, id));
+}
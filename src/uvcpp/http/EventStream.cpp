@@ -0,0 +1,178 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/EventStream.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+uint64_t EventStream::DefaultHighWaterMark = 64 * 1024;
+
+EventStream::EventStream(ResponseStreamPtr stream)
+    :stream_(stream),
+    policy_(Policy::Coalesce),
+    dropped_(0),
+    coalesced_(nullptr)
+{
+    stream_->setHighWaterMark(DefaultHighWaterMark);
+}
+
+EventStream::~EventStream()
+{
+}
+
+void EventStream::open()
+{
+    Response head;
+    head.setStatus(Response::StatusCode::OK, "OK");
+    head.appendHead("Content-Type", "text/event-stream");
+    head.appendHead("Cache-Control", "no-cache");
+    std::weak_ptr<EventStream> weak = shared_from_this();
+    stream_->setDrainCallback([weak]()
+    {
+        auto self = weak.lock();
+        if (nullptr != self)
+        {
+            self->onDrain();
+        }
+    });
+    stream_->writeHead(head);
+}
+
+void EventStream::send(std::shared_ptr<std::string> event)
+{
+    auto self = shared_from_this();
+    stream_->getLoop()->runInThisLoop([self, event]()
+    {
+        self->sendInLoop(event);
+    });
+}
+
+void EventStream::send(const std::string& event, const std::string& data, const std::string& id)
+{
+    send(Encode(event, data, id));
+}
+
+void EventStream::close()
+{
+    stream_->end();
+}
+
+bool EventStream::isClosed()
+{
+    return stream_->isClosed() || stream_->isEnded();
+}
+
+EventLoop* EventStream::getLoop()
+{
+    return stream_->getLoop();
+}
+
+uint64_t EventStream::DroppedEvents()
+{
+    return dropped_;
+}
+
+void EventStream::setPolicy(Policy policy)
+{
+    policy_ = policy;
+}
+
+void EventStream::setHighWaterMark(uint64_t size)
+{
+    stream_->setHighWaterMark(size);
+}
+
+std::shared_ptr<std::string> EventStream::Encode(const std::string& event, const std::string& data,
+    const std::string& id, uint64_t retry)
+{
+    auto out = std::make_shared<std::string>();
+    out->reserve(data.size() + event.size() + id.size() + 32);
+    if (!event.empty())
+    {
+        *out += "event: ";
+        *out += event;
+        *out += '\n';
+    }
+    if (!id.empty())
+    {
+        *out += "id: ";
+        *out += id;
+        *out += '\n';
+    }
+    if (retry > 0)
+    {
+        *out += "retry: ";
+        *out += std::to_string(retry);
+        *out += '\n';
+    }
+    size_t begin = 0;
+    while (true)
+    {
+        auto end = data.find('\n', begin);
+        *out += "data: ";
+        if (end == data.npos)
+        {
+            out->append(data, begin, data.npos);
+            *out += '\n';
+            break;
+        }
+        out->append(data, begin, end - begin);
+        *out += '\n';
+        begin = end + 1;
+    }
+    *out += '\n';
+    return out;
+}
+
+std::shared_ptr<std::string> EventStream::EncodeComment(const std::string& comment)
+{
+    return std::make_shared<std::string>(": " + comment + "\n\n");
+}
+
+void EventStream::sendInLoop(std::shared_ptr<std::string> event)
+{
+    if (isClosed())
+    {
+        coalesced_ = nullptr;
+        return;
+    }
+    if (nullptr == coalesced_ && stream_->isWritable())
+    {
+        stream_->writeChunk(event);
+        return;
+    }
+    if (policy_ == Policy::Coalesce)
+    {
+        //以最新事件替换尚未写出的事件。
+        if (nullptr != coalesced_)
+        {
+            dropped_++;
+        }
+        coalesced_ = event;
+        return;
+    }
+    dropped_++;
+}
+
+void EventStream::onDrain()
+{
+    if (isClosed())
+    {
+        coalesced_ = nullptr;
+        return;
+    }
+    if (nullptr != coalesced_ && stream_->isWritable())
+    {
+        auto event = coalesced_;
+        coalesced_ = nullptr;
+        stream_->writeChunk(event);
+    }
+}
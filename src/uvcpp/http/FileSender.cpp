@@ -0,0 +1,245 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "../include/http/FileSender.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+//回退读写时每段64Kb。
+uint64_t FileSender::PieceSize = 64 << 10;
+
+FileSender::FileSender(EventLoop* loop, uv_file file, int64_t offset, uint64_t length)
+    :loop_(loop),
+    file_(file),
+    socket_(-1),
+    sendfileMode_(false),
+    offset_(offset),
+    remain_(length),
+    callback_(nullptr),
+    writer_(nullptr)
+{
+    req_.data = static_cast<void*>(this);
+}
+
+FileSender::~FileSender()
+{
+    closeSocket();
+    if (file_ >= 0)
+    {
+        //未经start即释放，同步关闭。
+        uv_fs_t req;
+        ::uv_fs_close(loop_->handle(), &req, file_, nullptr);
+        ::uv_fs_req_cleanup(&req);
+    }
+}
+
+void FileSender::start(TcpConnectionPtr connection, OnCompleteCallback callback)
+{
+    connection_ = connection;
+    callback_ = callback;
+    self_ = shared_from_this();
+#ifndef _WIN32
+    //dup出的句柄不受连接关闭影响，避免线程池中sendfile写到被复用的fd。
+    uv_os_fd_t fd;
+    if (0 == connection->fileno(fd))
+    {
+        socket_ = ::dup(fd);
+        sendfileMode_ = socket_ >= 0;
+    }
+#endif
+    if (0 == remain_)
+    {
+        finish(0);
+    }
+    else if (sendfileMode_)
+    {
+        sendfile();
+    }
+    else
+    {
+        read();
+    }
+}
+
+void FileSender::start(OnPieceCallback writer, OnCompleteCallback callback)
+{
+    writer_ = writer;
+    callback_ = callback;
+    self_ = shared_from_this();
+    if (0 == remain_)
+    {
+        finish(0);
+    }
+    else
+    {
+        read();
+    }
+}
+
+void FileSender::sendfile()
+{
+    int rst = ::uv_fs_sendfile(loop_->handle(), &req_, socket_, file_, offset_, (size_t)remain_, OnFsCallback);
+    if (0 != rst)
+    {
+        finish(rst);
+    }
+}
+
+void FileSender::read()
+{
+    uint64_t size = remain_ < PieceSize ? remain_ : PieceSize;
+    buffer_.resize(size);
+    uv_buf_t buf = uv_buf_init(const_cast<char*>(buffer_.c_str()), (unsigned int)size);
+    int rst = ::uv_fs_read(loop_->handle(), &req_, file_, &buf, 1, offset_, OnFsCallback);
+    if (0 != rst)
+    {
+        finish(rst);
+    }
+}
+
+void FileSender::OnFsCallback(uv_fs_t* req)
+{
+    auto sender = static_cast<FileSender*>(req->data);
+    auto result = req->result;
+    auto type = req->fs_type;
+    ::uv_fs_req_cleanup(req);
+    if (UV_FS_SENDFILE == type)
+    {
+        sender->onSendfile(result);
+    }
+    else
+    {
+        sender->onRead(result);
+    }
+}
+
+void FileSender::onSendfile(ssize_t result)
+{
+    auto connection = connection_.lock();
+    if (nullptr == connection || !connection->isConnected())
+    {
+        finish(WriteInfo::Disconnected);
+        return;
+    }
+    if (UV_EAGAIN == result)
+    {
+        //发送缓冲已满，借助写队列等待可写。
+        read();
+        return;
+    }
+    if (result <= 0)
+    {
+        finish(0 == result ? (int)UV_EOF : (int)result);
+        return;
+    }
+    offset_ += result;
+    remain_ -= result;
+    if (0 == remain_)
+    {
+        finish(0);
+        return;
+    }
+    sendfile();
+}
+
+void FileSender::onRead(ssize_t result)
+{
+    if (result <= 0)
+    {
+        //文件被截断等，已声明的Content-Length无法满足。
+        finish(0 == result ? (int)UV_EOF : (int)result);
+        return;
+    }
+    uint64_t size = result;
+    if (nullptr != writer_)
+    {
+        writer_(buffer_.c_str(), size, [this, size](int status)
+        {
+            onWrite(size, status);
+        });
+        return;
+    }
+    auto connection = connection_.lock();
+    if (nullptr == connection)
+    {
+        finish(WriteInfo::Disconnected);
+        return;
+    }
+    connection->write(buffer_.c_str(), size, [this, size](WriteInfo& info)
+    {
+        onWrite(size, info.status);
+    });
+}
+
+void FileSender::onWrite(uint64_t size, int status)
+{
+    if (0 != status)
+    {
+        finish(status);
+        return;
+    }
+    offset_ += size;
+    remain_ -= size;
+    if (0 == remain_)
+    {
+        finish(0);
+    }
+    else if (sendfileMode_)
+    {
+        sendfile();
+    }
+    else
+    {
+        read();
+    }
+}
+
+void FileSender::finish(int status)
+{
+    closeSocket();
+    if (file_ >= 0)
+    {
+        auto req = new uv_fs_t;
+        if (0 != ::uv_fs_close(loop_->handle(), req, file_, [](uv_fs_t* req)
+        {
+            ::uv_fs_req_cleanup(req);
+            delete req;
+        }))
+        {
+            delete req;
+        }
+        file_ = -1;
+    }
+    auto self = self_;
+    self_ = nullptr;
+    auto callback = callback_;
+    callback_ = nullptr;
+    writer_ = nullptr;
+    if (callback)
+    {
+        callback(status);
+    }
+}
+
+void FileSender::closeSocket()
+{
+#ifndef _WIN32
+    if (socket_ >= 0)
+    {
+        ::close(socket_);
+        socket_ = -1;
+    }
+#endif
+}
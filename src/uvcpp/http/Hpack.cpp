@@ -0,0 +1,634 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <unordered_map>
+
+#include "../include/http/Hpack.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+namespace
+{
+
+const std::pair<const char*, const char*> StaticTable[HpackTable::StaticTableSize] =
+{
+    { ":authority", "" },
+    { ":method", "GET" },
+    { ":method", "POST" },
+    { ":path", "/" },
+    { ":path", "/index.html" },
+    { ":scheme", "http" },
+    { ":scheme", "https" },
+    { ":status", "200" },
+    { ":status", "204" },
+    { ":status", "206" },
+    { ":status", "304" },
+    { ":status", "400" },
+    { ":status", "404" },
+    { ":status", "500" },
+    { "accept-charset", "" },
+    { "accept-encoding", "gzip, deflate" },
+    { "accept-language", "" },
+    { "accept-ranges", "" },
+    { "accept", "" },
+    { "access-control-allow-origin", "" },
+    { "age", "" },
+    { "allow", "" },
+    { "authorization", "" },
+    { "cache-control", "" },
+    { "content-disposition", "" },
+    { "content-encoding", "" },
+    { "content-language", "" },
+    { "content-length", "" },
+    { "content-location", "" },
+    { "content-range", "" },
+    { "content-type", "" },
+    { "cookie", "" },
+    { "date", "" },
+    { "etag", "" },
+    { "expect", "" },
+    { "expires", "" },
+    { "from", "" },
+    { "host", "" },
+    { "if-match", "" },
+    { "if-modified-since", "" },
+    { "if-none-match", "" },
+    { "if-range", "" },
+    { "if-unmodified-since", "" },
+    { "last-modified", "" },
+    { "link", "" },
+    { "location", "" },
+    { "max-forwards", "" },
+    { "proxy-authenticate", "" },
+    { "proxy-authorization", "" },
+    { "range", "" },
+    { "referer", "" },
+    { "refresh", "" },
+    { "retry-after", "" },
+    { "server", "" },
+    { "set-cookie", "" },
+    { "strict-transport-security", "" },
+    { "transfer-encoding", "" },
+    { "user-agent", "" },
+    { "vary", "" },
+    { "via", "" },
+    { "www-authenticate", "" },
+};
+
+//静态表查找索引。
+struct StaticIndex
+{
+    StaticIndex()
+    {
+        for (uint64_t i = HpackTable::StaticTableSize; i > 0; i--)
+        {
+            auto& entry = StaticTable[i - 1];
+            names[entry.first] = i;
+            if (entry.second[0] != '\0')
+            {
+                fields[std::string(entry.first) + '\0' + entry.second] = i;
+            }
+        }
+    }
+    std::unordered_map<std::string, uint64_t> names;
+    std::unordered_map<std::string, uint64_t> fields;
+};
+
+const StaticIndex& GetStaticIndex()
+{
+    static StaticIndex index;
+    return index;
+}
+
+struct HuffmanCode
+{
+    uint32_t code;
+    uint8_t bits;
+};
+
+//RFC 7541 附录B，第256项为EOS。
+const HuffmanCode HuffmanTable[257] =
+{
+    { 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 },
+    { 0xfffffe4, 28 }, { 0xfffffe5, 28 }, { 0xfffffe6, 28 }, { 0xfffffe7, 28 },
+    { 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 },
+    { 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 },
+    { 0xfffffed, 28 }, { 0xfffffee, 28 }, { 0xfffffef, 28 }, { 0xffffff0, 28 },
+    { 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+    { 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 },
+    { 0xffffff8, 28 }, { 0xffffff9, 28 }, { 0xffffffa, 28 }, { 0xffffffb, 28 },
+    { 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 },
+    { 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 },
+    { 0x3fa, 10 }, { 0x3fb, 10 }, { 0xf9, 8 }, { 0x7fb, 11 },
+    { 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+    { 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 },
+    { 0x1a, 6 }, { 0x1b, 6 }, { 0x1c, 6 }, { 0x1d, 6 },
+    { 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 },
+    { 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 },
+    { 0x1ffa, 13 }, { 0x21, 6 }, { 0x5d, 7 }, { 0x5e, 7 },
+    { 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+    { 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 },
+    { 0x67, 7 }, { 0x68, 7 }, { 0x69, 7 }, { 0x6a, 7 },
+    { 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 },
+    { 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 },
+    { 0xfc, 8 }, { 0x73, 7 }, { 0xfd, 8 }, { 0x1ffb, 13 },
+    { 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+    { 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 },
+    { 0x24, 6 }, { 0x5, 5 }, { 0x25, 6 }, { 0x26, 6 },
+    { 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 },
+    { 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 },
+    { 0x2b, 6 }, { 0x76, 7 }, { 0x2c, 6 }, { 0x8, 5 },
+    { 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+    { 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 },
+    { 0x7fc, 11 }, { 0x3ffd, 14 }, { 0x1ffd, 13 }, { 0xffffffc, 28 },
+    { 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 },
+    { 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 },
+    { 0x3fffd6, 22 }, { 0x7fffda, 23 }, { 0x7fffdb, 23 }, { 0x7fffdc, 23 },
+    { 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+    { 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 },
+    { 0xffffee, 24 }, { 0x7fffe1, 23 }, { 0x7fffe2, 23 }, { 0x7fffe3, 23 },
+    { 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 },
+    { 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 },
+    { 0x3fffda, 22 }, { 0x1fffdd, 21 }, { 0xfffe9, 20 }, { 0x3fffdb, 22 },
+    { 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+    { 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 },
+    { 0x1fffdf, 21 }, { 0x3fffdf, 22 }, { 0x7fffeb, 23 }, { 0x7fffec, 23 },
+    { 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 },
+    { 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 },
+    { 0xfffea, 20 }, { 0x3fffe2, 22 }, { 0x3fffe3, 22 }, { 0x3fffe4, 22 },
+    { 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+    { 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 },
+    { 0x3fffe7, 22 }, { 0x7ffff2, 23 }, { 0x3fffe8, 22 }, { 0x1ffffec, 25 },
+    { 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 },
+    { 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 },
+    { 0x7fff2, 19 }, { 0x1fffe3, 21 }, { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 },
+    { 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+    { 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 },
+    { 0xffffffd, 28 }, { 0x7ffffe3, 27 }, { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 },
+    { 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 },
+    { 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 },
+    { 0x3fffea, 22 }, { 0x3fffeb, 22 }, { 0x1ffffee, 25 }, { 0x1ffffef, 25 },
+    { 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+    { 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 },
+    { 0x7ffffe7, 27 }, { 0x7ffffe8, 27 }, { 0x7ffffe9, 27 }, { 0x7ffffea, 27 },
+    { 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 },
+    { 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 },
+    { 0x3fffffff, 30 },
+};
+
+//规范Huffman码：同一码长的编码按符号顺序连续分配，按码长分组即可解码。
+struct HuffmanDecodeTable
+{
+    HuffmanDecodeTable()
+    {
+        uint16_t index = 0;
+        for (int bits = 0; bits <= MaxBits; bits++)
+        {
+            count[bits] = 0;
+            offset[bits] = index;
+            first[bits] = 0;
+            for (uint16_t sym = 0; sym < 257; sym++)
+            {
+                if (HuffmanTable[sym].bits == bits)
+                {
+                    if (0 == count[bits])
+                    {
+                        first[bits] = HuffmanTable[sym].code;
+                    }
+                    count[bits]++;
+                    symbols[index++] = sym;
+                }
+            }
+        }
+    }
+    static const int MaxBits = 30;
+    uint32_t first[MaxBits + 1];
+    uint16_t count[MaxBits + 1];
+    uint16_t offset[MaxBits + 1];
+    uint16_t symbols[257];
+};
+
+const HuffmanDecodeTable& GetHuffmanDecodeTable()
+{
+    static HuffmanDecodeTable table;
+    return table;
+}
+
+const uint16_t HuffmanEos = 256;
+
+//以下头部值变化频繁，不进入动态表。
+bool IsVolatileHeader(const std::string& name)
+{
+    return name == ":path" || name == "content-length" || name == "date" || name == "etag"
+        || name == "last-modified" || name == "content-range" || name == "age";
+}
+
+bool IsSensitiveHeader(const std::string& name)
+{
+    return name == "authorization" || name == "proxy-authorization" || name == "set-cookie" || name == "cookie";
+}
+
+}
+
+HpackTable::HpackTable(uint64_t maxSize)
+    :size_(0),
+    maxSize_(maxSize)
+{
+}
+
+bool HpackTable::get(uint64_t index, std::string& name, std::string& value)
+{
+    if (0 == index)
+    {
+        return false;
+    }
+    if (index <= StaticTableSize)
+    {
+        name = StaticTable[index - 1].first;
+        value = StaticTable[index - 1].second;
+        return true;
+    }
+    index -= StaticTableSize + 1;
+    if (index >= entries_.size())
+    {
+        return false;
+    }
+    name = entries_[index].first;
+    value = entries_[index].second;
+    return true;
+}
+
+void HpackTable::add(const std::string& name, const std::string& value)
+{
+    uint64_t size = name.size() + value.size() + EntryOverhead;
+    //超过表容量的条目使表清空，且不加入(RFC 7541 4.4)。
+    if (size > maxSize_)
+    {
+        evict(maxSize_);
+        return;
+    }
+    evict(size);
+    entries_.emplace_front(name, value);
+    size_ += size;
+}
+
+void HpackTable::setMaxSize(uint64_t size)
+{
+    maxSize_ = size;
+    evict(0);
+}
+
+uint64_t HpackTable::getMaxSize()
+{
+    return maxSize_;
+}
+
+uint64_t HpackTable::size()
+{
+    return size_;
+}
+
+uint64_t HpackTable::find(const std::string& name, const std::string& value, uint64_t& nameIndex)
+{
+    auto& index = GetStaticIndex();
+    nameIndex = 0;
+    auto it = index.names.find(name);
+    if (it != index.names.end())
+    {
+        nameIndex = it->second;
+        auto field = index.fields.find(name + '\0' + value);
+        if (field != index.fields.end())
+        {
+            return field->second;
+        }
+    }
+    for (uint64_t i = 0; i < entries_.size(); i++)
+    {
+        if (entries_[i].first == name)
+        {
+            if (entries_[i].second == value)
+            {
+                return StaticTableSize + 1 + i;
+            }
+            if (0 == nameIndex)
+            {
+                nameIndex = StaticTableSize + 1 + i;
+            }
+        }
+    }
+    return 0;
+}
+
+void HpackTable::evict(uint64_t size)
+{
+    while (!entries_.empty() && size_ + size > maxSize_)
+    {
+        auto& back = entries_.back();
+        size_ -= back.first.size() + back.second.size() + EntryOverhead;
+        entries_.pop_back();
+    }
+}
+
+HpackDecoder::HpackDecoder()
+    :maxTableSize_(HpackTable::DefaultTableSize)
+{
+}
+
+int HpackDecoder::decode(const char* data, uint64_t size, HpackHeaders& headers)
+{
+    auto pos = reinterpret_cast<const uint8_t*>(data);
+    auto end = pos + size;
+    bool started = false;
+    while (pos < end)
+    {
+        uint8_t byte = *pos;
+        uint64_t index = 0;
+        std::string name;
+        std::string value;
+        if (byte & 0x80)
+        {
+            //Indexed Header Field
+            if (0 != Hpack::DecodeInteger(pos, end, 7, index) || !table_.get(index, name, value))
+            {
+                return -1;
+            }
+            headers.emplace_back(std::move(name), std::move(value));
+            started = true;
+            continue;
+        }
+        if ((byte & 0xe0) == 0x20)
+        {
+            //Dynamic Table Size Update，只能出现在header block开头。
+            if (started || 0 != Hpack::DecodeInteger(pos, end, 5, index) || index > maxTableSize_)
+            {
+                return -1;
+            }
+            table_.setMaxSize(index);
+            continue;
+        }
+        bool indexing = (byte & 0xc0) == 0x40;
+        if (0 != Hpack::DecodeInteger(pos, end, indexing ? 6 : 4, index))
+        {
+            return -1;
+        }
+        if (0 == index)
+        {
+            if (0 != decodeString(pos, end, name))
+            {
+                return -1;
+            }
+        }
+        else if (!table_.get(index, name, value))
+        {
+            return -1;
+        }
+        if (0 != decodeString(pos, end, value))
+        {
+            return -1;
+        }
+        if (indexing)
+        {
+            table_.add(name, value);
+        }
+        headers.emplace_back(std::move(name), std::move(value));
+        started = true;
+    }
+    return 0;
+}
+
+void HpackDecoder::setMaxTableSize(uint64_t size)
+{
+    maxTableSize_ = size;
+    if (table_.getMaxSize() > size)
+    {
+        table_.setMaxSize(size);
+    }
+}
+
+int HpackDecoder::decodeString(const uint8_t*& pos, const uint8_t* end, std::string& out)
+{
+    if (pos >= end)
+    {
+        return -1;
+    }
+    bool huffman = (*pos & 0x80) != 0;
+    uint64_t length = 0;
+    if (0 != Hpack::DecodeInteger(pos, end, 7, length) || length > (uint64_t)(end - pos))
+    {
+        return -1;
+    }
+    out.clear();
+    if (huffman)
+    {
+        if (0 != Hpack::HuffmanDecode(pos, length, out))
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        out.assign(reinterpret_cast<const char*>(pos), length);
+    }
+    pos += length;
+    return 0;
+}
+
+HpackEncoder::HpackEncoder()
+    :sizeUpdate_(false)
+{
+}
+
+void HpackEncoder::encode(const HpackHeaders& headers, std::string& out)
+{
+    if (sizeUpdate_)
+    {
+        sizeUpdate_ = false;
+        Hpack::EncodeInteger(table_.getMaxSize(), 5, 0x20, out);
+    }
+    for (auto& header : headers)
+    {
+        auto& name = header.first;
+        auto& value = header.second;
+        uint64_t nameIndex = 0;
+        auto index = table_.find(name, value, nameIndex);
+        if (0 != index)
+        {
+            Hpack::EncodeInteger(index, 7, 0x80, out);
+            continue;
+        }
+        bool sensitive = IsSensitiveHeader(name);
+        //小条目加入动态表，供后续响应引用。
+        bool indexing = !sensitive && !IsVolatileHeader(name)
+            && name.size() + value.size() + HpackTable::EntryOverhead <= (table_.getMaxSize() >> 2);
+        if (indexing)
+        {
+            Hpack::EncodeInteger(nameIndex, 6, 0x40, out);
+        }
+        else
+        {
+            Hpack::EncodeInteger(nameIndex, 4, sensitive ? 0x10 : 0x00, out);
+        }
+        if (0 == nameIndex)
+        {
+            encodeString(name, out);
+        }
+        encodeString(value, out);
+        if (indexing)
+        {
+            table_.add(name, value);
+        }
+    }
+}
+
+void HpackEncoder::setMaxTableSize(uint64_t size)
+{
+    //本端编码最多使用默认大小。
+    if (size > HpackTable::DefaultTableSize)
+    {
+        size = HpackTable::DefaultTableSize;
+    }
+    if (size != table_.getMaxSize())
+    {
+        table_.setMaxSize(size);
+        sizeUpdate_ = true;
+    }
+}
+
+void HpackEncoder::encodeString(const std::string& str, std::string& out)
+{
+    auto size = Hpack::HuffmanEncodedSize(str);
+    if (size < str.size())
+    {
+        Hpack::EncodeInteger(size, 7, 0x80, out);
+        Hpack::HuffmanEncode(str, out);
+    }
+    else
+    {
+        Hpack::EncodeInteger(str.size(), 7, 0x00, out);
+        out += str;
+    }
+}
+
+void Hpack::EncodeInteger(uint64_t value, int prefix, uint8_t flags, std::string& out)
+{
+    uint64_t max = (1u << prefix) - 1;
+    if (value < max)
+    {
+        out.push_back((char)(flags | value));
+        return;
+    }
+    out.push_back((char)(flags | max));
+    value -= max;
+    while (value >= 0x80)
+    {
+        out.push_back((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+int Hpack::DecodeInteger(const uint8_t*& pos, const uint8_t* end, int prefix, uint64_t& value)
+{
+    if (pos >= end)
+    {
+        return -1;
+    }
+    uint64_t max = (1u << prefix) - 1;
+    value = *pos++ & max;
+    if (value < max)
+    {
+        return 0;
+    }
+    for (int shift = 0; pos < end; shift += 7)
+    {
+        //限制在32位以内，拒绝超长编码。
+        if (shift > 28)
+        {
+            return -1;
+        }
+        uint8_t byte = *pos++;
+        value += (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value > 0xffffffffu ? -1 : 0;
+        }
+    }
+    return -1;
+}
+
+uint64_t Hpack::HuffmanEncodedSize(const std::string& str)
+{
+    uint64_t bits = 0;
+    for (auto ch : str)
+    {
+        bits += HuffmanTable[(uint8_t)ch].bits;
+    }
+    return (bits + 7) >> 3;
+}
+
+void Hpack::HuffmanEncode(const std::string& str, std::string& out)
+{
+    uint64_t buffer = 0;
+    int bits = 0;
+    for (auto ch : str)
+    {
+        auto& code = HuffmanTable[(uint8_t)ch];
+        buffer = (buffer << code.bits) | code.code;
+        bits += code.bits;
+        while (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back((char)(buffer >> bits));
+        }
+    }
+    //以EOS的高位(全1)填充至字节边界。
+    if (bits > 0)
+    {
+        out.push_back((char)((buffer << (8 - bits)) | (0xff >> bits)));
+    }
+}
+
+int Hpack::HuffmanDecode(const uint8_t* data, uint64_t size, std::string& out)
+{
+    auto& table = GetHuffmanDecodeTable();
+    uint32_t code = 0;
+    int bits = 0;
+    for (uint64_t i = 0; i < size; i++)
+    {
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            code = (code << 1) | ((data[i] >> bit) & 1);
+            bits++;
+            uint32_t offset = code - table.first[bits];
+            if (table.count[bits] > 0 && offset < table.count[bits])
+            {
+                auto sym = table.symbols[table.offset[bits] + offset];
+                if (HuffmanEos == sym)
+                {
+                    return -1;
+                }
+                out.push_back((char)sym);
+                code = 0;
+                bits = 0;
+            }
+            else if (bits >= HuffmanDecodeTable::MaxBits)
+            {
+                return -1;
+            }
+        }
+    }
+    //填充不超过7位且须全为1。
+    if (bits > 7 || code != (1u << bits) - 1)
+    {
+        return -1;
+    }
+    return 0;
+}
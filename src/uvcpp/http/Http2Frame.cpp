@@ -0,0 +1,86 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/Http2Frame.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+void Http2Frame::DecodeHead(const char* data, Http2Frame& frame)
+{
+    auto ptr = reinterpret_cast<const uint8_t*>(data);
+    frame.length = ((uint32_t)ptr[0] << 16) | ((uint32_t)ptr[1] << 8) | ptr[2];
+    frame.type = ptr[3];
+    frame.flags = ptr[4];
+    //忽略保留位。
+    frame.streamId = ReadUint32(data + 5) & 0x7fffffff;
+    frame.payload = data + HeadSize;
+}
+
+void Http2Frame::EncodeHead(std::string& out, uint32_t length, uint8_t type, uint8_t flags, uint32_t streamId)
+{
+    char head[HeadSize];
+    head[0] = (char)(length >> 16);
+    head[1] = (char)(length >> 8);
+    head[2] = (char)length;
+    head[3] = (char)type;
+    head[4] = (char)flags;
+    head[5] = (char)((streamId >> 24) & 0x7f);
+    head[6] = (char)(streamId >> 16);
+    head[7] = (char)(streamId >> 8);
+    head[8] = (char)streamId;
+    out.append(head, HeadSize);
+}
+
+void Http2Frame::EncodeSetting(std::string& out, uint16_t id, uint32_t value)
+{
+    out.push_back((char)(id >> 8));
+    out.push_back((char)id);
+    AppendUint32(out, value);
+}
+
+void Http2Frame::EncodeRstStream(std::string& out, uint32_t streamId, uint32_t error)
+{
+    EncodeHead(out, 4, RstStream, 0, streamId);
+    AppendUint32(out, error);
+}
+
+void Http2Frame::EncodeWindowUpdate(std::string& out, uint32_t streamId, uint32_t increment)
+{
+    EncodeHead(out, 4, WindowUpdate, 0, streamId);
+    AppendUint32(out, increment & 0x7fffffff);
+}
+
+void Http2Frame::EncodeGoAway(std::string& out, uint32_t lastStreamId, uint32_t error)
+{
+    EncodeHead(out, 8, GoAway, 0, 0);
+    AppendUint32(out, lastStreamId & 0x7fffffff);
+    AppendUint32(out, error);
+}
+
+void Http2Frame::EncodePing(std::string& out, const char data[8], bool ack)
+{
+    EncodeHead(out, 8, Ping, ack ? Ack : 0, 0);
+    out.append(data, 8);
+}
+
+void Http2Frame::AppendUint32(std::string& out, uint32_t value)
+{
+    out.push_back((char)(value >> 24));
+    out.push_back((char)(value >> 16));
+    out.push_back((char)(value >> 8));
+    out.push_back((char)value);
+}
+
+uint32_t Http2Frame::ReadUint32(const char* data)
+{
+    auto ptr = reinterpret_cast<const uint8_t*>(data);
+    return ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) | ((uint32_t)ptr[2] << 8) | ptr[3];
+}
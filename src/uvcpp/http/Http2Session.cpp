@@ -0,0 +1,1055 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../include/http/Http2Session.hpp"
+#include "../include/http/Http2Stream.hpp"
+#include "../include/http/ResponseWriter.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+const char Http2Session::Preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+uint32_t Http2Session::DefaultMaxConcurrentStreams = 100;
+//默认请求body上限16Mb，接收窗口1Mb。
+uint64_t Http2Session::DefaultMaxRequestSize = 16 << 20;
+uint32_t Http2Session::LocalWindowSize = 1 << 20;
+
+namespace
+{
+
+//HEADERS + CONTINUATION累计上限。
+const uint64_t MaxHeaderBlockSize = 64 << 10;
+
+std::string ToLower(const std::string& str)
+{
+    std::string out(str);
+    std::transform(out.begin(), out.end(), out.begin(),
+        [](unsigned char ch) { return (char)::tolower(ch); });
+    return out;
+}
+
+//Http2禁止的连接级消息头(RFC 7540 8.1.2.2)。
+bool IsConnectionHeader(const std::string& name)
+{
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection"
+        || name == "transfer-encoding" || name == "upgrade";
+}
+
+int Base64UrlDecode(const std::string& in, std::string& out)
+{
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (auto ch : in)
+    {
+        int value;
+        if (ch >= 'A' && ch <= 'Z')
+            value = ch - 'A';
+        else if (ch >= 'a' && ch <= 'z')
+            value = ch - 'a' + 26;
+        else if (ch >= '0' && ch <= '9')
+            value = ch - '0' + 52;
+        else if (ch == '-' || ch == '+')
+            value = 62;
+        else if (ch == '_' || ch == '/')
+            value = 63;
+        else if (ch == '=')
+            break;
+        else
+            return -1;
+        buffer = (buffer << 6) | value;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back((char)(buffer >> bits));
+        }
+    }
+    return 0;
+}
+
+struct WriteBatch
+{
+    std::vector<std::shared_ptr<std::string>> data;
+    std::vector<Http2Session::OnDataCallback> callbacks;
+};
+
+}
+
+Http2Session::Http2Session(EventLoop* loop, TcpConnectionPtr connection)
+    :loop_(loop),
+    connection_(connection),
+    onRequest_(nullptr),
+    onClose_(nullptr),
+    prefaceReceived_(false),
+    settingsReceived_(false),
+    closed_(false),
+    goingAway_(false),
+    inInput_(false),
+    lastStreamId_(0),
+    maxConcurrentStreams_(DefaultMaxConcurrentStreams),
+    maxRequestSize_(DefaultMaxRequestSize),
+    headerStream_(0),
+    headerFlags_(0),
+    peerMaxFrameSize_(Http2Frame::DefaultMaxFrameSize),
+    peerInitialWindow_(Http2Frame::DefaultWindowSize),
+    sendWindow_(Http2Frame::DefaultWindowSize),
+    recvWindow_(LocalWindowSize)
+{
+}
+
+Http2Session::~Http2Session()
+{
+}
+
+void Http2Session::setRequestCallback(OnRequestCallback callback)
+{
+    onRequest_ = callback;
+}
+
+void Http2Session::setCloseConnectionCallback(DefaultCallback callback)
+{
+    onClose_ = callback;
+}
+
+void Http2Session::setMaxConcurrentStreams(uint32_t num)
+{
+    maxConcurrentStreams_ = num;
+}
+
+void Http2Session::setMaxRequestSize(uint64_t size)
+{
+    maxRequestSize_ = size;
+}
+
+void Http2Session::start()
+{
+    sendSettings();
+    flush();
+}
+
+int Http2Session::startUpgrade(const std::string& settings, Request& req)
+{
+    //HTTP2-Settings等同于客户端的SETTINGS帧，无需应答ACK。
+    std::string payload;
+    if (0 != Base64UrlDecode(settings, payload) || payload.size() % 6 != 0)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < payload.size(); i += 6)
+    {
+        uint16_t id = ((uint16_t)(uint8_t)payload[i] << 8) | (uint8_t)payload[i + 1];
+        if (0 != applySetting(id, Http2Frame::ReadUint32(payload.c_str() + i + 2)))
+        {
+            return -1;
+        }
+    }
+    sendSettings();
+    lastStreamId_ = 1;
+    auto& stream = createStream(1);
+    stream.remoteClosed = true;
+    flush();
+    respond(stream, req);
+    return 0;
+}
+
+void Http2Session::onData(const char* data, size_t size)
+{
+    if (closed_)
+    {
+        return;
+    }
+    auto self = shared_from_this();
+    input_.append(data, size);
+    inInput_ = true;
+    processInput();
+    inInput_ = false;
+    flush();
+}
+
+void Http2Session::onDisconnected()
+{
+    closed_ = true;
+    std::map<uint32_t, StreamState> streams;
+    streams.swap(streams_);
+    ready_.clear();
+    output_.clear();
+    std::vector<OnDataCallback> callbacks;
+    callbacks.swap(callbacks_);
+    for (auto& callback : callbacks)
+    {
+        callback(WriteInfo::Disconnected);
+    }
+    for (auto& it : streams)
+    {
+        for (auto& chunk : it.second.queue)
+        {
+            if (chunk.callback)
+            {
+                chunk.callback(WriteInfo::Disconnected);
+            }
+        }
+        if (nullptr != it.second.response)
+        {
+            it.second.response->abort();
+        }
+    }
+}
+
+void Http2Session::shutdown(uint32_t error)
+{
+    if (closed_ || goingAway_)
+    {
+        return;
+    }
+    goingAway_ = true;
+    Http2Frame::EncodeGoAway(control(), lastStreamId_, error);
+    flush();
+}
+
+uint64_t Http2Session::streamSize()
+{
+    return streams_.size();
+}
+
+EventLoop* Http2Session::getLoop()
+{
+    return loop_;
+}
+
+void Http2Session::submitHeaders(uint32_t id, Response& resp, bool endStream)
+{
+    if (closed_ || streams_.find(id) == streams_.end())
+    {
+        return;
+    }
+    HpackHeaders headers;
+    headers.emplace_back(":status", std::to_string((int)resp.getStatusCode()));
+    bool hasDate = false;
+    for (auto& head : resp.getHeads())
+    {
+        auto name = ToLower(head.first);
+        if (IsConnectionHeader(name))
+        {
+            continue;
+        }
+        hasDate = hasDate || name == "date";
+        headers.emplace_back(std::move(name), head.second);
+    }
+    if (!hasDate)
+    {
+        //复用每秒缓存的"Date: ...\r\n"。
+        auto& date = ResponseWriter::GetDateHead();
+        headers.emplace_back("date", date.substr(6, date.size() - 8));
+    }
+    std::string block;
+    encoder_.encode(headers, block);
+    //超过对端帧上限时拆分为HEADERS + CONTINUATION。
+    size_t offset = 0;
+    bool first = true;
+    do
+    {
+        size_t size = std::min<size_t>(block.size() - offset, peerMaxFrameSize_);
+        bool last = offset + size == block.size();
+        uint8_t flags = (last ? Http2Frame::EndHeaders : 0) | (first && endStream ? Http2Frame::EndStream : 0);
+        auto& out = control();
+        Http2Frame::EncodeHead(out, (uint32_t)size, first ? Http2Frame::Headers : Http2Frame::Continuation, flags, id);
+        out.append(block, offset, size);
+        offset += size;
+        first = false;
+    } while (offset < block.size());
+    if (endStream)
+    {
+        closeStream(id, 0);
+    }
+    flush();
+}
+
+void Http2Session::submitData(uint32_t id, std::shared_ptr<std::string> data, bool endStream, OnDataCallback callback)
+{
+    auto it = streams_.find(id);
+    if (closed_ || it == streams_.end())
+    {
+        if (callback)
+        {
+            callback(WriteInfo::Disconnected);
+        }
+        return;
+    }
+    if (data->empty() && !endStream)
+    {
+        if (callback)
+        {
+            callback(0);
+        }
+        return;
+    }
+    it->second.queue.push_back(DataChunk{ data, 0, endStream, callback });
+    schedule(it->second);
+    sendData();
+    flush();
+}
+
+void Http2Session::resetStream(uint32_t id, uint32_t error)
+{
+    if (closed_ || streams_.find(id) == streams_.end())
+    {
+        return;
+    }
+    Http2Frame::EncodeRstStream(control(), id, error);
+    closeStream(id, WriteInfo::Disconnected);
+    flush();
+}
+
+int Http2Session::MatchPreface(const char* data, size_t size)
+{
+    size_t n = size < PrefaceSize ? size : PrefaceSize;
+    if (0 != std::memcmp(data, Preface, n))
+    {
+        return -1;
+    }
+    return size >= PrefaceSize ? 1 : 0;
+}
+
+bool Http2Session::IsUpgradeRequest(Request& req)
+{
+    auto upgrade = req.getHead("Upgrade");
+    if (upgrade.empty())
+    {
+        upgrade = req.getHead("upgrade");
+    }
+    if (ToLower(upgrade).find("h2c") == std::string::npos)
+    {
+        return false;
+    }
+    return !req.getHead("HTTP2-Settings").empty() || !req.getHead("http2-settings").empty();
+}
+
+void Http2Session::processInput()
+{
+    size_t pos = 0;
+    if (!prefaceReceived_)
+    {
+        auto rst = MatchPreface(input_.c_str(), input_.size());
+        if (rst < 0)
+        {
+            connectionError(Http2Frame::ProtocolError);
+            return;
+        }
+        if (0 == rst)
+        {
+            return;
+        }
+        prefaceReceived_ = true;
+        pos = PrefaceSize;
+    }
+    while (!closed_ && input_.size() - pos >= Http2Frame::HeadSize)
+    {
+        Http2Frame frame;
+        Http2Frame::DecodeHead(input_.c_str() + pos, frame);
+        //本端未修改SETTINGS_MAX_FRAME_SIZE。
+        if (frame.length > Http2Frame::DefaultMaxFrameSize)
+        {
+            connectionError(Http2Frame::FrameSizeError);
+            return;
+        }
+        if (input_.size() - pos < Http2Frame::HeadSize + frame.length)
+        {
+            break;
+        }
+        pos += Http2Frame::HeadSize + frame.length;
+        auto error = onFrame(frame);
+        if (0 != error)
+        {
+            connectionError(error);
+            return;
+        }
+    }
+    input_.erase(0, pos);
+}
+
+int Http2Session::onFrame(Http2Frame& frame)
+{
+    //header block未结束时只允许同一stream的CONTINUATION。
+    if (0 != headerStream_ && (frame.type != Http2Frame::Continuation || frame.streamId != headerStream_))
+    {
+        return Http2Frame::ProtocolError;
+    }
+    //preface之后的第一个帧必须为SETTINGS。
+    if (!settingsReceived_ && frame.type != Http2Frame::Settings)
+    {
+        return Http2Frame::ProtocolError;
+    }
+    switch (frame.type)
+    {
+    case Http2Frame::Data:
+        return onDataFrame(frame);
+    case Http2Frame::Headers:
+        return onHeaders(frame);
+    case Http2Frame::Priority:
+        if (0 == frame.streamId)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        return frame.length == 5 ? 0 : Http2Frame::FrameSizeError;
+    case Http2Frame::RstStream:
+        return onRstStream(frame);
+    case Http2Frame::Settings:
+        return onSettings(frame);
+    case Http2Frame::PushPromise:
+        return Http2Frame::ProtocolError;
+    case Http2Frame::Ping:
+        return onPing(frame);
+    case Http2Frame::GoAway:
+        if (0 != frame.streamId)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        goingAway_ = true;
+        return 0;
+    case Http2Frame::WindowUpdate:
+        return onWindowUpdate(frame);
+    case Http2Frame::Continuation:
+        return onContinuation(frame);
+    default:
+        //忽略未知类型的帧。
+        return 0;
+    }
+}
+
+int Http2Session::onHeaders(Http2Frame& frame)
+{
+    auto id = frame.streamId;
+    if (0 == id || 0 == (id & 1))
+    {
+        return Http2Frame::ProtocolError;
+    }
+    const char* data = frame.payload;
+    uint32_t length = frame.length;
+    if (frame.flags & Http2Frame::Padded)
+    {
+        if (length < 1 || (uint8_t)data[0] >= length)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        length -= 1 + (uint8_t)data[0];
+        data++;
+    }
+    if (frame.flags & Http2Frame::PriorityFlag)
+    {
+        if (length < 5)
+        {
+            return Http2Frame::FrameSizeError;
+        }
+        data += 5;
+        length -= 5;
+    }
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+    {
+        if (id <= lastStreamId_)
+        {
+            return Http2Frame::StreamClosed;
+        }
+        lastStreamId_ = id;
+    }
+    else if (it->second.remoteClosed)
+    {
+        return Http2Frame::StreamClosed;
+    }
+    else if (0 == (frame.flags & Http2Frame::EndStream))
+    {
+        //trailer必须结束stream。
+        return Http2Frame::ProtocolError;
+    }
+    headerStream_ = id;
+    headerFlags_ = frame.flags;
+    headerBlock_.assign(data, length);
+    if (frame.flags & Http2Frame::EndHeaders)
+    {
+        return onHeaderBlock();
+    }
+    return 0;
+}
+
+int Http2Session::onContinuation(Http2Frame& frame)
+{
+    if (0 == headerStream_)
+    {
+        return Http2Frame::ProtocolError;
+    }
+    if (headerBlock_.size() + frame.length > MaxHeaderBlockSize)
+    {
+        return Http2Frame::EnhanceYourCalm;
+    }
+    headerBlock_.append(frame.payload, frame.length);
+    if (frame.flags & Http2Frame::EndHeaders)
+    {
+        return onHeaderBlock();
+    }
+    return 0;
+}
+
+int Http2Session::onHeaderBlock()
+{
+    auto id = headerStream_;
+    headerStream_ = 0;
+    //即使拒绝该stream也须解码，保持动态表同步。
+    HpackHeaders headers;
+    auto rst = decoder_.decode(headerBlock_.c_str(), headerBlock_.size(), headers);
+    headerBlock_.clear();
+    if (0 != rst)
+    {
+        return Http2Frame::CompressionError;
+    }
+    auto it = streams_.find(id);
+    if (it != streams_.end())
+    {
+        //trailer内容不传递给路由。
+        it->second.remoteClosed = true;
+        dispatch(it->second);
+        return 0;
+    }
+    if (goingAway_ || streams_.size() >= maxConcurrentStreams_)
+    {
+        Http2Frame::EncodeRstStream(control(), id, Http2Frame::RefusedStream);
+        return 0;
+    }
+    auto& stream = createStream(id);
+    stream.headers.swap(headers);
+    for (auto& header : stream.headers)
+    {
+        //依据content-length提前拒绝过大的body。
+        if (header.first == "content-length" && std::strtoull(header.second.c_str(), nullptr, 10) > maxRequestSize_)
+        {
+            Response resp(HttpVersion::Http1_1, Response::StatusCode::PayloadTooLarge);
+            submitHeaders(id, resp, true);
+            Http2Frame::EncodeRstStream(control(), id, Http2Frame::NoError);
+            return 0;
+        }
+    }
+    if (headerFlags_ & Http2Frame::EndStream)
+    {
+        stream.remoteClosed = true;
+        dispatch(stream);
+    }
+    return 0;
+}
+
+int Http2Session::onDataFrame(Http2Frame& frame)
+{
+    auto id = frame.streamId;
+    if (0 == id)
+    {
+        return Http2Frame::ProtocolError;
+    }
+    //连接级流量控制计入整个payload(含填充)。
+    recvWindow_ -= frame.length;
+    if (recvWindow_ < 0)
+    {
+        return Http2Frame::FlowControlError;
+    }
+    if (recvWindow_ <= (int64_t)(LocalWindowSize >> 1))
+    {
+        Http2Frame::EncodeWindowUpdate(control(), 0, (uint32_t)(LocalWindowSize - recvWindow_));
+        recvWindow_ = LocalWindowSize;
+    }
+    const char* data = frame.payload;
+    uint32_t length = frame.length;
+    if (frame.flags & Http2Frame::Padded)
+    {
+        if (length < 1 || (uint8_t)data[0] >= length)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        length -= 1 + (uint8_t)data[0];
+        data++;
+    }
+    auto it = streams_.find(id);
+    if (it == streams_.end() || it->second.remoteClosed)
+    {
+        if (id > lastStreamId_)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        //已重置或已响应完成的stream，丢弃在途数据。
+        return 0;
+    }
+    auto& stream = it->second;
+    stream.recvWindow -= frame.length;
+    if (stream.recvWindow < 0)
+    {
+        resetStream(id, Http2Frame::FlowControlError);
+        return 0;
+    }
+    if (stream.body.size() + length > maxRequestSize_)
+    {
+        //以413应答后重置，通知客户端停止发送。
+        Response resp(HttpVersion::Http1_1, Response::StatusCode::PayloadTooLarge);
+        submitHeaders(id, resp, true);
+        Http2Frame::EncodeRstStream(control(), id, Http2Frame::NoError);
+        return 0;
+    }
+    stream.body.append(data, length);
+    if (frame.flags & Http2Frame::EndStream)
+    {
+        stream.remoteClosed = true;
+        dispatch(stream);
+        return 0;
+    }
+    if (stream.recvWindow <= (int64_t)(LocalWindowSize >> 1))
+    {
+        Http2Frame::EncodeWindowUpdate(control(), id, (uint32_t)(LocalWindowSize - stream.recvWindow));
+        stream.recvWindow = LocalWindowSize;
+    }
+    return 0;
+}
+
+int Http2Session::onRstStream(Http2Frame& frame)
+{
+    if (4 != frame.length)
+    {
+        return Http2Frame::FrameSizeError;
+    }
+    if (0 == frame.streamId || frame.streamId > lastStreamId_)
+    {
+        return Http2Frame::ProtocolError;
+    }
+    closeStream(frame.streamId, WriteInfo::Disconnected);
+    return 0;
+}
+
+int Http2Session::onSettings(Http2Frame& frame)
+{
+    if (0 != frame.streamId)
+    {
+        return Http2Frame::ProtocolError;
+    }
+    if (frame.flags & Http2Frame::Ack)
+    {
+        return 0 == frame.length ? 0 : Http2Frame::FrameSizeError;
+    }
+    if (0 != frame.length % 6)
+    {
+        return Http2Frame::FrameSizeError;
+    }
+    for (uint32_t i = 0; i < frame.length; i += 6)
+    {
+        auto ptr = frame.payload + i;
+        uint16_t id = ((uint16_t)(uint8_t)ptr[0] << 8) | (uint8_t)ptr[1];
+        auto error = applySetting(id, Http2Frame::ReadUint32(ptr + 2));
+        if (0 != error)
+        {
+            return error;
+        }
+    }
+    settingsReceived_ = true;
+    Http2Frame::EncodeHead(control(), 0, Http2Frame::Settings, Http2Frame::Ack, 0);
+    //初始窗口可能增大。
+    sendData();
+    return 0;
+}
+
+int Http2Session::onPing(Http2Frame& frame)
+{
+    if (8 != frame.length)
+    {
+        return Http2Frame::FrameSizeError;
+    }
+    if (0 != frame.streamId)
+    {
+        return Http2Frame::ProtocolError;
+    }
+    if (0 == (frame.flags & Http2Frame::Ack))
+    {
+        Http2Frame::EncodePing(control(), frame.payload, true);
+    }
+    return 0;
+}
+
+int Http2Session::onWindowUpdate(Http2Frame& frame)
+{
+    if (4 != frame.length)
+    {
+        return Http2Frame::FrameSizeError;
+    }
+    auto increment = Http2Frame::ReadUint32(frame.payload) & 0x7fffffff;
+    if (0 == frame.streamId)
+    {
+        if (0 == increment)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        sendWindow_ += increment;
+        if (sendWindow_ > Http2Frame::MaxWindowSize)
+        {
+            return Http2Frame::FlowControlError;
+        }
+        sendData();
+        return 0;
+    }
+    auto it = streams_.find(frame.streamId);
+    if (it == streams_.end())
+    {
+        return frame.streamId > lastStreamId_ ? Http2Frame::ProtocolError : 0;
+    }
+    auto& stream = it->second;
+    if (0 == increment)
+    {
+        resetStream(frame.streamId, Http2Frame::ProtocolError);
+        return 0;
+    }
+    stream.sendWindow += increment;
+    if (stream.sendWindow > Http2Frame::MaxWindowSize)
+    {
+        resetStream(frame.streamId, Http2Frame::FlowControlError);
+        return 0;
+    }
+    if (!stream.queue.empty())
+    {
+        schedule(stream);
+        sendData();
+    }
+    return 0;
+}
+
+int Http2Session::applySetting(uint16_t id, uint32_t value)
+{
+    switch (id)
+    {
+    case Http2Frame::HeaderTableSize:
+        encoder_.setMaxTableSize(value);
+        break;
+    case Http2Frame::EnablePush:
+        if (value > 1)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        break;
+    case Http2Frame::InitialWindowSize:
+    {
+        if (value > Http2Frame::MaxWindowSize)
+        {
+            return Http2Frame::FlowControlError;
+        }
+        //调整所有stream的发送窗口(可为负)。
+        int64_t delta = (int64_t)value - peerInitialWindow_;
+        peerInitialWindow_ = value;
+        for (auto& it : streams_)
+        {
+            it.second.sendWindow += delta;
+            if (it.second.sendWindow > Http2Frame::MaxWindowSize)
+            {
+                return Http2Frame::FlowControlError;
+            }
+            if (delta > 0 && !it.second.queue.empty())
+            {
+                schedule(it.second);
+            }
+        }
+        break;
+    }
+    case Http2Frame::MaxFrameSize:
+        if (value < Http2Frame::DefaultMaxFrameSize || value > Http2Frame::MaxFrameSizeLimit)
+        {
+            return Http2Frame::ProtocolError;
+        }
+        peerMaxFrameSize_ = value;
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+Http2Session::StreamState& Http2Session::createStream(uint32_t id)
+{
+    auto& stream = streams_[id];
+    stream.id = id;
+    stream.remoteClosed = false;
+    stream.scheduled = false;
+    stream.sendWindow = peerInitialWindow_;
+    stream.recvWindow = LocalWindowSize;
+    return stream;
+}
+
+void Http2Session::dispatch(StreamState& stream)
+{
+    Request req;
+    if (0 != buildRequest(stream, req))
+    {
+        resetStream(stream.id, Http2Frame::ProtocolError);
+        return;
+    }
+    respond(stream, req);
+}
+
+void Http2Session::respond(StreamState& stream, Request& req)
+{
+    auto connection = connection_.lock();
+    if (nullptr == connection)
+    {
+        return;
+    }
+    stream.response = std::make_shared<Http2Stream>(loop_, connection, shared_from_this(), stream.id);
+    //回调中可能已完成响应并移除stream，此后不再访问stream。
+    ResponseStreamPtr response = stream.response;
+    if (onRequest_)
+    {
+        onRequest_(req, response);
+    }
+}
+
+int Http2Session::buildRequest(StreamState& stream, Request& req)
+{
+    req.setVersion(HttpVersion::Http1_1);
+    std::string method;
+    std::string path;
+    std::string authority;
+    std::string cookie;
+    for (auto& header : stream.headers)
+    {
+        auto& name = header.first;
+        if (!name.empty() && name[0] == ':')
+        {
+            if (name == ":method")
+                method = header.second;
+            else if (name == ":path")
+                path = header.second;
+            else if (name == ":authority")
+                authority = header.second;
+            else if (name != ":scheme")
+                return -1;
+            continue;
+        }
+        //多个cookie头合并(RFC 7540 8.1.2.5)。
+        if (name == "cookie")
+        {
+            if (!cookie.empty())
+            {
+                cookie += "; ";
+            }
+            cookie += header.second;
+            continue;
+        }
+        req.appendHead(name, header.second);
+    }
+    auto methon = Request::StrToMethon(method);
+    if (Methon::Invalid == methon || path.empty() || 0 != req.parseUrl(path))
+    {
+        return -1;
+    }
+    req.setMethon(methon);
+    if (!authority.empty() && req.getHead("host").empty())
+    {
+        req.appendHead("host", std::move(authority));
+    }
+    if (!cookie.empty())
+    {
+        req.appendHead("cookie", std::move(cookie));
+    }
+    req.swapContent(stream.body);
+    stream.headers.clear();
+    return 0;
+}
+
+void Http2Session::closeStream(uint32_t id, int status)
+{
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+    {
+        return;
+    }
+    auto queue = std::move(it->second.queue);
+    auto response = it->second.response;
+    streams_.erase(it);
+    for (auto& chunk : queue)
+    {
+        if (chunk.callback)
+        {
+            chunk.callback(status);
+        }
+    }
+    if (0 != status && nullptr != response)
+    {
+        response->abort();
+    }
+}
+
+void Http2Session::connectionError(uint32_t error)
+{
+    if (closed_)
+    {
+        return;
+    }
+    Http2Frame::EncodeGoAway(control(), lastStreamId_, error);
+    closed_ = true;
+    //GOAWAY写出后关闭连接。
+    auto self = shared_from_this();
+    //写出成功与否都关闭连接。
+    callbacks_.push_back([self](int)
+    {
+        if (self->onClose_)
+        {
+            self->onClose_();
+        }
+    });
+    inInput_ = false;
+    flush();
+}
+
+std::string& Http2Session::control()
+{
+    if (output_.empty() || !output_.back().control)
+    {
+        output_.push_back(Segment{ std::make_shared<std::string>(), 0, 0, true });
+    }
+    return *output_.back().data;
+}
+
+void Http2Session::sendSettings()
+{
+    auto& out = control();
+    Http2Frame::EncodeHead(out, 12, Http2Frame::Settings, 0, 0);
+    Http2Frame::EncodeSetting(out, Http2Frame::MaxConcurrentStreams, maxConcurrentStreams_);
+    Http2Frame::EncodeSetting(out, Http2Frame::InitialWindowSize, LocalWindowSize);
+    //连接级接收窗口只能通过WINDOW_UPDATE调整。
+    if (LocalWindowSize > Http2Frame::DefaultWindowSize)
+    {
+        Http2Frame::EncodeWindowUpdate(out, 0, LocalWindowSize - Http2Frame::DefaultWindowSize);
+    }
+}
+
+void Http2Session::schedule(StreamState& stream)
+{
+    if (!stream.scheduled)
+    {
+        stream.scheduled = true;
+        ready_.push_back(stream.id);
+    }
+}
+
+void Http2Session::sendData()
+{
+    //各stream轮流每次发送一帧，直至窗口耗尽或无数据。
+    while (!ready_.empty() && !closed_ && sendWindow_ > 0)
+    {
+        bool progress = false;
+        auto count = ready_.size();
+        for (size_t i = 0; i < count && !ready_.empty(); i++)
+        {
+            auto id = ready_.front();
+            ready_.pop_front();
+            auto it = streams_.find(id);
+            if (it == streams_.end())
+            {
+                continue;
+            }
+            auto& stream = it->second;
+            stream.scheduled = false;
+            if (stream.queue.empty())
+            {
+                continue;
+            }
+            auto& chunk = stream.queue.front();
+            uint64_t remain = chunk.data->size() - chunk.offset;
+            uint64_t size = remain;
+            if (size > 0)
+            {
+                int64_t window = std::min(stream.sendWindow, sendWindow_);
+                size = std::min<uint64_t>(size, window > 0 ? window : 0);
+                size = std::min<uint64_t>(size, peerMaxFrameSize_);
+                if (0 == size)
+                {
+                    //stream窗口耗尽时等待WINDOW_UPDATE再调度。
+                    if (stream.sendWindow > 0)
+                    {
+                        schedule(stream);
+                    }
+                    continue;
+                }
+            }
+            bool end = size == remain && chunk.endStream;
+            Http2Frame::EncodeHead(control(), (uint32_t)size, Http2Frame::Data, end ? Http2Frame::EndStream : 0, id);
+            if (size > 0)
+            {
+                output_.push_back(Segment{ chunk.data, chunk.offset, size, false });
+            }
+            chunk.offset += size;
+            stream.sendWindow -= size;
+            sendWindow_ -= size;
+            progress = true;
+            if (chunk.offset == chunk.data->size())
+            {
+                if (chunk.callback)
+                {
+                    callbacks_.push_back(chunk.callback);
+                }
+                stream.queue.pop_front();
+            }
+            if (end)
+            {
+                closeStream(id, 0);
+                continue;
+            }
+            if (!stream.queue.empty())
+            {
+                schedule(stream);
+            }
+        }
+        if (!progress)
+        {
+            break;
+        }
+    }
+}
+
+void Http2Session::flush()
+{
+    if (inInput_ || output_.empty())
+    {
+        return;
+    }
+    auto batch = std::make_shared<WriteBatch>();
+    batch->callbacks.swap(callbacks_);
+    std::vector<uv_buf_t> bufs;
+    bufs.reserve(output_.size());
+    for (auto& segment : output_)
+    {
+        auto size = segment.control ? segment.data->size() : segment.size;
+        if (size > 0)
+        {
+            bufs.push_back(uv_buf_init(const_cast<char*>(segment.data->c_str()) + segment.offset, (unsigned int)size));
+            batch->data.push_back(segment.data);
+        }
+    }
+    output_.clear();
+    auto connection = connection_.lock();
+    if (nullptr == connection || bufs.empty())
+    {
+        int status = nullptr == connection ? WriteInfo::Disconnected : 0;
+        for (auto& callback : batch->callbacks)
+        {
+            callback(status);
+        }
+        return;
+    }
+    //同一轮产生的帧合并为一次聚合写。
+    connection->write(bufs.data(), (unsigned int)bufs.size(), [batch](WriteInfo& info)
+    {
+        for (auto& callback : batch->callbacks)
+        {
+            callback(info.status);
+        }
+    });
+}
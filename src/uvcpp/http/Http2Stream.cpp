@@ -0,0 +1,234 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/Http2Stream.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+Http2Stream::Http2Stream(EventLoop* loop, TcpConnectionPtr connection, Http2SessionPtr session, uint32_t id)
+    :ResponseStream(loop, connection, HttpVersion::Http1_1),
+    session_(session),
+    id_(id)
+{
+    //结束由END_STREAM标识，与chunked相同需显式end。
+    chunked_ = true;
+    keepAlive_ = true;
+}
+
+Http2Stream::~Http2Stream()
+{
+}
+
+uint32_t Http2Stream::getStreamId()
+{
+    return id_;
+}
+
+void Http2Stream::sendInLoop(std::shared_ptr<Response> resp)
+{
+    if (headSent_)
+    {
+        return;
+    }
+    auto session = session_.lock();
+    if (closed_ || nullptr == session)
+    {
+        onClosed();
+        onComplete();
+        return;
+    }
+    headSent_ = true;
+    compressContent(*resp);
+    std::string content;
+    resp->swapContent(content);
+    resp->removeHead("Content-Length");
+    resp->removeHead("content-length");
+    auto code = resp->getStatusCode();
+    if (code >= Response::StatusCode::OK && code != Response::StatusCode::NoContent
+        && code != Response::StatusCode::NotModified)
+    {
+        resp->appendHead("content-length", std::to_string(content.size()));
+    }
+    if (content.empty())
+    {
+        session->submitHeaders(id_, *resp, true);
+        onComplete();
+        return;
+    }
+    session->submitHeaders(id_, *resp, false);
+    uint64_t size = content.size();
+    pending_ += size;
+    submitEnd(session, std::make_shared<std::string>(std::move(content)), size);
+}
+
+void Http2Stream::writeHeadInLoop(std::shared_ptr<Response> head)
+{
+    if (headSent_ || closed_)
+    {
+        return;
+    }
+    auto session = session_.lock();
+    if (nullptr == session)
+    {
+        onClosed();
+        return;
+    }
+    headSent_ = true;
+    prepareCompression(*head);
+    std::string content;
+    head->swapContent(content);
+    session->submitHeaders(id_, *head, false);
+    if (!content.empty())
+    {
+        pending_ += content.size();
+        writeChunkInLoop(std::make_shared<std::string>(std::move(content)));
+    }
+}
+
+void Http2Stream::writeBufferInLoop(std::shared_ptr<std::string> data, uint64_t size)
+{
+    auto session = session_.lock();
+    if (closed_ || nullptr == session)
+    {
+        afterWrite(size, WriteInfo::Disconnected);
+        return;
+    }
+    auto ptr = self();
+    session->submitData(id_, data, false, [ptr, size](int status)
+    {
+        ptr->afterWrite(size, status);
+    });
+}
+
+void Http2Stream::sendFileInLoop(std::shared_ptr<Response> head, std::shared_ptr<FileSender> sender)
+{
+    auto session = session_.lock();
+    if (headSent_ || closed_ || nullptr == session)
+    {
+        onClosed();
+        onComplete();
+        return;
+    }
+    headSent_ = true;
+    session->submitHeaders(id_, *head, false);
+    auto ptr = self();
+    //逐块读取后作为DATA帧写出，写完一块再读下一块。
+    sender->start([ptr](const char* data, uint64_t size, FileSender::OnCompleteCallback done)
+    {
+        auto session = ptr->session_.lock();
+        if (ptr->closed_ || nullptr == session)
+        {
+            done(WriteInfo::Disconnected);
+            return;
+        }
+        session->submitData(ptr->id_, std::make_shared<std::string>(data, size), false, done);
+    },
+    [ptr](int status)
+    {
+        auto session = ptr->session_.lock();
+        if (0 != status || ptr->closed_ || nullptr == session)
+        {
+            //文件未发送完整，重置stream以免客户端误认为已结束。
+            if (nullptr != session)
+            {
+                session->resetStream(ptr->id_, Http2Frame::InternalError);
+            }
+            ptr->onClosed();
+            ptr->onComplete();
+            return;
+        }
+        ptr->submitEnd(session, std::make_shared<std::string>(), 0);
+    });
+}
+
+void Http2Stream::sendSerializedInLoop(std::shared_ptr<std::string> head, std::shared_ptr<std::string> body)
+{
+    if (headSent_)
+    {
+        return;
+    }
+    auto session = session_.lock();
+    if (closed_ || nullptr == session)
+    {
+        onClosed();
+        onComplete();
+        return;
+    }
+    headSent_ = true;
+    //head为Http1格式的状态行及消息头，解析后重新编码。
+    Response resp;
+    std::string text(*head);
+    text += "\r\n";
+    if (ParseResult::Success != resp.unpack(text))
+    {
+        session->resetStream(id_, Http2Frame::InternalError);
+        onClosed();
+        onComplete();
+        return;
+    }
+    if (nullptr == body || body->empty())
+    {
+        session->submitHeaders(id_, resp, true);
+        onComplete();
+        return;
+    }
+    session->submitHeaders(id_, resp, false);
+    submitEnd(session, body, 0);
+}
+
+void Http2Stream::endInLoop()
+{
+    if (!headSent_)
+    {
+        sendInLoop(std::make_shared<Response>(version_, Response::StatusCode::OK));
+        return;
+    }
+    auto session = session_.lock();
+    if (closed_ || nullptr == session)
+    {
+        onComplete();
+        return;
+    }
+    auto tail = std::make_shared<std::string>();
+    if (nullptr != compression_)
+    {
+        //写出压缩流结尾。
+        compression_->update(nullptr, 0, *tail, true);
+        compression_.reset();
+    }
+    pending_ += tail->size();
+    submitEnd(session, tail, tail->size());
+}
+
+void Http2Stream::cancel()
+{
+    auto session = session_.lock();
+    if (nullptr != session)
+    {
+        session->resetStream(id_, Http2Frame::Cancel);
+    }
+    abort();
+}
+
+std::shared_ptr<Http2Stream> Http2Stream::self()
+{
+    return std::static_pointer_cast<Http2Stream>(shared_from_this());
+}
+
+void Http2Stream::submitEnd(Http2SessionPtr session, std::shared_ptr<std::string> data, uint64_t size)
+{
+    auto ptr = self();
+    session->submitData(id_, data, true, [ptr, size](int status)
+    {
+        ptr->afterWrite(size, status);
+        ptr->onComplete();
+    });
+}
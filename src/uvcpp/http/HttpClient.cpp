@@ -16,9 +16,12 @@ using namespace uv::http;
 HttpClient::HttpClient(EventLoop* loop)
     :client_(new TcpClient(loop)),
     callback_(nullptr),
+    onHeaders_(nullptr),
+    onBodyChunk_(nullptr),
+    onComplete_(nullptr),
+    completed_(false),
     isConnected(false)
 {
-    buffer_.resize(20480);
 }
 
 HttpClient::~HttpClient()
@@ -40,7 +43,16 @@ HttpClient::~HttpClient()
 void HttpClient::Req(uv::SocketAddr& addr,Request& req)
 {
     req_ = req;
-    buffer_.clear();
+    completed_ = false;
+    parser_.reset(req.getMethon() == Methon::Head);
+    parser_.setHeadersCallback([this](Response& resp)
+    {
+        if (nullptr != onHeaders_)
+        {
+            onHeaders_(&resp);
+        }
+    });
+    parser_.setBodyCallback(onBodyChunk_);
     client_->setConnectStatusCallback(std::bind(&HttpClient::onConnectStatus,this,std::placeholders::_1));
     client_->setMessageCallback(std::bind(&HttpClient::onMessage, this, std::placeholders::_1, std::placeholders::_2));
     client_->connect(addr);
@@ -51,11 +63,39 @@ void HttpClient::setOnResp(OnRespCallback callback)
     callback_ = callback;
 }
 
+void HttpClient::setOnHeaders(OnHeadersCallback callback)
+{
+    onHeaders_ = callback;
+}
+
+void HttpClient::setOnBodyChunk(OnBodyChunkCallback callback)
+{
+    onBodyChunk_ = callback;
+}
+
+void HttpClient::setOnComplete(OnCompleteCallback callback)
+{
+    onComplete_ = callback;
+}
+
 void HttpClient::onResp(ReqResult rst, Response* resp)
 {
-    if (nullptr != callback_)
+    //每次请求仅回调一次。
+    if (completed_)
+    {
+        return;
+    }
+    completed_ = true;
+    //回调中可能释放HttpClient，先取出回调。
+    auto callback = callback_;
+    auto onComplete = onComplete_;
+    if (nullptr != callback)
     {
-        callback_(rst, resp);
+        callback(rst, resp);
+    }
+    if (nullptr != onComplete)
+    {
+        onComplete(rst);
     }
 }
 
@@ -76,10 +116,10 @@ void HttpClient::onConnectStatus(TcpClient::ConnectStatus status)
     else
     {
         isConnected = false;
-        Response resp;
-        if (0 == resp.unpack(buffer_))
+        //以关闭连接结束的响应。
+        if (ParseResult::Success == parser_.finish())
         {
-            onResp(Success, &resp);
+            onResp(Success, &parser_.getResponse());
         }
         else
         {
@@ -90,22 +130,20 @@ void HttpClient::onConnectStatus(TcpClient::ConnectStatus status)
 
 void HttpClient::onMessage(const char* data, ssize_t size)
 {
-    unsigned bufsize = (unsigned)buffer_.size();
-    unsigned datasize = bufsize + (unsigned)size;
-    buffer_.resize(datasize);
-    char* out = (char*)buffer_.c_str() + bufsize;
-    std::copy(data, data + size, out);
-
-    Response resp;
-    auto rst = resp.unpackAndCompleted(buffer_);
+    if (completed_)
+    {
+        return;
+    }
+    //增量解析，已解析的数据不再保留。
+    size_t used = 0;
+    auto rst = parser_.parse(data, (size_t)size, used);
     if (rst == ParseResult::Success)
     {
-        onResp(Success, &resp);
+        onResp(Success, &parser_.getResponse());
     }
     else if (rst == ParseResult::Error)
     {
         uv::LogWriter::Instance()->error("parse http's response error.");
-        //解析出错
-        buffer_.clear();
+        onResp(ParseFail, nullptr);
     }
 }
@@ -0,0 +1,570 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <cstring>
+
+#include "../include/http/HttpClientPool.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+struct HttpClientPool::Pending
+{
+    std::string data;
+    bool head;
+    //GET/HEAD/PUT/DELETE/OPTIONS/TRACE，连接断开时可重发。
+    bool idempotent;
+    //已发出的幂等请求在连接断开时重发一次。
+    bool retried;
+    uint64_t start;
+    OnRespCallback callback;
+};
+
+struct HttpClientPool::Connection
+{
+    enum State
+    {
+        Disconnected,
+        Connecting,
+        Connected,
+        Closing
+    };
+    Upstream* upstream;
+    TcpClient* client;
+    State state;
+    //已完成过keep-alive响应，可pipeline。
+    bool reused;
+    uint64_t idleSince;
+    std::deque<PendingPtr> inflight;
+    ResponseParser parser;
+};
+
+struct HttpClientPool::Upstream
+{
+    Upstream(SocketAddr& address)
+        :addr(address)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+    std::string name;
+    SocketAddr addr;
+    std::deque<PendingPtr> queue;
+    //连接槽位，断开后TcpClient保留用于重连。
+    std::vector<ConnectionPtr> conns;
+    UpstreamStats stats;
+};
+
+uint64_t HttpClientPool::UpstreamStats::latencyAverage() const
+{
+    uint64_t count = 0;
+    for (int i = 0; i < LatencyBuckets; i++)
+    {
+        count += latency[i];
+    }
+    return 0 == count ? 0 : latencyTotal / count;
+}
+
+uint64_t HttpClientPool::UpstreamStats::latencyPercentile(double p) const
+{
+    uint64_t count = 0;
+    for (int i = 0; i < LatencyBuckets; i++)
+    {
+        count += latency[i];
+    }
+    if (0 == count)
+    {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(p * count);
+    if (target < 1)
+    {
+        target = 1;
+    }
+    uint64_t sum = 0;
+    for (int i = 0; i < LatencyBuckets; i++)
+    {
+        sum += latency[i];
+        if (sum >= target)
+        {
+            uint64_t bound = 1ull << i;
+            return bound < latencyMax ? bound : latencyMax;
+        }
+    }
+    return latencyMax;
+}
+
+HttpClientPool::HttpClientPool(EventLoop* loop)
+    :loop_(loop),
+    maxConnections_(8),
+    pipelining_(1),
+    idleTimeout_(60000),
+    timer_(nullptr)
+{
+}
+
+HttpClientPool::~HttpClientPool()
+{
+    if (nullptr != timer_)
+    {
+        timer_->close([](Timer* timer)
+        {
+            delete timer;
+        });
+    }
+    for (auto& it : upstreams_)
+    {
+        for (auto& conn : it.second->conns)
+        {
+            if (Connection::Connected == conn->state || Connection::Connecting == conn->state)
+            {
+                //连接中的socket及connect请求仍由libuv持有，在关闭回调中释放client。
+                conn->client->close([](TcpClient* client)
+                {
+                    delete client;
+                });
+            }
+            else if (Connection::Closing != conn->state)
+            {
+                //Closing状态的client在关闭回调中释放。
+                delete conn->client;
+            }
+        }
+    }
+}
+
+void HttpClientPool::Req(SocketAddr& addr, Request& req, OnRespCallback callback)
+{
+    auto name = addr.toStr();
+    auto it = upstreams_.find(name);
+    if (it == upstreams_.end())
+    {
+        auto upstream = std::make_shared<Upstream>(addr);
+        upstream->name = name;
+        it = upstreams_.insert(std::make_pair(name, upstream)).first;
+    }
+    auto upstream = it->second.get();
+    auto pending = std::make_shared<Pending>();
+    req.pack(pending->data);
+    auto methon = req.getMethon();
+    pending->head = methon == Methon::Head;
+    pending->idempotent = methon == Methon::Get || methon == Methon::Head || methon == Methon::Put ||
+        methon == Methon::Delete || methon == Methon::Options || methon == Methon::Trace;
+    pending->retried = false;
+    pending->start = ::uv_hrtime();
+    pending->callback = callback;
+    upstream->stats.requests++;
+    upstream->queue.push_back(pending);
+    dispatch(upstream);
+}
+
+void HttpClientPool::setMaxConnections(unsigned int size)
+{
+    maxConnections_ = size > 0 ? size : 1;
+}
+
+void HttpClientPool::setPipelining(unsigned int depth)
+{
+    pipelining_ = depth > 0 ? depth : 1;
+}
+
+void HttpClientPool::setIdleTimeout(uint64_t ms)
+{
+    idleTimeout_ = ms;
+}
+
+bool HttpClientPool::getStats(const std::string& name, UpstreamStats& stats)
+{
+    auto it = upstreams_.find(name);
+    if (it == upstreams_.end())
+    {
+        return false;
+    }
+    auto upstream = it->second.get();
+    stats = upstream->stats;
+    stats.queued = upstream->queue.size();
+    stats.connections = 0;
+    for (auto& conn : upstream->conns)
+    {
+        if (Connection::Connected == conn->state)
+        {
+            stats.connections++;
+        }
+    }
+    return true;
+}
+
+void HttpClientPool::getStats(std::map<std::string, UpstreamStats>& stats)
+{
+    for (auto& it : upstreams_)
+    {
+        getStats(it.first, stats[it.first]);
+    }
+}
+
+void HttpClientPool::dispatch(Upstream* upstream)
+{
+    while (!upstream->queue.empty())
+    {
+        //优先空闲连接，其次未完成请求最少且已确认keep-alive的连接。
+        Connection* target = nullptr;
+        for (auto& conn : upstream->conns)
+        {
+            if (Connection::Connected != conn->state)
+            {
+                continue;
+            }
+            if (conn->inflight.empty())
+            {
+                target = conn.get();
+                break;
+            }
+            if (conn->reused && conn->inflight.size() < pipelining_ &&
+                (nullptr == target || conn->inflight.size() < target->inflight.size()))
+            {
+                target = conn.get();
+            }
+        }
+        if (nullptr == target)
+        {
+            break;
+        }
+        auto pending = upstream->queue.front();
+        upstream->queue.pop_front();
+        send(target, pending);
+    }
+    uint64_t connecting = 0;
+    for (auto& conn : upstream->conns)
+    {
+        if (Connection::Connecting == conn->state)
+        {
+            connecting++;
+        }
+    }
+    while (upstream->queue.size() > connecting)
+    {
+        Connection* slot = nullptr;
+        for (auto& conn : upstream->conns)
+        {
+            if (Connection::Disconnected == conn->state)
+            {
+                slot = conn.get();
+                break;
+            }
+        }
+        if (nullptr == slot)
+        {
+            if (upstream->conns.size() >= maxConnections_)
+            {
+                break;
+            }
+            auto conn = std::make_shared<Connection>();
+            conn->upstream = upstream;
+            conn->client = new TcpClient(loop_);
+            conn->state = Connection::Disconnected;
+            conn->reused = false;
+            conn->idleSince = 0;
+            slot = conn.get();
+            conn->client->setConnectStatusCallback([this, slot](TcpClient::ConnectStatus status)
+            {
+                onConnectStatus(slot, status);
+            });
+            conn->client->setMessageCallback([this, slot](const char* data, ssize_t size)
+            {
+                onMessage(slot, data, size);
+            });
+            upstream->conns.push_back(conn);
+        }
+        slot->state = Connection::Connecting;
+        slot->reused = false;
+        upstream->stats.connects++;
+        slot->client->connect(upstream->addr);
+        connecting++;
+    }
+}
+
+void HttpClientPool::send(Connection* conn, PendingPtr pending)
+{
+    if (conn->reused)
+    {
+        conn->upstream->stats.reuses++;
+    }
+    conn->inflight.push_back(pending);
+    if (conn->inflight.size() == 1)
+    {
+        conn->parser.reset(pending->head);
+    }
+    //pending持有请求数据直至写完成。
+    conn->client->write(pending->data.c_str(), (unsigned int)pending->data.size(), [pending](WriteInfo&)
+    {
+    });
+}
+
+void HttpClientPool::closeConnection(Connection* conn)
+{
+    if (Connection::Connected != conn->state)
+    {
+        return;
+    }
+    conn->state = Connection::Closing;
+    std::deque<PendingPtr> failed;
+    requeue(conn, failed);
+    std::weak_ptr<Connection> weak;
+    for (auto& ptr : conn->upstream->conns)
+    {
+        if (ptr.get() == conn)
+        {
+            weak = ptr;
+            break;
+        }
+    }
+    conn->client->close([this, weak](TcpClient* client)
+    {
+        auto conn = weak.lock();
+        if (nullptr == conn)
+        {
+            //连接池已释放。
+            delete client;
+            return;
+        }
+        conn->state = Connection::Disconnected;
+        dispatch(conn->upstream);
+    });
+    fail(conn->upstream, failed);
+}
+
+void HttpClientPool::requeue(Connection* conn, std::deque<PendingPtr>& failed)
+{
+    //已发出的请求可能已被对端处理，只重发未重试过的幂等请求，其余由调用者以失败结束。
+    auto upstream = conn->upstream;
+    while (!conn->inflight.empty())
+    {
+        auto pending = conn->inflight.back();
+        conn->inflight.pop_back();
+        if (pending->idempotent && !pending->retried)
+        {
+            pending->retried = true;
+            upstream->queue.push_front(pending);
+        }
+        else
+        {
+            failed.push_front(pending);
+        }
+    }
+}
+
+void HttpClientPool::fail(Upstream* upstream, std::deque<PendingPtr>& failed)
+{
+    for (auto& pending : failed)
+    {
+        complete(upstream, pending, HttpClient::ConnectFail, nullptr);
+    }
+}
+
+void HttpClientPool::complete(Upstream* upstream, PendingPtr pending, HttpClient::ReqResult rst, Response* resp)
+{
+    auto& stats = upstream->stats;
+    if (HttpClient::Success == rst)
+    {
+        uint64_t latency = (::uv_hrtime() - pending->start) / 1000;
+        stats.latencyTotal += latency;
+        if (latency > stats.latencyMax)
+        {
+            stats.latencyMax = latency;
+        }
+        int index = 0;
+        while (index < UpstreamStats::LatencyBuckets - 1 && (1ull << index) <= latency)
+        {
+            index++;
+        }
+        stats.latency[index]++;
+    }
+    else
+    {
+        stats.failures++;
+    }
+    if (nullptr != pending->callback)
+    {
+        pending->callback(rst, resp);
+    }
+}
+
+void HttpClientPool::onConnectStatus(Connection* conn, TcpClient::ConnectStatus status)
+{
+    auto upstream = conn->upstream;
+    if (TcpClient::OnConnectSuccess == status)
+    {
+        conn->state = Connection::Connected;
+        conn->idleSince = ::uv_now(loop_->handle());
+        if (nullptr == timer_ && idleTimeout_ > 0)
+        {
+            uint64_t interval = idleTimeout_ / 2;
+            interval = interval < 10 ? 10 : (interval > 1000 ? 1000 : interval);
+            timer_ = new Timer(loop_, interval, interval, std::bind(&HttpClientPool::onTimer, this));
+            timer_->start();
+        }
+        dispatch(upstream);
+    }
+    else if (TcpClient::OnConnectFail == status)
+    {
+        conn->state = Connection::Disconnected;
+        bool available = false;
+        for (auto& ptr : upstream->conns)
+        {
+            if (Connection::Disconnected != ptr->state)
+            {
+                available = true;
+                break;
+            }
+        }
+        //upstream不可用，排队中的请求全部失败。
+        if (!available)
+        {
+            std::deque<PendingPtr> queue;
+            queue.swap(upstream->queue);
+            for (auto& pending : queue)
+            {
+                complete(upstream, pending, HttpClient::ConnectFail, nullptr);
+            }
+        }
+        else
+        {
+            dispatch(upstream);
+        }
+    }
+    else
+    {
+        onClosed(conn);
+    }
+}
+
+void HttpClientPool::onMessage(Connection* conn, const char* data, ssize_t size)
+{
+    auto upstream = conn->upstream;
+    size_t offset = 0;
+    while (offset < (size_t)size)
+    {
+        if (conn->inflight.empty())
+        {
+            //收到未请求的数据，连接不可再用。
+            uv::LogWriter::Instance()->error("http client pool receive unexpected data.");
+            closeConnection(conn);
+            return;
+        }
+        size_t used = 0;
+        auto rst = conn->parser.parse(data + offset, (size_t)size - offset, used);
+        offset += used;
+        if (ParseResult::Fail == rst)
+        {
+            break;
+        }
+        auto pending = conn->inflight.front();
+        conn->inflight.pop_front();
+        if (ParseResult::Error == rst)
+        {
+            uv::LogWriter::Instance()->error("parse http's response error.");
+            closeConnection(conn);
+            complete(upstream, pending, HttpClient::ParseFail, nullptr);
+            return;
+        }
+        Response resp;
+        std::swap(resp, conn->parser.getResponse());
+        bool keepAlive = conn->parser.isKeepAlive();
+        if (!conn->inflight.empty())
+        {
+            conn->parser.reset(conn->inflight.front()->head);
+        }
+        else
+        {
+            conn->idleSince = ::uv_now(loop_->handle());
+        }
+        if (keepAlive)
+        {
+            conn->reused = true;
+        }
+        else
+        {
+            closeConnection(conn);
+        }
+        complete(upstream, pending, HttpClient::Success, &resp);
+        if (!keepAlive)
+        {
+            return;
+        }
+    }
+    dispatch(upstream);
+}
+
+void HttpClientPool::onClosed(Connection* conn)
+{
+    auto upstream = conn->upstream;
+    conn->state = Connection::Disconnected;
+    PendingPtr pending = nullptr;
+    if (!conn->inflight.empty())
+    {
+        pending = conn->inflight.front();
+        conn->inflight.pop_front();
+    }
+    bool stale = conn->reused && nullptr != pending && !conn->parser.isStarted() && pending->idempotent && !pending->retried;
+    conn->reused = false;
+    std::deque<PendingPtr> failed;
+    requeue(conn, failed);
+    if (nullptr != pending)
+    {
+        if (ParseResult::Success == conn->parser.finish())
+        {
+            //以关闭连接结束的响应。
+            Response resp;
+            std::swap(resp, conn->parser.getResponse());
+            complete(upstream, pending, HttpClient::Success, &resp);
+        }
+        else if (stale)
+        {
+            //空闲连接被对端关闭，请求未被处理，重发一次。
+            pending->retried = true;
+            upstream->queue.push_front(pending);
+        }
+        else
+        {
+            complete(upstream, pending, HttpClient::ParseFail, nullptr);
+        }
+    }
+    fail(upstream, failed);
+    dispatch(upstream);
+}
+
+void HttpClientPool::onTimer()
+{
+    auto now = ::uv_now(loop_->handle());
+    bool active = false;
+    for (auto& it : upstreams_)
+    {
+        for (auto& conn : it.second->conns)
+        {
+            if (Connection::Connected == conn->state && conn->inflight.empty()
+                && now - conn->idleSince >= idleTimeout_)
+            {
+                closeConnection(conn.get());
+            }
+            if (Connection::Disconnected != conn->state)
+            {
+                active = true;
+            }
+        }
+    }
+    //无连接时释放定时器，不阻止loop退出。
+    if (!active && nullptr != timer_)
+    {
+        timer_->close([](Timer* timer)
+        {
+            delete timer;
+        });
+        timer_ = nullptr;
+    }
+}
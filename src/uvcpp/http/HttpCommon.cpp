@@ -8,6 +8,8 @@
    Description: https://github.com/wlgq2/uv-cpp
 */
 
+#include <algorithm>
+
 #include "../include/http/HttpCommon.hpp"
 
 using namespace uv;
@@ -117,3 +119,124 @@ int uv::http::AppendHead(std::string& str, std::map<std::string, std::string>& h
     heads[key] = value;
     return 0;
 }
+
+namespace
+{
+inline uint32_t RotateLeft(uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+void Sha1Block(uint32_t state[5], const unsigned char* block)
+{
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16)
+            | ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; i++)
+    {
+        w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for (int i = 0; i < 80; i++)
+    {
+        uint32_t f, k;
+        if (i < 20)
+        {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        }
+        else if (i < 40)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        }
+        else if (i < 60)
+        {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t temp = RotateLeft(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = RotateLeft(b, 30);
+        b = a;
+        a = temp;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+}
+
+void uv::http::Sha1(const char* data, uint64_t size, unsigned char digest[20])
+{
+    uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    auto input = reinterpret_cast<const unsigned char*>(data);
+    uint64_t i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        Sha1Block(state, input + i);
+    }
+    //尾部补位：0x80，补0至56字节，最后8字节为位长度(大端)。
+    unsigned char tail[128] = { 0 };
+    uint64_t rest = size - i;
+    std::copy(input + i, input + size, tail);
+    tail[rest] = 0x80;
+    uint64_t tailSize = rest < 56 ? 64 : 128;
+    uint64_t bits = size * 8;
+    for (int j = 0; j < 8; j++)
+    {
+        tail[tailSize - 1 - j] = (unsigned char)(bits >> (j * 8));
+    }
+    Sha1Block(state, tail);
+    if (tailSize == 128)
+    {
+        Sha1Block(state, tail + 64);
+    }
+    for (int j = 0; j < 5; j++)
+    {
+        digest[j * 4] = (unsigned char)(state[j] >> 24);
+        digest[j * 4 + 1] = (unsigned char)(state[j] >> 16);
+        digest[j * 4 + 2] = (unsigned char)(state[j] >> 8);
+        digest[j * 4 + 3] = (unsigned char)state[j];
+    }
+}
+
+std::string uv::http::Base64Encode(const unsigned char* data, uint64_t size)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    uint64_t i = 0;
+    for (; i + 3 <= size; i += 3)
+    {
+        uint32_t value = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        out += table[(value >> 18) & 0x3F];
+        out += table[(value >> 12) & 0x3F];
+        out += table[(value >> 6) & 0x3F];
+        out += table[value & 0x3F];
+    }
+    if (i < size)
+    {
+        uint32_t value = (uint32_t)data[i] << 16;
+        if (i + 1 < size)
+        {
+            value |= (uint32_t)data[i + 1] << 8;
+        }
+        out += table[(value >> 18) & 0x3F];
+        out += table[(value >> 12) & 0x3F];
+        out += (i + 1 < size) ? table[(value >> 6) & 0x3F] : '=';
+        out += '=';
+    }
+    return out;
+}
@@ -9,60 +9,457 @@
 */
 
 #include "../include/http/HttpServer.hpp"
+#include "../include/http/ResponseWriter.hpp"
+#include "../include/http/Http2Stream.hpp"
+#include "../include/LogWriter.hpp"
+#include "../include/Metrics.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 using namespace uv;
 using namespace uv::http;
 
+namespace
+{
+//请求超时检查间隔(ms)。
+const uint64_t RequestTimerInterval = 100;
+}
+
+//默认请求body上限16Mb。
+uint64_t uv::http::HttpServer::DefaultMaxBodySize = 16 << 20;
+
 uv::http::HttpServer::HttpServer(EventLoop* loop)
-    :uv::TcpServer(loop)
+    :HttpServer(loop, nullptr)
+{
+}
+
+uv::http::HttpServer::HttpServer(EventLoop* loop, HttpServer* parent)
+    :uv::TcpServer(loop),
+    parent_(nullptr == parent ? this : parent),
+    routes_(std::make_shared<RouteTable>()),
+    pendingRoutes_(nullptr),
+    routeVersion_(0),
+    cachedRoutes_(nullptr),
+    cachedVersion_(0),
+    threadNum_(0),
+    nextWorker_(0),
+    pending_(0),
+    maxPending_(0),
+    maxBodySize_(DefaultMaxBodySize),
+    http2_(true),
+    requestTimeout_(0),
+    timeoutCode_(Response::StatusCode::GatewayTimeout),
+    timer_(loop, RequestTimerInterval, RequestTimerInterval, std::bind(&HttpServer::onTimer, this))
 {
     setMessageCallback(std::bind(&HttpServer::onMesage,this,
         std::placeholders::_1,std::placeholders::_2,std::placeholders::_3));
 }
 
+uv::http::HttpServer::~HttpServer()
+{
+    for (auto worker : workers_)
+    {
+        auto loop = worker->loop;
+        auto server = worker->server;
+        //连接及定时器在工作loop中关闭，关闭回调执行后再停止loop，之后才能在本线程析构。
+        loop->runInThisLoop([loop, server]()
+        {
+            server->closeInLoop([loop]()
+            {
+                loop->stop();
+            });
+        });
+        worker->thread.join();
+        delete worker->server;
+        delete worker->loop;
+        delete worker;
+    }
+}
+
+int uv::http::HttpServer::bindAndListen(SocketAddr& addr)
+{
+    if (threadNum_ > 0 && workers_.empty())
+    {
+        startWorkers(addr.Ipv());
+    }
+    return TcpServer::bindAndListen(addr);
+}
+
 void uv::http::HttpServer::Get(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Get].set(path, callback);
+    addRoute(Methon::Get, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Post(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Post].set(path, callback);
+    addRoute(Methon::Post, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Head(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Head].set(path, callback);
+    addRoute(Methon::Head, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Put(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Put].set(path, callback);
+    addRoute(Methon::Put, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Delete(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Delete].set(path, callback);
+    addRoute(Methon::Delete, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Connect(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Connect].set(path, callback);
+    addRoute(Methon::Connect, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Options(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Options].set(path, callback);
+    addRoute(Methon::Options, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Trace(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Trace].set(path, callback);
+    addRoute(Methon::Trace, path, Route{ callback, nullptr });
 }
 
 void uv::http::HttpServer::Patch(std::string path, OnHttpReqCallback callback)
 {
-    route_[Methon::Patch].set(path, callback);
+    addRoute(Methon::Patch, path, Route{ callback, nullptr });
+}
+
+void uv::http::HttpServer::Stream(Methon methon, std::string path, OnHttpStreamCallback callback)
+{
+    if (methon < Methon::Invalid)
+    {
+        addRoute(methon, path, Route{ nullptr, callback });
+    }
+}
+
+void uv::http::HttpServer::Upload(Methon methon, std::string path, OnHttpBodyCallback callback)
+{
+    if (methon < Methon::Invalid)
+    {
+        addRoute(methon, path, Route{ nullptr, nullptr, nullptr, callback });
+    }
+}
+
+void uv::http::HttpServer::UploadFile(Methon methon, std::string path, OnUploadFileCallback callback, std::string dir)
+{
+    Upload(methon, path, [callback, dir](Request& req, RequestBodyPtr body, ResponseStreamPtr stream)
+    {
+        auto request = std::make_shared<Request>(req);
+        auto sink = std::make_shared<TempFileSink>(stream->getLoop(), dir);
+        sink->start(body, [callback, request, stream](int status, const std::string& path)
+        {
+            callback(*request, status, path, stream);
+        });
+    });
+}
+
+void uv::http::HttpServer::WebSocket(std::string path, OnWebSocketCallback callback)
+{
+    addRoute(Methon::Get, path, Route{ nullptr, nullptr, callback });
+}
+
+ResponseCachePtr uv::http::HttpServer::GetCached(std::string path, OnHttpReqCallback callback, ResponseCachePtr cache)
+{
+    if (nullptr == cache)
+    {
+        cache = std::make_shared<ResponseCache>();
+    }
+    Stream(Methon::Get, path, cache->wrap(callback));
+    return cache;
+}
+
+ResponseCompressorPtr uv::http::HttpServer::GetCompressed(std::string path, OnHttpReqCallback callback, ResponseCompressorPtr compressor)
+{
+    if (nullptr == compressor)
+    {
+        compressor = std::make_shared<ResponseCompressor>();
+    }
+    Stream(Methon::Get, path, compressor->wrap(callback));
+    return compressor;
+}
+
+void uv::http::HttpServer::EventSource(std::string path, OnEventStreamCallback callback)
+{
+    Stream(Methon::Get, path, [callback](Request& req, ResponseStreamPtr stream)
+    {
+        auto eventStream = std::make_shared<EventStream>(stream);
+        eventStream->open();
+        callback(req, eventStream);
+    });
+}
+
+void uv::http::HttpServer::Metrics(std::string path)
+{
+    Get(path, [](Request&, Response* resp)
+    {
+        std::string content;
+        uv::Metrics::Instance()->serialize(content);
+        resp->setStatus(Response::StatusCode::OK, "OK");
+        resp->appendHead("Content-Type", uv::Metrics::ContentType);
+        resp->swapContent(content);
+    });
+}
+
+StaticFileHandlerPtr uv::http::HttpServer::Static(std::string path, std::string root)
+{
+    auto handler = std::make_shared<StaticFileHandler>(path, root);
+    auto callback = std::bind(&StaticFileHandler::handle, handler, std::placeholders::_1, std::placeholders::_2);
+    Stream(Methon::Get, path + "*", callback);
+    Stream(Methon::Head, path + "*", callback);
+    return handler;
+}
+
+void uv::http::HttpServer::setRequestTimeout(uint64_t ms, Response::StatusCode code)
+{
+    requestTimeout_ = ms;
+    timeoutCode_ = code;
+    //timer_属于本loop，在loop线程中启停。
+    loop_->runInThisLoop([this, ms]()
+    {
+        if (ms > 0)
+        {
+            timer_.start();
+        }
+        else
+        {
+            timer_.stop();
+        }
+    });
+    for (auto worker : workers_)
+    {
+        auto server = worker->server;
+        worker->loop->runInThisLoop([server, ms, code]()
+        {
+            server->setRequestTimeout(ms, code);
+        });
+    }
+}
+
+void uv::http::HttpServer::setMaxPendingRequests(uint64_t size)
+{
+    maxPending_ = size;
+    for (auto worker : workers_)
+    {
+        auto server = worker->server;
+        worker->loop->runInThisLoop([server, size]()
+        {
+            server->setMaxPendingRequests(size);
+        });
+    }
+}
+
+void uv::http::HttpServer::setHttp2(bool enable)
+{
+    http2_ = enable;
+    for (auto worker : workers_)
+    {
+        auto server = worker->server;
+        worker->loop->runInThisLoop([server, enable]()
+        {
+            server->setHttp2(enable);
+        });
+    }
+}
+
+void uv::http::HttpServer::setMaxBodySize(uint64_t size)
+{
+    maxBodySize_ = size;
+    for (auto worker : workers_)
+    {
+        auto server = worker->server;
+        worker->loop->runInThisLoop([server, size]()
+        {
+            server->setMaxBodySize(size);
+        });
+    }
+}
+
+uint64_t uv::http::HttpServer::PendingRequests()
+{
+    uint64_t pending = pending_;
+    for (auto worker : workers_)
+    {
+        pending += worker->server->PendingRequests();
+    }
+    return pending;
+}
+
+RouteTablePtr uv::http::HttpServer::getRoutes()
+{
+    if (parent_ != this)
+    {
+        return parent_->getRoutes();
+    }
+    std::lock_guard<std::mutex> lock(routeMutex_);
+    if (nullptr != pendingRoutes_)
+    {
+        routes_ = pendingRoutes_;
+        pendingRoutes_ = nullptr;
+    }
+    return routes_;
+}
+
+void uv::http::HttpServer::setRoutes(RouteTablePtr routes)
+{
+    if (parent_ != this)
+    {
+        parent_->setRoutes(routes);
+        return;
+    }
+    if (nullptr == routes)
+    {
+        routes = std::make_shared<RouteTable>();
+    }
+    std::lock_guard<std::mutex> lock(routeMutex_);
+    pendingRoutes_ = nullptr;
+    routes_ = routes;
+    routeVersion_.fetch_add(1, std::memory_order_release);
+}
+
+void uv::http::HttpServer::setThreadNum(unsigned int num)
+{
+#ifdef _WIN32
+    if (num > 0)
+    {
+        uv::LogWriter::Instance()->warn("http server multi loop mode is not supported on windows.");
+    }
+#else
+    threadNum_ = num;
+#endif
+}
+
+void uv::http::HttpServer::onAccept(EventLoop* loop, UVTcpPtr client)
+{
+#ifndef _WIN32
+    if (!workers_.empty())
+    {
+        //复制socket后关闭本loop中的句柄，由工作loop以复制的fd重新打开。
+        uv_os_fd_t fd;
+        int sock = -1;
+        if (0 == ::uv_fileno((uv_handle_t*)client.get(), &fd))
+        {
+            sock = ::dup(fd);
+        }
+        client->data = new UVTcpPtr(client);
+        ::uv_close((uv_handle_t*)client.get(), [](uv_handle_t* handle)
+        {
+            delete static_cast<UVTcpPtr*>(handle->data);
+        });
+        if (sock < 0)
+        {
+            uv::LogWriter::Instance()->error("dispatch connection fail.");
+            return;
+        }
+        auto worker = workers_[nextWorker_++ % workers_.size()];
+        auto server = worker->server;
+        worker->loop->runInThisLoop([server, sock]()
+        {
+            server->adopt(sock);
+        });
+        return;
+    }
+#endif
+    TcpServer::onAccept(loop, client);
+}
+
+void uv::http::HttpServer::addRoute(Methon methon, std::string& path, const Route& route)
+{
+    if (parent_ != this)
+    {
+        parent_->addRoute(methon, path, route);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(routeMutex_);
+    //已发布的表可能正被其他loop查询，只在发布后的第一次注册时复制。
+    if (nullptr == pendingRoutes_)
+    {
+        pendingRoutes_ = std::make_shared<RouteTable>(*routes_);
+    }
+    pendingRoutes_->set(methon, path, route);
+    routeVersion_.fetch_add(1, std::memory_order_release);
+}
+
+const RouteTablePtr& uv::http::HttpServer::currentRoutes()
+{
+    auto version = parent_->routeVersion_.load(std::memory_order_acquire);
+    if (nullptr == cachedRoutes_ || version != cachedVersion_)
+    {
+        cachedRoutes_ = parent_->getRoutes();
+        cachedVersion_ = version;
+    }
+    return cachedRoutes_;
+}
+
+void uv::http::HttpServer::startWorkers(SocketAddr::IPV ipv)
+{
+    for (unsigned int i = 0; i < threadNum_; i++)
+    {
+        auto worker = new Worker();
+        worker->loop = new EventLoop();
+        worker->server = new HttpServer(worker->loop, this);
+        worker->server->setTimeout(getTimeoutMs(), getTimeoutResolution());
+        worker->server->setWriteLimits(writeDeadline_, writeQueueLimit_, evictSlowConsumer_);
+        worker->server->setSlowConsumerCallback(onSlowConsumerCallback_);
+        worker->server->setMaxPendingRequests(maxPending_);
+        worker->server->setHttp2(http2_);
+        worker->server->setMaxBodySize(maxBodySize_);
+        worker->server->setRequestTimeout(requestTimeout_, timeoutCode_);
+        worker->server->prepareAccept(ipv);
+        auto loop = worker->loop;
+        worker->thread = std::thread([loop]()
+        {
+            loop->run();
+        });
+        workers_.push_back(worker);
+    }
+}
+
+void uv::http::HttpServer::closeInLoop(DefaultCallback callback)
+{
+    auto pending = std::make_shared<int>(2);
+    auto onClosed = [pending, callback]()
+    {
+        if (0 == --(*pending))
+        {
+            callback();
+        }
+    };
+    timer_.close([onClosed](Timer*)
+    {
+        onClosed();
+    });
+    closeConnections(onClosed);
+}
+
+void uv::http::HttpServer::adopt(uv_os_sock_t sock)
+{
+    UVTcpPtr client = std::make_shared<uv_tcp_t>();
+    ::uv_tcp_init(loop_->handle(), client.get());
+    if (0 != ::uv_tcp_open(client.get(), sock))
+    {
+        uv::LogWriter::Instance()->error("open dispatched connection fail.");
+#ifndef _WIN32
+        ::close(sock);
+#endif
+        client->data = new UVTcpPtr(client);
+        ::uv_close((uv_handle_t*)client.get(), [](uv_handle_t* handle)
+        {
+            delete static_cast<UVTcpPtr*>(handle->data);
+        });
+        return;
+    }
+    TcpServer::onAccept(loop_, client);
 }
 
 void uv::http::HttpServer::onMesage(TcpConnectionPtr conn, const char* data, ssize_t size)
@@ -73,37 +470,439 @@ void uv::http::HttpServer::onMesage(TcpConnectionPtr conn, const char* data, ssi
         uv::LogWriter::Instance()->error("http server need use data buffer.");
         return;
     }
-    packetbuf->append(data, size);
+    auto session = std::static_pointer_cast<HttpSession>(conn->getContext());
+    if (nullptr == session)
+    {
+        session = std::make_shared<HttpSession>();
+        conn->setContext(session);
+    }
+    auto webSocket = session->getWebSocket();
+    if (nullptr != webSocket)
+    {
+        webSocket->onData(data, size);
+        return;
+    }
+    auto http2 = session->getHttp2();
+    if (nullptr != http2)
+    {
+        http2->onData(data, size);
+        return;
+    }
+    auto incoming = session->getIncoming();
+    if (nullptr != incoming)
+    {
+        auto used = feedBody(session, incoming, data, size);
+        if (used < (uint64_t)size)
+        {
+            //body之后的数据属于下一个请求。
+            onMesage(conn, data + used, size - used);
+        }
+        return;
+    }
+    //已决定关闭连接，忽略后续请求。
+    if (session->isClosing())
+    {
+        return;
+    }
+    //packet buffer仅保存不完整的消息头，本次数据直接拼接解析，不受缓存大小限制。
     std::string out;
     packetbuf->readBufferN(out, packetbuf->readSize());
-    Request req;
-    auto rst = req.unpackAndCompleted(out);
-    if (ParseResult::Error == rst)
+    packetbuf->clear();
+    out.append(data, size);
+    if (http2_ && 0 == session->size())
     {
-        //parse error,clear buffer.
-        packetbuf->clear();
+        //prior knowledge：以Http2 preface开头，不完整时等待后续数据。
+        auto rst = Http2Session::MatchPreface(out.c_str(), out.size());
+        if (0 == rst)
+        {
+            packetbuf->append(out.c_str(), out.size());
+            return;
+        }
+        if (1 == rst)
+        {
+            http2 = createHttp2(conn, session);
+            http2->start();
+            http2->onData(out.c_str(), out.size());
+            return;
+        }
     }
-    else if (ParseResult::Success == rst)
+    //同一次读取可能包含多个pipeline请求。
+    while (!session->isClosing() && !out.empty())
     {
-        packetbuf->clear();
-        //搜寻回调函数
-        OnHttpReqCallback callback(nullptr);
-        if (route_[req.getMethon()].get(req.getPath(), callback))
+        Request req;
+        uint64_t length = 0;
+        auto rst = req.unpack(out);
+        if (ParseResult::Error == rst || (ParseResult::Success == rst && 0 != req.getContentLength(length)))
+        {
+            onBadRequest(conn, session);
+            return;
+        }
+        if (ParseResult::Fail == rst)
         {
-            if (nullptr != callback)
+            break;
+        }
+        if (maxBodySize_ > 0 && length > maxBodySize_)
+        {
+            //依据Content-Length拒绝，不再读取body。
+            onBadRequest(conn, session, Response::StatusCode::PayloadTooLarge);
+            return;
+        }
+        std::string content;
+        req.swapContent(content);
+        uint64_t headSize = out.size() - content.size();
+        if (content.size() < length)
+        {
+            //body未收全：已到达部分及后续数据分块交付，不经packet buffer缓存。
+            beginBody(conn, session, req, length, content);
+            return;
+        }
+        content.resize(length);
+        req.swapContent(content);
+        out.erase(0, headSize + length);
+        onRequest(conn, session, req);
+        webSocket = session->getWebSocket();
+        if (nullptr != webSocket)
+        {
+            //升级请求之后的数据属于WebSocket帧。
+            if (!out.empty())
+            {
+                webSocket->onData(out.c_str(), out.size());
+            }
+            return;
+        }
+        http2 = session->getHttp2();
+        if (nullptr != http2)
+        {
+            //101之后的数据为客户端Http2 preface及帧。
+            if (!out.empty())
             {
-                Response resp;
-                callback(req, &resp);
-                std::string respData;
-                resp.pack(respData);
-                std::string connName = conn->Name();
-                conn->write(respData.c_str(), respData.size(), [this, connName](WriteInfo&)
-                {
-                    closeConnection(connName);
-                });
+                http2->onData(out.c_str(), out.size());
+            }
+            return;
+        }
+    }
+    if (!session->isClosing() && !out.empty() && 0 != packetbuf->append(out.c_str(), out.size()))
+    {
+        //消息头超过缓存大小。
+        onBadRequest(conn, session, Response::StatusCode::RequestHeaderFieldsTooLarge);
+    }
+}
+
+void uv::http::HttpServer::onRequest(TcpConnectionPtr conn, HttpSessionPtr session, Request& req, RequestBodyPtr body)
+{
+    //搜寻回调函数
+    Route route;
+    bool found = currentRoutes()->get(req.getMethon(), req.getPath(), route);
+    if (found && nullptr != route.webSocketCallback && upgrade(conn, session, req, route.webSocketCallback))
+    {
+        return;
+    }
+    if (http2_ && 0 == session->size() && Http2Session::IsUpgradeRequest(req))
+    {
+        upgradeHttp2(conn, session, req);
+        return;
+    }
+    auto stream = std::make_shared<ResponseStream>(loop_, conn, req.getVersion());
+    stream->setKeepAlive(req.isKeepAlive());
+    if (!stream->isKeepAlive())
+    {
+        session->setClosing();
+    }
+    DeadlineIterator deadline;
+    bool tracked = track(stream, deadline, nullptr == body);
+    std::weak_ptr<HttpSession> weakSession = session;
+    std::string connName = conn->Name();
+    auto ptr = stream.get();
+    stream->setCompleteCallback([this, weakSession, connName, ptr, tracked, deadline]() mutable
+    {
+        onResponseComplete(weakSession, connName, ptr, tracked, deadline);
+    });
+    if (session->push(stream))
+    {
+        stream->activate();
+    }
+    dispatch(req, stream, found, route, body);
+}
 
+void uv::http::HttpServer::dispatch(Request& req, ResponseStreamPtr stream, bool found, Route& route, RequestBodyPtr body)
+{
+    if (nullptr != body)
+    {
+        //未交给body路由时丢弃后续body。
+        body->onBodyChunk([](const char*, size_t)
+        {
+        });
+    }
+    static auto requests = uv::Metrics::Instance()->counter("uvcpp_http_requests_total", "Http requests dispatched (http/1.x and http/2).");
+    requests->inc();
+    if (maxPending_ > 0 && pending_ > maxPending_)
+    {
+        stream->sendStatus(Response::StatusCode::ServerUnavailable);
+        return;
+    }
+    if (!found)
+    {
+        stream->sendStatus(Response::StatusCode::NotFound);
+    }
+    else if (nullptr != route.callback)
+    {
+        Response resp(req.getVersion(), Response::StatusCode::OK);
+        route.callback(req, &resp);
+        stream->send(resp);
+    }
+    else if (nullptr != route.streamCallback)
+    {
+        route.streamCallback(req, stream);
+    }
+    else if (nullptr != route.bodyCallback && nullptr != body)
+    {
+        body->onBodyChunk(nullptr);
+        route.bodyCallback(req, body, stream);
+    }
+    else if (nullptr != route.bodyCallback)
+    {
+        //body已完整接收(如Http2)，一次交付。
+        std::string content;
+        req.swapContent(content);
+        body = std::make_shared<RequestBody>(nullptr, content.size());
+        route.bodyCallback(req, body, stream);
+        body->append(content.c_str(), content.size());
+        body->complete(0);
+    }
+    else
+    {
+        //WebSocket路由收到非升级请求。
+        stream->sendStatus(Response::StatusCode::BadRequest);
+    }
+}
+
+bool uv::http::HttpServer::track(ResponseStreamPtr stream, DeadlineIterator& deadline, bool timed)
+{
+    pending_++;
+    if (0 == requestTimeout_ || !timed)
+    {
+        return false;
+    }
+    deadline = deadlines_.insert(deadlines_.end(),
+        Deadline{ uv_now(loop_->handle()) + requestTimeout_, stream, false });
+    return true;
+}
+
+void uv::http::HttpServer::untrack(bool tracked, DeadlineIterator deadline)
+{
+    pending_--;
+    if (tracked)
+    {
+        if (deadline->expired)
+        {
+            expired_.erase(deadline);
+        }
+        else
+        {
+            deadlines_.erase(deadline);
+        }
+    }
+}
+
+void uv::http::HttpServer::onResponseComplete(std::weak_ptr<HttpSession> weakSession, std::string& name,
+    ResponseStream* stream, bool tracked, DeadlineIterator deadline)
+{
+    untrack(tracked, deadline);
+    auto session = weakSession.lock();
+    if (nullptr == session)
+    {
+        return;
+    }
+    bool keepAlive = stream->isKeepAlive() && !stream->isClosed();
+    auto next = session->complete(stream);
+    if (!keepAlive)
+    {
+        closeConnection(name);
+    }
+    else if (nullptr != next)
+    {
+        next->activate();
+    }
+}
+
+void uv::http::HttpServer::onBadRequest(TcpConnectionPtr conn, HttpSessionPtr session, Response::StatusCode code)
+{
+    auto stream = std::make_shared<ResponseStream>(loop_, conn, HttpVersion::Http1_1);
+    session->setClosing();
+    std::weak_ptr<HttpSession> weakSession = session;
+    std::string connName = conn->Name();
+    auto ptr = stream.get();
+    stream->setCompleteCallback([this, weakSession, connName, ptr]() mutable
+    {
+        onResponseComplete(weakSession, connName, ptr, false, DeadlineIterator());
+    });
+    pending_++;
+    if (session->push(stream))
+    {
+        stream->activate();
+    }
+    stream->sendStatus(code);
+}
+
+void uv::http::HttpServer::beginBody(TcpConnectionPtr conn, HttpSessionPtr session, Request& req, uint64_t length, std::string& partial)
+{
+    auto body = std::make_shared<RequestBody>(conn, length);
+    session->setIncoming(body);
+    auto expect = req.getHead("Expect");
+    if (expect.empty())
+    {
+        expect = req.getHead("expect");
+    }
+    std::transform(expect.begin(), expect.end(), expect.begin(), ::tolower);
+    if (expect.find("100-continue") != std::string::npos && partial.empty())
+    {
+        //客户端等待100 Continue后再发送body。
+        static const char Continue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        conn->write(Continue, sizeof(Continue) - 1, nullptr);
+    }
+    Route route;
+    if (currentRoutes()->get(req.getMethon(), req.getPath(), route) && nullptr != route.bodyCallback)
+    {
+        onRequest(conn, session, req, body);
+    }
+    else
+    {
+        //普通路由：body接收完整后再按原流程处理。
+        auto request = std::make_shared<Request>(req);
+        auto content = std::make_shared<std::string>();
+        body->onBodyChunk([content](const char* data, size_t size)
+        {
+            content->append(data, size);
+        });
+        std::weak_ptr<TcpConnection> weakConn = conn;
+        std::weak_ptr<HttpSession> weakSession = session;
+        body->onEnd([this, weakConn, weakSession, request, content](int status)
+        {
+            auto conn = weakConn.lock();
+            auto session = weakSession.lock();
+            if (0 != status || nullptr == conn || nullptr == session)
+            {
+                return;
             }
+            request->swapContent(*content);
+            onRequest(conn, session, *request);
+        });
+    }
+    feedBody(session, body, partial.c_str(), partial.size());
+}
+
+uint64_t uv::http::HttpServer::feedBody(HttpSessionPtr session, RequestBodyPtr body, const char* data, uint64_t size)
+{
+    uint64_t remain = body->getContentLength() - body->getReceived();
+    uint64_t used = size < remain ? size : remain;
+    body->append(data, (size_t)used);
+    if (used == remain)
+    {
+        session->setIncoming(nullptr);
+        body->complete(0);
+    }
+    return used;
+}
+
+bool uv::http::HttpServer::upgrade(TcpConnectionPtr conn, HttpSessionPtr session, Request& req, OnWebSocketCallback& callback)
+{
+    //pipeline中仍有未完成的响应时不升级。
+    if (session->size() > 0 || !WebSocketSession::IsUpgradeRequest(req))
+    {
+        return false;
+    }
+    auto key = req.getHead("Sec-WebSocket-Key");
+    if (key.empty())
+    {
+        key = req.getHead("sec-websocket-key");
+    }
+    Response resp(HttpVersion::Http1_1, Response::StatusCode::SwitchingProtocols);
+    resp.setStatus(Response::StatusCode::SwitchingProtocols, "Switching Protocols");
+    resp.appendHead("Upgrade", "websocket");
+    resp.appendHead("Connection", "Upgrade");
+    resp.appendHead("Sec-WebSocket-Accept", WebSocketSession::AcceptKey(key));
+    ResponseWriter::Write(conn, resp, nullptr);
+
+    auto webSocket = std::make_shared<WebSocketSession>(loop_, conn);
+    std::string connName = conn->Name();
+    webSocket->setCloseConnectionCallback([this, connName]()
+    {
+        closeConnection(connName);
+    });
+    session->setWebSocket(webSocket);
+    session->setClosing();
+    callback(req, webSocket);
+    return true;
+}
+
+Http2SessionPtr uv::http::HttpServer::createHttp2(TcpConnectionPtr conn, HttpSessionPtr session)
+{
+    auto http2 = std::make_shared<Http2Session>(loop_, conn);
+    http2->setMaxRequestSize(maxBodySize_ > 0 ? maxBodySize_ : std::numeric_limits<uint64_t>::max());
+    std::string connName = conn->Name();
+    http2->setRequestCallback([this](Request& req, ResponseStreamPtr stream)
+    {
+        onHttp2Request(req, stream);
+    });
+    http2->setCloseConnectionCallback([this, connName]()
+    {
+        closeConnection(connName);
+    });
+    session->setHttp2(http2);
+    session->setClosing();
+    return http2;
+}
+
+void uv::http::HttpServer::upgradeHttp2(TcpConnectionPtr conn, HttpSessionPtr session, Request& req)
+{
+    auto settings = req.getHead("HTTP2-Settings");
+    if (settings.empty())
+    {
+        settings = req.getHead("http2-settings");
+    }
+    Response resp(HttpVersion::Http1_1, Response::StatusCode::SwitchingProtocols);
+    resp.setStatus(Response::StatusCode::SwitchingProtocols, "Switching Protocols");
+    resp.appendHead("Connection", "Upgrade");
+    resp.appendHead("Upgrade", "h2c");
+    ResponseWriter::Write(conn, resp, nullptr);
+
+    //升级请求作为stream 1处理。
+    auto http2 = createHttp2(conn, session);
+    if (0 != http2->startUpgrade(settings, req))
+    {
+        uv::LogWriter::Instance()->warn("invalid HTTP2-Settings in h2c upgrade.");
+        closeConnection(conn->Name());
+    }
+}
+
+void uv::http::HttpServer::onHttp2Request(Request& req, ResponseStreamPtr stream)
+{
+    Route route;
+    bool found = currentRoutes()->get(req.getMethon(), req.getPath(), route);
+    //各stream独立响应，无pipeline顺序。
+    DeadlineIterator deadline;
+    bool tracked = track(stream, deadline);
+    stream->setCompleteCallback([this, tracked, deadline]()
+    {
+        untrack(tracked, deadline);
+    });
+    stream->activate();
+    dispatch(req, stream, found, route);
+}
+
+void uv::http::HttpServer::onTimer()
+{
+    auto now = uv_now(loop_->handle());
+    while (!deadlines_.empty() && deadlines_.front().time <= now)
+    {
+        auto it = deadlines_.begin();
+        it->expired = true;
+        auto stream = it->stream.lock();
+        expired_.splice(expired_.end(), deadlines_, it);
+        //处理函数已开始响应但未end()时无法再应答，放弃响应，否则连接及其后pipeline的请求一直等待。
+        if (nullptr != stream && !stream->sendStatus(timeoutCode_) && !stream->isEnded())
+        {
+            stream->cancel();
         }
     }
-    else ; //parse fail.
-}
\ No newline at end of file
+}
@@ -0,0 +1,120 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/HttpSession.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+HttpSession::HttpSession()
+    :closing_(false),
+    webSocket_(nullptr),
+    http2_(nullptr),
+    incoming_(nullptr)
+{
+}
+
+HttpSession::~HttpSession()
+{
+    //连接已关闭，未完成的请求body及响应直接结束。
+    if (nullptr != incoming_)
+    {
+        auto incoming = incoming_;
+        incoming_ = nullptr;
+        incoming->complete(WriteInfo::Disconnected);
+    }
+    std::deque<ResponseStreamPtr> pipeline;
+    pipeline.swap(pipeline_);
+    for (auto& stream : pipeline)
+    {
+        stream->abort();
+    }
+    if (nullptr != webSocket_)
+    {
+        webSocket_->onDisconnected();
+    }
+    if (nullptr != http2_)
+    {
+        http2_->onDisconnected();
+    }
+}
+
+bool HttpSession::push(ResponseStreamPtr stream)
+{
+    pipeline_.push_back(stream);
+    return pipeline_.size() == 1;
+}
+
+ResponseStreamPtr HttpSession::complete(ResponseStream* stream)
+{
+    if (pipeline_.empty())
+    {
+        return nullptr;
+    }
+    if (pipeline_.front().get() == stream)
+    {
+        pipeline_.pop_front();
+        return pipeline_.empty() ? nullptr : pipeline_.front();
+    }
+    for (auto it = pipeline_.begin(); it != pipeline_.end(); it++)
+    {
+        if (it->get() == stream)
+        {
+            pipeline_.erase(it);
+            break;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t HttpSession::size()
+{
+    return pipeline_.size();
+}
+
+void HttpSession::setClosing()
+{
+    closing_ = true;
+}
+
+bool HttpSession::isClosing()
+{
+    return closing_;
+}
+
+void HttpSession::setWebSocket(WebSocketSessionPtr session)
+{
+    webSocket_ = session;
+}
+
+WebSocketSessionPtr HttpSession::getWebSocket()
+{
+    return webSocket_;
+}
+
+void HttpSession::setHttp2(Http2SessionPtr session)
+{
+    http2_ = session;
+}
+
+Http2SessionPtr HttpSession::getHttp2()
+{
+    return http2_;
+}
+
+void HttpSession::setIncoming(RequestBodyPtr body)
+{
+    incoming_ = body;
+}
+
+RequestBodyPtr HttpSession::getIncoming()
+{
+    return incoming_;
+}
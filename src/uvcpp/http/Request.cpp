@@ -109,6 +109,11 @@ void Request::setPath(std::string& path)
     path_ = path;
 }
 
+int Request::parseUrl(std::string& url)
+{
+    return unpackPath(url);
+}
+
 const std::string& Request::getValue()
 {
     return value_;
@@ -209,6 +214,69 @@ ParseResult Request::unpackAndCompleted(std::string & data)
     return rst;
 }
 
+ParseResult Request::unpackAndCompleted(std::string& data, uint64_t& size)
+{
+    auto rst = unpack(data);
+    if (rst != ParseResult::Success)
+    {
+        return rst;
+    }
+    uint64_t headSize = data.size() - content_.size();
+    uint64_t length = 0;
+    if (0 != getContentLength(length))
+    {
+        return ParseResult::Error;
+    }
+    if (content_.size() < length)
+    {
+        return ParseResult::Fail;
+    }
+    content_.resize(length);
+    size = headSize + length;
+    return ParseResult::Success;
+}
+
+int Request::getContentLength(uint64_t& length)
+{
+    length = 0;
+    auto it = heads_.find("Content-Length");
+    if (it == heads_.end())
+    {
+        it = heads_.find("content-length");
+    }
+    if (it == heads_.end())
+    {
+        return 0;
+    }
+    try
+    {
+        length = std::stoull(it->second);
+    }
+    catch (...)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+bool Request::isKeepAlive()
+{
+    std::string value = getHead("Connection");
+    if (value.empty())
+    {
+        value = getHead("connection");
+    }
+    for (auto& ch : value)
+    {
+        ch = ::tolower((unsigned char)ch);
+    }
+    if (version_ == HttpVersion::Http1_0)
+    {
+        return value.find("keep-alive") != value.npos;
+    }
+    return value.find("close") == value.npos;
+}
+
 std::string Request::MethonToStr(Methon methon)
 {
     switch (methon)
@@ -0,0 +1,142 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/RequestBody.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+RequestBody::RequestBody(TcpConnectionPtr connection, uint64_t length)
+    :connection_(connection),
+    length_(length),
+    received_(0),
+    paused_(false),
+    completed_(false),
+    status_(0),
+    onChunk_(nullptr),
+    onEnd_(nullptr)
+{
+}
+
+RequestBody::~RequestBody()
+{
+}
+
+void RequestBody::onBodyChunk(OnBodyChunkCallback callback)
+{
+    onChunk_ = callback;
+    if (nullptr != onChunk_ && !pending_.empty())
+    {
+        std::string data;
+        data.swap(pending_);
+        onChunk_(data.c_str(), data.size());
+    }
+    notifyEnd();
+}
+
+void RequestBody::onEnd(OnBodyEndCallback callback)
+{
+    onEnd_ = callback;
+    notifyEnd();
+}
+
+void RequestBody::pause()
+{
+    if (paused_ || completed_)
+    {
+        return;
+    }
+    paused_ = true;
+    auto connection = connection_.lock();
+    if (nullptr != connection)
+    {
+        connection->pauseRead();
+    }
+}
+
+void RequestBody::resume()
+{
+    if (!paused_)
+    {
+        return;
+    }
+    paused_ = false;
+    auto connection = connection_.lock();
+    if (nullptr != connection)
+    {
+        connection->resumeRead();
+    }
+}
+
+bool RequestBody::isPaused()
+{
+    return paused_;
+}
+
+uint64_t RequestBody::getContentLength()
+{
+    return length_;
+}
+
+uint64_t RequestBody::getReceived()
+{
+    return received_;
+}
+
+bool RequestBody::isCompleted()
+{
+    return completed_;
+}
+
+void RequestBody::append(const char* data, size_t size)
+{
+    if (completed_ || 0 == size)
+    {
+        return;
+    }
+    received_ += size;
+    if (nullptr == onChunk_)
+    {
+        pending_.append(data, size);
+        return;
+    }
+    onChunk_(data, size);
+}
+
+void RequestBody::complete(int status)
+{
+    if (completed_)
+    {
+        return;
+    }
+    completed_ = true;
+    status_ = status;
+    if (0 != status)
+    {
+        pending_.clear();
+    }
+    //body已结束，恢复读取以处理后续请求。
+    resume();
+    notifyEnd();
+}
+
+void RequestBody::notifyEnd()
+{
+    //结束且暂存数据已交付后回调一次。
+    if (!completed_ || !pending_.empty() || nullptr == onEnd_)
+    {
+        return;
+    }
+    auto self = shared_from_this();
+    auto end = onEnd_;
+    onEnd_ = nullptr;
+    onChunk_ = nullptr;
+    end(status_);
+}
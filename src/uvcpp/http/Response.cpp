@@ -71,6 +71,16 @@ std::string Response::getHead(std::string& key)
     return it->second;
 }
 
+void Response::removeHead(const std::string& key)
+{
+    heads_.erase(key);
+}
+
+const std::map<std::string, std::string>& Response::getHeads()
+{
+    return heads_;
+}
+
 void Response::swapContent(std::string& body)
 {
     content_.swap(body);
@@ -0,0 +1,334 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+
+#include "../include/http/ResponseCache.hpp"
+#include "../include/http/ResponseWriter.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+//默认32Mb，有效期1秒。
+uint64_t ResponseCache::DefaultMaxBytes = 32 * 1024 * 1024;
+uint64_t ResponseCache::DefaultTtl = 1000;
+
+namespace
+{
+std::string GetHead(Request& req, const std::string& key)
+{
+    auto value = req.getHead(std::string(key));
+    if (value.empty())
+    {
+        std::string lowerKey(key);
+        std::transform(lowerKey.begin(), lowerKey.end(), lowerKey.begin(),
+            [](unsigned char ch) { return (char)::tolower(ch); });
+        value = req.getHead(lowerKey);
+    }
+    return value;
+}
+
+std::string GetCacheControl(Response& resp)
+{
+    std::string key("Cache-Control");
+    auto value = resp.getHead(key);
+    if (value.empty())
+    {
+        key = "cache-control";
+        value = resp.getHead(key);
+    }
+    std::transform(value.begin(), value.end(), value.begin(),
+        [](unsigned char ch) { return (char)::tolower(ch); });
+    return value;
+}
+
+//返回-1表示未指定该指令。
+int64_t GetDirectiveSeconds(const std::string& value, const char* directive)
+{
+    auto pos = value.find(directive);
+    if (pos == value.npos)
+    {
+        return -1;
+    }
+    pos += std::char_traits<char>::length(directive);
+    if (pos >= value.size() || value[pos] != '=')
+    {
+        return -1;
+    }
+    try
+    {
+        return std::stoll(value.substr(pos + 1));
+    }
+    catch (...)
+    {
+        return -1;
+    }
+}
+
+bool IsCacheableStatus(Response::StatusCode code)
+{
+    switch (code)
+    {
+    case Response::StatusCode::OK:
+    case Response::StatusCode::NoContent:
+    case Response::StatusCode::MovedPermanently:
+    case Response::StatusCode::NotFound:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+ResponseCache::ResponseCache(uint64_t maxBytes, uint64_t ttlMs)
+    :maxBytes_(maxBytes),
+    maxEntrySize_(maxBytes / 8),
+    ttl_(ttlMs),
+    bytes_(0),
+    stats_{ 0, 0, 0, 0, 0, 0, 0 }
+{
+}
+
+void ResponseCache::setMaxBytes(uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_ = size;
+    while (bytes_ > maxBytes_ && !entries_.empty())
+    {
+        erase(std::prev(entries_.end()));
+        stats_.evictions++;
+    }
+}
+
+void ResponseCache::setMaxEntrySize(uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxEntrySize_ = size;
+}
+
+void ResponseCache::setDefaultTtl(uint64_t ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_ = ms;
+}
+
+void ResponseCache::setKeyParams(const std::vector<std::string>& params)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    keyParams_ = params;
+}
+
+void ResponseCache::setKeyHeads(const std::vector<std::string>& heads)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    keyHeads_ = heads;
+}
+
+ResponseCache::OnHttpStreamCallback ResponseCache::wrap(OnHttpReqCallback handler)
+{
+    return wrapDeferred([handler](Request& req, ResponseDone done)
+    {
+        Response resp(HttpVersion::Http1_1, Response::StatusCode::OK);
+        handler(req, &resp);
+        done(resp);
+    });
+}
+
+ResponseCache::OnHttpStreamCallback ResponseCache::wrapDeferred(OnDeferredCallback handler)
+{
+    auto self = shared_from_this();
+    return [self, handler](Request& req, ResponseStreamPtr stream) mutable
+    {
+        self->handle(req, stream, handler);
+    };
+}
+
+void ResponseCache::handle(Request& req, ResponseStreamPtr stream, OnDeferredCallback& handler)
+{
+    //客户端要求重新验证时跳过查找，结果仍写入缓存。
+    auto requestControl = GetHead(req, "Cache-Control");
+    bool refresh = requestControl.find("no-cache") != requestControl.npos;
+    std::string key = makeKey(req);
+    std::shared_ptr<std::string> head;
+    std::shared_ptr<std::string> body;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end() && !refresh)
+        {
+            if (it->second->expire > Now())
+            {
+                stats_.hits++;
+                entries_.splice(entries_.begin(), entries_, it->second);
+                head = it->second->head;
+                body = it->second->body;
+            }
+            else
+            {
+                stats_.expired++;
+                erase(it->second);
+            }
+        }
+        if (nullptr == head)
+        {
+            auto flight = flights_.find(key);
+            if (flight != flights_.end())
+            {
+                stats_.coalesced++;
+                flight->second.push_back(stream);
+                return;
+            }
+            stats_.misses++;
+            flights_[key].push_back(stream);
+        }
+    }
+    if (nullptr != head)
+    {
+        stream->sendSerialized(head, body);
+        return;
+    }
+    auto self = shared_from_this();
+    auto called = std::make_shared<std::atomic<bool>>(false);
+    handler(req, [self, key, called](Response& resp)
+    {
+        if (!called->exchange(true))
+        {
+            self->complete(key, resp);
+        }
+    });
+}
+
+void ResponseCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+void ResponseCache::getStats(Stats& stats)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats = stats_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+}
+
+std::string ResponseCache::makeKey(Request& req)
+{
+    std::string key = Request::MethonToStr(req.getMethon());
+    key += ' ';
+    key += req.getPath();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& param : keyParams_)
+    {
+        key += '\0';
+        key += req.getUrlParam(std::string(param));
+    }
+    for (auto& head : keyHeads_)
+    {
+        key += '\0';
+        key += GetHead(req, head);
+    }
+    return key;
+}
+
+void ResponseCache::complete(const std::string& key, Response& resp)
+{
+    auto head = std::make_shared<std::string>();
+    ResponseWriter::PackHead(resp, *head);
+    //去掉结束空行，写出时由ResponseStream补充Connection头。
+    head->resize(head->size() - sizeof(Crlf));
+    auto body = std::make_shared<std::string>();
+    resp.swapContent(*body);
+    uint64_t ttl = getTtl(resp);
+
+    std::vector<ResponseStreamPtr> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto flight = flights_.find(key);
+        if (flight != flights_.end())
+        {
+            waiters.swap(flight->second);
+            flights_.erase(flight);
+        }
+        if (ttl > 0)
+        {
+            insert(key, head, body, ttl);
+        }
+    }
+    for (auto& stream : waiters)
+    {
+        stream->sendSerialized(head, body);
+    }
+}
+
+void ResponseCache::insert(const std::string& key, std::shared_ptr<std::string> head,
+    std::shared_ptr<std::string> body, uint64_t ttl)
+{
+    uint64_t size = key.size() + head->size() + body->size();
+    if (size > maxEntrySize_ || size > maxBytes_)
+    {
+        return;
+    }
+    auto it = index_.find(key);
+    if (it != index_.end())
+    {
+        erase(it->second);
+    }
+    entries_.push_front(Entry{ key, head, body, Now() + ttl, size });
+    index_[key] = entries_.begin();
+    bytes_ += size;
+    while (bytes_ > maxBytes_)
+    {
+        erase(std::prev(entries_.end()));
+        stats_.evictions++;
+    }
+}
+
+void ResponseCache::erase(EntryIterator it)
+{
+    bytes_ -= it->size;
+    index_.erase(it->key);
+    entries_.erase(it);
+}
+
+uint64_t ResponseCache::getTtl(Response& resp)
+{
+    if (!IsCacheableStatus(resp.getStatusCode()))
+    {
+        return 0;
+    }
+    auto control = GetCacheControl(resp);
+    if (control.find("no-store") != control.npos || control.find("no-cache") != control.npos ||
+        control.find("private") != control.npos)
+    {
+        return 0;
+    }
+    auto seconds = GetDirectiveSeconds(control, "s-maxage");
+    if (seconds < 0)
+    {
+        seconds = GetDirectiveSeconds(control, "max-age");
+    }
+    if (seconds >= 0)
+    {
+        return (uint64_t)seconds * 1000;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ttl_;
+}
+
+uint64_t ResponseCache::Now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
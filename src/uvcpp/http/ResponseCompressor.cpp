@@ -0,0 +1,148 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/ResponseCompressor.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+//默认1Kb以下不压缩，256Kb以上在线程池中压缩。
+uint64_t ResponseCompressor::DefaultMinSize = 1024;
+uint64_t ResponseCompressor::DefaultAsyncSize = 256 * 1024;
+
+namespace
+{
+
+struct CompressTask
+{
+    uv_work_t req;
+    ResponseStreamPtr stream;
+    std::shared_ptr<Response> resp;
+    Compression::Encoding encoding;
+    int level;
+    int status;
+    std::string out;
+};
+
+//body替换为压缩数据，长度由ResponseWriter重新计算。
+void SetCompressedContent(Response& resp, Compression::Encoding encoding, std::string& out)
+{
+    resp.removeHead("Content-Length");
+    resp.removeHead("content-length");
+    resp.appendHead("Content-Encoding", Compression::EncodingName(encoding));
+    resp.swapContent(out);
+}
+
+}
+
+ResponseCompressor::ResponseCompressor(int level)
+    :level_(level),
+    minSize_(DefaultMinSize),
+    asyncSize_(DefaultAsyncSize)
+{
+}
+
+void ResponseCompressor::setLevel(int level)
+{
+    level_ = level;
+}
+
+void ResponseCompressor::setMinSize(uint64_t size)
+{
+    minSize_ = size;
+}
+
+void ResponseCompressor::setAsyncSize(uint64_t size)
+{
+    asyncSize_ = size;
+}
+
+ResponseCompressor::OnHttpStreamCallback ResponseCompressor::wrap(OnHttpReqCallback handler)
+{
+    auto self = shared_from_this();
+    return [self, handler](Request& req, ResponseStreamPtr stream)
+    {
+        auto resp = std::make_shared<Response>(req.getVersion(), Response::StatusCode::OK);
+        handler(req, resp.get());
+        auto size = resp->getContent().size();
+        if (size < self->minSize_ || !Compression::IsCompressible(*resp))
+        {
+            stream->send(*resp);
+            return;
+        }
+        //同一url的响应随Accept-Encoding变化。
+        std::string key("Vary");
+        if (resp->getHead(key).empty())
+        {
+            resp->appendHead("Vary", "Accept-Encoding");
+        }
+        auto encoding = Compression::Negotiate(req);
+        if (Compression::Identity == encoding)
+        {
+            stream->send(*resp);
+            return;
+        }
+        if (size >= self->asyncSize_)
+        {
+            self->compressInPool(stream, resp, encoding);
+            return;
+        }
+        std::string out;
+        if (0 == Compression::Compress(encoding, resp->getContent().c_str(), size, out, self->level_))
+        {
+            SetCompressedContent(*resp, encoding, out);
+        }
+        stream->send(*resp);
+    };
+}
+
+ResponseCompressor::OnHttpStreamCallback ResponseCompressor::wrapStream(OnHttpStreamCallback handler)
+{
+    auto self = shared_from_this();
+    return [self, handler](Request& req, ResponseStreamPtr stream)
+    {
+        stream->setCompression(Compression::Negotiate(req), self->level_);
+        handler(req, stream);
+    };
+}
+
+void ResponseCompressor::compressInPool(ResponseStreamPtr stream, std::shared_ptr<Response> resp, Compression::Encoding encoding)
+{
+    auto task = new CompressTask();
+    task->req.data = task;
+    task->stream = stream;
+    task->resp = resp;
+    task->encoding = encoding;
+    task->level = level_;
+    task->status = -1;
+    auto rst = ::uv_queue_work(stream->getLoop()->handle(), &task->req,
+        [](uv_work_t* req)
+    {
+        auto task = static_cast<CompressTask*>(req->data);
+        auto& content = task->resp->getContent();
+        task->status = Compression::Compress(task->encoding, content.c_str(), content.size(), task->out, task->level);
+    },
+        [](uv_work_t* req, int status)
+    {
+        auto task = static_cast<CompressTask*>(req->data);
+        if (0 == status && 0 == task->status)
+        {
+            SetCompressedContent(*task->resp, task->encoding, task->out);
+        }
+        task->stream->send(*task->resp);
+        delete task;
+    });
+    if (0 != rst)
+    {
+        //线程池不可用时原样发送。
+        stream->send(*resp);
+        delete task;
+    }
+}
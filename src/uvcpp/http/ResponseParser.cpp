@@ -0,0 +1,394 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <cstring>
+
+#include "../include/http/ResponseParser.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+namespace
+{
+
+//chunk-size行及trailer行长度上限。
+const size_t MaxLineSize = 8192;
+//按Content-Length预分配body的上限。
+const uint64_t MaxReserveSize = 16 << 20;
+
+std::string ToLower(std::string str)
+{
+    for (auto& ch : str)
+    {
+        ch = ::tolower((unsigned char)ch);
+    }
+    return str;
+}
+
+}
+
+//消息头最大64Kb。
+uint64_t ResponseParser::MaxHeadSize = 64 << 10;
+
+ResponseParser::ResponseParser()
+    :onHeaders_(nullptr),
+    onBody_(nullptr)
+{
+    reset();
+}
+
+void ResponseParser::setHeadersCallback(OnHeadersCallback callback)
+{
+    onHeaders_ = callback;
+}
+
+void ResponseParser::setBodyCallback(OnBodyCallback callback)
+{
+    onBody_ = callback;
+}
+
+void ResponseParser::reset(bool headRequest)
+{
+    state_ = Head;
+    headRequest_ = headRequest;
+    keepAlive_ = false;
+    started_ = false;
+    remain_ = 0;
+    head_.clear();
+    line_.clear();
+    body_.clear();
+    response_ = Response();
+}
+
+ParseResult ResponseParser::parse(const char* data, size_t size, size_t& used)
+{
+    used = 0;
+    if (size > 0)
+    {
+        started_ = true;
+    }
+    while (true)
+    {
+        size_t avail = size - used;
+        const char* ptr = data + used;
+        size_t n = 0;
+        bool completed = false;
+        ParseResult rst;
+        switch (state_)
+        {
+        case Head:
+            rst = parseHead(ptr, avail, n);
+            used += n;
+            if (ParseResult::Success != rst)
+            {
+                return rst;
+            }
+            break;
+        case Body:
+            n = avail < remain_ ? avail : (size_t)remain_;
+            onBody(ptr, n);
+            used += n;
+            remain_ -= n;
+            if (0 == remain_)
+            {
+                return onCompleted();
+            }
+            return ParseResult::Fail;
+        case ChunkSize:
+            rst = parseLine(ptr, avail, n, completed);
+            used += n;
+            if (ParseResult::Error == rst)
+            {
+                return rst;
+            }
+            if (!completed)
+            {
+                return ParseResult::Fail;
+            }
+            if (ParseResult::Error == parseChunkSize())
+            {
+                return ParseResult::Error;
+            }
+            break;
+        case ChunkData:
+            n = avail < remain_ ? avail : (size_t)remain_;
+            onBody(ptr, n);
+            used += n;
+            remain_ -= n;
+            if (remain_ > 0)
+            {
+                return ParseResult::Fail;
+            }
+            //chunk数据后的CRLF。
+            state_ = ChunkCrlf;
+            remain_ = sizeof(Crlf);
+            break;
+        case ChunkCrlf:
+            n = avail < remain_ ? avail : (size_t)remain_;
+            used += n;
+            remain_ -= n;
+            if (remain_ > 0)
+            {
+                return ParseResult::Fail;
+            }
+            state_ = ChunkSize;
+            break;
+        case Trailer:
+            rst = parseLine(ptr, avail, n, completed);
+            used += n;
+            if (ParseResult::Error == rst)
+            {
+                return rst;
+            }
+            if (!completed)
+            {
+                return ParseResult::Fail;
+            }
+            //空行结束trailer，trailer内容忽略。
+            if (line_.empty())
+            {
+                return onCompleted();
+            }
+            line_.clear();
+            break;
+        case UntilClose:
+            onBody(ptr, avail);
+            used += avail;
+            return ParseResult::Fail;
+        case Completed:
+        default:
+            return ParseResult::Success;
+        }
+    }
+}
+
+ParseResult ResponseParser::finish()
+{
+    if (UntilClose == state_)
+    {
+        return onCompleted();
+    }
+    return Completed == state_ ? ParseResult::Success : ParseResult::Fail;
+}
+
+Response& ResponseParser::getResponse()
+{
+    return response_;
+}
+
+bool ResponseParser::isKeepAlive()
+{
+    return keepAlive_;
+}
+
+bool ResponseParser::isStarted()
+{
+    return started_;
+}
+
+ParseResult ResponseParser::parseHead(const char* data, size_t size, size_t& used)
+{
+    //仅在新数据(及其前3字节)中查找消息头结束标志。
+    size_t from = head_.size() > 3 ? head_.size() - 3 : 0;
+    head_.append(data, size);
+    auto pos = head_.find("\r\n\r\n", from);
+    if (pos == head_.npos)
+    {
+        used = size;
+        return head_.size() > MaxHeadSize ? ParseResult::Error : ParseResult::Fail;
+    }
+    size_t end = pos + 4;
+    used = size - (head_.size() - end);
+    head_.resize(end);
+    return onHeadCompleted();
+}
+
+ParseResult ResponseParser::onHeadCompleted()
+{
+    response_ = Response();
+    auto rst = response_.unpack(head_);
+    head_.clear();
+    if (ParseResult::Success != rst)
+    {
+        return ParseResult::Error;
+    }
+    int code = response_.statusCode_;
+    //忽略100 Continue等中间响应，继续解析最终响应。
+    if (code >= 100 && code < 200 && code != Response::SwitchingProtocols)
+    {
+        response_ = Response();
+        state_ = Head;
+        return ParseResult::Success;
+    }
+    std::string value;
+    findHead("Connection", value);
+    value = ToLower(value);
+    if (response_.version_ == HttpVersion::Http1_0)
+    {
+        keepAlive_ = value.find("keep-alive") != value.npos;
+    }
+    else
+    {
+        keepAlive_ = value.find("close") == value.npos;
+    }
+    if (nullptr != onHeaders_)
+    {
+        onHeaders_(response_);
+    }
+    if (code == Response::SwitchingProtocols)
+    {
+        //协议已切换，连接不可复用。
+        keepAlive_ = false;
+        onCompleted();
+        return ParseResult::Success;
+    }
+    if (headRequest_ || code == Response::NoContent || code == Response::NotModified)
+    {
+        onCompleted();
+        return ParseResult::Success;
+    }
+    if (findHead("Transfer-Encoding", value) && ToLower(value).find("chunked") != value.npos)
+    {
+        state_ = ChunkSize;
+        return ParseResult::Success;
+    }
+    if (findHead("Content-Length", value))
+    {
+        if (value.empty() || value.size() > 19 || value.find_first_not_of("0123456789") != value.npos)
+        {
+            return ParseResult::Error;
+        }
+        remain_ = std::stoull(value);
+        if (0 == remain_)
+        {
+            onCompleted();
+            return ParseResult::Success;
+        }
+        if (nullptr == onBody_)
+        {
+            body_.reserve(remain_ < MaxReserveSize ? remain_ : MaxReserveSize);
+        }
+        state_ = Body;
+        return ParseResult::Success;
+    }
+    //无长度信息，以关闭连接作为结束。
+    keepAlive_ = false;
+    state_ = UntilClose;
+    return ParseResult::Success;
+}
+
+ParseResult ResponseParser::parseLine(const char* data, size_t size, size_t& used, bool& completed)
+{
+    auto end = static_cast<const char*>(::memchr(data, '\n', size));
+    if (nullptr == end)
+    {
+        line_.append(data, size);
+        used = size;
+        completed = false;
+        return line_.size() > MaxLineSize ? ParseResult::Error : ParseResult::Fail;
+    }
+    line_.append(data, end - data);
+    used = end - data + 1;
+    if (!line_.empty() && line_.back() == '\r')
+    {
+        line_.pop_back();
+    }
+    completed = true;
+    return ParseResult::Success;
+}
+
+ParseResult ResponseParser::parseChunkSize()
+{
+    //chunk-size [;chunk-ext]
+    uint64_t size = 0;
+    size_t digits = 0;
+    for (auto ch : line_)
+    {
+        int value;
+        if (ch >= '0' && ch <= '9')
+            value = ch - '0';
+        else if (ch >= 'a' && ch <= 'f')
+            value = ch - 'a' + 10;
+        else if (ch >= 'A' && ch <= 'F')
+            value = ch - 'A' + 10;
+        else
+            break;
+        if (++digits > 15)
+        {
+            return ParseResult::Error;
+        }
+        size = (size << 4) | value;
+    }
+    line_.clear();
+    if (0 == digits)
+    {
+        return ParseResult::Error;
+    }
+    if (0 == size)
+    {
+        state_ = Trailer;
+    }
+    else
+    {
+        state_ = ChunkData;
+        remain_ = size;
+    }
+    return ParseResult::Success;
+}
+
+void ResponseParser::onBody(const char* data, size_t size)
+{
+    if (0 == size)
+    {
+        return;
+    }
+    if (nullptr != onBody_)
+    {
+        onBody_(data, size);
+        return;
+    }
+    body_.append(data, size);
+}
+
+ParseResult ResponseParser::onCompleted()
+{
+    state_ = Completed;
+    response_.content_.swap(body_);
+    body_.clear();
+    return ParseResult::Success;
+}
+
+bool ResponseParser::findHead(const char* key, std::string& value)
+{
+    auto size = ::strlen(key);
+    for (auto it = response_.heads_.begin(); it != response_.heads_.end(); it++)
+    {
+        auto& name = it->first;
+        if (name.size() != size)
+        {
+            continue;
+        }
+        size_t i = 0;
+        for (; i < size; i++)
+        {
+            if (::tolower((unsigned char)name[i]) != ::tolower((unsigned char)key[i]))
+            {
+                break;
+            }
+        }
+        if (i == size)
+        {
+            value = it->second;
+            return true;
+        }
+    }
+    value.clear();
+    return false;
+}
@@ -0,0 +1,682 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/ResponseStream.hpp"
+#include "../include/http/ResponseWriter.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+namespace
+{
+
+struct ChunkBuffers
+{
+    char head[20];
+    std::shared_ptr<std::string> data;
+};
+
+const char ChunkedEnd[] = "0\r\n\r\n";
+const char ConnectionClose[] = "Connection: close\r\n\r\n";
+const char ConnectionKeepAlive[] = "Connection: keep-alive\r\n\r\n";
+
+bool HasContentLength(Response& resp)
+{
+    std::string key("Content-Length");
+    if (!resp.getHead(key).empty())
+    {
+        return true;
+    }
+    key = "content-length";
+    return !resp.getHead(key).empty();
+}
+
+}
+
+//默认高水位1Mb。
+uint64_t ResponseStream::DefaultHighWaterMark = 1024 << 10;
+
+ResponseStream::ResponseStream(EventLoop* loop, TcpConnectionPtr connection, HttpVersion version)
+    :loop_(loop),
+    connection_(connection),
+    version_(version),
+    chunked_(false),
+    headSent_(false),
+    keepAlive_(false),
+    active_(false),
+    completed_(false),
+    needDrain_(false),
+    started_(false),
+    ended_(false),
+    closed_(false),
+    pending_(0),
+    highWaterMark_(DefaultHighWaterMark),
+    onDrain_(nullptr),
+    onComplete_(nullptr)
+{
+}
+
+ResponseStream::~ResponseStream()
+{
+}
+
+void ResponseStream::send(Response& resp)
+{
+    started_ = true;
+    if (ended_.exchange(true))
+    {
+        return;
+    }
+    auto ptr = std::make_shared<Response>();
+    std::swap(*ptr, resp);
+    auto self = shared_from_this();
+    post([self, ptr]()
+    {
+        self->sendInLoop(ptr);
+    });
+}
+
+void ResponseStream::writeHead(Response& head)
+{
+    started_ = true;
+    if (ended_)
+    {
+        return;
+    }
+    auto ptr = std::make_shared<Response>();
+    std::swap(*ptr, head);
+    auto self = shared_from_this();
+    post([self, ptr]()
+    {
+        self->writeHeadInLoop(ptr);
+    });
+}
+
+bool ResponseStream::writeChunk(const char* data, size_t size)
+{
+    return writeChunk(std::string(data, size));
+}
+
+bool ResponseStream::writeChunk(std::string&& data)
+{
+    auto ptr = std::make_shared<std::string>();
+    ptr->swap(data);
+    return writeChunk(ptr);
+}
+
+bool ResponseStream::writeChunk(std::shared_ptr<std::string> ptr)
+{
+    started_ = true;
+    if (ended_ || closed_)
+    {
+        return false;
+    }
+    //空chunk会被解析为结束标志，忽略。
+    if (ptr->empty())
+    {
+        return isWritable();
+    }
+    bool writable = (pending_ += ptr->size()) < highWaterMark_;
+    //投递前置位，否则loop线程可能在置位前写完全部数据而不回调drain。
+    if (!writable)
+    {
+        needDrain_ = true;
+    }
+    auto self = shared_from_this();
+    post([self, ptr]()
+    {
+        self->writeChunkInLoop(ptr);
+    });
+    return writable;
+}
+
+void ResponseStream::end()
+{
+    started_ = true;
+    if (ended_.exchange(true))
+    {
+        return;
+    }
+    auto self = shared_from_this();
+    post([self]()
+    {
+        self->endInLoop();
+    });
+}
+
+void ResponseStream::sendFile(Response& head, uv_file file, int64_t offset, uint64_t length)
+{
+    //先构造sender接管file，响应被丢弃时随之关闭。
+    auto sender = std::make_shared<FileSender>(loop_, file, offset, length);
+    started_ = true;
+    if (ended_.exchange(true))
+    {
+        return;
+    }
+    auto ptr = std::make_shared<Response>();
+    std::swap(*ptr, head);
+    if (!HasContentLength(*ptr))
+    {
+        ptr->appendHead("Content-Length", std::to_string(length));
+    }
+    auto self = shared_from_this();
+    post([self, ptr, sender]()
+    {
+        self->sendFileInLoop(ptr, sender);
+    });
+}
+
+bool ResponseStream::isWritable()
+{
+    return pending_ < highWaterMark_;
+}
+
+bool ResponseStream::isClosed()
+{
+    return closed_;
+}
+
+bool ResponseStream::isEnded()
+{
+    return ended_;
+}
+
+bool ResponseStream::isKeepAlive()
+{
+    return keepAlive_;
+}
+
+uint64_t ResponseStream::pendingSize()
+{
+    return pending_;
+}
+
+EventLoop* ResponseStream::getLoop()
+{
+    return loop_;
+}
+
+void ResponseStream::setCompression(Compression::Encoding encoding, int level)
+{
+    if (Compression::Identity == encoding)
+    {
+        return;
+    }
+    auto self = shared_from_this();
+    post([self, encoding, level]()
+    {
+        if (!self->headSent_)
+        {
+            self->compression_.reset(new Compression(encoding, level));
+        }
+    });
+}
+
+void ResponseStream::setDrainCallback(DefaultCallback callback)
+{
+    auto self = shared_from_this();
+    post([self, callback]()
+    {
+        self->onDrain_ = callback;
+    });
+}
+
+void ResponseStream::setHighWaterMark(uint64_t size)
+{
+    highWaterMark_ = size;
+}
+
+void ResponseStream::setKeepAlive(bool keepAlive)
+{
+    keepAlive_ = keepAlive;
+}
+
+void ResponseStream::setCompleteCallback(DefaultCallback callback)
+{
+    onComplete_ = callback;
+}
+
+void ResponseStream::activate()
+{
+    active_ = true;
+    while (!ops_.empty() && !completed_)
+    {
+        auto op = ops_.front();
+        ops_.pop_front();
+        op();
+    }
+    ops_.clear();
+}
+
+void ResponseStream::sendSerialized(std::shared_ptr<std::string> head, std::shared_ptr<std::string> body)
+{
+    started_ = true;
+    if (ended_.exchange(true))
+    {
+        return;
+    }
+    auto self = shared_from_this();
+    post([self, head, body]()
+    {
+        self->sendSerializedInLoop(head, body);
+    });
+}
+
+bool ResponseStream::sendStatus(Response::StatusCode code)
+{
+    if (started_.exchange(true) || ended_.exchange(true))
+    {
+        return false;
+    }
+    auto resp = std::make_shared<Response>(version_, code);
+    auto self = shared_from_this();
+    post([self, resp]()
+    {
+        self->sendInLoop(resp);
+    });
+    return true;
+}
+
+void ResponseStream::abort()
+{
+    started_ = true;
+    ended_ = true;
+    ops_.clear();
+    onClosed();
+    onComplete();
+}
+
+void ResponseStream::cancel()
+{
+    onClosed();
+    //Http1.x无法单独结束一个写到一半的响应，关闭连接，pipeline中的其余响应随会话一同放弃。
+    auto connection = connection_.lock();
+    if (nullptr != connection)
+    {
+        connection->onSocketClose();
+    }
+    else
+    {
+        abort();
+    }
+}
+
+void ResponseStream::post(DefaultCallback op)
+{
+    auto self = shared_from_this();
+    loop_->runInThisLoop([self, op]()
+    {
+        if (self->completed_)
+        {
+            return;
+        }
+        if (self->active_)
+        {
+            op();
+        }
+        else
+        {
+            self->ops_.push_back(op);
+        }
+    });
+}
+
+void ResponseStream::sendInLoop(std::shared_ptr<Response> resp)
+{
+    if (headSent_)
+    {
+        return;
+    }
+    auto connection = connection_.lock();
+    if (closed_ || nullptr == connection)
+    {
+        onClosed();
+        onComplete();
+        return;
+    }
+    headSent_ = true;
+    compressContent(*resp);
+    appendConnectionHead(*resp);
+    auto self = shared_from_this();
+    ResponseWriter::Write(connection, *resp, [self](WriteInfo& info)
+    {
+        if (0 != info.status)
+        {
+            self->onClosed();
+        }
+        self->onComplete();
+    });
+}
+
+void ResponseStream::writeHeadInLoop(std::shared_ptr<Response> head)
+{
+    if (headSent_ || closed_)
+    {
+        return;
+    }
+    auto connection = connection_.lock();
+    if (nullptr == connection)
+    {
+        onClosed();
+        return;
+    }
+    headSent_ = true;
+    prepareCompression(*head);
+    bool hasLength = HasContentLength(*head);
+    if (!hasLength && version_ != HttpVersion::Http1_0)
+    {
+        chunked_ = true;
+        head->appendHead("Transfer-Encoding", "chunked");
+    }
+    else if (!hasLength)
+    {
+        //Http1.0无法分块，以关闭连接作为结束。
+        keepAlive_ = false;
+    }
+    appendConnectionHead(*head);
+    std::string content;
+    head->swapContent(content);
+
+    auto buffer = ResponseWriter::FetchBuffer();
+    ResponseWriter::PackHead(*head, *buffer, false);
+    auto self = shared_from_this();
+    connection->write(buffer->c_str(), buffer->size(), [self, buffer](WriteInfo& info)
+    {
+        ResponseWriter::ReleaseBuffer(buffer);
+        if (0 != info.status)
+        {
+            self->onClosed();
+        }
+    });
+    if (!content.empty())
+    {
+        pending_ += content.size();
+        writeChunkInLoop(std::make_shared<std::string>(std::move(content)));
+    }
+}
+
+void ResponseStream::writeChunkInLoop(std::shared_ptr<std::string> data)
+{
+    uint64_t size = data->size();
+    if (!headSent_)
+    {
+        writeHeadInLoop(std::make_shared<Response>());
+    }
+    if (nullptr != compression_ && !closed_)
+    {
+        auto out = std::make_shared<std::string>();
+        compression_->update(data->c_str(), size, *out);
+        data = out;
+    }
+    writeBufferInLoop(data, size);
+}
+
+void ResponseStream::writeBufferInLoop(std::shared_ptr<std::string> data, uint64_t size)
+{
+    auto connection = connection_.lock();
+    if (closed_ || nullptr == connection)
+    {
+        afterWrite(size, WriteInfo::Disconnected);
+        return;
+    }
+    //空chunk会被解析为结束标志。
+    if (data->empty())
+    {
+        afterWrite(size, 0);
+        return;
+    }
+    auto buffers = new ChunkBuffers();
+    buffers->data = data;
+    uv_buf_t bufs[3];
+    unsigned int nbufs = 0;
+    if (chunked_)
+    {
+        int len = ::snprintf(buffers->head, sizeof(buffers->head), "%llx\r\n", (unsigned long long)data->size());
+        bufs[nbufs++] = uv_buf_init(buffers->head, len);
+    }
+    bufs[nbufs++] = uv_buf_init(const_cast<char*>(data->c_str()), (unsigned int)data->size());
+    if (chunked_)
+    {
+        bufs[nbufs++] = uv_buf_init(const_cast<char*>(Crlf), sizeof(Crlf));
+    }
+    auto self = shared_from_this();
+    connection->write(bufs, nbufs, [self, buffers, size](WriteInfo& info)
+    {
+        delete buffers;
+        self->afterWrite(size, info.status);
+    });
+}
+
+void ResponseStream::sendFileInLoop(std::shared_ptr<Response> head, std::shared_ptr<FileSender> sender)
+{
+    auto connection = connection_.lock();
+    if (headSent_ || closed_ || nullptr == connection)
+    {
+        onClosed();
+        onComplete();
+        return;
+    }
+    headSent_ = true;
+    appendConnectionHead(*head);
+    auto buffer = ResponseWriter::FetchBuffer();
+    ResponseWriter::PackHead(*head, *buffer, false);
+    auto self = shared_from_this();
+    //sendfile绕过写队列，须等待消息头写完再开始。
+    connection->write(buffer->c_str(), buffer->size(), [self, buffer, sender](WriteInfo& info)
+    {
+        ResponseWriter::ReleaseBuffer(buffer);
+        auto connection = self->connection_.lock();
+        if (0 != info.status || self->closed_ || nullptr == connection)
+        {
+            self->onClosed();
+            self->onComplete();
+            return;
+        }
+        sender->start(connection, [self](int status)
+        {
+            if (0 != status)
+            {
+                self->onClosed();
+            }
+            self->onComplete();
+        });
+    });
+}
+
+void ResponseStream::sendSerializedInLoop(std::shared_ptr<std::string> head, std::shared_ptr<std::string> body)
+{
+    if (headSent_)
+    {
+        return;
+    }
+    auto connection = connection_.lock();
+    if (closed_ || nullptr == connection)
+    {
+        onClosed();
+        onComplete();
+        return;
+    }
+    headSent_ = true;
+    //与appendConnectionHead一致：仅关闭连接或Http1.0保持连接时需要Connection头。
+    const char* end = Crlf;
+    size_t endSize = sizeof(Crlf);
+    if (!keepAlive_)
+    {
+        end = ConnectionClose;
+        endSize = sizeof(ConnectionClose) - 1;
+    }
+    else if (version_ == HttpVersion::Http1_0)
+    {
+        end = ConnectionKeepAlive;
+        endSize = sizeof(ConnectionKeepAlive) - 1;
+    }
+    uv_buf_t bufs[3];
+    unsigned int nbufs = 0;
+    bufs[nbufs++] = uv_buf_init(const_cast<char*>(head->c_str()), (unsigned int)head->size());
+    bufs[nbufs++] = uv_buf_init(const_cast<char*>(end), (unsigned int)endSize);
+    if (nullptr != body && !body->empty())
+    {
+        bufs[nbufs++] = uv_buf_init(const_cast<char*>(body->c_str()), (unsigned int)body->size());
+    }
+    auto self = shared_from_this();
+    connection->write(bufs, nbufs, [self, head, body](WriteInfo& info)
+    {
+        if (0 != info.status)
+        {
+            self->onClosed();
+        }
+        self->onComplete();
+    });
+}
+
+void ResponseStream::endInLoop()
+{
+    if (!headSent_)
+    {
+        //无任何body的流式响应，直接以Content-Length: 0应答。
+        sendInLoop(std::make_shared<Response>(version_, Response::StatusCode::OK));
+        return;
+    }
+    auto connection = connection_.lock();
+    if (closed_ || nullptr == connection)
+    {
+        onComplete();
+        return;
+    }
+    if (nullptr != compression_)
+    {
+        //写出压缩流结尾。
+        auto tail = std::make_shared<std::string>();
+        compression_->update(nullptr, 0, *tail, true);
+        compression_.reset();
+        pending_ += tail->size();
+        writeBufferInLoop(tail, tail->size());
+    }
+    if (chunked_)
+    {
+        auto self = shared_from_this();
+        connection->write(ChunkedEnd, sizeof(ChunkedEnd) - 1, [self](WriteInfo& info)
+        {
+            if (0 != info.status)
+            {
+                self->onClosed();
+            }
+            self->onComplete();
+        });
+    }
+    else if (0 == pending_)
+    {
+        onComplete();
+    }
+}
+
+void ResponseStream::prepareCompression(Response& resp)
+{
+    if (nullptr == compression_)
+    {
+        return;
+    }
+    if (Compression::Identity == compression_->getEncoding() || !Compression::IsCompressible(resp))
+    {
+        compression_.reset();
+        return;
+    }
+    //压缩后长度未知，改用chunked。
+    resp.removeHead("Content-Length");
+    resp.removeHead("content-length");
+    resp.appendHead("Content-Encoding", Compression::EncodingName(compression_->getEncoding()));
+    std::string key("Vary");
+    if (resp.getHead(key).empty())
+    {
+        resp.appendHead("Vary", "Accept-Encoding");
+    }
+}
+
+void ResponseStream::compressContent(Response& resp)
+{
+    if (resp.getContent().empty())
+    {
+        compression_.reset();
+    }
+    prepareCompression(resp);
+    if (nullptr != compression_)
+    {
+        std::string body;
+        compression_->update(resp.getContent().c_str(), resp.getContent().size(), body, true);
+        resp.swapContent(body);
+        compression_.reset();
+    }
+}
+
+void ResponseStream::appendConnectionHead(Response& resp)
+{
+    if (!keepAlive_)
+    {
+        resp.appendHead("Connection", "close");
+    }
+    else if (version_ == HttpVersion::Http1_0)
+    {
+        resp.appendHead("Connection", "keep-alive");
+    }
+}
+
+void ResponseStream::afterWrite(uint64_t size, int status)
+{
+    pending_ -= size;
+    if (0 != status)
+    {
+        onClosed();
+    }
+    else if (needDrain_ && pending_ <= (highWaterMark_ >> 1))
+    {
+        needDrain_ = false;
+        if (onDrain_)
+        {
+            onDrain_();
+        }
+    }
+    //非chunked模式下，数据全部写完即为结束。
+    if (headSent_ && !chunked_ && ended_ && 0 == pending_)
+    {
+        onComplete();
+    }
+}
+
+void ResponseStream::onClosed()
+{
+    if (closed_.exchange(true))
+    {
+        return;
+    }
+    if (needDrain_)
+    {
+        needDrain_ = false;
+        if (onDrain_)
+        {
+            onDrain_();
+        }
+    }
+}
+
+void ResponseStream::onComplete()
+{
+    if (completed_)
+    {
+        return;
+    }
+    completed_ = true;
+    onDrain_ = nullptr;
+    if (onComplete_)
+    {
+        auto callback = onComplete_;
+        onComplete_ = nullptr;
+        callback();
+    }
+}
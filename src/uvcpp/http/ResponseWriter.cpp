@@ -0,0 +1,270 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <ctime>
+#include <vector>
+
+#include "../include/http/ResponseWriter.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+namespace
+{
+
+const int StatusCodeMin = 100;
+const int StatusCodeMax = 599;
+
+class StatusLineTable
+{
+public:
+    StatusLineTable()
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            lines_[i].resize(StatusCodeMax - StatusCodeMin + 1);
+        }
+        for (int code = StatusCodeMin; code <= StatusCodeMax; code++)
+        {
+            auto info = ResponseWriter::GetStatusInfo((Response::StatusCode)code);
+            if (nullptr == info)
+            {
+                continue;
+            }
+            std::string codeStr = " " + std::to_string(code) + " " + info;
+            lines_[0][code - StatusCodeMin] = "HTTP/1.0" + codeStr + "\r\n";
+            lines_[1][code - StatusCodeMin] = "HTTP/1.1" + codeStr + "\r\n";
+        }
+    }
+
+    const std::string* get(HttpVersion version, int code)
+    {
+        if (code < StatusCodeMin || code > StatusCodeMax)
+        {
+            return nullptr;
+        }
+        auto& line = lines_[version == HttpVersion::Http1_0 ? 0 : 1][code - StatusCodeMin];
+        return line.empty() ? nullptr : &line;
+    }
+
+private:
+    std::vector<std::string> lines_[2];
+};
+
+StatusLineTable& GetStatusLineTable()
+{
+    static StatusLineTable table;
+    return table;
+}
+
+struct DateCache
+{
+    time_t second = 0;
+    std::string head;
+};
+
+bool EqualsNoCase(const std::string& str, const char* key, size_t size)
+{
+    if (str.size() != size)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        if (::tolower((unsigned char)str[i]) != ::tolower((unsigned char)key[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ResponseBuffers
+{
+    std::string* head;
+    std::string body;
+};
+
+thread_local std::vector<std::unique_ptr<std::string>> BufferPool;
+
+}
+
+const std::string& ResponseWriter::GetStatusLine(HttpVersion version, Response::StatusCode code)
+{
+    static const std::string empty;
+    auto line = GetStatusLineTable().get(version, code);
+    return nullptr == line ? empty : *line;
+}
+
+const char* ResponseWriter::GetStatusInfo(Response::StatusCode code)
+{
+    switch (code)
+    {
+    case Response::Continue: return "Continue";
+    case Response::SwitchingProtocols: return "Switching Protocols";
+    case Response::OK: return "OK";
+    case Response::Created: return "Created";
+    case Response::Accepted: return "Accepted";
+    case Response::NoContent: return "No Content";
+    case Response::PartialContent: return "Partial Content";
+    case Response::MovedPermanently: return "Moved Permanently";
+    case Response::Found: return "Found";
+    case Response::NotModified: return "Not Modified";
+    case Response::BadRequest: return "Bad Request";
+    case Response::Unauthorized: return "Unauthorized";
+    case Response::Forbidden: return "Forbidden";
+    case Response::NotFound: return "Not Found";
+    case Response::MethodNotAllowed: return "Method Not Allowed";
+    case Response::RequestTimeout: return "Request Timeout";
+    case Response::PayloadTooLarge: return "Payload Too Large";
+    case Response::RangeNotSatisfiable: return "Range Not Satisfiable";
+    case Response::RequestHeaderFieldsTooLarge: return "Request Header Fields Too Large";
+    case Response::InternalServerError: return "Internal Server Error";
+    case Response::NotImplemented: return "Not Implemented";
+    case Response::BadGateway: return "Bad Gateway";
+    case Response::ServerUnavailable: return "Service Unavailable";
+    case Response::GatewayTimeout: return "Gateway Timeout";
+    default: return nullptr;
+    }
+}
+
+const std::string& ResponseWriter::GetDateHead()
+{
+    static thread_local DateCache cache;
+
+    time_t now = ::time(nullptr);
+    if (now == cache.second && !cache.head.empty())
+    {
+        return cache.head;
+    }
+    cache.head = "Date: ";
+    cache.head += FormatHttpDate(now);
+    cache.head.append(Crlf, sizeof(Crlf));
+    cache.second = now;
+    return cache.head;
+}
+
+std::string ResponseWriter::FormatHttpDate(time_t time)
+{
+    static const char* Weeks[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char* Months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    struct tm gmt;
+#if _MSC_VER
+    ::gmtime_s(&gmt, &time);
+#else
+    ::gmtime_r(&time, &gmt);
+#endif
+    char buf[32];
+    int size = ::snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+        Weeks[gmt.tm_wday], gmt.tm_mday, Months[gmt.tm_mon], gmt.tm_year + 1900,
+        gmt.tm_hour, gmt.tm_min, gmt.tm_sec);
+    return std::string(buf, size);
+}
+
+void ResponseWriter::PackHead(Response& resp, std::string& out, bool withLength)
+{
+    auto& line = GetStatusLine(resp.version_, resp.statusCode_);
+    if (!line.empty() && (resp.statusInfo_.empty() || resp.statusInfo_ == GetStatusInfo(resp.statusCode_)))
+    {
+        out += line;
+    }
+    else
+    {
+        out += resp.version_ == HttpVersion::Http1_0 ? "HTTP/1.0 " : "HTTP/1.1 ";
+        out += std::to_string(resp.statusCode_);
+        out += " ";
+        out += resp.statusInfo_;
+        out.append(Crlf, sizeof(Crlf));
+    }
+    bool hasDate = false;
+    bool hasLength = false;
+    for (auto it = resp.heads_.begin(); it != resp.heads_.end(); it++)
+    {
+        auto& key = it->first;
+        if (!hasDate)
+        {
+            hasDate = EqualsNoCase(key, "Date", 4);
+        }
+        if (!hasLength)
+        {
+            hasLength = EqualsNoCase(key, "Content-Length", 14) || EqualsNoCase(key, "Transfer-Encoding", 17);
+        }
+        out += key;
+        out += ": ";
+        out += it->second;
+        out.append(Crlf, sizeof(Crlf));
+    }
+    if (!hasDate)
+    {
+        out += GetDateHead();
+    }
+    //1xx、204、304响应不带body。
+    bool hasBody = resp.statusCode_ >= 200 && resp.statusCode_ != Response::NoContent
+        && resp.statusCode_ != Response::NotModified;
+    if (withLength && !hasLength && hasBody)
+    {
+        out += "Content-Length: ";
+        out += std::to_string(resp.content_.size());
+        out.append(Crlf, sizeof(Crlf));
+    }
+    out.append(Crlf, sizeof(Crlf));
+}
+
+int ResponseWriter::Write(TcpConnectionPtr conn, Response& resp, AfterWriteCallback callback)
+{
+    auto buffers = new ResponseBuffers();
+    buffers->head = FetchBuffer();
+    PackHead(resp, *buffers->head);
+    buffers->body.swap(resp.content_);
+
+    uv_buf_t bufs[2];
+    unsigned int nbufs = 1;
+    bufs[0] = uv_buf_init(const_cast<char*>(buffers->head->c_str()), (unsigned int)buffers->head->size());
+    if (!buffers->body.empty())
+    {
+        bufs[1] = uv_buf_init(const_cast<char*>(buffers->body.c_str()), (unsigned int)buffers->body.size());
+        nbufs = 2;
+    }
+    return conn->write(bufs, nbufs, [buffers, callback](WriteInfo& info)
+    {
+        if (nullptr != callback)
+        {
+            callback(info);
+        }
+        ReleaseBuffer(buffers->head);
+        delete buffers;
+    });
+}
+
+std::string* ResponseWriter::FetchBuffer()
+{
+    if (BufferPool.empty())
+    {
+        auto buffer = new std::string();
+        buffer->reserve(BufferReserveSize);
+        return buffer;
+    }
+    auto buffer = BufferPool.back().release();
+    BufferPool.pop_back();
+    return buffer;
+}
+
+void ResponseWriter::ReleaseBuffer(std::string* buffer)
+{
+    //过大的缓存不回收，避免常驻内存。
+    if (BufferPool.size() >= BufferPoolSize || buffer->capacity() > (BufferReserveSize << 4))
+    {
+        delete buffer;
+        return;
+    }
+    buffer->clear();
+    BufferPool.emplace_back(buffer);
+}
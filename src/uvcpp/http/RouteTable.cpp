@@ -0,0 +1,64 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "../include/http/RouteTable.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+uv::http::RouteTable::RouteTable()
+{
+}
+
+uv::http::RouteTable::RouteTable(const RouteTable& other)
+    :entries_(other.entries_)
+{
+    for (int i = 0; i < Methon::Invalid; i++)
+    {
+        index_[i] = other.index_[i];
+    }
+    for (auto& entry : entries_)
+    {
+        route_[entry.methon].set(std::string(entry.path), entry.route);
+    }
+}
+
+void uv::http::RouteTable::set(Methon methon, const std::string& path, const Route& route)
+{
+    if (methon >= Methon::Invalid)
+    {
+        return;
+    }
+    auto it = index_[methon].find(path);
+    if (it != index_[methon].end())
+    {
+        entries_[it->second].route = route;
+    }
+    else
+    {
+        index_[methon].emplace(path, entries_.size());
+        entries_.push_back(Entry{ methon, path, route });
+    }
+    route_[methon].set(std::string(path), route);
+}
+
+bool uv::http::RouteTable::get(Methon methon, const std::string& path, Route& route) const
+{
+    if (methon >= Methon::Invalid)
+    {
+        return false;
+    }
+    return route_[methon].get(path, route);
+}
+
+size_t uv::http::RouteTable::size() const
+{
+    return entries_.size();
+}
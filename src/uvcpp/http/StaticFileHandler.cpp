@@ -0,0 +1,686 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <functional>
+
+#include "../include/http/StaticFileHandler.hpp"
+#include "../include/http/ResponseWriter.hpp"
+#include "../include/http/Compression.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+namespace
+{
+
+//libuv文件操作请求，回调在loop线程中执行。
+struct FsTask
+{
+    uv_fs_t req;
+    std::function<void(uv_fs_t*)> callback;
+};
+
+void OnFsTask(uv_fs_t* req)
+{
+    auto task = static_cast<FsTask*>(req->data);
+    task->callback(req);
+    ::uv_fs_req_cleanup(req);
+    delete task;
+}
+
+FsTask* CreateFsTask(std::function<void(uv_fs_t*)> callback)
+{
+    auto task = new FsTask();
+    task->req.data = static_cast<void*>(task);
+    task->callback = callback;
+    return task;
+}
+
+//提交失败时同步回调错误码。
+void CheckFsTask(FsTask* task, int rst)
+{
+    if (0 != rst)
+    {
+        task->req.result = rst;
+        OnFsTask(&task->req);
+    }
+}
+
+void CloseFile(EventLoop* loop, uv_file file)
+{
+    auto task = CreateFsTask([](uv_fs_t*) {});
+    CheckFsTask(task, ::uv_fs_close(loop->handle(), &task->req, file, OnFsTask));
+}
+
+using OnReadFileCallback = std::function<void(int, std::shared_ptr<std::string>)>;
+
+struct ReadFileState
+{
+    EventLoop* loop;
+    uv_file file;
+    uint64_t offset;
+    std::shared_ptr<std::string> data;
+    OnReadFileCallback callback;
+};
+
+void ReadFileNext(std::shared_ptr<ReadFileState> state)
+{
+    if (state->offset == state->data->size())
+    {
+        CloseFile(state->loop, state->file);
+        state->callback(0, state->data);
+        return;
+    }
+    auto task = CreateFsTask([state](uv_fs_t* req)
+    {
+        if (req->result <= 0)
+        {
+            CloseFile(state->loop, state->file);
+            state->callback(0 == req->result ? (int)UV_EOF : (int)req->result, nullptr);
+            return;
+        }
+        state->offset += req->result;
+        ReadFileNext(state);
+    });
+    uv_buf_t buf = uv_buf_init(&(*state->data)[state->offset], (unsigned int)(state->data->size() - state->offset));
+    CheckFsTask(task, ::uv_fs_read(state->loop->handle(), &task->req, state->file, &buf, 1, state->offset, OnFsTask));
+}
+
+//读取文件前size字节。
+void ReadFile(EventLoop* loop, const std::string& path, uint64_t size, OnReadFileCallback callback)
+{
+    auto task = CreateFsTask([loop, size, callback](uv_fs_t* req)
+    {
+        if (req->result < 0)
+        {
+            callback((int)req->result, nullptr);
+            return;
+        }
+        auto state = std::make_shared<ReadFileState>();
+        state->loop = loop;
+        state->file = (uv_file)req->result;
+        state->offset = 0;
+        state->data = std::make_shared<std::string>(size, '\0');
+        state->callback = callback;
+        ReadFileNext(state);
+    });
+    CheckFsTask(task, ::uv_fs_open(loop->handle(), &task->req, path.c_str(), O_RDONLY, 0, OnFsTask));
+}
+
+bool ParseNumber(const std::string& str, uint64_t& num)
+{
+    if (str.empty() || str.size() > 19)
+    {
+        return false;
+    }
+    num = 0;
+    for (auto ch : str)
+    {
+        if (ch < '0' || ch > '9')
+        {
+            return false;
+        }
+        num = num * 10 + (ch - '0');
+    }
+    return true;
+}
+
+//返回0忽略Range，1为部分内容，-1为无法满足。仅支持单区间。
+int ParseRange(const std::string& range, uint64_t size, uint64_t& offset, uint64_t& length)
+{
+    static const std::string Unit("bytes=");
+    if (range.compare(0, Unit.size(), Unit) != 0 || range.find(',') != range.npos)
+    {
+        return 0;
+    }
+    auto pos = range.find('-', Unit.size());
+    if (pos == range.npos)
+    {
+        return 0;
+    }
+    std::string first(range, Unit.size(), pos - Unit.size());
+    std::string last(range, pos + 1);
+    uint64_t start = 0;
+    uint64_t end = 0;
+    if (first.empty())
+    {
+        //后缀区间: 最后n个字节。
+        uint64_t n = 0;
+        if (!ParseNumber(last, n))
+        {
+            return 0;
+        }
+        if (0 == n || 0 == size)
+        {
+            return -1;
+        }
+        start = n >= size ? 0 : size - n;
+        end = size - 1;
+    }
+    else
+    {
+        if (!ParseNumber(first, start))
+        {
+            return 0;
+        }
+        if (start >= size)
+        {
+            return -1;
+        }
+        end = size - 1;
+        if (!last.empty())
+        {
+            uint64_t num = 0;
+            if (!ParseNumber(last, num) || num < start)
+            {
+                return 0;
+            }
+            end = num < end ? num : end;
+        }
+    }
+    offset = start;
+    length = end - start + 1;
+    return 1;
+}
+
+std::string Trim(const std::string& str)
+{
+    auto begin = str.find_first_not_of(" \t");
+    if (begin == str.npos)
+    {
+        return std::string();
+    }
+    auto end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+bool MatchEtag(const std::string& values, const std::string& etag)
+{
+    size_t begin = 0;
+    while (begin <= values.size())
+    {
+        auto end = values.find(',', begin);
+        if (end == values.npos)
+        {
+            end = values.size();
+        }
+        auto value = Trim(values.substr(begin, end - begin));
+        //弱比较。
+        if (value.compare(0, 2, "W/") == 0)
+        {
+            value.erase(0, 2);
+        }
+        if (value == "*" || value == etag)
+        {
+            return true;
+        }
+        begin = end + 1;
+    }
+    return false;
+}
+
+int HexValue(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+int UrlDecode(const std::string& str, std::string& out)
+{
+    out.clear();
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        if (str[i] != '%')
+        {
+            out += str[i];
+            continue;
+        }
+        if (i + 2 >= str.size())
+        {
+            return -1;
+        }
+        int high = HexValue(str[i + 1]);
+        int low = HexValue(str[i + 2]);
+        if (high < 0 || low < 0)
+        {
+            return -1;
+        }
+        out += (char)((high << 4) | low);
+        i += 2;
+    }
+    return 0;
+}
+
+std::string GetRequestHead(Request& req, const char* key, const char* lowerKey)
+{
+    auto value = req.getHead(key);
+    if (value.empty())
+    {
+        value = req.getHead(lowerKey);
+    }
+    return value;
+}
+
+}
+
+struct StaticFileHandler::FileRequest
+{
+    Methon methon;
+    HttpVersion version;
+    std::string path;
+    //实际读取的文件：path或其.gz文件。
+    std::string file;
+    bool gzip;
+    std::string ifNoneMatch;
+    std::string ifModifiedSince;
+    std::string range;
+    std::string ifRange;
+    ResponseStreamPtr stream;
+};
+
+StaticFileHandler::StaticFileHandler(std::string prefix, std::string root)
+    :prefix_(prefix),
+    root_(root),
+    index_("index.html"),
+    maxEntries_(4096),
+    maxBytes_(32 << 20),
+    maxFileSize_(64 << 10),
+    statInterval_(1000),
+    gzipSiblings_(false),
+    bytes_(0)
+{
+    while (root_.size() > 1 && root_.back() == '/')
+    {
+        root_.pop_back();
+    }
+}
+
+StaticFileHandler::~StaticFileHandler()
+{
+}
+
+void StaticFileHandler::handle(Request& req, ResponseStreamPtr stream)
+{
+    auto request = std::make_shared<FileRequest>();
+    if (0 != toLocalPath(req.getPath(), request->path))
+    {
+        stream->sendStatus(Response::StatusCode::NotFound);
+        return;
+    }
+    request->methon = req.getMethon();
+    request->version = req.getVersion();
+    request->ifNoneMatch = GetRequestHead(req, "If-None-Match", "if-none-match");
+    request->ifModifiedSince = GetRequestHead(req, "If-Modified-Since", "if-modified-since");
+    request->range = GetRequestHead(req, "Range", "range");
+    request->ifRange = GetRequestHead(req, "If-Range", "if-range");
+    request->stream = stream;
+    //Range按原文件计算，不使用预压缩文件。
+    request->gzip = gzipSiblings_ && request->range.empty() && Compression::IsAccepted(req, Compression::Gzip);
+    request->file = request->gzip ? request->path + ".gz" : request->path;
+    lookup(request);
+}
+
+void StaticFileHandler::setGzipSiblings(bool enable)
+{
+    gzipSiblings_ = enable;
+}
+
+void StaticFileHandler::setIndex(std::string index)
+{
+    index_ = index;
+}
+
+void StaticFileHandler::setCacheSize(uint64_t entries, uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxEntries_ = entries;
+    maxBytes_ = bytes;
+}
+
+void StaticFileHandler::setMaxCacheFileSize(uint64_t size)
+{
+    maxFileSize_ = size;
+}
+
+void StaticFileHandler::setStatInterval(uint64_t ms)
+{
+    statInterval_ = ms;
+}
+
+uint64_t StaticFileHandler::CacheEntries()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+uint64_t StaticFileHandler::CacheBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+std::string StaticFileHandler::GetContentType(const std::string& path)
+{
+    static const std::unordered_map<std::string, std::string> types =
+    {
+        { "html", "text/html; charset=utf-8" },
+        { "htm", "text/html; charset=utf-8" },
+        { "css", "text/css; charset=utf-8" },
+        { "js", "application/javascript; charset=utf-8" },
+        { "json", "application/json" },
+        { "txt", "text/plain; charset=utf-8" },
+        { "xml", "application/xml" },
+        { "svg", "image/svg+xml" },
+        { "png", "image/png" },
+        { "jpg", "image/jpeg" },
+        { "jpeg", "image/jpeg" },
+        { "gif", "image/gif" },
+        { "ico", "image/x-icon" },
+        { "webp", "image/webp" },
+        { "wasm", "application/wasm" },
+        { "pdf", "application/pdf" },
+        { "mp4", "video/mp4" },
+        { "woff", "font/woff" },
+        { "woff2", "font/woff2" },
+    };
+    auto dot = path.rfind('.');
+    auto slash = path.rfind('/');
+    if (dot != path.npos && (slash == path.npos || dot > slash))
+    {
+        std::string ext = path.substr(dot + 1);
+        for (auto& ch : ext)
+        {
+            ch = ::tolower((unsigned char)ch);
+        }
+        auto it = types.find(ext);
+        if (it != types.end())
+        {
+            return it->second;
+        }
+    }
+    return "application/octet-stream";
+}
+
+void StaticFileHandler::lookup(FileRequestPtr request)
+{
+    auto info = getCache(request->file);
+    auto now = ::uv_now(request->stream->getLoop()->handle());
+    if (nullptr != info && now - info->checkTime < statInterval_)
+    {
+        if (request->gzip && !info->exists)
+        {
+            //无.gz文件，回退到原文件。
+            request->gzip = false;
+            request->file = request->path;
+            lookup(request);
+            return;
+        }
+        respond(request, info);
+        return;
+    }
+    stat(request);
+}
+
+void StaticFileHandler::stat(FileRequestPtr request)
+{
+    auto self = shared_from_this();
+    auto loop = request->stream->getLoop();
+    auto task = CreateFsTask([self, request, loop](uv_fs_t* req)
+    {
+        auto info = std::make_shared<FileInfo>();
+        info->checkTime = ::uv_now(loop->handle());
+        info->exists = req->result == 0 && (req->statbuf.st_mode & S_IFMT) == S_IFREG;
+        info->size = 0;
+        info->mtime = 0;
+        if (info->exists)
+        {
+            info->size = req->statbuf.st_size;
+            info->mtime = req->statbuf.st_mtim.tv_sec;
+            char etag[64];
+            ::snprintf(etag, sizeof(etag), "\"%llx-%llx.%llx\"", (unsigned long long)info->size,
+                (unsigned long long)req->statbuf.st_mtim.tv_sec, (unsigned long long)req->statbuf.st_mtim.tv_nsec);
+            info->etag = etag;
+            info->lastModified = ResponseWriter::FormatHttpDate((time_t)info->mtime);
+            //文件未变化则保留已缓存内容。
+            auto old = self->getCache(request->file);
+            if (nullptr != old && old->etag == info->etag)
+            {
+                info->data = old->data;
+            }
+        }
+        self->setCache(request->file, info);
+        if (request->gzip && !info->exists)
+        {
+            request->gzip = false;
+            request->file = request->path;
+            self->lookup(request);
+            return;
+        }
+        self->respond(request, info);
+    });
+    CheckFsTask(task, ::uv_fs_stat(loop->handle(), &task->req, request->file.c_str(), OnFsTask));
+}
+
+void StaticFileHandler::load(FileRequestPtr request, FileInfoPtr info)
+{
+    auto self = shared_from_this();
+    ReadFile(request->stream->getLoop(), request->file, info->size,
+        [self, request, info](int status, std::shared_ptr<std::string> data)
+    {
+        if (0 != status)
+        {
+            request->stream->sendStatus(UV_ENOENT == status ?
+                Response::StatusCode::NotFound : Response::StatusCode::InternalServerError);
+            return;
+        }
+        auto newInfo = std::make_shared<FileInfo>(*info);
+        newInfo->data = data;
+        self->setCache(request->file, newInfo);
+        self->respond(request, newInfo);
+    });
+}
+
+void StaticFileHandler::respond(FileRequestPtr request, FileInfoPtr info)
+{
+    auto stream = request->stream;
+    auto version = request->version;
+    if (!info->exists)
+    {
+        stream->sendStatus(Response::StatusCode::NotFound);
+        return;
+    }
+    //条件请求：If-None-Match优先于If-Modified-Since。
+    bool notModified = request->ifNoneMatch.empty() ?
+        (!request->ifModifiedSince.empty() && request->ifModifiedSince == info->lastModified) :
+        MatchEtag(request->ifNoneMatch, info->etag);
+    if (notModified)
+    {
+        Response resp(version, Response::StatusCode::NotModified);
+        resp.appendHead("ETag", std::string(info->etag));
+        resp.appendHead("Last-Modified", std::string(info->lastModified));
+        if (gzipSiblings_)
+        {
+            resp.appendHead("Vary", "Accept-Encoding");
+        }
+        stream->send(resp);
+        return;
+    }
+    uint64_t offset = 0;
+    uint64_t length = info->size;
+    int range = 0;
+    if (!request->range.empty() &&
+        (request->ifRange.empty() || request->ifRange == info->etag || request->ifRange == info->lastModified))
+    {
+        range = ParseRange(request->range, info->size, offset, length);
+    }
+    if (range < 0)
+    {
+        Response resp(version, Response::StatusCode::RangeNotSatisfiable);
+        resp.appendHead("Content-Range", "bytes */" + std::to_string(info->size));
+        stream->send(resp);
+        return;
+    }
+    Response head(version, range > 0 ? Response::StatusCode::PartialContent : Response::StatusCode::OK);
+    head.appendHead("Content-Type", GetContentType(request->path));
+    head.appendHead("Content-Length", std::to_string(length));
+    head.appendHead("Accept-Ranges", "bytes");
+    head.appendHead("ETag", std::string(info->etag));
+    head.appendHead("Last-Modified", std::string(info->lastModified));
+    if (gzipSiblings_)
+    {
+        head.appendHead("Vary", "Accept-Encoding");
+    }
+    if (request->gzip)
+    {
+        head.appendHead("Content-Encoding", "gzip");
+    }
+    if (range > 0)
+    {
+        head.appendHead("Content-Range", "bytes " + std::to_string(offset) + "-"
+            + std::to_string(offset + length - 1) + "/" + std::to_string(info->size));
+    }
+    if (Methon::Head == request->methon || 0 == length)
+    {
+        stream->writeHead(head);
+        stream->end();
+        return;
+    }
+    if (nullptr != info->data)
+    {
+        stream->writeHead(head);
+        if (length == info->data->size())
+        {
+            stream->writeChunk(info->data);
+        }
+        else
+        {
+            stream->writeChunk(std::make_shared<std::string>(*info->data, offset, length));
+        }
+        stream->end();
+        return;
+    }
+    if (info->size <= maxFileSize_)
+    {
+        load(request, info);
+        return;
+    }
+    sendFile(request, head, offset, length);
+}
+
+void StaticFileHandler::sendFile(FileRequestPtr request, Response& head, uint64_t offset, uint64_t length)
+{
+    auto ptr = std::make_shared<Response>();
+    std::swap(*ptr, head);
+    auto loop = request->stream->getLoop();
+    auto task = CreateFsTask([request, ptr, offset, length](uv_fs_t* req)
+    {
+        if (req->result < 0)
+        {
+            request->stream->sendStatus(UV_ENOENT == req->result ?
+                Response::StatusCode::NotFound : Response::StatusCode::InternalServerError);
+            return;
+        }
+        request->stream->sendFile(*ptr, (uv_file)req->result, offset, length);
+    });
+    CheckFsTask(task, ::uv_fs_open(loop->handle(), &task->req, request->file.c_str(), O_RDONLY, 0, OnFsTask));
+}
+
+StaticFileHandler::FileInfoPtr StaticFileHandler::getCache(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(path);
+    if (it == cache_.end())
+    {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+}
+
+void StaticFileHandler::setCache(const std::string& path, FileInfoPtr info)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(path);
+    if (it != cache_.end())
+    {
+        if (nullptr != it->second->second->data)
+        {
+            bytes_ -= it->second->second->data->size();
+        }
+        lru_.erase(it->second);
+        cache_.erase(it);
+    }
+    lru_.emplace_front(path, info);
+    cache_[path] = lru_.begin();
+    if (nullptr != info->data)
+    {
+        bytes_ += info->data->size();
+    }
+    while (!lru_.empty() && (lru_.size() > maxEntries_ || bytes_ > maxBytes_))
+    {
+        auto& back = lru_.back();
+        if (nullptr != back.second->data)
+        {
+            bytes_ -= back.second->data->size();
+        }
+        cache_.erase(back.first);
+        lru_.pop_back();
+    }
+}
+
+int StaticFileHandler::toLocalPath(const std::string& url, std::string& path)
+{
+    if (url.compare(0, prefix_.size(), prefix_) != 0)
+    {
+        return -1;
+    }
+    std::string name;
+    if (0 != UrlDecode(url.substr(prefix_.size()), name))
+    {
+        return -1;
+    }
+    //拒绝越出root目录的路径。
+    if (name.find('\0') != name.npos || name.find('\\') != name.npos)
+    {
+        return -1;
+    }
+    size_t begin = 0;
+    while (begin <= name.size())
+    {
+        auto end = name.find('/', begin);
+        if (end == name.npos)
+        {
+            end = name.size();
+        }
+        if (name.compare(begin, end - begin, "..") == 0)
+        {
+            return -1;
+        }
+        begin = end + 1;
+    }
+    if (name.empty() || name.back() == '/')
+    {
+        name += index_;
+    }
+    path = root_;
+    if (name.front() != '/')
+    {
+        path += '/';
+    }
+    path += name;
+    return 0;
+}
@@ -0,0 +1,290 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <fcntl.h>
+#include <atomic>
+
+#include "../include/http/TempFileSink.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+//待写数据1Mb时暂停读取。
+uint64_t TempFileSink::HighWaterMark = 1024 << 10;
+
+TempFileSink::TempFileSink(EventLoop* loop, const std::string& dir)
+    :loop_(loop),
+    path_(MakePath(dir)),
+    file_(-1),
+    busy_(false),
+    ended_(false),
+    status_(0),
+    offset_(0),
+    body_(nullptr),
+    callback_(nullptr)
+{
+    req_.data = static_cast<void*>(this);
+}
+
+TempFileSink::~TempFileSink()
+{
+}
+
+void TempFileSink::start(RequestBodyPtr body, OnCompleteCallback callback)
+{
+    body_ = body;
+    callback_ = callback;
+    self_ = shared_from_this();
+    open();
+    if (nullptr == self_)
+    {
+        return;
+    }
+    //self_持有期间回调中使用this安全。
+    body->onBodyChunk([this](const char* data, size_t size)
+    {
+        onChunk(data, size);
+    });
+    body->onEnd([this](int status)
+    {
+        onEnd(status);
+    });
+}
+
+const std::string& TempFileSink::getPath()
+{
+    return path_;
+}
+
+uint64_t TempFileSink::getWritten()
+{
+    return offset_;
+}
+
+void TempFileSink::open()
+{
+    busy_ = true;
+    int rst = ::uv_fs_open(loop_->handle(), &req_, path_.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0600, OnFsCallback);
+    if (0 != rst)
+    {
+        busy_ = false;
+        fail(rst);
+    }
+}
+
+void TempFileSink::write()
+{
+    if (busy_ || file_ < 0 || 0 != status_)
+    {
+        return;
+    }
+    if (writing_.empty())
+    {
+        writing_.swap(queued_);
+        if (nullptr != body_ && body_->isPaused())
+        {
+            body_->resume();
+        }
+    }
+    if (writing_.empty())
+    {
+        if (ended_)
+        {
+            close();
+        }
+        return;
+    }
+    uv_buf_t buf = uv_buf_init(const_cast<char*>(writing_.c_str()), (unsigned int)writing_.size());
+    busy_ = true;
+    int rst = ::uv_fs_write(loop_->handle(), &req_, file_, &buf, 1, offset_, OnFsCallback);
+    if (0 != rst)
+    {
+        busy_ = false;
+        fail(rst);
+    }
+}
+
+void TempFileSink::close()
+{
+    busy_ = true;
+    int rst = ::uv_fs_close(loop_->handle(), &req_, file_, OnFsCallback);
+    if (0 != rst)
+    {
+        busy_ = false;
+        file_ = -1;
+        if (0 == status_)
+        {
+            status_ = rst;
+        }
+        onClose();
+    }
+}
+
+void TempFileSink::OnFsCallback(uv_fs_t* req)
+{
+    auto sink = static_cast<TempFileSink*>(req->data);
+    auto result = req->result;
+    auto type = req->fs_type;
+    ::uv_fs_req_cleanup(req);
+    sink->busy_ = false;
+    if (UV_FS_OPEN == type)
+    {
+        sink->onOpen(result);
+    }
+    else if (UV_FS_WRITE == type)
+    {
+        sink->onWrite(result);
+    }
+    else
+    {
+        sink->onClose();
+    }
+}
+
+void TempFileSink::onOpen(ssize_t result)
+{
+    if (result < 0)
+    {
+        fail((int)result);
+        return;
+    }
+    file_ = (uv_file)result;
+    if (0 != status_)
+    {
+        //打开期间body已失败。
+        close();
+        return;
+    }
+    write();
+}
+
+void TempFileSink::onWrite(ssize_t result)
+{
+    if (result < 0)
+    {
+        fail((int)result);
+        return;
+    }
+    offset_ += result;
+    //部分写入时继续写剩余部分。
+    writing_.erase(0, (size_t)result);
+    if (0 != status_)
+    {
+        close();
+        return;
+    }
+    write();
+}
+
+void TempFileSink::onClose()
+{
+    file_ = -1;
+    if (0 != status_)
+    {
+        auto req = new uv_fs_t;
+        if (0 != ::uv_fs_unlink(loop_->handle(), req, path_.c_str(), [](uv_fs_t* req)
+        {
+            ::uv_fs_req_cleanup(req);
+            delete req;
+        }))
+        {
+            delete req;
+        }
+        path_.clear();
+    }
+    finish();
+}
+
+void TempFileSink::onChunk(const char* data, size_t size)
+{
+    if (0 != status_)
+    {
+        return;
+    }
+    queued_.append(data, size);
+    if (queued_.size() >= HighWaterMark && nullptr != body_)
+    {
+        body_->pause();
+    }
+    write();
+}
+
+void TempFileSink::onEnd(int status)
+{
+    ended_ = true;
+    if (0 != status)
+    {
+        fail(status);
+        return;
+    }
+    write();
+}
+
+void TempFileSink::fail(int status)
+{
+    if (0 == status_)
+    {
+        status_ = status;
+    }
+    writing_.clear();
+    queued_.clear();
+    if (busy_)
+    {
+        //等待当前请求回调后清理。
+        return;
+    }
+    if (file_ >= 0)
+    {
+        close();
+        return;
+    }
+    path_.clear();
+    finish();
+}
+
+void TempFileSink::finish()
+{
+    auto self = self_;
+    self_ = nullptr;
+    if (nullptr != body_)
+    {
+        //写入失败后丢弃剩余body。
+        body_->onBodyChunk(nullptr);
+        body_->onEnd(nullptr);
+        body_->resume();
+        body_ = nullptr;
+    }
+    auto callback = callback_;
+    callback_ = nullptr;
+    if (callback)
+    {
+        callback(status_, path_);
+    }
+}
+
+std::string TempFileSink::MakePath(const std::string& dir)
+{
+    static std::atomic<uint64_t> counter(0);
+    std::string path(dir);
+    if (path.empty())
+    {
+        char buf[1024];
+        size_t size = sizeof(buf);
+        path = 0 == ::uv_os_tmpdir(buf, &size) ? std::string(buf, size) : std::string(".");
+    }
+    if (path.back() != '/' && path.back() != '\\')
+    {
+        path += "/";
+    }
+    //进程号 + 计数 + 时间，O_EXCL保证不覆盖已有文件。
+    path += "uvcpp-upload-" + std::to_string(::uv_os_getpid()) + "-" + std::to_string(counter++)
+        + "-" + std::to_string(::uv_hrtime() % 1000000007);
+    return path;
+}
@@ -0,0 +1,70 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <vector>
+
+#include "../include/http/WebSocketGroup.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+WebSocketGroup::WebSocketGroup()
+{
+}
+
+void WebSocketGroup::add(WebSocketSessionPtr session)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[session.get()] = session;
+}
+
+void WebSocketGroup::remove(WebSocketSessionPtr session)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_.erase(session.get());
+}
+
+size_t WebSocketGroup::size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+size_t WebSocketGroup::broadcast(WebSocketFrame::Opcode opcode, const char* data, uint64_t size)
+{
+    auto frame = WebSocketParser::Encode(opcode, data, size);
+    std::vector<WebSocketSessionPtr> sessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions.reserve(sessions_.size());
+        for (auto it = sessions_.begin(); it != sessions_.end();)
+        {
+            auto session = it->second.lock();
+            if (nullptr == session || !session->isOpen())
+            {
+                it = sessions_.erase(it);
+                continue;
+            }
+            sessions.push_back(session);
+            it++;
+        }
+    }
+    //锁外投递，避免在loop线程中回调时与add/remove相互等待。
+    for (auto& session : sessions)
+    {
+        session->sendFrame(frame);
+    }
+    return sessions.size();
+}
+
+size_t WebSocketGroup::broadcast(const std::string& text)
+{
+    return broadcast(WebSocketFrame::Text, text.c_str(), text.size());
+}
@@ -0,0 +1,274 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <cstring>
+
+#include "../include/http/WebSocketParser.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UV_WEBSOCKET_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define UV_WEBSOCKET_NEON
+#endif
+
+using namespace uv;
+using namespace uv::http;
+
+WebSocketParser::WebSocketParser()
+    :offset_(0),
+    maxFrameSize_(UINT64_MAX),
+    requireMask_(true)
+{
+}
+
+void WebSocketParser::setRequireMask(bool require)
+{
+    requireMask_ = require;
+}
+
+void WebSocketParser::setMaxFrameSize(uint64_t size)
+{
+    maxFrameSize_ = size;
+}
+
+void WebSocketParser::append(const char* data, size_t size)
+{
+    //已解析的帧从缓存头部移除，剩余不完整帧前移。
+    if (offset_ > 0)
+    {
+        buffer_.erase(0, offset_);
+        offset_ = 0;
+    }
+    buffer_.append(data, size);
+}
+
+ParseResult WebSocketParser::next(WebSocketFrame& frame, uint16_t& error)
+{
+    uint64_t available = buffer_.size() - offset_;
+    if (available < 2)
+    {
+        return ParseResult::Fail;
+    }
+    auto head = reinterpret_cast<unsigned char*>(&buffer_[offset_]);
+    bool fin = (head[0] & 0x80) != 0;
+    uint8_t opcode = head[0] & 0x0F;
+    bool masked = (head[1] & 0x80) != 0;
+    uint64_t length = head[1] & 0x7F;
+    error = WebSocketFrame::ProtocolError;
+    //未协商扩展，RSV位必须为0。
+    if (head[0] & 0x70)
+    {
+        return ParseResult::Error;
+    }
+    if (opcode & 0x08)
+    {
+        //控制帧不可分片，payload不超过125字节。
+        if (!fin || length > 125 ||
+            (opcode != WebSocketFrame::Close && opcode != WebSocketFrame::Ping && opcode != WebSocketFrame::Pong))
+        {
+            return ParseResult::Error;
+        }
+    }
+    else if (opcode > WebSocketFrame::Binary)
+    {
+        return ParseResult::Error;
+    }
+    if (requireMask_ && !masked)
+    {
+        return ParseResult::Error;
+    }
+    uint64_t headSize = 2;
+    if (length == 126)
+    {
+        headSize = 4;
+        if (available < headSize)
+        {
+            return ParseResult::Fail;
+        }
+        length = ((uint64_t)head[2] << 8) | head[3];
+    }
+    else if (length == 127)
+    {
+        headSize = 10;
+        if (available < headSize)
+        {
+            return ParseResult::Fail;
+        }
+        length = 0;
+        for (int i = 2; i < 10; i++)
+        {
+            length = (length << 8) | head[i];
+        }
+        if (length >> 63)
+        {
+            return ParseResult::Error;
+        }
+    }
+    if (length > maxFrameSize_)
+    {
+        error = WebSocketFrame::MessageTooBig;
+        return ParseResult::Error;
+    }
+    if (masked)
+    {
+        headSize += 4;
+    }
+    if (available < headSize || available - headSize < length)
+    {
+        return ParseResult::Fail;
+    }
+    char* payload = reinterpret_cast<char*>(head + headSize);
+    if (masked)
+    {
+        Unmask(payload, length, head + headSize - 4);
+    }
+    frame.fin = fin;
+    frame.opcode = opcode;
+    frame.payload = payload;
+    frame.size = length;
+    offset_ += headSize + length;
+    return ParseResult::Success;
+}
+
+void WebSocketParser::Unmask(char* data, uint64_t size, const unsigned char key[4])
+{
+    uint32_t key32;
+    std::memcpy(&key32, key, 4);
+    uint64_t i = 0;
+#if defined(UV_WEBSOCKET_SSE2)
+    __m128i mask = _mm_set1_epi32((int)key32);
+    for (; i + 16 <= size; i += 16)
+    {
+        auto ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, _mm_xor_si128(_mm_loadu_si128(ptr), mask));
+    }
+#elif defined(UV_WEBSOCKET_NEON)
+    uint8x16_t mask = vreinterpretq_u8_u32(vdupq_n_u32(key32));
+    for (; i + 16 <= size; i += 16)
+    {
+        auto ptr = reinterpret_cast<uint8_t*>(data + i);
+        vst1q_u8(ptr, veorq_u8(vld1q_u8(ptr), mask));
+    }
+#endif
+    //i始终为4的倍数，尾部按key[i & 3]对齐。
+    uint64_t key64 = ((uint64_t)key32 << 32) | key32;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, data + i, 8);
+        value ^= key64;
+        std::memcpy(data + i, &value, 8);
+    }
+    for (; i < size; i++)
+    {
+        data[i] ^= key[i & 3];
+    }
+}
+
+void WebSocketParser::EncodeHead(std::string& out, uint8_t opcode, uint64_t size, bool fin)
+{
+    out += (char)((fin ? 0x80 : 0x00) | (opcode & 0x0F));
+    if (size < 126)
+    {
+        out += (char)size;
+    }
+    else if (size <= 0xFFFF)
+    {
+        out += (char)126;
+        out += (char)(size >> 8);
+        out += (char)(size & 0xFF);
+    }
+    else
+    {
+        out += (char)127;
+        for (int i = 7; i >= 0; i--)
+        {
+            out += (char)((size >> (i * 8)) & 0xFF);
+        }
+    }
+}
+
+std::shared_ptr<std::string> WebSocketParser::Encode(uint8_t opcode, const char* data, uint64_t size)
+{
+    auto frame = std::make_shared<std::string>();
+    frame->reserve(size + 10);
+    EncodeHead(*frame, opcode, size);
+    frame->append(data, size);
+    return frame;
+}
+
+bool WebSocketParser::IsValidUtf8(const char* data, uint64_t size)
+{
+    auto str = reinterpret_cast<const unsigned char*>(data);
+    uint64_t i = 0;
+    while (i < size)
+    {
+        //ASCII快速路径，每次检查8字节。
+        if (i + 8 <= size)
+        {
+            uint64_t value;
+            std::memcpy(&value, str + i, 8);
+            if (0 == (value & 0x8080808080808080ULL))
+            {
+                i += 8;
+                continue;
+            }
+        }
+        unsigned char ch = str[i];
+        if (ch < 0x80)
+        {
+            i++;
+            continue;
+        }
+        uint64_t count;
+        uint32_t code;
+        if (ch >= 0xC2 && ch <= 0xDF)
+        {
+            count = 1;
+            code = ch & 0x1F;
+        }
+        else if (ch >= 0xE0 && ch <= 0xEF)
+        {
+            count = 2;
+            code = ch & 0x0F;
+        }
+        else if (ch >= 0xF0 && ch <= 0xF4)
+        {
+            count = 3;
+            code = ch & 0x07;
+        }
+        else
+        {
+            return false;
+        }
+        if (i + count >= size)
+        {
+            return false;
+        }
+        for (uint64_t j = 1; j <= count; j++)
+        {
+            if ((str[i + j] & 0xC0) != 0x80)
+            {
+                return false;
+            }
+            code = (code << 6) | (str[i + j] & 0x3F);
+        }
+        //拒绝过长编码、代理区及超出范围的码点。
+        if ((count == 2 && code < 0x800) || (count == 3 && code < 0x10000) ||
+            (code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF)
+        {
+            return false;
+        }
+        i += count + 1;
+    }
+    return true;
+}
@@ -0,0 +1,462 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <algorithm>
+
+#include "../include/http/WebSocketSession.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+uint64_t WebSocketSession::DefaultMaxMessageSize = 16 * 1024 * 1024;
+uint64_t WebSocketSession::DefaultCloseTimeout = 5000;
+
+namespace
+{
+const char WebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+std::string GetRequestHead(Request& req, const char* key, const char* lowerKey)
+{
+    auto value = req.getHead(key);
+    if (value.empty())
+    {
+        value = req.getHead(lowerKey);
+    }
+    std::transform(value.begin(), value.end(), value.begin(),
+        [](unsigned char ch) { return (char)::tolower(ch); });
+    return value;
+}
+
+bool IsValidCloseCode(uint16_t code)
+{
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011) || (code >= 3000 && code <= 4999);
+}
+}
+
+WebSocketSession::WebSocketSession(EventLoop* loop, TcpConnectionPtr connection)
+    :loop_(loop),
+    connection_(connection),
+    name_(connection->Name()),
+    state_(Open),
+    pending_(0),
+    messageOpcode_(WebSocketFrame::Continuation),
+    maxMessageSize_(DefaultMaxMessageSize),
+    closeNotified_(false),
+    closeTimeout_(DefaultCloseTimeout),
+    onMessageCallback_(nullptr),
+    onCloseCallback_(nullptr),
+    onPongCallback_(nullptr),
+    closeConnectionCallback_(nullptr)
+{
+    parser_.setMaxFrameSize(maxMessageSize_);
+}
+
+WebSocketSession::~WebSocketSession()
+{
+}
+
+void WebSocketSession::setMessageCallback(OnMessageCallback callback)
+{
+    onMessageCallback_ = callback;
+}
+
+void WebSocketSession::setCloseCallback(OnCloseCallback callback)
+{
+    onCloseCallback_ = callback;
+}
+
+void WebSocketSession::setPongCallback(OnPongCallback callback)
+{
+    onPongCallback_ = callback;
+}
+
+void WebSocketSession::setMaxMessageSize(uint64_t size)
+{
+    maxMessageSize_ = size;
+    parser_.setMaxFrameSize(size);
+}
+
+void WebSocketSession::setCloseTimeout(uint64_t ms)
+{
+    closeTimeout_ = ms;
+}
+
+void WebSocketSession::sendText(const std::string& data)
+{
+    send(WebSocketFrame::Text, data.c_str(), data.size());
+}
+
+void WebSocketSession::sendBinary(const std::string& data)
+{
+    send(WebSocketFrame::Binary, data.c_str(), data.size());
+}
+
+void WebSocketSession::send(WebSocketFrame::Opcode opcode, const char* data, uint64_t size)
+{
+    sendFrame(WebSocketParser::Encode(opcode, data, size));
+}
+
+void WebSocketSession::sendFrame(std::shared_ptr<std::string> frame)
+{
+    auto self = shared_from_this();
+    post([self, frame]()
+    {
+        if (self->state_ == Open)
+        {
+            self->writeFrame(frame);
+        }
+    });
+}
+
+void WebSocketSession::ping(const std::string& data)
+{
+    sendFrame(WebSocketParser::Encode(WebSocketFrame::Ping, data.c_str(), std::min<uint64_t>(data.size(), 125)));
+}
+
+void WebSocketSession::close(uint16_t code, const std::string& reason)
+{
+    auto self = shared_from_this();
+    post([self, code, reason]()
+    {
+        self->closeInLoop(code, reason);
+    });
+}
+
+bool WebSocketSession::isOpen()
+{
+    return state_ == Open;
+}
+
+uint64_t WebSocketSession::pendingSize()
+{
+    return pending_;
+}
+
+const std::string& WebSocketSession::Name()
+{
+    return name_;
+}
+
+EventLoop* WebSocketSession::getLoop()
+{
+    return loop_;
+}
+
+void WebSocketSession::setCloseConnectionCallback(DefaultCallback callback)
+{
+    closeConnectionCallback_ = callback;
+}
+
+void WebSocketSession::onData(const char* data, size_t size)
+{
+    if (state_ == Closed)
+    {
+        return;
+    }
+    parser_.append(data, size);
+    while (state_ != Closed)
+    {
+        WebSocketFrame frame;
+        uint16_t error;
+        auto rst = parser_.next(frame, error);
+        if (ParseResult::Fail == rst)
+        {
+            break;
+        }
+        if (ParseResult::Error == rst)
+        {
+            fail(error);
+            break;
+        }
+        onFrame(frame);
+    }
+}
+
+void WebSocketSession::onDisconnected()
+{
+    state_ = Closed;
+    cancelCloseTimer();
+    notifyClose(WebSocketFrame::Abnormal, "");
+}
+
+bool WebSocketSession::IsUpgradeRequest(Request& req)
+{
+    if (req.getMethon() != Methon::Get || req.getVersion() != HttpVersion::Http1_1)
+    {
+        return false;
+    }
+    auto upgrade = GetRequestHead(req, "Upgrade", "upgrade");
+    auto connection = GetRequestHead(req, "Connection", "connection");
+    auto version = GetRequestHead(req, "Sec-WebSocket-Version", "sec-websocket-version");
+    auto key = GetRequestHead(req, "Sec-WebSocket-Key", "sec-websocket-key");
+    return upgrade.find("websocket") != upgrade.npos &&
+        connection.find("upgrade") != connection.npos &&
+        version == "13" && !key.empty();
+}
+
+std::string WebSocketSession::AcceptKey(const std::string& key)
+{
+    std::string str = key + WebSocketGuid;
+    unsigned char digest[20];
+    Sha1(str.c_str(), str.size(), digest);
+    return Base64Encode(digest, sizeof(digest));
+}
+
+void WebSocketSession::post(DefaultCallback op)
+{
+    loop_->runInThisLoop(op);
+}
+
+void WebSocketSession::writeFrame(std::shared_ptr<std::string> frame, DefaultCallback callback)
+{
+    auto connection = connection_.lock();
+    if (nullptr == connection)
+    {
+        if (nullptr != callback)
+        {
+            callback();
+        }
+        return;
+    }
+    uint64_t size = frame->size();
+    pending_ += size;
+    auto self = shared_from_this();
+    connection->write(frame->c_str(), frame->size(), [self, frame, size, callback](WriteInfo&)
+    {
+        self->pending_ -= size;
+        if (nullptr != callback)
+        {
+            callback();
+        }
+    });
+}
+
+void WebSocketSession::closeInLoop(uint16_t code, const std::string& reason)
+{
+    if (state_ != Open)
+    {
+        return;
+    }
+    state_ = Closing;
+    writeFrame(EncodeClose(code, reason));
+    if (closeTimeout_ > 0)
+    {
+        std::weak_ptr<WebSocketSession> session = shared_from_this();
+        closeTimer_ = loop_->getTimerService()->schedule(closeTimeout_, [session]()
+        {
+            auto ptr = session.lock();
+            if (ptr)
+            {
+                ptr->onCloseTimeout();
+            }
+        });
+    }
+}
+
+void WebSocketSession::onCloseTimeout()
+{
+    //对端未在时限内回应关闭帧。
+    if (state_ != Closing)
+    {
+        return;
+    }
+    state_ = Closed;
+    shutdown();
+    notifyClose(WebSocketFrame::Abnormal, "");
+}
+
+void WebSocketSession::cancelCloseTimer()
+{
+    //未发起过关闭的连接不创建TimerService。
+    if (nullptr != closeTimer_.element)
+    {
+        loop_->getTimerService()->cancel(closeTimer_);
+    }
+}
+
+void WebSocketSession::onFrame(WebSocketFrame& frame)
+{
+    switch (frame.opcode)
+    {
+    case WebSocketFrame::Ping:
+        if (state_ == Open)
+        {
+            writeFrame(WebSocketParser::Encode(WebSocketFrame::Pong, frame.payload, frame.size));
+        }
+        break;
+    case WebSocketFrame::Pong:
+        if (nullptr != onPongCallback_)
+        {
+            std::string data(frame.payload, frame.size);
+            onPongCallback_(shared_from_this(), data);
+        }
+        break;
+    case WebSocketFrame::Close:
+        onCloseFrame(frame);
+        break;
+    case WebSocketFrame::Continuation:
+        //未处于分片消息中。
+        if (messageOpcode_ == WebSocketFrame::Continuation)
+        {
+            fail(WebSocketFrame::ProtocolError);
+            return;
+        }
+        if (message_.size() + frame.size > maxMessageSize_)
+        {
+            fail(WebSocketFrame::MessageTooBig);
+            return;
+        }
+        message_.append(frame.payload, frame.size);
+        if (frame.fin)
+        {
+            std::string message;
+            message.swap(message_);
+            auto opcode = messageOpcode_;
+            messageOpcode_ = WebSocketFrame::Continuation;
+            deliver(opcode, message);
+        }
+        break;
+    default:
+        //上一条分片消息尚未结束。
+        if (messageOpcode_ != WebSocketFrame::Continuation)
+        {
+            fail(WebSocketFrame::ProtocolError);
+            return;
+        }
+        if (frame.fin)
+        {
+            std::string message(frame.payload, frame.size);
+            deliver(frame.opcode, message);
+        }
+        else
+        {
+            messageOpcode_ = frame.opcode;
+            message_.assign(frame.payload, frame.size);
+        }
+        break;
+    }
+}
+
+void WebSocketSession::onCloseFrame(WebSocketFrame& frame)
+{
+    uint16_t code = WebSocketFrame::NoStatus;
+    std::string reason;
+    if (frame.size == 1)
+    {
+        fail(WebSocketFrame::ProtocolError);
+        return;
+    }
+    if (frame.size >= 2)
+    {
+        code = ((uint16_t)(unsigned char)frame.payload[0] << 8) | (unsigned char)frame.payload[1];
+        if (!IsValidCloseCode(code))
+        {
+            fail(WebSocketFrame::ProtocolError);
+            return;
+        }
+        if (!WebSocketParser::IsValidUtf8(frame.payload + 2, frame.size - 2))
+        {
+            fail(WebSocketFrame::InvalidPayload);
+            return;
+        }
+        reason.assign(frame.payload + 2, frame.size - 2);
+    }
+    auto self = shared_from_this();
+    if (state_ == Open)
+    {
+        //回应关闭帧后断开连接。
+        state_ = Closed;
+        auto response = EncodeClose(code == WebSocketFrame::NoStatus ? 0 : code, "");
+        writeFrame(response, [self]()
+        {
+            self->shutdown();
+        });
+    }
+    else
+    {
+        state_ = Closed;
+        cancelCloseTimer();
+        shutdown();
+    }
+    notifyClose(code, reason);
+}
+
+void WebSocketSession::deliver(uint8_t opcode, std::string& message)
+{
+    if (opcode == WebSocketFrame::Text && !WebSocketParser::IsValidUtf8(message.c_str(), message.size()))
+    {
+        fail(WebSocketFrame::InvalidPayload);
+        return;
+    }
+    if (nullptr != onMessageCallback_)
+    {
+        onMessageCallback_(shared_from_this(), (WebSocketFrame::Opcode)opcode, message);
+    }
+}
+
+void WebSocketSession::fail(uint16_t code)
+{
+    if (state_ == Closed)
+    {
+        return;
+    }
+    auto self = shared_from_this();
+    if (state_ == Open)
+    {
+        state_ = Closed;
+        writeFrame(EncodeClose(code, ""), [self]()
+        {
+            self->shutdown();
+        });
+    }
+    else
+    {
+        state_ = Closed;
+        cancelCloseTimer();
+        shutdown();
+    }
+    notifyClose(code, "");
+}
+
+void WebSocketSession::shutdown()
+{
+    if (nullptr != closeConnectionCallback_)
+    {
+        auto callback = closeConnectionCallback_;
+        closeConnectionCallback_ = nullptr;
+        callback();
+    }
+}
+
+void WebSocketSession::notifyClose(uint16_t code, const std::string& reason)
+{
+    if (closeNotified_)
+    {
+        return;
+    }
+    closeNotified_ = true;
+    if (nullptr != onCloseCallback_)
+    {
+        onCloseCallback_(shared_from_this(), code, reason);
+    }
+}
+
+std::shared_ptr<std::string> WebSocketSession::EncodeClose(uint16_t code, const std::string& reason)
+{
+    //code为0时关闭帧不带payload。
+    std::string payload;
+    if (0 != code)
+    {
+        payload += (char)(code >> 8);
+        payload += (char)(code & 0xFF);
+        payload.append(reason, 0, 123);
+    }
+    return WebSocketParser::Encode(WebSocketFrame::Close, payload.c_str(), payload.size());
+}
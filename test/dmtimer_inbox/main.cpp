@@ -0,0 +1,206 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <uv11.hpp>
+#include <DMTimerAdapter.hpp>
+
+//工作线程向loop中的dmtimer模块注册后立即注销timer(模拟请求超时)，对比两种方式：
+//inbox         CDMTimerModule::PostTimer/PostKillTimer，无锁投递，下次Run()时执行；
+//runInThisLoop 每次调用构造lambda，经EventLoop::runInThisLoop转到loop线程执行SetTimer/KillTimer。
+//统计工作线程每次调用的耗时，以及全部命令在loop中执行完的总耗时。
+
+class CountSink : public ITimerSink
+{
+public:
+    CountSink()
+        :fired(0)
+    {
+    }
+    virtual void OnTimer(uint64_t qwIDEvent)
+    {
+        fired++;
+    }
+    std::atomic<uint64_t> fired;
+};
+
+//所有命令执行完后由loop线程回调，记录结束时间，关闭适配器后停止loop。
+class DoneSink : public ITimerSink
+{
+public:
+    DoneSink(uv::EventLoop* loop, uv::DMTimerAdapter* adapter, uint64_t& end)
+        :loop_(loop),
+        adapter_(adapter),
+        end_(end)
+    {
+    }
+    virtual void OnTimer(uint64_t qwIDEvent)
+    {
+        if (0 == end_)
+        {
+            end_ = uv_hrtime();
+            auto loop = loop_;
+            adapter_->close([loop]()
+            {
+                loop->stop();
+            });
+        }
+    }
+private:
+    uv::EventLoop* loop_;
+    uv::DMTimerAdapter* adapter_;
+    uint64_t& end_;
+};
+
+struct BenchResult
+{
+    uint64_t callNs = 0;
+    uint64_t totalNs = 0;
+    uint64_t fired = 0;
+};
+
+static BenchResult Run(bool inbox, int threads, unsigned int count)
+{
+    BenchResult result;
+    uv::EventLoop loop;
+    uv::DMTimerAdapter adapter(&loop);
+    CountSink sink;
+    uint64_t end = 0;
+    DoneSink doneSink(&loop, &adapter, end);
+    std::vector<CDMTimerNode*> nodes;
+    std::atomic<bool> running(false);
+    uv::Timer started(&loop, 0, 0, [&running](uv::Timer* timer)
+    {
+        running = true;
+        timer->close(nullptr);
+    });
+    started.start();
+    adapter.start();
+
+    std::thread loopThread([&loop]()
+    {
+        loop.run();
+    });
+    while (!running)
+    {
+        std::this_thread::yield();
+    }
+
+    //runInThisLoop方式下每个工作线程一个节点，timer以序号区分。
+    class Node : public CDMTimerNode
+    {
+    public:
+        Node(CountSink& sink)
+            :sink_(sink)
+        {
+        }
+        virtual void OnTimer(uint64_t qwIDEvent)
+        {
+            sink_.fired++;
+        }
+    private:
+        CountSink& sink_;
+    };
+    for (int i = 0; i < threads; i++)
+    {
+        auto node = new Node(sink);
+        adapter.attach(node);
+        nodes.push_back(node);
+    }
+
+    auto module = adapter.getModule();
+    std::vector<uint64_t> callNs(threads);
+    std::vector<std::thread> workers;
+    auto start = uv_hrtime();
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]()
+        {
+            auto begin = uv_hrtime();
+            auto node = nodes[t];
+            for (unsigned int i = 0; i < count; i++)
+            {
+                if (inbox)
+                {
+                    auto id = module->PostTimer(&sink, i, 50, 50);
+                    module->PostKillTimer(id);
+                }
+                else
+                {
+                    loop.runInThisLoop([node, i]()
+                    {
+                        node->SetTimer(i, 50);
+                    });
+                    loop.runInThisLoop([node, i]()
+                    {
+                        node->KillTimer(i);
+                    });
+                }
+            }
+            callNs[t] = uv_hrtime() - begin;
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    //同一队列中此前的命令均已执行后才会触发。
+    if (inbox)
+    {
+        module->PostTimer(&doneSink, 0, 1000, 0);
+    }
+    else
+    {
+        loop.runInThisLoop([&doneSink]()
+        {
+            doneSink.OnTimer(0);
+        });
+    }
+    loopThread.join();
+
+    for (auto ns : callNs)
+    {
+        result.callNs += ns;
+    }
+    result.callNs /= threads;
+    result.totalNs = end - start;
+    result.fired = sink.fired;
+    for (auto node : nodes)
+    {
+        delete node;
+    }
+    return result;
+}
+
+static void Report(const char* name, unsigned int count, BenchResult& result)
+{
+    std::cout << "  " << name << "  " << (double)result.callNs / count << " ns/op per thread, all applied after "
+        << result.totalNs / 1000000.0 << " ms, " << result.fired << " cancelled timers fired" << std::endl;
+}
+
+int main(int argc, char** args)
+{
+    int threads = 4;
+    unsigned int count = 200000;
+    if (argc > 1)
+        threads = std::max(1, std::atoi(args[1]));
+    if (argc > 2)
+        count = std::stoul(args[2]);
+
+    std::cout << threads << " threads x " << count << " schedule+cancel" << std::endl;
+    auto inbox = Run(true, threads, count);
+    Report("inbox        ", count, inbox);
+    auto bounce = Run(false, threads, count);
+    Report("runInThisLoop", count, bounce);
+    return 0;
+}
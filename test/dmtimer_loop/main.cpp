@@ -0,0 +1,125 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <uv11.hpp>
+#include <DMTimerAdapter.hpp>
+
+//每个线程一个EventLoop及其dmtimer模块，各线程的timer只在本线程触发，互不加锁。
+//线程0使用该线程的默认模块(CDMTimerModule::Instance())，其余线程由适配器持有模块。
+
+class Session : public CDMTimerNode
+{
+public:
+    Session(std::thread::id owner, uint64_t& fired, uint64_t& foreign)
+        :owner_(owner),
+        fired_(fired),
+        foreign_(foreign)
+    {
+    }
+
+    virtual void OnTimer(uint64_t qwIDEvent)
+    {
+        fired_++;
+        if (std::this_thread::get_id() != owner_)
+        {
+            foreign_++;
+        }
+    }
+
+private:
+    std::thread::id owner_;
+    uint64_t& fired_;
+    uint64_t& foreign_;
+};
+
+struct LoopResult
+{
+    uint64_t fired = 0;
+    uint64_t foreign = 0;
+    std::string profile;
+};
+
+static void RunLoop(int index, int sessions, uint64_t duration, LoopResult& result)
+{
+    uv::EventLoop loop;
+    CDMTimerModule* module = (0 == index) ? CDMTimerModule::Instance() : nullptr;
+    uv::DMTimerAdapter adapter(&loop, 1, module);
+    std::vector<Session*> nodes;
+    for (int i = 0; i < sessions; i++)
+    {
+        auto node = new Session(std::this_thread::get_id(), result.fired, result.foreign);
+        adapter.attach(node);
+        //心跳10ms，超时检查100ms。
+        node->SetTimer(1, 10);
+        node->SetTimer(2, 100);
+        nodes.push_back(node);
+    }
+    //线程0统计各timer的触发次数、延迟及回调耗时。
+    adapter.getModule()->EnableProfile(0 == index);
+    adapter.start();
+
+    uv::Timer stop(&loop, duration, 0, [&](uv::Timer* timer)
+    {
+        if (adapter.getModule()->IsProfileEnabled())
+        {
+            adapter.getModule()->DumpProfile(result.profile);
+        }
+        for (auto node : nodes)
+        {
+            delete node;
+        }
+        nodes.clear();
+        //适配器及本定时器的句柄都关闭后再退出loop。
+        adapter.close([timer, &loop]()
+        {
+            timer->close([&loop](uv::Timer*)
+            {
+                loop.stop();
+            });
+        });
+    });
+    stop.start();
+    loop.run();
+}
+
+int main(int argc, char** args)
+{
+    int threads = 4;
+    int sessions = 1000;
+    uint64_t duration = 1000;
+    if (argc > 1)
+        threads = std::max(1, std::atoi(args[1]));
+    if (argc > 2)
+        sessions = std::max(1, std::atoi(args[2]));
+
+    std::vector<LoopResult> results(threads);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(RunLoop, i, sessions, duration, std::ref(results[i]));
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    uint64_t expected = (duration / 10 + duration / 100) * sessions;
+    for (int i = 0; i < threads; i++)
+    {
+        std::cout << "loop " << i << ": " << results[i].fired << " timer callbacks (expected about " << expected
+            << "), " << results[i].foreign << " on a foreign thread" << std::endl;
+    }
+    std::cout << "loop 0 timer profile (late in ms, cost in us):" << std::endl << results[0].profile;
+    return 0;
+}
@@ -0,0 +1,108 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <uv11.hpp>
+
+//客户端与服务端均开启100ms心跳，2秒后服务端停止读取(模拟对端挂死)，观察失效检出用时。
+int main(int argc, char** args)
+{
+    uv::EventLoop loop;
+    uv::GlobalConfig::BufferModeStatus = uv::GlobalConfig::CycleBuffer;
+    const uint64_t interval = 100;
+    const unsigned int misses = 3;
+
+    uint64_t received = 0;
+    std::weak_ptr<uv::TcpConnection> accepted;
+    uv::TcpServer server(&loop);
+    server.setHeartbeat(interval, misses);
+    server.setNewConnectCallback([&accepted](std::weak_ptr<uv::TcpConnection> connection)
+    {
+        accepted = connection;
+    });
+    server.setMessageCallback([&received](uv::TcpConnectionPtr connection, const char* data, ssize_t size)
+    {
+        auto packetbuf = connection->getPacketBuffer();
+        packetbuf->append(data, size);
+        uv::Packet packet;
+        while (0 == packetbuf->readPacket(packet))
+        {
+            received++;
+        }
+    });
+    uv::SocketAddr addr("127.0.0.1", 10011);
+    server.bindAndListen(addr);
+
+    uint64_t stopped = 0;
+    uv::TcpClient client(&loop);
+    client.setHeartbeat(interval, misses);
+    client.setConnectStatusCallback([&](uv::TcpClient::ConnectStatus status)
+    {
+        if (uv::TcpClient::OnConnectClose == status)
+        {
+            std::cout << "peer dead detected after " << uv_now(loop.handle()) - stopped << " ms (bound "
+                << (misses + 1) * interval << " ms), packets received by server: " << received << std::endl;
+            loop.stop();
+        }
+        else if (uv::TcpClient::OnConnectFail == status)
+        {
+            std::cout << "connect fail." << std::endl;
+            loop.stop();
+        }
+    });
+    client.connect(addr);
+
+    //普通数据包与心跳帧交错发送，其中与控制帧等长且含控制帧包头字节的包不应被剥离。
+    uv::Timer sender(&loop, 20, 20, [&client](uv::Timer*)
+    {
+        static const char* messages[] = { "hello heartbeat", "\x01}}}}}}}}" };
+        static int index = 0;
+        uv::Packet packet;
+        auto message = messages[index++ & 1];
+        packet.pack(message, (uint16_t)strlen(message));
+        client.write(packet.Buffer().c_str(), packet.PacketSize());
+    });
+    sender.start();
+
+    uv::Timer report(&loop, 500, 500, [&](uv::Timer*)
+    {
+        uv::HeartbeatStats stats;
+        if (client.getHeartbeatStats(stats))
+        {
+            std::cout << "ping " << stats.pingsSent << " pong " << stats.pongsReceived
+                << " srtt " << stats.smoothedRtt << "us jitter " << stats.rttJitter << "us min " << stats.minRtt << "us";
+            if (stats.tcpInfoValid)
+            {
+                std::cout << " | tcp rtt " << stats.tcpRtt << "us cwnd " << stats.tcpCwnd << " retrans " << stats.tcpRetransmits;
+            }
+            std::cout << " | server packets " << received << std::endl;
+        }
+    });
+    report.start();
+
+    uv::Timer hang(&loop, 2000, 0, [&](uv::Timer*)
+    {
+        auto connection = accepted.lock();
+        if (connection)
+        {
+            //服务端停止读取且不再回复pong。
+            connection->setHeartbeat(0, 0);
+            connection->pauseRead();
+            stopped = uv_now(loop.handle());
+            std::cout << "server stops reading." << std::endl;
+        }
+    });
+    hang.start();
+
+    loop.run();
+}
@@ -0,0 +1,138 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <uv11.hpp>
+
+//周期定时器的抖动：记录相邻两次回调间隔与标称周期之差的绝对值(us)，
+//对比uv::Timer(最小1ms)与HighResTimer在1ms~50us周期下的分位数及log2直方图。
+
+#ifdef __linux__
+
+struct JitterResult
+{
+    std::vector<uint64_t> errors;
+};
+
+static void Record(JitterResult& result, uint64_t& last, uint64_t periodNs)
+{
+    auto now = uv::HighResTimer::Now();
+    if (0 != last)
+    {
+        auto interval = now - last;
+        auto error = interval > periodNs ? interval - periodNs : periodNs - interval;
+        result.errors.push_back(error / 1000);
+    }
+    last = now;
+}
+
+static JitterResult RunUvTimer(uint64_t periodMs, unsigned int count)
+{
+    JitterResult result;
+    uv::EventLoop loop;
+    uint64_t last = 0;
+    uv::Timer timer(&loop, periodMs, periodMs, [&](uv::Timer* handle)
+    {
+        Record(result, last, periodMs * 1000000);
+        if (result.errors.size() == count)
+        {
+            handle->close([&loop](uv::Timer*)
+            {
+                loop.stop();
+            });
+        }
+    });
+    timer.start();
+    loop.run();
+    return result;
+}
+
+static JitterResult RunHighRes(uint64_t periodUs, unsigned int count)
+{
+    JitterResult result;
+    uv::EventLoop loop;
+    uv::HighResTimer timers(&loop);
+    uint64_t last = 0;
+    uv::HighResTimer::Handle handle;
+    handle = timers.schedule(periodUs, [&]()
+    {
+        Record(result, last, periodUs * 1000);
+        if (result.errors.size() == count)
+        {
+            timers.cancel(handle);
+            loop.stop();
+        }
+    }, periodUs);
+    loop.run();
+    return result;
+}
+
+static void Report(const char* name, uint64_t periodUs, JitterResult& result)
+{
+    auto& errors = result.errors;
+    std::sort(errors.begin(), errors.end());
+    auto percentile = [&errors](double p)
+    {
+        return errors[std::min(errors.size() - 1, (size_t)(p / 100 * errors.size()))];
+    };
+    std::cout << name << " period " << periodUs << "us, jitter(us) p50 " << percentile(50) << " p90 " << percentile(90)
+        << " p99 " << percentile(99) << " p99.9 " << percentile(99.9) << " max " << errors.back() << std::endl;
+    //log2分桶：[0,1) [1,2) [2,4) ...
+    std::vector<uint64_t> buckets;
+    for (auto error : errors)
+    {
+        size_t bucket = 0;
+        while ((1ull << bucket) <= error)
+        {
+            bucket++;
+        }
+        if (buckets.size() <= bucket)
+        {
+            buckets.resize(bucket + 1);
+        }
+        buckets[bucket]++;
+    }
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        if (0 == buckets[i])
+            continue;
+        uint64_t low = i == 0 ? 0 : (1ull << (i - 1));
+        std::cout << "    [" << low << ", " << (1ull << i) << ") " << std::string(std::max<uint64_t>(1, buckets[i] * 50 / errors.size()), '#')
+            << " " << buckets[i] << std::endl;
+    }
+}
+
+int main(int argc, char** args)
+{
+    unsigned int count = 5000;
+    if (argc > 1)
+        count = std::stoul(args[1]);
+
+    auto uvTimer = RunUvTimer(1, count);
+    Report("uv::Timer   ", 1000, uvTimer);
+    for (uint64_t period : { 1000, 200, 100, 50 })
+    {
+        auto highRes = RunHighRes(period, count);
+        Report("HighResTimer", period, highRes);
+    }
+    return 0;
+}
+
+#else
+
+int main(int argc, char** args)
+{
+    std::cout << "HighResTimer requires Linux timerfd." << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,191 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "BenchConnection.hpp"
+
+using namespace uv;
+using namespace uv::http;
+
+BenchConnection::BenchConnection(EventLoop* loop, SocketAddr& addr, const std::string& request)
+    :loop_(loop),
+    addr_(addr),
+    request_(request),
+    client_(loop),
+    reconnect_(nullptr),
+    state_(Closed),
+    stopping_(false),
+    startNs_(0),
+    bytes_(0),
+    connectErrors_(0)
+{
+    client_.setConnectStatusCallback(std::bind(&BenchConnection::onConnectStatus, this, std::placeholders::_1));
+    client_.setMessageCallback(std::bind(&BenchConnection::onMessage, this, std::placeholders::_1, std::placeholders::_2));
+    //只统计body字节数，不缓存内容。
+    parser_.setBodyCallback([this](const char* data, size_t size)
+    {
+        bytes_ += size;
+    });
+}
+
+void BenchConnection::setResponseCallback(OnResponseCallback callback)
+{
+    onResponse_ = callback;
+}
+
+void BenchConnection::setReadyCallback(OnReadyCallback callback)
+{
+    onReady_ = callback;
+}
+
+void BenchConnection::connect()
+{
+    state_ = Connecting;
+    client_.connect(addr_);
+}
+
+void BenchConnection::send(uint64_t startNs)
+{
+    state_ = Busy;
+    startNs_ = startNs;
+    bytes_ = 0;
+    parser_.reset();
+    //同一连接只有一个在途请求，request_在写完成前保持有效。
+    client_.write(request_.c_str(), (unsigned int)request_.size());
+}
+
+void BenchConnection::close(std::function<void()> callback)
+{
+    stopping_ = true;
+    if (nullptr != reconnect_)
+    {
+        reconnect_->close([](Timer* timer)
+        {
+            delete timer;
+        });
+        reconnect_ = nullptr;
+    }
+    if (state_ == Closed || state_ == Connecting)
+    {
+        //连接中的socket在连接结果返回后关闭。
+        state_ = Closed;
+        callback();
+        return;
+    }
+    state_ = Closed;
+    client_.close([callback](TcpClient*)
+    {
+        callback();
+    });
+}
+
+BenchConnection::State BenchConnection::getState()
+{
+    return state_;
+}
+
+uint64_t BenchConnection::getConnectErrors()
+{
+    return connectErrors_;
+}
+
+void BenchConnection::onConnectStatus(TcpClient::ConnectStatus status)
+{
+    if (stopping_)
+    {
+        return;
+    }
+    if (status == TcpClient::OnConnectSuccess)
+    {
+        state_ = Idle;
+        if (onReady_)
+        {
+            onReady_(this);
+        }
+        return;
+    }
+    if (status == TcpClient::OnConnectFail)
+    {
+        connectErrors_++;
+    }
+    onFail();
+}
+
+void BenchConnection::onMessage(const char* data, ssize_t size)
+{
+    if (state_ != Busy)
+    {
+        return;
+    }
+    size_t used = 0;
+    auto rst = parser_.parse(data, (size_t)size, used);
+    if (rst == ParseResult::Success)
+    {
+        state_ = Idle;
+        auto keepAlive = parser_.isKeepAlive();
+        if (onResponse_)
+        {
+            onResponse_(this, (int)parser_.getResponse().getStatusCode(), startNs_, bytes_);
+        }
+        if (!keepAlive && !stopping_)
+        {
+            state_ = Closed;
+            client_.close([this](TcpClient*)
+            {
+                scheduleReconnect();
+            });
+            return;
+        }
+        if (state_ == Idle && onReady_)
+        {
+            onReady_(this);
+        }
+    }
+    else if (rst == ParseResult::Error)
+    {
+        if (onResponse_)
+        {
+            onResponse_(this, -1, startNs_, 0);
+        }
+        state_ = Closed;
+        client_.close([this](TcpClient*)
+        {
+            scheduleReconnect();
+        });
+    }
+}
+
+void BenchConnection::onFail()
+{
+    if (state_ == Busy && onResponse_)
+    {
+        onResponse_(this, -1, startNs_, 0);
+    }
+    state_ = Closed;
+    scheduleReconnect();
+}
+
+void BenchConnection::scheduleReconnect()
+{
+    if (stopping_ || nullptr != reconnect_)
+    {
+        return;
+    }
+    //断开后稍后重连，避免服务端不可用时空转。
+    reconnect_ = new Timer(loop_, 10, 0, [this](Timer* timer)
+    {
+        timer->close([](Timer* ptr)
+        {
+            delete ptr;
+        });
+        reconnect_ = nullptr;
+        connect();
+    });
+    reconnect_->start();
+}
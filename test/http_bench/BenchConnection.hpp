@@ -0,0 +1,65 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef BENCH_CONNECTION_HPP
+#define BENCH_CONNECTION_HPP
+
+#include <functional>
+#include <uv11.hpp>
+
+//压测用keep-alive连接：同一时刻只有一个请求在途，响应完整后回到空闲。
+class BenchConnection
+{
+public:
+    enum State
+    {
+        Connecting,
+        Idle,
+        Busy,
+        Closed
+    };
+    //status为响应状态码，status<0表示请求失败(连接断开或解析出错)。
+    using OnResponseCallback = std::function<void(BenchConnection*, int status, uint64_t startNs, uint64_t bytes)>;
+    using OnReadyCallback = std::function<void(BenchConnection*)>;
+
+    BenchConnection(uv::EventLoop* loop, uv::SocketAddr& addr, const std::string& request);
+
+    void setResponseCallback(OnResponseCallback callback);
+    void setReadyCallback(OnReadyCallback callback);
+
+    void connect();
+    //startNs为请求的计时起点(开环模式下为计划发送时刻)。
+    void send(uint64_t startNs);
+    void close(std::function<void()> callback);
+
+    State getState();
+    uint64_t getConnectErrors();
+
+private:
+    uv::EventLoop* loop_;
+    uv::SocketAddr addr_;
+    const std::string& request_;
+    uv::TcpClient client_;
+    uv::http::ResponseParser parser_;
+    uv::Timer* reconnect_;
+    State state_;
+    bool stopping_;
+    uint64_t startNs_;
+    uint64_t bytes_;
+    uint64_t connectErrors_;
+    OnResponseCallback onResponse_;
+    OnReadyCallback onReady_;
+
+    void onConnectStatus(uv::TcpClient::ConnectStatus status);
+    void onMessage(const char* data, ssize_t size);
+    void onFail();
+    void scheduleReconnect();
+};
+#endif
@@ -0,0 +1,215 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "BenchWorker.hpp"
+
+using namespace uv;
+
+//等待全部连接建立的最长时间，超时后以已建立的连接开始压测。
+static const uint64_t ConnectTimeoutNs = 2000000000ull;
+
+BenchWorker::BenchWorker(SocketAddr& addr, const std::string& request, int connections, uint64_t durationMs, double rate)
+    :addr_(addr),
+    request_(request),
+    connections_(connections),
+    durationNs_(durationMs * 1000000ull),
+    rate_(rate),
+    loop_(nullptr),
+    ticker_(nullptr),
+    connected_(0),
+    closing_(0),
+    started_(false),
+    stopping_(false),
+    createNs_(0),
+    startNs_(0),
+    scheduled_(0)
+{
+}
+
+void BenchWorker::run()
+{
+    EventLoop loop;
+    loop_ = &loop;
+    createNs_ = uv_hrtime();
+    for (int i = 0; i < connections_; i++)
+    {
+        std::unique_ptr<BenchConnection> client(new BenchConnection(loop_, addr_, request_));
+        client->setReadyCallback(std::bind(&BenchWorker::onReady, this, std::placeholders::_1));
+        client->setResponseCallback(std::bind(&BenchWorker::onResponse, this, std::placeholders::_1,
+            std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
+        client->connect();
+        clients_.push_back(std::move(client));
+    }
+    //调度粒度为1ms，开环模式下延迟自计划时刻起算，已包含调度误差。
+    ticker_ = new Timer(loop_, 1, 1, [this](Timer*)
+    {
+        onTick();
+    });
+    ticker_->start();
+    loop.run();
+
+    for (auto& client : clients_)
+    {
+        result_.connectErrors += client->getConnectErrors();
+    }
+    clients_.clear();
+    loop_ = nullptr;
+}
+
+BenchResult& BenchWorker::getResult()
+{
+    return result_;
+}
+
+void BenchWorker::onTick()
+{
+    auto now = uv_hrtime();
+    if (!started_)
+    {
+        if (connected_ >= connections_ || now - createNs_ >= ConnectTimeoutNs)
+        {
+            start(now);
+        }
+        return;
+    }
+    if (now - startNs_ >= durationNs_)
+    {
+        finish(now);
+        return;
+    }
+    schedule(now);
+    dispatch();
+}
+
+void BenchWorker::onReady(BenchConnection* client)
+{
+    if (stopping_)
+    {
+        return;
+    }
+    if (!started_)
+    {
+        connected_++;
+        idle_.push_back(client);
+        return;
+    }
+    if (rate_ <= 0)
+    {
+        //闭环：收到响应后立即发送下一个请求。
+        client->send(uv_hrtime());
+        return;
+    }
+    idle_.push_back(client);
+    dispatch();
+}
+
+void BenchWorker::onResponse(BenchConnection* client, int status, uint64_t startNs, uint64_t bytes)
+{
+    if (stopping_)
+    {
+        return;
+    }
+    if (status < 0)
+    {
+        result_.errors++;
+        return;
+    }
+    result_.requests++;
+    result_.bytes += bytes;
+    if (status < 200 || status > 299)
+    {
+        result_.non2xx++;
+    }
+    result_.latency.record((uv_hrtime() - startNs) / 1000);
+}
+
+void BenchWorker::start(uint64_t now)
+{
+    started_ = true;
+    startNs_ = now;
+    if (rate_ <= 0)
+    {
+        std::vector<BenchConnection*> idle;
+        idle.swap(idle_);
+        for (auto client : idle)
+        {
+            client->send(now);
+        }
+        return;
+    }
+    schedule(now);
+    dispatch();
+}
+
+void BenchWorker::schedule(uint64_t now)
+{
+    if (rate_ <= 0)
+    {
+        return;
+    }
+    //开环：第i个请求的计划发送时刻为start + i/rate，与响应是否返回无关，避免协同遗漏。
+    while (true)
+    {
+        uint64_t intended = startNs_ + (uint64_t)(scheduled_ * 1e9 / rate_);
+        if (intended > now)
+        {
+            break;
+        }
+        backlog_.push_back(intended);
+        scheduled_++;
+    }
+}
+
+void BenchWorker::dispatch()
+{
+    while (!backlog_.empty() && !idle_.empty())
+    {
+        auto client = idle_.back();
+        idle_.pop_back();
+        //重连期间可能已失效。
+        if (client->getState() != BenchConnection::Idle)
+        {
+            continue;
+        }
+        client->send(backlog_.front());
+        backlog_.pop_front();
+    }
+}
+
+void BenchWorker::finish(uint64_t now)
+{
+    stopping_ = true;
+    result_.elapsedNs = now - startNs_;
+    result_.unsent = backlog_.size();
+    backlog_.clear();
+    idle_.clear();
+    ticker_->close([](Timer* timer)
+    {
+        delete timer;
+    });
+    ticker_ = nullptr;
+    closing_ = (int)clients_.size();
+    auto loop = loop_;
+    auto onClosed = [this, loop]()
+    {
+        if (--closing_ == 0)
+        {
+            loop->stop();
+        }
+    };
+    for (auto& client : clients_)
+    {
+        client->close(onClosed);
+    }
+    if (clients_.empty())
+    {
+        loop_->stop();
+    }
+}
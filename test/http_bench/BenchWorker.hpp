@@ -0,0 +1,75 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef BENCH_WORKER_HPP
+#define BENCH_WORKER_HPP
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <uv11.hpp>
+
+#include "BenchConnection.hpp"
+#include "LatencyHistogram.hpp"
+
+struct BenchResult
+{
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t non2xx = 0;
+    uint64_t connectErrors = 0;
+    //开环模式下到结束时仍未发出的请求数。
+    uint64_t unsent = 0;
+    uint64_t bytes = 0;
+    uint64_t elapsedNs = 0;
+    LatencyHistogram latency;
+};
+
+//单线程压测：一个EventLoop驱动若干连接，run()阻塞至压测结束。
+class BenchWorker
+{
+public:
+    //rate为每秒请求数，0表示每个连接收到响应后立即发送下一个请求(最大吞吐)。
+    BenchWorker(uv::SocketAddr& addr, const std::string& request, int connections, uint64_t durationMs, double rate);
+
+    void run();
+    BenchResult& getResult();
+
+private:
+    uv::SocketAddr addr_;
+    std::string request_;
+    int connections_;
+    uint64_t durationNs_;
+    double rate_;
+
+    uv::EventLoop* loop_;
+    uv::Timer* ticker_;
+    std::vector<std::unique_ptr<BenchConnection>> clients_;
+    std::vector<BenchConnection*> idle_;
+    //开环模式下已到计划时刻、等待空闲连接的请求。
+    std::deque<uint64_t> backlog_;
+    int connected_;
+    int closing_;
+    bool started_;
+    bool stopping_;
+    uint64_t createNs_;
+    uint64_t startNs_;
+    uint64_t scheduled_;
+    BenchResult result_;
+
+    void onTick();
+    void onReady(BenchConnection* client);
+    void onResponse(BenchConnection* client, int status, uint64_t startNs, uint64_t bytes);
+    void start(uint64_t now);
+    void schedule(uint64_t now);
+    void dispatch();
+    void finish(uint64_t now);
+};
+#endif
@@ -0,0 +1,129 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include "LatencyHistogram.hpp"
+
+LatencyHistogram::LatencyHistogram()
+    :counts_(Index(MaxValue) + 1, 0),
+    count_(0),
+    min_(UINT64_MAX),
+    max_(0),
+    sum_(0)
+{
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    if (value > MaxValue)
+    {
+        value = MaxValue;
+    }
+    counts_[Index(value)]++;
+    count_++;
+    sum_ += (double)value;
+    if (value < min_)
+    {
+        min_ = value;
+    }
+    if (value > max_)
+    {
+        max_ = value;
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t i = 0; i < counts_.size(); i++)
+    {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    if (other.min_ < min_)
+    {
+        min_ = other.min_;
+    }
+    if (other.max_ > max_)
+    {
+        max_ = other.max_;
+    }
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return count_;
+}
+
+uint64_t LatencyHistogram::min() const
+{
+    return 0 == count_ ? 0 : min_;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+    return max_;
+}
+
+double LatencyHistogram::mean() const
+{
+    return 0 == count_ ? 0 : sum_ / count_;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    if (0 == count_)
+    {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(p / 100.0 * count_ + 0.5);
+    if (target < 1)
+    {
+        target = 1;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts_.size(); i++)
+    {
+        total += counts_[i];
+        if (total >= target)
+        {
+            auto value = HighestValue(i);
+            return value < max_ ? value : max_;
+        }
+    }
+    return max_;
+}
+
+size_t LatencyHistogram::Index(uint64_t value)
+{
+    if (value < SubBucketCount)
+    {
+        return (size_t)value;
+    }
+    unsigned int msb = 0;
+    while ((value >> (msb + 1)) != 0)
+    {
+        msb++;
+    }
+    //右移后落在[SubBucketHalf, SubBucketCount)。
+    unsigned int shift = msb - (SubBucketBits - 1);
+    return (size_t)(SubBucketCount + (shift - 1) * SubBucketHalf + ((value >> shift) - SubBucketHalf));
+}
+
+uint64_t LatencyHistogram::HighestValue(size_t index)
+{
+    if (index < SubBucketCount)
+    {
+        return index;
+    }
+    uint64_t offset = index - SubBucketCount;
+    unsigned int shift = (unsigned int)(offset / SubBucketHalf) + 1;
+    uint64_t sub = offset % SubBucketHalf + SubBucketHalf;
+    return ((sub + 1) << shift) - 1;
+}
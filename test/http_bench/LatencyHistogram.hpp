@@ -0,0 +1,50 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//HDR风格直方图：按2的幂分组，组内线性细分1024格，相对误差不超过0.1%。
+//记录值上限2^40(us约12天)，超出按上限计。
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const;
+    uint64_t min() const;
+    uint64_t max() const;
+    double mean() const;
+    //p为百分位(0~100)，返回该格可表示的最大值。
+    uint64_t percentile(double p) const;
+
+private:
+    static const unsigned int SubBucketBits = 11;
+    static const uint64_t SubBucketCount = 1 << SubBucketBits;
+    static const uint64_t SubBucketHalf = SubBucketCount >> 1;
+    static const uint64_t MaxValue = (uint64_t)1 << 40;
+
+    static size_t Index(uint64_t value);
+    static uint64_t HighestValue(size_t index);
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t min_;
+    uint64_t max_;
+    double sum_;
+};
+#endif
@@ -0,0 +1,265 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+#include <uv11.hpp>
+
+#include "BenchWorker.hpp"
+
+struct BenchOptions
+{
+    int connections = 10;
+    int threads = 1;
+    uint64_t durationMs = 10000;
+    double rate = 0;
+    std::string json;
+    std::string url;
+    std::string host;
+    std::string ip;
+    int port = 80;
+    std::string path = "/";
+};
+
+static const double Percentiles[] = { 50, 75, 90, 99, 99.9, 99.99 };
+
+static void Usage()
+{
+    std::cout << "usage: http_bench [options] http://ip:port/path\n"
+        << "  -c <n>     keep-alive connections (default 10)\n"
+        << "  -t <n>     EventLoop threads (default 1)\n"
+        << "  -d <sec>   duration in seconds (default 10)\n"
+        << "  -r <rps>   fixed total request rate, 0 = max throughput (default 0)\n"
+        << "  -j <file>  write json results to file, '-' for stdout\n";
+}
+
+static bool ParseUrl(BenchOptions& options)
+{
+    const std::string scheme("http://");
+    if (options.url.compare(0, scheme.size(), scheme) != 0)
+    {
+        return false;
+    }
+    auto rest = options.url.substr(scheme.size());
+    auto slash = rest.find('/');
+    if (slash != std::string::npos)
+    {
+        options.path = rest.substr(slash);
+        rest = rest.substr(0, slash);
+    }
+    options.host = rest;
+    auto colon = rest.find(':');
+    if (colon != std::string::npos)
+    {
+        try
+        {
+            options.port = std::stoi(rest.substr(colon + 1));
+        }
+        catch (...)
+        {
+            return false;
+        }
+        rest = rest.substr(0, colon);
+    }
+    options.ip = rest == "localhost" ? "127.0.0.1" : rest;
+    return !options.ip.empty();
+}
+
+static bool ParseOptions(int argc, char** args, BenchOptions& options)
+{
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg(args[i]);
+            if (arg[0] != '-' || arg == "-")
+            {
+                options.url = arg;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            std::string value(args[++i]);
+            if (arg == "-c")
+                options.connections = std::stoi(value);
+            else if (arg == "-t")
+                options.threads = std::stoi(value);
+            else if (arg == "-d")
+                options.durationMs = (uint64_t)(std::stod(value) * 1000);
+            else if (arg == "-r")
+                options.rate = std::stod(value);
+            else if (arg == "-j")
+                options.json = value;
+            else
+                return false;
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+    if (options.threads < 1 || options.connections < options.threads || options.durationMs == 0 || options.rate < 0)
+    {
+        return false;
+    }
+    return ParseUrl(options);
+}
+
+static std::string FormatLatency(uint64_t us)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2);
+    if (us >= 1000000)
+        os << us / 1000000.0 << "s";
+    else if (us >= 1000)
+        os << us / 1000.0 << "ms";
+    else
+        os << us << "us";
+    return os.str();
+}
+
+static std::string PercentileKey(double p)
+{
+    std::ostringstream os;
+    os << "p" << p;
+    auto key = os.str();
+    std::replace(key.begin(), key.end(), '.', '_');
+    return key;
+}
+
+static void WriteJson(std::ostream& os, BenchOptions& options, BenchResult& result, double seconds)
+{
+    auto& latency = result.latency;
+    os << std::fixed << std::setprecision(2);
+    os << "{\n"
+        << "  \"url\": \"" << options.url << "\",\n"
+        << "  \"connections\": " << options.connections << ",\n"
+        << "  \"threads\": " << options.threads << ",\n"
+        << "  \"duration_s\": " << seconds << ",\n"
+        << "  \"rate\": " << options.rate << ",\n"
+        << "  \"requests\": " << result.requests << ",\n"
+        << "  \"errors\": " << result.errors << ",\n"
+        << "  \"connect_errors\": " << result.connectErrors << ",\n"
+        << "  \"non2xx\": " << result.non2xx << ",\n"
+        << "  \"unsent\": " << result.unsent << ",\n"
+        << "  \"bytes\": " << result.bytes << ",\n"
+        << "  \"rps\": " << (seconds > 0 ? result.requests / seconds : 0) << ",\n"
+        << "  \"latency_us\": {\n"
+        << "    \"min\": " << latency.min() << ",\n"
+        << "    \"mean\": " << latency.mean() << ",\n";
+    for (auto p : Percentiles)
+    {
+        os << "    \"" << PercentileKey(p) << "\": " << latency.percentile(p) << ",\n";
+    }
+    os << "    \"max\": " << latency.max() << "\n"
+        << "  }\n"
+        << "}\n";
+}
+
+int main(int argc, char** args)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, args, options))
+    {
+        Usage();
+        return 1;
+    }
+    //连接失败等统计到结果中，不逐条输出日志。
+    uv::LogWriter::Instance()->setLevel(uv::LogWriter::Fatal);
+    uv::SocketAddr addr(options.ip, options.port);
+    std::string request("GET " + options.path + " HTTP/1.1\r\nHost: " + options.host + "\r\nUser-Agent: uv-cpp http_bench\r\n\r\n");
+
+    //连接数在各线程间均分，总请求速率同样均分。
+    std::vector<std::unique_ptr<BenchWorker>> workers;
+    for (int i = 0; i < options.threads; i++)
+    {
+        int connections = options.connections / options.threads + (i < options.connections % options.threads ? 1 : 0);
+        double rate = options.rate * connections / options.connections;
+        workers.emplace_back(new BenchWorker(addr, request, connections, options.durationMs, rate));
+    }
+    std::cout << "Running " << options.durationMs / 1000.0 << "s test @ " << options.url << "\n  "
+        << options.threads << " threads and " << options.connections << " connections";
+    if (options.rate > 0)
+    {
+        std::cout << ", " << options.rate << " requests/sec";
+    }
+    std::cout << std::endl;
+
+    std::vector<std::thread> threads;
+    for (auto& worker : workers)
+    {
+        auto ptr = worker.get();
+        threads.emplace_back([ptr]()
+        {
+            ptr->run();
+        });
+    }
+    BenchResult total;
+    uint64_t elapsedNs = 0;
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+        auto& result = workers[i]->getResult();
+        total.requests += result.requests;
+        total.errors += result.errors;
+        total.non2xx += result.non2xx;
+        total.connectErrors += result.connectErrors;
+        total.unsent += result.unsent;
+        total.bytes += result.bytes;
+        total.latency.merge(result.latency);
+        if (result.elapsedNs > elapsedNs)
+        {
+            elapsedNs = result.elapsedNs;
+        }
+    }
+    double seconds = elapsedNs / 1e9;
+
+    auto& latency = total.latency;
+    std::cout << std::fixed << std::setprecision(2)
+        << "  Latency  mean " << FormatLatency((uint64_t)latency.mean())
+        << "  max " << FormatLatency(latency.max()) << "\n"
+        << "  Latency Distribution\n";
+    for (auto p : Percentiles)
+    {
+        std::ostringstream key;
+        key << p << "%";
+        std::cout << "  " << std::setw(8) << key.str() << "  " << FormatLatency(latency.percentile(p)) << "\n";
+    }
+    std::cout << "  " << total.requests << " requests in " << seconds << "s, " << total.bytes << " bytes body read\n";
+    if (total.errors || total.connectErrors || total.non2xx || total.unsent)
+    {
+        std::cout << "  Errors: " << total.errors << ", connect errors: " << total.connectErrors
+            << ", non-2xx: " << total.non2xx << ", unsent: " << total.unsent << "\n";
+    }
+    std::cout << "Requests/sec: " << (seconds > 0 ? total.requests / seconds : 0) << std::endl;
+
+    if (options.json == "-")
+    {
+        WriteJson(std::cout, options, total, seconds);
+    }
+    else if (!options.json.empty())
+    {
+        std::ofstream file(options.json);
+        if (!file)
+        {
+            std::cerr << "open " << options.json << " fail." << std::endl;
+            return 1;
+        }
+        WriteJson(file, options, total, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <uv11.hpp>
+
+int main(int argc, char** args)
+{
+    uv::EventLoop loop;
+#ifndef _WIN32
+    //接管SIGPIPE信号，对端关闭后继续写入不致进程退出。
+    uv::Signal signal(&loop, SIGPIPE, [](int sig)
+    {
+    });
+#endif
+
+    //本地http服务，keep-alive响应。
+    uv::http::HttpServer::SetBufferMode(uv::GlobalConfig::BufferMode::CycleBuffer);
+    uv::http::HttpServer server(&loop);
+    server.Get("/echo", [](uv::http::Request& req, uv::http::Response* resp)
+    {
+        resp->setVersion(uv::http::HttpVersion::Http1_1);
+        resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+        std::string str("echo ");
+        str += req.getUrlParam("id");
+        resp->swapContent(str);
+    });
+    uv::SocketAddr addr("127.0.0.1", 10012);
+    server.bindAndListen(addr);
+
+    //最多2个连接，每个连接pipeline 4个请求，其余请求排队。
+    uv::http::HttpClientPool pool(&loop);
+    pool.setMaxConnections(2);
+    pool.setPipelining(4);
+    pool.setIdleTimeout(1000);
+
+    const int count = 1000;
+    int completed = 0;
+    for (int i = 0; i < count; i++)
+    {
+        uv::http::Request req;
+        req.setPath("/echo");
+        req.appendUrlParam("id", std::to_string(i));
+        req.appendHead("Host", "127.0.0.1");
+        pool.Req(addr, req, [&](uv::http::HttpClient::ReqResult rst, uv::http::Response* resp)
+        {
+            if (rst != uv::http::HttpClient::Success)
+            {
+                uv::LogWriter::Instance()->error("request fail.");
+            }
+            if (++completed == count)
+            {
+                uv::http::HttpClientPool::UpstreamStats stats;
+                pool.getStats(addr.toStr(), stats);
+                std::cout << "requests:" << stats.requests << " failures:" << stats.failures
+                    << " connects:" << stats.connects << " reuses:" << stats.reuses
+                    << " avg:" << stats.latencyAverage() << "us p99:" << stats.latencyPercentile(0.99)
+                    << "us max:" << stats.latencyMax << "us" << std::endl;
+                server.close([&loop]()
+                {
+                    loop.stop();
+                });
+            }
+        });
+    }
+    loop.run();
+}
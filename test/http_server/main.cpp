@@ -1,91 +1,241 @@
-﻿/*
-   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
-
-   Author: orcaer@yeah.net
-
-   Last modified: 2020-4-13
-
-   Description: https://github.com/wlgq2/uv-cpp
-*/
-
-#include <iostream>
-#include <uv11.hpp>
-
-void func1(uv::http::Request& req, uv::http::Response* resp)
-{
-    resp->setVersion(uv::http::HttpVersion::Http1_1);
-    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
-    resp->appendHead("Server", "uv-cpp");
-    std::string str("test~");
-    resp->swapContent(str);
-}
-
-void func2(uv::http::Request& req, uv::http::Response* resp)
-{
-    resp->setVersion(uv::http::HttpVersion::Http1_1);
-    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
-    resp->appendHead("Server", "uv-cpp");
-    std::string str = req.getPath();
-    resp->swapContent(str);
-}
-void func3(uv::http::Request& req, uv::http::Response* resp)
-{
-    resp->setVersion(uv::http::HttpVersion::Http1_1);
-    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
-    resp->appendHead("Server", "uv-cpp");
-    std::string str("value is ");
-    str += req.getValue();
-    resp->swapContent(str);
-}
-void func4(uv::http::Request& req, uv::http::Response* resp)
-{
-    resp->setVersion(uv::http::HttpVersion::Http1_1);
-    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
-    resp->appendHead("Server", "uv-cpp");
-    std::string value1 = req.getUrlParam("param1");
-    std::string value2 = req.getUrlParam("param2");
-    std::string str;
-    try
-    {
-        double num1 = std::stoi(value1);
-        double num2 = std::stoi(value2);
-        str = "sum :";
-        str += std::to_string(num1 + num2);
-    }
-    catch (...)
-    {
-        str = "param is not num.";
-    }
-    resp->swapContent(str);
-}
-
-void func5(uv::http::Request& req, uv::http::Response* resp)
-{
-    resp->setVersion(uv::http::HttpVersion::Http1_1);
-    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
-    resp->appendHead("Server", "uv-cpp");
-    std::string str("uv-cpp default page.");
-    resp->swapContent(str);
-}
-
-int main(int argc, char** args)
-{
-    uv::EventLoop loop;
-    uv::http::HttpServer::SetBufferMode(uv::GlobalConfig::BufferMode::CycleBuffer);
-
-    uv::http::HttpServer server(&loop);
-    //example:  127.0.0.1:10010/test
-    server.Get("/test", std::bind(&func1, std::placeholders::_1, std::placeholders::_2));
-    //example:  127.0.0.1:10010/some123abc
-    server.Get("/some*", std::bind(&func2, std::placeholders::_1, std::placeholders::_2));
-    //example:  127.0.0.1:10010/value:1234
-    server.Get("/value:", std::bind(&func3, std::placeholders::_1, std::placeholders::_2));
-    //example:  127.0.0.1:10010/sum?param1=100&param2=23
-    server.Get("/sum", std::bind(&func4, std::placeholders::_1, std::placeholders::_2));
-    //defalut server.
-    server.Get("/*", std::bind(&func5, std::placeholders::_1, std::placeholders::_2));
-
-    uv::SocketAddr addr("127.0.0.1", 10010);
-    server.bindAndListen(addr);
-    loop.run();
-}
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2020-4-13
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <thread>
+#include <algorithm>
+#include <uv11.hpp>
+
+void func1(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setVersion(uv::http::HttpVersion::Http1_1);
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string str("test~");
+    resp->swapContent(str);
+}
+
+void func2(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setVersion(uv::http::HttpVersion::Http1_1);
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string str = req.getPath();
+    resp->swapContent(str);
+}
+void func3(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setVersion(uv::http::HttpVersion::Http1_1);
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string str("value is ");
+    str += req.getValue();
+    resp->swapContent(str);
+}
+void func4(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setVersion(uv::http::HttpVersion::Http1_1);
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string value1 = req.getUrlParam("param1");
+    std::string value2 = req.getUrlParam("param2");
+    std::string str;
+    try
+    {
+        double num1 = std::stoi(value1);
+        double num2 = std::stoi(value2);
+        str = "sum :";
+        str += std::to_string(num1 + num2);
+    }
+    catch (...)
+    {
+        str = "param is not num.";
+    }
+    resp->swapContent(str);
+}
+
+void func5(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setVersion(uv::http::HttpVersion::Http1_1);
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string str("uv-cpp default page.");
+    resp->swapContent(str);
+}
+
+void func6(uv::http::Request& req, uv::http::ResponseStreamPtr stream)
+{
+    uv::http::Response head;
+    head.setStatus(uv::http::Response::StatusCode::OK, "OK");
+    head.appendHead("Server", "uv-cpp");
+    head.appendHead("Content-Type", "text/plain");
+    stream->writeHead(head);
+    //其他线程中分块写入，超过高水位时等待。
+    std::thread([stream]()
+    {
+        for (int i = 0; i < 100 && !stream->isClosed(); i++)
+        {
+            while (!stream->isWritable() && !stream->isClosed())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            stream->writeChunk("chunk " + std::to_string(i) + "\n");
+        }
+        stream->end();
+    }).detach();
+}
+
+void func7(uv::http::Request& req, uv::http::ResponseStreamPtr stream)
+{
+    //回调返回后在其他线程中完成响应，超时未响应时服务端以504应答。
+    uint64_t delay = 100;
+    try
+    {
+        delay = std::stoul(req.getUrlParam("ms"));
+    }
+    catch (...)
+    {
+    }
+    std::thread([stream, delay]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        uv::http::Response resp;
+        resp.setStatus(uv::http::Response::StatusCode::OK, "OK");
+        resp.appendHead("Server", "uv-cpp");
+        std::string str("deferred " + std::to_string(delay) + "ms");
+        resp.swapContent(str);
+        stream->send(resp);
+    }).detach();
+}
+
+void func8(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    resp->appendHead("Content-Type", "text/plain; charset=utf-8");
+    int lines = 1000;
+    try
+    {
+        lines = std::stoi(req.getUrlParam("lines"));
+    }
+    catch (...)
+    {
+    }
+    std::string str;
+    for (int i = 0; i < lines; i++)
+    {
+        str += "line " + std::to_string(i) + " of compressible text.\n";
+    }
+    resp->swapContent(str);
+}
+
+void func9(uv::http::Request& req, uv::http::RequestBodyPtr body, uv::http::ResponseStreamPtr stream)
+{
+    //body分块到达时统计字节数，接收完成后应答。
+    auto lines = std::make_shared<uint64_t>(0);
+    body->onBodyChunk([lines](const char* data, size_t size)
+    {
+        *lines += std::count(data, data + size, '\n');
+    });
+    body->onEnd([body, lines, stream](int status)
+    {
+        if (0 != status)
+        {
+            return;
+        }
+        uv::http::Response resp;
+        resp.setStatus(uv::http::Response::StatusCode::OK, "OK");
+        std::string str("received " + std::to_string(body->getReceived()) + " bytes, " + std::to_string(*lines) + " lines.");
+        resp.swapContent(str);
+        stream->send(resp);
+    });
+}
+
+void func10(uv::http::Request& req, int status, const std::string& path, uv::http::ResponseStreamPtr stream)
+{
+    if (0 != status)
+    {
+        stream->sendStatus(uv::http::Response::StatusCode::InternalServerError);
+        return;
+    }
+    uv::http::Response resp;
+    resp.setStatus(uv::http::Response::StatusCode::Created, "Created");
+    std::string str("saved to " + path);
+    resp.swapContent(str);
+    stream->send(resp);
+}
+
+int main(int argc, char** args)
+{
+    uv::EventLoop loop;
+#ifndef _WIN32
+    //接管SIGPIPE信号，对端关闭后继续写入(如sendfile)不致进程退出。
+    uv::Signal signal(&loop, SIGPIPE, [](int sig)
+    {
+    });
+#endif
+    uv::http::HttpServer::SetBufferMode(uv::GlobalConfig::BufferMode::CycleBuffer);
+
+    uv::http::HttpServer server(&loop);
+    //example:  127.0.0.1:10010/test
+    server.Get("/test", std::bind(&func1, std::placeholders::_1, std::placeholders::_2));
+    //example:  127.0.0.1:10010/some123abc
+    server.Get("/some*", std::bind(&func2, std::placeholders::_1, std::placeholders::_2));
+    //example:  127.0.0.1:10010/value:1234
+    server.Get("/value:", std::bind(&func3, std::placeholders::_1, std::placeholders::_2));
+    //example:  127.0.0.1:10010/sum?param1=100&param2=23
+    server.Get("/sum", std::bind(&func4, std::placeholders::_1, std::placeholders::_2));
+    //example:  127.0.0.1:10010/cached/sum?param1=100&param2=23  (按参数缓存1秒)
+    auto cache = server.GetCached("/cached/sum", std::bind(&func4, std::placeholders::_1, std::placeholders::_2));
+    cache->setKeyParams({ "param1", "param2" });
+    //example:  127.0.0.1:10010/compressed?lines=100000  (按Accept-Encoding压缩，大响应在线程池中压缩)
+    auto compressor = server.GetCompressed("/compressed", std::bind(&func8, std::placeholders::_1, std::placeholders::_2));
+    //example:  127.0.0.1:10010/stream
+    server.Stream(uv::http::Methon::Get, "/stream", std::bind(&func6, std::placeholders::_1, std::placeholders::_2));
+    //example:  127.0.0.1:10010/stream/compressed
+    server.Stream(uv::http::Methon::Get, "/stream/compressed",
+        compressor->wrapStream(std::bind(&func6, std::placeholders::_1, std::placeholders::_2)));
+    //example:  127.0.0.1:10010/deferred?ms=500
+    server.Stream(uv::http::Methon::Get, "/deferred", std::bind(&func7, std::placeholders::_1, std::placeholders::_2));
+    //example:  curl --data-binary @file 127.0.0.1:10010/upload/count  (流式接收body)
+    server.Upload(uv::http::Methon::Post, "/upload/count", std::bind(&func9, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    //example:  curl -T file 127.0.0.1:10010/upload  (body写入临时文件)
+    server.UploadFile(uv::http::Methon::Put, "/upload", std::bind(&func10, std::placeholders::_1,
+        std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
+    //example:  127.0.0.1:10010/static/index.html  (当前目录下的文件)
+    auto files = server.Static("/static/", ".");
+    //存在index.html.gz时向支持gzip的客户端直接发送。
+    files->setGzipSiblings(true);
+    //example:  127.0.0.1:10010/events?channel=clock
+    uv::http::EventBroker broker;
+    server.EventSource("/events", [&broker](uv::http::Request& req, uv::http::EventStreamPtr stream)
+    {
+        broker.subscribe(req.getUrlParam("channel"), stream);
+    });
+    uv::Timer clock(&loop, 1000, 1000, [&broker](uv::Timer*)
+    {
+        broker.publish("clock", "time", uv::http::ResponseWriter::FormatHttpDate(time(nullptr)));
+    });
+    clock.start();
+    //example:  127.0.0.1:10010/metrics
+    server.Metrics("/metrics");
+    //defalut server.
+    server.Get("/*", std::bind(&func5, std::placeholders::_1, std::placeholders::_2));
+
+    server.setRequestTimeout(1000);
+    server.setMaxPendingRequests(10000);
+    server.setMaxBodySize(1024 << 20);
+    //h2c：curl --http2-prior-knowledge 或 curl --http2(Upgrade)访问以上路由，各stream并发处理。
+    server.setHttp2(true);
+
+    uv::SocketAddr addr("127.0.0.1", 10010);
+    server.bindAndListen(addr);
+    loop.run();
+}
@@ -0,0 +1,69 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <uv11.hpp>
+
+std::string ThreadName()
+{
+    std::stringstream ss;
+    ss << std::this_thread::get_id();
+    return ss.str();
+}
+
+void func1(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string str("handled in thread " + ThreadName());
+    resp->swapContent(str);
+}
+
+void func2(uv::http::Request& req, uv::http::Response* resp)
+{
+    resp->setStatus(uv::http::Response::StatusCode::OK, "OK");
+    resp->appendHead("Server", "uv-cpp");
+    std::string str("route published at runtime.");
+    resp->swapContent(str);
+}
+
+int main(int argc, char** args)
+{
+    uv::EventLoop loop;
+#ifndef _WIN32
+    uv::Signal signal(&loop, SIGPIPE, [](int sig)
+    {
+    });
+#endif
+    uv::http::HttpServer::SetBufferMode(uv::GlobalConfig::BufferMode::CycleBuffer);
+
+    uv::http::HttpServer server(&loop);
+    //本loop负责accept，连接分配到4个工作loop。
+    server.setThreadNum(4);
+    //example:  127.0.0.1:10013/thread
+    server.Get("/thread", std::bind(&func1, std::placeholders::_1, std::placeholders::_2));
+    server.Static("/static/", ".");
+    server.setRequestTimeout(1000);
+
+    uv::SocketAddr addr("127.0.0.1", 10013);
+    server.bindAndListen(addr);
+
+    //运行中发布新路由，各工作loop下一次请求生效。
+    //example:  127.0.0.1:10013/later  (3秒后可访问)
+    uv::Timer timer(&loop, 3000, 0, [&server](uv::Timer*)
+    {
+        server.Get("/later", std::bind(&func2, std::placeholders::_1, std::placeholders::_2));
+        std::cout << "routes :" << server.getRoutes()->size() << std::endl;
+    });
+    timer.start();
+    loop.run();
+}
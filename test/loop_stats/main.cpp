@@ -0,0 +1,117 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <uv11.hpp>
+
+//空转loop(idle回调使poll不阻塞)1秒内的迭代次数，用于比较开启统计的开销。
+static uint64_t SpinIterations(bool stats)
+{
+    uv::EventLoop loop;
+    loop.setStatsEnabled(stats);
+    uint64_t iterations = 0;
+    uv::Idle idle(&loop);
+    idle.setCallback([&iterations]()
+    {
+        iterations++;
+    });
+    uv::Timer timer(&loop, 1000, 0, [&loop](uv::Timer*)
+    {
+        loop.stop();
+    });
+    timer.start();
+    loop.run();
+    return iterations;
+}
+
+static void PrintStats(const uv::LoopStats::Snapshot& stats)
+{
+    std::cout << "iterations " << stats.iterations
+        << " | poll p50 " << stats.poll.percentile(0.5) << "us p99 " << stats.poll.percentile(0.99) << "us"
+        << " | busy p50 " << stats.callback.percentile(0.5) << "us p99 " << stats.callback.percentile(0.99) << "us max " << stats.callback.max << "us"
+        << " | utilization " << stats.utilization()
+        << " | async/iter mean " << stats.asyncTasks.mean() << " max " << stats.asyncTasks.max
+        << " | timer late p99 " << stats.timerLateness.percentile(0.99) << "us max " << stats.timerLateness.max << "us" << std::endl;
+}
+
+int main(int argc, char** args)
+{
+    uv::EventLoop loop;
+    loop.setStatsEnabled(true);
+
+    //tcp乒乓使loop持续有I/O回调。
+    uv::TcpServer server(&loop);
+    server.setMessageCallback([](uv::TcpConnectionPtr connection, const char* data, ssize_t size)
+    {
+        connection->write(data, size, nullptr);
+    });
+    uv::SocketAddr addr("127.0.0.1", 10012);
+    server.bindAndListen(addr);
+    uv::TcpClient client(&loop);
+    char message[64] = "loop stats";
+    client.setConnectStatusCallback([&client, &message](uv::TcpClient::ConnectStatus status)
+    {
+        if (uv::TcpClient::OnConnectSuccess == status)
+        {
+            client.write(message, sizeof(message));
+        }
+    });
+    client.setMessageCallback([&client](const char* data, ssize_t size)
+    {
+        client.write(data, (unsigned)size);
+    });
+    client.connect(addr);
+
+    //其他线程每毫秒投递一个任务。
+    std::atomic<bool> running(true);
+    std::thread poster([&loop, &running]()
+    {
+        while (running)
+        {
+            loop.runInThisLoop([]()
+            {
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    //每秒一次阻塞20ms，体现为回调时间长尾及其后定时器的延迟。
+    int ticks = 0;
+    uv::Timer work(&loop, 10, 10, [&ticks](uv::Timer*)
+    {
+        if (++ticks % 100 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    });
+    work.start();
+
+    int reports = 0;
+    uv::Timer report(&loop, 1000, 1000, [&](uv::Timer*)
+    {
+        PrintStats(loop.stats());
+        if (++reports == 3)
+        {
+            running = false;
+            loop.stop();
+        }
+    });
+    report.start();
+    loop.run();
+    poster.join();
+
+    auto off = SpinIterations(false);
+    auto on = SpinIterations(true);
+    std::cout << "spin iterations/s: stats off " << off << ", on " << on
+        << " (" << (off > 0 ? (double)(off - on) * 100 / off : 0.0) << "% overhead)" << std::endl;
+}
@@ -0,0 +1,127 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <ctime>
+#include <uv11.hpp>
+
+//count个周期定时器(心跳，周期200~300ms，首次到期随机)运行seconds秒，对比不同slack下
+//loop每秒唤醒次数(uv_check_t计数每轮迭代)、回调次数、CPU时间及省去的唤醒数。
+
+struct BenchResult
+{
+    uint64_t wakeups = 0;
+    uint64_t callbacks = 0;
+    uint64_t saved = 0;
+    double cpuMs = 0;
+};
+
+static uv::Metrics::Counter* GetWakeupsSaved()
+{
+    return uv::Metrics::Instance()->counter("uvcpp_timer_wakeups_saved_total",
+        "Timer deadlines merged into an earlier loop wakeup by slack alignment.");
+}
+
+static BenchResult Run(bool service, uint64_t slack, unsigned int count, uint64_t seconds)
+{
+    BenchResult result;
+    uv::EventLoop loop;
+    uv_check_t check;
+    ::uv_check_init(loop.handle(), &check);
+    check.data = &result;
+    ::uv_check_start(&check, [](uv_check_t* handle)
+    {
+        static_cast<BenchResult*>(handle->data)->wakeups++;
+    });
+
+    std::mt19937 random(1);
+    std::vector<uv::Timer*> timers;
+    std::vector<uv::TimerService::Handle> handles;
+    auto timerService = loop.getTimerService();
+    timerService->setSlack(slack);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uint64_t period = 200 + random() % 100;
+        uint64_t first = random() % period;
+        if (service)
+        {
+            handles.push_back(timerService->schedule(first, [&result]()
+            {
+                result.callbacks++;
+            }, period));
+        }
+        else
+        {
+            auto timer = new uv::Timer(&loop, first, period, [&result](uv::Timer*)
+            {
+                result.callbacks++;
+            });
+            timer->setSlack(slack);
+            timer->start();
+            timers.push_back(timer);
+        }
+    }
+
+    auto saved = GetWakeupsSaved()->value();
+    auto cpu = std::clock();
+    uv::Timer stop(&loop, seconds * 1000, 0, [&](uv::Timer*)
+    {
+        result.cpuMs = (double)(std::clock() - cpu) * 1000 / CLOCKS_PER_SEC;
+        result.saved = GetWakeupsSaved()->value() - saved;
+        for (auto& handle : handles)
+        {
+            timerService->cancel(handle);
+        }
+        for (auto timer : timers)
+        {
+            timer->close([](uv::Timer* ptr)
+            {
+                delete ptr;
+            });
+        }
+        ::uv_close((uv_handle_t*)&check, nullptr);
+        loop.stop();
+    });
+    stop.start();
+    loop.run();
+    return result;
+}
+
+static void Report(const char* name, uint64_t slack, uint64_t seconds, BenchResult& result)
+{
+    std::cout << "  " << name << " slack " << slack << "ms: " << result.wakeups / seconds << " wakeups/s, "
+        << result.callbacks / seconds << " callbacks/s, " << result.saved / seconds << " wakeups saved/s, cpu "
+        << result.cpuMs << " ms" << std::endl;
+}
+
+int main(int argc, char** args)
+{
+    unsigned int count = 5000;
+    uint64_t seconds = 3;
+    if (argc > 1)
+        count = std::stoul(args[1]);
+    if (argc > 2)
+        seconds = std::stoul(args[2]);
+
+    std::cout << count << " periodic timers for " << seconds << "s" << std::endl;
+    for (auto slack : { 0, 10, 50 })
+    {
+        auto result = Run(false, slack, count, seconds);
+        Report("uv::Timer   ", slack, seconds, result);
+    }
+    for (auto slack : { 0, 10, 50 })
+    {
+        auto result = Run(true, slack, count, seconds);
+        Report("TimerService", slack, seconds, result);
+    }
+    return 0;
+}
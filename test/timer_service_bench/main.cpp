@@ -0,0 +1,219 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <random>
+#include <uv11.hpp>
+
+//TimerService与uv::Timer对比：
+//churn  模拟请求超时，定时器创建后很快取消(同时在途window个)，统计每次schedule+cancel的开销；
+//       uv::Timer的close需等待loop回调，另计全部关闭完成的总耗时。
+//fire   count个定时器在1s内均匀到期，统计调度耗时及平均/最大迟到。
+
+struct ChurnResult
+{
+    uint64_t callNs = 0;
+    uint64_t totalNs = 0;
+};
+
+struct FireResult
+{
+    uint64_t scheduleNs = 0;
+    uint64_t fired = 0;
+    uint64_t lateSum = 0;
+    uint64_t lateMax = 0;
+};
+
+//在loop中执行func，func完成后调用done()时停止loop。
+static void RunInLoop(std::function<void(uv::EventLoop*, std::function<void()>)> func)
+{
+    uv::EventLoop loop;
+    uv::Timer start(&loop, 0, 0, [&](uv::Timer*)
+    {
+        func(&loop, [&loop]()
+        {
+            loop.stop();
+        });
+    });
+    start.start();
+    loop.run();
+}
+
+static ChurnResult ChurnService(unsigned int count, unsigned int window, std::vector<uint64_t>& timeouts)
+{
+    ChurnResult result;
+    RunInLoop([&](uv::EventLoop* loop, std::function<void()> done)
+    {
+        auto service = loop->getTimerService();
+        std::deque<uv::TimerService::Handle> inflight;
+        auto start = uv_hrtime();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            inflight.push_back(service->schedule(timeouts[i], []()
+            {
+            }));
+            if (inflight.size() > window)
+            {
+                service->cancel(inflight.front());
+                inflight.pop_front();
+            }
+        }
+        for (auto& handle : inflight)
+        {
+            service->cancel(handle);
+        }
+        result.callNs = uv_hrtime() - start;
+        result.totalNs = result.callNs;
+        done();
+    });
+    return result;
+}
+
+static ChurnResult ChurnUvTimer(unsigned int count, unsigned int window, std::vector<uint64_t>& timeouts)
+{
+    ChurnResult result;
+    RunInLoop([&](uv::EventLoop* loop, std::function<void()> done)
+    {
+        auto closed = std::make_shared<unsigned int>(0);
+        auto start = uv_hrtime();
+        auto onClosed = [&result, closed, count, start, done](uv::Timer* timer)
+        {
+            //回调对象属于timer，delete后不能再访问捕获的变量。
+            if (++*closed == count)
+            {
+                result.totalNs = uv_hrtime() - start;
+                done();
+            }
+            delete timer;
+        };
+        std::deque<uv::Timer*> inflight;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            auto timer = new uv::Timer(loop, timeouts[i], 0, [](uv::Timer*)
+            {
+            });
+            timer->start();
+            inflight.push_back(timer);
+            if (inflight.size() > window)
+            {
+                inflight.front()->close(onClosed);
+                inflight.pop_front();
+            }
+        }
+        for (auto timer : inflight)
+        {
+            timer->close(onClosed);
+        }
+        result.callNs = uv_hrtime() - start;
+    });
+    return result;
+}
+
+static FireResult FireService(unsigned int count, std::vector<uint64_t>& timeouts)
+{
+    FireResult result;
+    RunInLoop([&](uv::EventLoop* loop, std::function<void()> done)
+    {
+        auto service = loop->getTimerService();
+        auto base = uv_now(loop->handle());
+        auto start = uv_hrtime();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            auto due = base + timeouts[i] % 1000;
+            service->schedule(timeouts[i] % 1000, [&result, loop, due, count, done]()
+            {
+                auto late = uv_now(loop->handle()) - due;
+                result.lateSum += late;
+                result.lateMax = late > result.lateMax ? late : result.lateMax;
+                if (++result.fired == count)
+                {
+                    done();
+                }
+            });
+        }
+        result.scheduleNs = uv_hrtime() - start;
+    });
+    return result;
+}
+
+static FireResult FireUvTimer(unsigned int count, std::vector<uint64_t>& timeouts)
+{
+    FireResult result;
+    RunInLoop([&](uv::EventLoop* loop, std::function<void()> done)
+    {
+        auto base = uv_now(loop->handle());
+        auto start = uv_hrtime();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            auto due = base + timeouts[i] % 1000;
+            auto timer = new uv::Timer(loop, timeouts[i] % 1000, 0, [&result, loop, due, count, done](uv::Timer* timer)
+            {
+                auto late = uv_now(loop->handle()) - due;
+                result.lateSum += late;
+                result.lateMax = late > result.lateMax ? late : result.lateMax;
+                bool last = ++result.fired == count;
+                timer->close([last, done](uv::Timer* ptr)
+                {
+                    if (last)
+                    {
+                        done();
+                    }
+                    delete ptr;
+                });
+            });
+            timer->start();
+        }
+        result.scheduleNs = uv_hrtime() - start;
+    });
+    return result;
+}
+
+static void ReportChurn(const char* name, unsigned int count, ChurnResult& result)
+{
+    std::cout << "  " << name << "  " << (double)result.callNs / count << " ns/op, all closed after "
+        << result.totalNs / 1000000.0 << " ms" << std::endl;
+}
+
+static void ReportFire(const char* name, unsigned int count, FireResult& result)
+{
+    std::cout << "  " << name << "  schedule " << (double)result.scheduleNs / count << " ns/op, late mean "
+        << (double)result.lateSum / result.fired << " ms, max " << result.lateMax << " ms" << std::endl;
+}
+
+int main(int argc, char** args)
+{
+    unsigned int count = 1000000;
+    unsigned int window = 10000;
+    if (argc > 1)
+    {
+        count = std::stoul(args[1]);
+    }
+    std::vector<uint64_t> timeouts(count);
+    std::mt19937 random(1);
+    for (auto& timeout : timeouts)
+    {
+        timeout = 1000 + random() % 30000;
+    }
+
+    std::cout << "churn: " << count << " schedule+cancel, " << window << " in flight" << std::endl;
+    auto churnService = ChurnService(count, window, timeouts);
+    ReportChurn("TimerService", count, churnService);
+    auto churnTimer = ChurnUvTimer(count, window, timeouts);
+    ReportChurn("uv::Timer   ", count, churnTimer);
+
+    unsigned int fireCount = count / 10;
+    std::cout << "fire: " << fireCount << " timers due within 1s" << std::endl;
+    auto fireService = FireService(fireCount, timeouts);
+    ReportFire("TimerService", fireCount, fireService);
+    auto fireTimer = FireUvTimer(fireCount, timeouts);
+    ReportFire("uv::Timer   ", fireCount, fireTimer);
+}
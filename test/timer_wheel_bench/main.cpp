@@ -0,0 +1,198 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <uv11.hpp>
+
+//空闲超时时间轮压测：模拟大量连接持续收到消息(每轮每个连接刷新一次)，
+//比较原std::set<shared_ptr>实现与侵入式链表实现的刷新开销及到期批量处理耗时。
+
+struct BenchConnection : public uv::TimerWheelNode
+{
+};
+
+//原实现：每次刷新向当前槽的set插入wrapper的shared_ptr，wrapper引用归零即超时。
+class SetWheel
+{
+public:
+    struct Wrapper
+    {
+        Wrapper(uint64_t* counter)
+            :counter(counter)
+        {
+        }
+        ~Wrapper()
+        {
+            (*counter)++;
+        }
+        uint64_t* counter;
+    };
+
+    SetWheel(unsigned int seconds)
+        :index_(0),
+        wheel_(seconds)
+    {
+    }
+    void insert(std::shared_ptr<Wrapper> value)
+    {
+        wheel_[index_].insert(value);
+    }
+    void tick()
+    {
+        if (++index_ == wheel_.size())
+        {
+            index_ = 0;
+        }
+        wheel_[index_].clear();
+    }
+private:
+    unsigned int index_;
+    std::vector<std::set<std::shared_ptr<Wrapper>>> wheel_;
+};
+
+struct BenchResult
+{
+    uint64_t touches = 0;
+    uint64_t touchNs = 0;
+    uint64_t expireNs = 0;
+    uint64_t expired = 0;
+    uint64_t drainMs = 0;
+};
+
+static void Report(const char* name, BenchResult& result)
+{
+    std::cout << name << "\n"
+        << "  touch   " << (double)result.touchNs / result.touches << " ns/op (" << result.touches << " touches)\n"
+        << "  expire  " << result.expired << " connections in " << result.expireNs / 1000 << " us of tick callbacks, "
+        << result.drainMs << " ms after traffic stopped" << std::endl;
+}
+
+static BenchResult RunSetWheel(unsigned int connections, unsigned int rounds, std::vector<unsigned int>& order)
+{
+    BenchResult result;
+    uv::EventLoop loop;
+    SetWheel wheel(1);
+    std::vector<std::shared_ptr<SetWheel::Wrapper>> wrappers;
+    for (unsigned int i = 0; i < connections; i++)
+    {
+        wrappers.push_back(std::make_shared<SetWheel::Wrapper>(&result.expired));
+    }
+    unsigned int round = 0;
+    uint64_t stopTime = 0;
+    uv::Timer ticker(&loop, 1000, 1000, [&](uv::Timer* timer)
+    {
+        auto start = uv_hrtime();
+        wheel.tick();
+        result.expireNs += uv_hrtime() - start;
+        if (result.expired == connections)
+        {
+            result.drainMs = uv_now(loop.handle()) - stopTime;
+            timer->close(nullptr);
+            loop.stop();
+        }
+    });
+    ticker.start();
+    uv::Timer traffic(&loop, 1, 1, [&](uv::Timer* timer)
+    {
+        auto start = uv_hrtime();
+        for (auto index : order)
+        {
+            wheel.insert(wrappers[index]);
+        }
+        result.touchNs += uv_hrtime() - start;
+        result.touches += connections;
+        if (++round == rounds)
+        {
+            //之后仅由时间轮持有引用。
+            wrappers.clear();
+            stopTime = uv_now(loop.handle());
+            timer->close(nullptr);
+        }
+    });
+    traffic.start();
+    loop.run();
+    return result;
+}
+
+static BenchResult RunIntrusiveWheel(unsigned int connections, unsigned int rounds, std::vector<unsigned int>& order)
+{
+    BenchResult result;
+    uv::EventLoop loop;
+    std::vector<BenchConnection> nodes(connections);
+    unsigned int round = 0;
+    uint64_t stopTime = 0;
+    uint64_t tickStart = 0;
+    uv::TimerWheel<BenchConnection> wheel(&loop);
+    wheel.setTimeout(1000, 10);
+    wheel.setTimeoutCallback([&](BenchConnection*)
+    {
+        if (0 == result.expired++)
+        {
+            tickStart = uv_hrtime();
+        }
+        if (result.expired == connections)
+        {
+            result.expireNs = uv_hrtime() - tickStart;
+            result.drainMs = uv_now(loop.handle()) - stopTime;
+            loop.stop();
+        }
+    });
+    wheel.start();
+    uv::Timer traffic(&loop, 1, 1, [&](uv::Timer* timer)
+    {
+        auto start = uv_hrtime();
+        for (auto index : order)
+        {
+            wheel.insert(&nodes[index]);
+        }
+        result.touchNs += uv_hrtime() - start;
+        result.touches += connections;
+        if (++round == rounds)
+        {
+            stopTime = uv_now(loop.handle());
+            timer->close(nullptr);
+        }
+    });
+    traffic.start();
+    loop.run();
+    return result;
+}
+
+int main(int argc, char** args)
+{
+    unsigned int connections = 100000;
+    unsigned int rounds = 200;
+    if (argc > 1)
+    {
+        connections = std::stoul(args[1]);
+    }
+    if (argc > 2)
+    {
+        rounds = std::stoul(args[2]);
+    }
+    //消息到达顺序随机，避免顺序访问带来的缓存优势。
+    std::vector<unsigned int> order(connections);
+    for (unsigned int i = 0; i < connections; i++)
+    {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+
+    std::cout << connections << " connections, " << rounds << " rounds of traffic, 1s idle timeout" << std::endl;
+    auto intrusive = RunIntrusiveWheel(connections, rounds, order);
+    Report("intrusive list wheel (10ms resolution)", intrusive);
+    auto set = RunSetWheel(connections, rounds, order);
+    Report("std::set<shared_ptr> wheel (1s resolution)", set);
+}
@@ -0,0 +1,64 @@
+﻿/*
+   Copyright © 2017-2020, orcaer@yeah.net  All rights reserved.
+
+   Author: orcaer@yeah.net
+
+   Last modified: 2026-10-19
+
+   Description: https://github.com/wlgq2/uv-cpp
+*/
+
+#include <iostream>
+#include <uv11.hpp>
+
+int main(int argc, char** args)
+{
+    uv::EventLoop loop;
+#ifndef _WIN32
+    uv::Signal signal(&loop, SIGPIPE, [](int sig)
+    {
+    });
+#endif
+    uv::http::HttpServer::SetBufferMode(uv::GlobalConfig::BufferMode::CycleBuffer);
+
+    uv::http::HttpServer server(&loop);
+    server.setThreadNum(2);
+    uv::http::WebSocketGroup group;
+
+    //example:  ws://127.0.0.1:10014/echo
+    server.WebSocket("/echo", [](uv::http::Request& req, uv::http::WebSocketSessionPtr session)
+    {
+        session->setMessageCallback([](uv::http::WebSocketSessionPtr session, uv::http::WebSocketFrame::Opcode opcode, std::string& message)
+        {
+            session->send(opcode, message.c_str(), message.size());
+        });
+    });
+
+    //example:  ws://127.0.0.1:10014/chat  (消息广播给所有连接)
+    server.WebSocket("/chat", [&group](uv::http::Request& req, uv::http::WebSocketSessionPtr session)
+    {
+        group.add(session);
+        session->setMessageCallback([&group](uv::http::WebSocketSessionPtr session, uv::http::WebSocketFrame::Opcode opcode, std::string& message)
+        {
+            group.broadcast(opcode, message.c_str(), message.size());
+        });
+        session->setCloseCallback([](uv::http::WebSocketSessionPtr session, uint16_t code, const std::string& reason)
+        {
+            std::cout << session->Name() << " closed :" << code << std::endl;
+        });
+    });
+
+    //每秒向聊天组广播一次时间。
+    uv::Timer timer(&loop, 1000, 1000, [&group](uv::Timer*)
+    {
+        if (group.size() > 0)
+        {
+            group.broadcast("tick " + uv::http::ResponseWriter::FormatHttpDate(time(nullptr)));
+        }
+    });
+    timer.start();
+
+    uv::SocketAddr addr("127.0.0.1", 10014);
+    server.bindAndListen(addr);
+    loop.run();
+}
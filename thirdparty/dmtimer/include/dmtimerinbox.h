@@ -0,0 +1,107 @@
+
+// Copyright (c) 2018 brinkqiang (brink.qiang@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __DMTIMERINBOX_H_INCLUDE__
+#define __DMTIMERINBOX_H_INCLUDE__
+
+#include "dmtimersink.h"
+
+#include <atomic>
+
+// 跨线程投递给CDMTimerModule的注册/注销命令
+struct STimerCommand {
+    enum {
+        eCMD_SET = 0,
+        eCMD_KILL,
+    };
+
+    STimerCommand()
+        : m_poNext( NULL ), m_nCmd( eCMD_SET ), m_qwTimerID( 0 ), m_poTimerSink( NULL ),
+          m_qwIDEvent( 0 ), m_qwElapse( 0 ), m_qwFirst( 0 ), m_bExact( false ) {
+    }
+
+    STimerCommand*  m_poNext;
+    int             m_nCmd;
+    uint64_t        m_qwTimerID;
+    ITimerSink*     m_poTimerSink;
+    uint64_t        m_qwIDEvent;
+    uint64_t        m_qwElapse;
+    uint64_t        m_qwFirst;
+    dm::any         m_oAny;
+    bool            m_bExact;
+};
+
+// 多生产者单消费者无锁收件箱: 任意线程Push, 所属线程用PopAll一次取走全部命令
+// 消费者整体取走链表, 不存在ABA问题
+class CDMTimerInbox {
+  public:
+    CDMTimerInbox()
+        : m_poHead( NULL ) {
+    }
+
+    ~CDMTimerInbox() {
+        Clear();
+    }
+
+    void Push( STimerCommand* poCmd ) {
+        STimerCommand* poHead = m_poHead.load( std::memory_order_relaxed );
+
+        do {
+            poCmd->m_poNext = poHead;
+        }
+        while ( !m_poHead.compare_exchange_weak( poHead, poCmd,
+                std::memory_order_release, std::memory_order_relaxed ) );
+    }
+
+    // 按投递顺序返回全部命令, 无命令时返回NULL
+    STimerCommand* PopAll() {
+        if ( NULL == m_poHead.load( std::memory_order_relaxed ) ) {
+            return NULL;
+        }
+
+        STimerCommand* poHead = m_poHead.exchange( NULL, std::memory_order_acquire );
+        STimerCommand* poPrev = NULL;
+
+        while ( poHead ) {
+            STimerCommand* poNext = poHead->m_poNext;
+            poHead->m_poNext = poPrev;
+            poPrev = poHead;
+            poHead = poNext;
+        }
+
+        return poPrev;
+    }
+
+    void Clear() {
+        STimerCommand* poCmd = PopAll();
+
+        while ( poCmd ) {
+            STimerCommand* poNext = poCmd->m_poNext;
+            delete poCmd;
+            poCmd = poNext;
+        }
+    }
+
+  private:
+    std::atomic<STimerCommand*> m_poHead;
+};
+
+#endif // __DMTIMERINBOX_H_INCLUDE__
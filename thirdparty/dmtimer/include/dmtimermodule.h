@@ -1,164 +1,196 @@
-
-// Copyright (c) 2018 brinkqiang (brink.qiang@gmail.com)
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files (the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions:
-//
-// The above copyright notice and this permission notice shall be included in all
-// copies or substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-// SOFTWARE.
-
-#ifndef __DMTIMERMODULE_H_INCLUDE__
-#define __DMTIMERMODULE_H_INCLUDE__
-
-#include "dmsingleton.h"
-#include "dmrapidpool.h"
-#include "dmtimernode.h"
-
-#ifdef WIN32
-struct timezone {
-    int  tz_minuteswest; /* minutes W of Greenwich */
-    int  tz_dsttime;     /* type of dst correction */
-};
-
-#define DELTA_EPOCH_IN_MICROSECS  11644473600000000Ui64
-
-typedef union {
-    uint64_t ft_scalar;
-    FILETIME ft_struct;
-} FT;
-
-static inline int gettimeofday(struct timeval* tv, struct timezone* tz) {
-    FT ft;
-    static int tzflag = 0;
-
-    if (NULL != tv) {
-        GetSystemTimeAsFileTime(&ft.ft_struct);
-        ft.ft_scalar /= 10;
-        ft.ft_scalar -= DELTA_EPOCH_IN_MICROSECS;
-        tv->tv_sec = (long)(ft.ft_scalar / 1000000UL);
-        tv->tv_usec = (long)(ft.ft_scalar % 1000000UL);
-    }
-
-    if (NULL != tz) {
-        if (!tzflag) {
-            _tzset();
-            tzflag++;
-        }
-
-        tz->tz_minuteswest = _timezone / 60;
-        tz->tz_dsttime = _daylight;
-    }
-
-    return 0;
-}
-#else
-#include <time.h>
-#include <sys/time.h>
-#endif
-
-static inline uint32_t GetTickCount32() {
-    //auto now = std::chrono::system_clock::now();
-    //auto now = std::chrono::steady_clock::now();
-    //auto now = std::chrono::high_resolution_clock::now();
-    //return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-#ifdef WIN32
-    return ::GetTickCount();
-#else
-    struct timespec ts = { 0 };
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
-#endif
-}
-
-class CDMTimeElapse {
-  public:
-    CDMTimeElapse() {
-        Start();
-    }
-
-    inline void Start() {
-        m_dwStart = GetTickCount32();
-    }
-
-    inline uint32_t End() {
-        return GetTickCount32() - m_dwStart;
-    }
-
-  private:
-    uint32_t m_dwStart;
-};
-
-
-class CDMTimerModule : public CDMSafeSingleton<CDMTimerModule> {
-  public:
-    friend class CDMSafeSingleton<CDMTimerModule>;
-
-    enum {
-        eMAX_POOL_S = 50000,
-        eMAX_POOL_I = 1000,
-        eMAX_TIME_COUNT = eMAX_POOL_S * eMAX_POOL_I,
-    };
-
-  public:
-    CDMTimerModule();
-
-    virtual ~CDMTimerModule();
-
-    void Init();
-    void UnInit();
-    int Run();
-
-    uint64_t GetCurTime();
-
-    CDMTimerElement* FetchElement();
-    void ReleaseElement( CDMTimerElement* pElement );
-
-    void AddTimerElement( CDMTimerElement* pElement );
-    void RemoveTimerElement( CDMTimerElement* pElement );
-  public:
-    uint64_t GetBootTime();
-
-    void    SetTimerInfo(uint64_t qwIDEvent, const std::string& strTimerObjName);
-    void    DelTimerInfo();
-
-  private:
-    void    __ReleaseElement( struct list_head* head );
-    int     __Cascade( TVec* tv, int idx );
-    bool    __TimerPending( CDMTimerElement* pElement );
-
-    CDMTimerElement* __GetTimerInfoByEntry( list_head* head );
-  private:
-    typedef CDynamicRapidPool<CDMTimerElement, eMAX_POOL_S, eMAX_POOL_I> TimerElementPool;
-
-    TimerElementPool m_oTimerElementPool;
-
-    uint64_t m_qwLastTime;
-    uint64_t m_qwCurTime;
-
-    uint32_t m_dwTickCount;
-    uint64_t m_qwTotalTickCount;
-
-    TVec_Root   m_tv1;
-    TVec        m_tv2;
-    TVec        m_tv3;
-    TVec        m_tv4;
-    TVec        m_tv5;
-
-    uint64_t m_qwIDEvent;
-    std::string m_strTimerObjName;
-};
-
-#endif // __DMTIMERMODULE_H_INCLUDE__
-
+
+// Copyright (c) 2018 brinkqiang (brink.qiang@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __DMTIMERMODULE_H_INCLUDE__
+#define __DMTIMERMODULE_H_INCLUDE__
+
+#include "dmsingleton.h"
+#include "dmrapidpool.h"
+#include "dmtimernode.h"
+#include "dmtimerinbox.h"
+#include "dmtimerprofile.h"
+
+#include <unordered_map>
+
+#ifdef WIN32
+struct timezone {
+    int  tz_minuteswest; /* minutes W of Greenwich */
+    int  tz_dsttime;     /* type of dst correction */
+};
+
+#define DELTA_EPOCH_IN_MICROSECS  11644473600000000Ui64
+
+typedef union {
+    uint64_t ft_scalar;
+    FILETIME ft_struct;
+} FT;
+
+static inline int gettimeofday(struct timeval* tv, struct timezone* tz) {
+    FT ft;
+    static int tzflag = 0;
+
+    if (NULL != tv) {
+        GetSystemTimeAsFileTime(&ft.ft_struct);
+        ft.ft_scalar /= 10;
+        ft.ft_scalar -= DELTA_EPOCH_IN_MICROSECS;
+        tv->tv_sec = (long)(ft.ft_scalar / 1000000UL);
+        tv->tv_usec = (long)(ft.ft_scalar % 1000000UL);
+    }
+
+    if (NULL != tz) {
+        if (!tzflag) {
+            _tzset();
+            tzflag++;
+        }
+
+        tz->tz_minuteswest = _timezone / 60;
+        tz->tz_dsttime = _daylight;
+    }
+
+    return 0;
+}
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+static inline uint32_t GetTickCount32() {
+    //auto now = std::chrono::system_clock::now();
+    //auto now = std::chrono::steady_clock::now();
+    //auto now = std::chrono::high_resolution_clock::now();
+    //return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+#ifdef WIN32
+    return ::GetTickCount();
+#else
+    struct timespec ts = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
+class CDMTimeElapse {
+  public:
+    CDMTimeElapse() {
+        Start();
+    }
+
+    inline void Start() {
+        m_dwStart = GetTickCount32();
+    }
+
+    inline uint32_t End() {
+        return GetTickCount32() - m_dwStart;
+    }
+
+  private:
+    uint32_t m_dwStart;
+};
+
+
+// 每个线程(或EventLoop)可各自持有一个实例, 实例只能在所属线程中使用
+class CDMTimerModule {
+  public:
+    enum {
+        eMAX_POOL_S = 50000,
+        eMAX_POOL_I = 1000,
+        eMAX_TIME_COUNT = eMAX_POOL_S * eMAX_POOL_I,
+    };
+
+  public:
+    CDMTimerModule();
+
+    virtual ~CDMTimerModule();
+
+    // 当前线程的默认实例, 随线程退出而销毁
+    static CDMTimerModule* Instance();
+
+    void Init();
+    void UnInit();
+    int Run();
+
+    uint64_t GetCurTime();
+
+    CDMTimerElement* FetchElement();
+    void ReleaseElement( CDMTimerElement* pElement );
+
+    void AddTimerElement( CDMTimerElement* pElement );
+    void RemoveTimerElement( CDMTimerElement* pElement );
+
+    // 以下两个接口可在任意线程调用, 命令由所属线程在下次Run()开始时执行
+    // 注册timer, 到期时以qwIDEvent回调poSink; 返回模块内唯一的timer ID(非0)
+    // poSink需保持有效, 直至PostKillTimer之后所属线程的下一次Run()或UnInit()返回
+    uint64_t PostTimer( ITimerSink* poSink, uint64_t qwIDEvent, uint64_t qwElapse,
+                        uint64_t qwFirst, const dm::any& oAny = dm::any(), bool bExact = false );
+    // 注销PostTimer返回的timer, ID已注销时忽略
+    void PostKillTimer( uint64_t qwTimerID );
+  public:
+    uint64_t GetBootTime();
+
+    // 正在回调的timer(sink及ID), 不在回调中时返回NULL
+    CDMTimerElement* GetRunningTimer();
+
+    // profile开启时按sink类型和timer ID统计触发次数、延迟及回调耗时, 关闭时不产生开销
+    void    EnableProfile( bool bEnable );
+    bool    IsProfileEnabled();
+    void    ResetProfile();
+    void    DumpProfile( std::string& strOut );
+
+  private:
+    void    __ReleaseElement( struct list_head* head );
+    int     __Cascade( TVec* tv, int idx );
+    void    __OnTimerProfiled( CDMTimerElement* pElement );
+    bool    __TimerPending( CDMTimerElement* pElement );
+
+    CDMTimerElement* __GetTimerInfoByEntry( list_head* head );
+    void    __DrainInbox();
+  private:
+    CDMTimerModule( const CDMTimerModule& );
+    CDMTimerModule& operator=( const CDMTimerModule& );
+  private:
+    typedef CDynamicRapidPool<CDMTimerElement, eMAX_POOL_S, eMAX_POOL_I> TimerElementPool;
+
+    TimerElementPool m_oTimerElementPool;
+
+    uint64_t m_qwLastTime;
+    uint64_t m_qwCurTime;
+
+    uint32_t m_dwTickCount;
+    uint64_t m_qwTotalTickCount;
+
+    TVec_Root   m_tv1;
+    TVec        m_tv2;
+    TVec        m_tv3;
+    TVec        m_tv4;
+    TVec        m_tv5;
+
+    CDMTimerElement* m_poRunningTimer;
+    bool m_bProfile;
+    CDMTimerProfile m_oProfile;
+
+    typedef std::unordered_map<uint64_t, CDMTimerElement*> PostedTimerMap;
+
+    CDMTimerInbox m_oInbox;
+    std::atomic<uint64_t> m_qwNextTimerID;
+    PostedTimerMap m_mapPostedTimer;
+};
+
+#endif // __DMTIMERMODULE_H_INCLUDE__
+
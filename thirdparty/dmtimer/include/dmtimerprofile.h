@@ -0,0 +1,88 @@
+
+// Copyright (c) 2018 brinkqiang (brink.qiang@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __DMTIMERPROFILE_H_INCLUDE__
+#define __DMTIMERPROFILE_H_INCLUDE__
+
+#include "dmtypes.h"
+
+#include <string>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+
+// timer回调统计: 按sink类型和timer ID汇总触发次数、延迟(实际触发与计划时间之差, 毫秒)
+// 及回调耗时(微秒)的log2直方图. 由CDMTimerModule在开启profile时于所属线程中记录
+class CDMTimerProfile {
+  public:
+    enum {
+        eBUCKET_COUNT = 32,
+    };
+
+    struct SHistogram {
+        SHistogram();
+
+        void Record( uint64_t qwValue );
+        // 返回第p百分位所在桶的上限
+        uint64_t Percentile( double dPercent ) const;
+
+        uint64_t m_qwCount;
+        uint64_t m_qwSum;
+        uint64_t m_qwMax;
+        uint64_t m_aqwBucket[eBUCKET_COUNT];
+    };
+
+    struct STimerStat {
+        const std::type_info* m_poType;
+        uint64_t m_qwIDEvent;
+        SHistogram m_oLate;
+        SHistogram m_oCost;
+    };
+
+  public:
+    void Record( const std::type_info& oType, uint64_t qwIDEvent, uint64_t qwLateMs, uint64_t qwCostUs );
+    void Reset();
+
+    // 按总耗时降序输出文本表格
+    void Dump( std::string& strOut ) const;
+
+  private:
+    struct SKey {
+        std::type_index m_oType;
+        uint64_t m_qwIDEvent;
+
+        bool operator==( const SKey& oKey ) const {
+            return m_oType == oKey.m_oType && m_qwIDEvent == oKey.m_qwIDEvent;
+        }
+    };
+
+    struct SKeyHash {
+        size_t operator()( const SKey& oKey ) const {
+            return oKey.m_oType.hash_code() ^ ( std::hash<uint64_t>()( oKey.m_qwIDEvent ) * 31 );
+        }
+    };
+
+    typedef std::unordered_map<SKey, STimerStat, SKeyHash> TimerStatMap;
+
+    TimerStatMap m_mapStat;
+};
+
+#endif // __DMTIMERPROFILE_H_INCLUDE__
@@ -1,218 +1,337 @@
-
-#include "dmtimermodule.h"
-
-CDMTimerModule::CDMTimerModule() {
-    Init();
-}
-
-CDMTimerModule::~CDMTimerModule() {
-    UnInit();
-}
-
-void CDMTimerModule::AddTimerElement( CDMTimerElement* pElement ) {
-    uint64_t qwExpires = pElement->m_qwNextTime;
-    uint64_t idx = static_cast<uint64_t>( qwExpires - m_qwLastTime );
-    struct list_head* vec = NULL;
-
-    if ( idx < TVR_SIZE ) {
-        int i = qwExpires & TVR_MASK;
-        vec = m_tv1.vec + i;
-    }
-    else if ( idx < ( 1 << ( TVR_BITS + TVN_BITS ) ) ) {
-        int i = ( qwExpires >> TVR_BITS ) & TVN_MASK;
-        vec = m_tv2.vec + i;
-    }
-    else if ( idx < ( 1 << ( TVR_BITS + 2 * TVN_BITS ) ) ) {
-        int i = ( qwExpires >> ( TVR_BITS + TVN_BITS ) ) & TVN_MASK;
-        vec = m_tv3.vec + i;
-    }
-    else if ( idx < ( 1 << ( TVR_BITS + 3 * TVN_BITS ) ) ) {
-        int i = ( qwExpires >> ( TVR_BITS + 2 * TVN_BITS ) ) & TVN_MASK;
-        vec = m_tv4.vec + i;
-    }
-    else if ( ( int64_t )idx < 0 ) {
-        vec = m_tv1.vec + ( m_qwLastTime & TVR_MASK );
-    }
-    else {
-        int i;
-
-        if ( idx > 0xffffffffUL ) {
-            idx = 0xffffffffUL;
-            qwExpires = idx + m_qwLastTime;
-        }
-
-        i = ( qwExpires >> ( TVR_BITS + 3 * TVN_BITS ) ) & TVN_MASK;
-        vec = m_tv5.vec + i;
-    }
-
-    list_add_tail( &pElement->m_stEntry, vec );
-}
-
-void CDMTimerModule::__ReleaseElement( struct list_head* head ) {
-    CDMTimerElement* timer = NULL;
-    struct list_head work_list;
-    struct list_head* temp = &work_list;
-    list_replace_init( head, &work_list );
-
-    while ( !list_empty( temp ) ) {
-        timer = __GetTimerInfoByEntry( temp->next );
-        RemoveTimerElement( timer );
-        ReleaseElement( timer );
-    }
-}
-
-int CDMTimerModule::__Cascade( TVec* tv, int idx ) {
-    CDMTimerElement* pTimer = NULL;
-    CDMTimerElement* pTemp = NULL;
-    struct list_head tv_list;
-    list_replace_init( tv->vec + idx, &tv_list );
-
-    for ( pTimer = __GetTimerInfoByEntry( ( &tv_list )->next ),
-            pTemp = __GetTimerInfoByEntry( pTimer->m_stEntry.next );
-            &pTimer->m_stEntry != ( &tv_list );
-            pTimer = pTemp,
-            pTemp = __GetTimerInfoByEntry( pTemp->m_stEntry.next ) ) {
-        AddTimerElement( pTimer );
-    }
-
-    return idx;
-}
-
-bool CDMTimerModule::__TimerPending( CDMTimerElement* pElement ) {
-    return NULL != pElement->m_stEntry.next;
-}
-
-
-void CDMTimerModule::RemoveTimerElement( CDMTimerElement* pElement ) {
-    if ( __TimerPending( pElement ) ) {
-        list_del( &pElement->m_stEntry );
-        pElement->m_stEntry.next = NULL;
-        pElement->m_stEntry.prev = NULL;
-        return;
-    }
-
-    DMASSERT( 0 );
-}
-
-CDMTimerElement* CDMTimerModule::__GetTimerInfoByEntry( struct list_head*
-        head ) {
-    const struct list_head* ptr = head;
-    return ( CDMTimerElement* )( ( char* )ptr - offsetof( CDMTimerElement,
-                                 m_stEntry ) );
-}
-
-void CDMTimerModule::Init() {
-    for ( int j = 0; j < TVR_SIZE; ++j ) {
-        INIT_LIST_HEAD( m_tv1.vec + j );
-    }
-
-    for ( int i = 0; i < TVN_SIZE; ++i ) {
-        INIT_LIST_HEAD( m_tv2.vec + i );
-        INIT_LIST_HEAD( m_tv3.vec + i );
-        INIT_LIST_HEAD( m_tv4.vec + i );
-        INIT_LIST_HEAD( m_tv5.vec + i );
-    }
-
-    m_dwTickCount = GetTickCount32();
-    m_qwTotalTickCount =  0;
-    m_qwLastTime = GetBootTime();
-    m_qwCurTime =  GetBootTime();
-}
-
-void CDMTimerModule::UnInit() {
-    for ( int j = 0; j < TVN_SIZE; ++j ) {
-        __ReleaseElement( m_tv5.vec + j );
-        __ReleaseElement( m_tv4.vec + j );
-        __ReleaseElement( m_tv3.vec + j );
-        __ReleaseElement( m_tv2.vec + j );
-    }
-
-    for ( int i = 0; i < TVR_SIZE; ++i ) {
-        __ReleaseElement( m_tv1.vec + i );
-    }
-}
-
-int CDMTimerModule::Run() {
-    int nEvents = 0;
-    m_qwCurTime =  GetBootTime();
-    CDMTimerElement* timer = NULL;
-
-    while ( DM_TIME_NOT_EQ( m_qwCurTime, m_qwLastTime ) ) {
-        struct list_head work_list;
-        struct list_head* temp = &work_list;
-        int index = m_qwLastTime & TVR_MASK;
-
-        if ( !index
-                && ( !__Cascade( &m_tv2, DM_INDEX( m_qwLastTime, 0 ) ) )
-                && ( !__Cascade( &m_tv3, DM_INDEX( m_qwLastTime, 1 ) ) )
-                && ( !__Cascade( &m_tv4, DM_INDEX( m_qwLastTime, 2 ) ) ) ) {
-            __Cascade( &m_tv5, DM_INDEX( m_qwLastTime, 3 ) );
-        }
-
-        list_replace_init( m_tv1.vec + index, &work_list );
-
-        while ( !list_empty( temp ) ) {
-            timer = __GetTimerInfoByEntry( temp->next );
-            RemoveTimerElement( timer );
-
-            if ( timer->m_bErased ) {
-                ReleaseElement( timer );
-                continue;
-            }
-
-            SetTimerInfo(timer->m_qwID, typeid(*(timer->m_poTimerSink)).name());
-            timer->m_poTimerSink->OnTimer( timer->m_qwID, timer->m_oAny );
-            DelTimerInfo();
-            ++nEvents;
-
-            if ( timer->m_bErased ) {
-                ReleaseElement( timer );
-                continue;
-            }
-
-            timer->m_qwNextTime += timer->m_qwElapse;
-
-            if ( !timer->m_bExact && m_qwCurTime >= timer->m_qwNextTime ) {
-                timer->m_qwNextTime = m_qwCurTime + timer->m_qwElapse;
-            }
-
-            AddTimerElement( timer );
-        }
-
-        ++m_qwLastTime;
-    }
-
-    return nEvents;
-}
-
-uint64_t CDMTimerModule::GetCurTime() {
-    return m_qwCurTime;
-}
-
-uint64_t CDMTimerModule::GetBootTime() {
-    uint32_t dwCurTime = GetTickCount32();
-    uint32_t dwPassedTime = dwCurTime - m_dwTickCount;
-    m_dwTickCount = dwCurTime;
-    m_qwTotalTickCount += dwPassedTime;
-    return m_qwTotalTickCount;
-}
-
-void CDMTimerModule::SetTimerInfo(uint64_t qwIDEvent, const std::string& strTimerObjName)
-{
-    m_qwIDEvent = qwIDEvent;
-    m_strTimerObjName = strTimerObjName;
-}
-
-void CDMTimerModule::DelTimerInfo()
-{
-    m_qwIDEvent = 0;
-    m_strTimerObjName.clear();
-}
-
-CDMTimerElement* CDMTimerModule::FetchElement() {
-    return m_oTimerElementPool.FetchObj();
-}
-
-void CDMTimerModule::ReleaseElement( CDMTimerElement* pElement ) {
-    m_oTimerElementPool.ReleaseObj( pElement );
-}
+
+#include "dmtimermodule.h"
+
+#include <chrono>
+
+CDMTimerModule::CDMTimerModule()
+    : m_poRunningTimer( NULL ), m_bProfile( false ), m_qwNextTimerID( 0 ) {
+    Init();
+}
+
+CDMTimerModule::~CDMTimerModule() {
+    UnInit();
+}
+
+CDMTimerModule* CDMTimerModule::Instance() {
+    static thread_local CDMTimerModule s_oModule;
+    return &s_oModule;
+}
+
+void CDMTimerModule::AddTimerElement( CDMTimerElement* pElement ) {
+    uint64_t qwExpires = pElement->m_qwNextTime;
+    uint64_t idx = static_cast<uint64_t>( qwExpires - m_qwLastTime );
+    struct list_head* vec = NULL;
+
+    if ( idx < TVR_SIZE ) {
+        int i = qwExpires & TVR_MASK;
+        vec = m_tv1.vec + i;
+    }
+    else if ( idx < ( 1 << ( TVR_BITS + TVN_BITS ) ) ) {
+        int i = ( qwExpires >> TVR_BITS ) & TVN_MASK;
+        vec = m_tv2.vec + i;
+    }
+    else if ( idx < ( 1 << ( TVR_BITS + 2 * TVN_BITS ) ) ) {
+        int i = ( qwExpires >> ( TVR_BITS + TVN_BITS ) ) & TVN_MASK;
+        vec = m_tv3.vec + i;
+    }
+    else if ( idx < ( 1 << ( TVR_BITS + 3 * TVN_BITS ) ) ) {
+        int i = ( qwExpires >> ( TVR_BITS + 2 * TVN_BITS ) ) & TVN_MASK;
+        vec = m_tv4.vec + i;
+    }
+    else if ( ( int64_t )idx < 0 ) {
+        vec = m_tv1.vec + ( m_qwLastTime & TVR_MASK );
+    }
+    else {
+        int i;
+
+        if ( idx > 0xffffffffUL ) {
+            idx = 0xffffffffUL;
+            qwExpires = idx + m_qwLastTime;
+        }
+
+        i = ( qwExpires >> ( TVR_BITS + 3 * TVN_BITS ) ) & TVN_MASK;
+        vec = m_tv5.vec + i;
+    }
+
+    list_add_tail( &pElement->m_stEntry, vec );
+}
+
+void CDMTimerModule::__ReleaseElement( struct list_head* head ) {
+    CDMTimerElement* timer = NULL;
+    struct list_head work_list;
+    struct list_head* temp = &work_list;
+    list_replace_init( head, &work_list );
+
+    while ( !list_empty( temp ) ) {
+        timer = __GetTimerInfoByEntry( temp->next );
+        RemoveTimerElement( timer );
+
+        // 未注销的timer通知其节点解除引用, 节点之后可继续使用
+        if ( !timer->m_bErased && timer->m_poTimerSink ) {
+            timer->m_poTimerSink->OnTimerDetach( timer );
+        }
+
+        ReleaseElement( timer );
+    }
+}
+
+int CDMTimerModule::__Cascade( TVec* tv, int idx ) {
+    CDMTimerElement* pTimer = NULL;
+    CDMTimerElement* pTemp = NULL;
+    struct list_head tv_list;
+    list_replace_init( tv->vec + idx, &tv_list );
+
+    for ( pTimer = __GetTimerInfoByEntry( ( &tv_list )->next ),
+            pTemp = __GetTimerInfoByEntry( pTimer->m_stEntry.next );
+            &pTimer->m_stEntry != ( &tv_list );
+            pTimer = pTemp,
+            pTemp = __GetTimerInfoByEntry( pTemp->m_stEntry.next ) ) {
+        AddTimerElement( pTimer );
+    }
+
+    return idx;
+}
+
+bool CDMTimerModule::__TimerPending( CDMTimerElement* pElement ) {
+    return NULL != pElement->m_stEntry.next;
+}
+
+
+void CDMTimerModule::RemoveTimerElement( CDMTimerElement* pElement ) {
+    if ( __TimerPending( pElement ) ) {
+        list_del( &pElement->m_stEntry );
+        pElement->m_stEntry.next = NULL;
+        pElement->m_stEntry.prev = NULL;
+        return;
+    }
+
+    DMASSERT( 0 );
+}
+
+CDMTimerElement* CDMTimerModule::__GetTimerInfoByEntry( struct list_head*
+        head ) {
+    const struct list_head* ptr = head;
+    return ( CDMTimerElement* )( ( char* )ptr - offsetof( CDMTimerElement,
+                                 m_stEntry ) );
+}
+
+void CDMTimerModule::Init() {
+    for ( int j = 0; j < TVR_SIZE; ++j ) {
+        INIT_LIST_HEAD( m_tv1.vec + j );
+    }
+
+    for ( int i = 0; i < TVN_SIZE; ++i ) {
+        INIT_LIST_HEAD( m_tv2.vec + i );
+        INIT_LIST_HEAD( m_tv3.vec + i );
+        INIT_LIST_HEAD( m_tv4.vec + i );
+        INIT_LIST_HEAD( m_tv5.vec + i );
+    }
+
+    m_dwTickCount = GetTickCount32();
+    m_qwTotalTickCount =  0;
+    m_qwLastTime = GetBootTime();
+    m_qwCurTime =  GetBootTime();
+}
+
+void CDMTimerModule::UnInit() {
+    // 先执行已投递的注销命令, 对应的sink此后可能已被销毁
+    __DrainInbox();
+
+    // 投递的定时器不属于任何CDMTimerNode, 释放时不通知其sink
+    for ( PostedTimerMap::iterator It = m_mapPostedTimer.begin();
+            It != m_mapPostedTimer.end(); ++It ) {
+        It->second->Kill();
+    }
+
+    m_mapPostedTimer.clear();
+
+    for ( int j = 0; j < TVN_SIZE; ++j ) {
+        __ReleaseElement( m_tv5.vec + j );
+        __ReleaseElement( m_tv4.vec + j );
+        __ReleaseElement( m_tv3.vec + j );
+        __ReleaseElement( m_tv2.vec + j );
+    }
+
+    for ( int i = 0; i < TVR_SIZE; ++i ) {
+        __ReleaseElement( m_tv1.vec + i );
+    }
+}
+
+int CDMTimerModule::Run() {
+    int nEvents = 0;
+    m_qwCurTime =  GetBootTime();
+    CDMTimerElement* timer = NULL;
+
+    __DrainInbox();
+
+    while ( DM_TIME_NOT_EQ( m_qwCurTime, m_qwLastTime ) ) {
+        struct list_head work_list;
+        struct list_head* temp = &work_list;
+        int index = m_qwLastTime & TVR_MASK;
+
+        if ( !index
+                && ( !__Cascade( &m_tv2, DM_INDEX( m_qwLastTime, 0 ) ) )
+                && ( !__Cascade( &m_tv3, DM_INDEX( m_qwLastTime, 1 ) ) )
+                && ( !__Cascade( &m_tv4, DM_INDEX( m_qwLastTime, 2 ) ) ) ) {
+            __Cascade( &m_tv5, DM_INDEX( m_qwLastTime, 3 ) );
+        }
+
+        list_replace_init( m_tv1.vec + index, &work_list );
+
+        while ( !list_empty( temp ) ) {
+            timer = __GetTimerInfoByEntry( temp->next );
+            RemoveTimerElement( timer );
+
+            if ( timer->m_bErased ) {
+                ReleaseElement( timer );
+                continue;
+            }
+
+            if ( m_bProfile ) {
+                __OnTimerProfiled( timer );
+            }
+            else {
+                m_poRunningTimer = timer;
+                timer->m_poTimerSink->OnTimer( timer->m_qwID, timer->m_oAny );
+                m_poRunningTimer = NULL;
+            }
+
+            ++nEvents;
+
+            if ( timer->m_bErased ) {
+                ReleaseElement( timer );
+                continue;
+            }
+
+            timer->m_qwNextTime += timer->m_qwElapse;
+
+            if ( !timer->m_bExact && m_qwCurTime >= timer->m_qwNextTime ) {
+                timer->m_qwNextTime = m_qwCurTime + timer->m_qwElapse;
+            }
+
+            AddTimerElement( timer );
+        }
+
+        ++m_qwLastTime;
+    }
+
+    return nEvents;
+}
+
+uint64_t CDMTimerModule::PostTimer( ITimerSink* poSink, uint64_t qwIDEvent,
+                                    uint64_t qwElapse, uint64_t qwFirst, const dm::any& oAny, bool bExact ) {
+    STimerCommand* poCmd = new STimerCommand();
+    poCmd->m_nCmd = STimerCommand::eCMD_SET;
+    poCmd->m_qwTimerID = ++m_qwNextTimerID;
+    poCmd->m_poTimerSink = poSink;
+    poCmd->m_qwIDEvent = qwIDEvent;
+    poCmd->m_qwElapse = qwElapse;
+    poCmd->m_qwFirst = qwFirst;
+    poCmd->m_oAny = oAny;
+    poCmd->m_bExact = bExact;
+    uint64_t qwTimerID = poCmd->m_qwTimerID;
+    m_oInbox.Push( poCmd );
+    return qwTimerID;
+}
+
+void CDMTimerModule::PostKillTimer( uint64_t qwTimerID ) {
+    STimerCommand* poCmd = new STimerCommand();
+    poCmd->m_nCmd = STimerCommand::eCMD_KILL;
+    poCmd->m_qwTimerID = qwTimerID;
+    m_oInbox.Push( poCmd );
+}
+
+void CDMTimerModule::__DrainInbox() {
+    // 注销命令只能在拿到ID之后投递, 因此总排在对应的注册命令之后
+    STimerCommand* poCmd = m_oInbox.PopAll();
+
+    while ( poCmd ) {
+        STimerCommand* poNext = poCmd->m_poNext;
+
+        if ( STimerCommand::eCMD_SET == poCmd->m_nCmd ) {
+            CDMTimerElement* poNewTimer = FetchElement();
+
+            if ( NULL == poNewTimer ) {
+                DMASSERT( 0 );
+            }
+            else {
+                poNewTimer->m_poTimerSink = poCmd->m_poTimerSink;
+                poNewTimer->m_qwID = poCmd->m_qwIDEvent;
+                poNewTimer->m_qwElapse = poCmd->m_qwElapse;
+                poNewTimer->m_bErased = false;
+                poNewTimer->m_bExact = poCmd->m_bExact;
+                poNewTimer->m_oAny = poCmd->m_oAny;
+                poNewTimer->m_qwNextTime = m_qwCurTime + poCmd->m_qwFirst;
+                AddTimerElement( poNewTimer );
+                m_mapPostedTimer[poCmd->m_qwTimerID] = poNewTimer;
+            }
+        }
+        else {
+            PostedTimerMap::iterator It = m_mapPostedTimer.find( poCmd->m_qwTimerID );
+
+            if ( It != m_mapPostedTimer.end() ) {
+                It->second->Kill();
+                m_mapPostedTimer.erase( It );
+            }
+        }
+
+        delete poCmd;
+        poCmd = poNext;
+    }
+}
+
+uint64_t CDMTimerModule::GetCurTime() {
+    return m_qwCurTime;
+}
+
+uint64_t CDMTimerModule::GetBootTime() {
+    uint32_t dwCurTime = GetTickCount32();
+    uint32_t dwPassedTime = dwCurTime - m_dwTickCount;
+    m_dwTickCount = dwCurTime;
+    m_qwTotalTickCount += dwPassedTime;
+    return m_qwTotalTickCount;
+}
+
+CDMTimerElement* CDMTimerModule::GetRunningTimer() {
+    return m_poRunningTimer;
+}
+
+void CDMTimerModule::EnableProfile( bool bEnable ) {
+    m_bProfile = bEnable;
+}
+
+bool CDMTimerModule::IsProfileEnabled() {
+    return m_bProfile;
+}
+
+void CDMTimerModule::ResetProfile() {
+    m_oProfile.Reset();
+}
+
+void CDMTimerModule::DumpProfile( std::string& strOut ) {
+    m_oProfile.Dump( strOut );
+}
+
+void CDMTimerModule::__OnTimerProfiled( CDMTimerElement* pElement ) {
+    // 回调中sink可能被销毁, 类型和ID需在回调前取出
+    const std::type_info& oType = typeid( *( pElement->m_poTimerSink ) );
+    uint64_t qwIDEvent = pElement->m_qwID;
+    uint64_t qwLate = m_qwCurTime > pElement->m_qwNextTime ? m_qwCurTime - pElement->m_qwNextTime : 0;
+    std::chrono::steady_clock::time_point oStart = std::chrono::steady_clock::now();
+
+    m_poRunningTimer = pElement;
+    pElement->m_poTimerSink->OnTimer( qwIDEvent, pElement->m_oAny );
+    m_poRunningTimer = NULL;
+
+    uint64_t qwCost = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - oStart ).count();
+    m_oProfile.Record( oType, qwIDEvent, qwLate, qwCost );
+}
+
+CDMTimerElement* CDMTimerModule::FetchElement() {
+    return m_oTimerElementPool.FetchObj();
+}
+
+void CDMTimerModule::ReleaseElement( CDMTimerElement* pElement ) {
+    m_oTimerElementPool.ReleaseObj( pElement );
+}
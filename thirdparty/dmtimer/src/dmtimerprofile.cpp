@@ -0,0 +1,124 @@
+
+#include "dmtimerprofile.h"
+
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+static std::string DMTypeName( const std::type_info& oType ) {
+#ifdef __GNUC__
+    int nStatus = 0;
+    char* pName = abi::__cxa_demangle( oType.name(), NULL, NULL, &nStatus );
+
+    if ( 0 == nStatus && pName ) {
+        std::string strName( pName );
+        free( pName );
+        return strName;
+    }
+
+    free( pName );
+#endif
+    return oType.name();
+}
+
+CDMTimerProfile::SHistogram::SHistogram()
+    : m_qwCount( 0 ), m_qwSum( 0 ), m_qwMax( 0 ) {
+    memset( m_aqwBucket, 0, sizeof( m_aqwBucket ) );
+}
+
+void CDMTimerProfile::SHistogram::Record( uint64_t qwValue ) {
+    // 桶0为0, 桶i为[2^(i-1), 2^i)
+    int nBucket = 0;
+
+    while ( nBucket < eBUCKET_COUNT - 1 && ( 1ull << nBucket ) <= qwValue ) {
+        ++nBucket;
+    }
+
+    ++m_aqwBucket[nBucket];
+    ++m_qwCount;
+    m_qwSum += qwValue;
+
+    if ( qwValue > m_qwMax ) {
+        m_qwMax = qwValue;
+    }
+}
+
+uint64_t CDMTimerProfile::SHistogram::Percentile( double dPercent ) const {
+    if ( 0 == m_qwCount ) {
+        return 0;
+    }
+
+    uint64_t qwRank = ( uint64_t )( dPercent / 100 * m_qwCount );
+    uint64_t qwSeen = 0;
+
+    for ( int i = 0; i < eBUCKET_COUNT; ++i ) {
+        qwSeen += m_aqwBucket[i];
+
+        if ( qwSeen > qwRank ) {
+            return std::min<uint64_t>( i == 0 ? 0 : ( 1ull << i ) - 1, m_qwMax );
+        }
+    }
+
+    return m_qwMax;
+}
+
+void CDMTimerProfile::Record( const std::type_info& oType, uint64_t qwIDEvent,
+                              uint64_t qwLateMs, uint64_t qwCostUs ) {
+    SKey oKey = { std::type_index( oType ), qwIDEvent };
+    TimerStatMap::iterator It = m_mapStat.find( oKey );
+
+    if ( It == m_mapStat.end() ) {
+        STimerStat oStat;
+        oStat.m_poType = &oType;
+        oStat.m_qwIDEvent = qwIDEvent;
+        It = m_mapStat.insert( std::make_pair( oKey, oStat ) ).first;
+    }
+
+    It->second.m_oLate.Record( qwLateMs );
+    It->second.m_oCost.Record( qwCostUs );
+}
+
+void CDMTimerProfile::Reset() {
+    m_mapStat.clear();
+}
+
+void CDMTimerProfile::Dump( std::string& strOut ) const {
+    std::vector<const STimerStat*> vecStat;
+
+    for ( TimerStatMap::const_iterator It = m_mapStat.begin(); It != m_mapStat.end(); ++It ) {
+        vecStat.push_back( &It->second );
+    }
+
+    std::sort( vecStat.begin(), vecStat.end(), []( const STimerStat * pLeft, const STimerStat * pRight ) {
+        return pLeft->m_oCost.m_qwSum > pRight->m_oCost.m_qwSum;
+    } );
+
+    char szLine[512];
+    snprintf( szLine, sizeof( szLine ), "%-32s %10s %10s %8s %8s %8s %10s %10s %10s %12s\n",
+              "sink", "id", "count", "late50", "late99", "lateMax",
+              "cost50", "cost99", "costMax", "costTotal" );
+    strOut += szLine;
+
+    for ( size_t i = 0; i < vecStat.size(); ++i ) {
+        const STimerStat* pStat = vecStat[i];
+        snprintf( szLine, sizeof( szLine ),
+                  "%-32s %10llu %10llu %8llu %8llu %8llu %10llu %10llu %10llu %12llu\n",
+                  DMTypeName( *pStat->m_poType ).c_str(),
+                  ( unsigned long long )pStat->m_qwIDEvent,
+                  ( unsigned long long )pStat->m_oCost.m_qwCount,
+                  ( unsigned long long )pStat->m_oLate.Percentile( 50 ),
+                  ( unsigned long long )pStat->m_oLate.Percentile( 99 ),
+                  ( unsigned long long )pStat->m_oLate.m_qwMax,
+                  ( unsigned long long )pStat->m_oCost.Percentile( 50 ),
+                  ( unsigned long long )pStat->m_oCost.Percentile( 99 ),
+                  ( unsigned long long )pStat->m_oCost.m_qwMax,
+                  ( unsigned long long )pStat->m_oCost.m_qwSum );
+        strOut += szLine;
+    }
+}